@@ -0,0 +1,152 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace bench;
+
+void Samples::add(double value) {
+    if (!values.empty() && values.back() > value) {
+        sorted = false;
+    }
+    values.push_back(value);
+}
+
+double Samples::sum() const {
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+double Samples::mean() const {
+    if (values.empty()) {
+        return 0.0;
+    }
+    return sum() / values.size();
+}
+
+double Samples::min() const {
+    if (values.empty()) {
+        return 0.0;
+    }
+    return *std::min_element(values.begin(), values.end());
+}
+
+double Samples::max() const {
+    if (values.empty()) {
+        return 0.0;
+    }
+    return *std::max_element(values.begin(), values.end());
+}
+
+double Samples::percentile(double p) const {
+    if (values.empty()) {
+        return 0.0;
+    }
+    if (!sorted) {
+        std::sort(values.begin(), values.end());
+        sorted = true;
+    }
+    // nearest-rank method
+    size_t rank = std::ceil(p / 100.0 * values.size());
+    rank = std::clamp<size_t>(rank, 1, values.size());
+    return values[rank - 1];
+}
+
+void Report::begin(const std::string& name) {
+    benchmark = name;
+    results[benchmark] = dv::object();
+    stream << "[" << name << "]" << std::endl;
+}
+
+void Report::add(
+    const std::string& metric, const Samples& samples, const std::string& unit
+) {
+    stream << std::fixed << std::setprecision(3);
+    stream << "  " << std::left << std::setw(40) << metric
+           << " n=" << samples.count()
+           << " mean=" << samples.mean()
+           << " p50=" << samples.percentile(50)
+           << " p95=" << samples.percentile(95)
+           << " p99=" << samples.percentile(99)
+           << " max=" << samples.max() << " " << unit << std::endl;
+
+    results[benchmark][metric] = dv::object({
+        {"unit", unit},
+        {"count", static_cast<dv::integer_t>(samples.count())},
+        {"mean", samples.mean()},
+        {"min", samples.min()},
+        {"p50", samples.percentile(50)},
+        {"p95", samples.percentile(95)},
+        {"p99", samples.percentile(99)},
+        {"max", samples.max()},
+    });
+}
+
+void Report::add(
+    const std::string& metric, double value, const std::string& unit
+) {
+    stream << std::fixed << std::setprecision(3);
+    stream << "  " << std::left << std::setw(40) << metric << " " << value
+           << " " << unit << std::endl;
+
+    results[benchmark][metric] = dv::object({
+        {"unit", unit},
+        {"value", value},
+    });
+}
+
+size_t bench::peak_rss() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters {};
+    if (!GetProcessMemoryInfo(
+            GetCurrentProcess(), &counters, sizeof(counters)
+        )) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage)) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    // kilobytes on Linux
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+static std::filesystem::path res_folder = "res";
+
+void bench::set_res_folder(std::filesystem::path folder) {
+    res_folder = std::move(folder);
+}
+
+const std::filesystem::path& bench::get_res_folder() {
+    return res_folder;
+}
+
+static std::vector<Benchmark>& benchmarks() {
+    static std::vector<Benchmark> list;
+    return list;
+}
+
+int bench::add(std::string name, BenchmarkFunc func) {
+    benchmarks().push_back(Benchmark {std::move(name), std::move(func)});
+    return static_cast<int>(benchmarks().size());
+}
+
+const std::vector<Benchmark>& bench::get_all() {
+    return benchmarks();
+}
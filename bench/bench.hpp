@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "data/dv.hpp"
+
+namespace bench {
+    /// @brief Measured values of a single metric
+    class Samples {
+        /// @brief Sorted lazily by percentile()
+        mutable std::vector<double> values;
+        mutable bool sorted = true;
+    public:
+        void add(double value);
+
+        size_t count() const {
+            return values.size();
+        }
+
+        double sum() const;
+        double mean() const;
+        double min() const;
+        double max() const;
+
+        /// @param p percentile in range [0, 100]
+        double percentile(double p) const;
+    };
+
+    /// @brief Benchmark results writer. Results are also collected
+    /// to be written as JSON
+    class Report {
+        std::ostream& stream;
+        std::string benchmark;
+        dv::value results = dv::object();
+    public:
+        Report(std::ostream& stream) : stream(stream) {
+        }
+
+        void begin(const std::string& name);
+
+        /// @brief Write metric statistics
+        void add(
+            const std::string& metric,
+            const Samples& samples,
+            const std::string& unit
+        );
+
+        /// @brief Write a single value metric
+        void add(const std::string& metric, double value, const std::string& unit);
+
+        /// @return {benchmark: {metric: {unit, count, mean, p50, ...}}}
+        const dv::value& getResults() const {
+            return results;
+        }
+    };
+
+    /// @return peak resident set size of the process in bytes
+    size_t peak_rss();
+
+    /// @brief Set engine resources folder used by benchmarks running
+    /// the engine (--res option)
+    void set_res_folder(std::filesystem::path folder);
+
+    const std::filesystem::path& get_res_folder();
+
+    using BenchmarkFunc = std::function<void(Report&)>;
+
+    struct Benchmark {
+        std::string name;
+        BenchmarkFunc func;
+    };
+
+    /// @brief Register benchmark (see VC_BENCHMARK)
+    int add(std::string name, BenchmarkFunc func);
+
+    const std::vector<Benchmark>& get_all();
+
+    /// @brief Microseconds elapsed since the timer creation
+    class Stopwatch {
+        std::chrono::high_resolution_clock::time_point start;
+    public:
+        Stopwatch() : start(std::chrono::high_resolution_clock::now()) {
+        }
+
+        double elapsedMicros() const {
+            using namespace std::chrono;
+            return duration<double, std::micro>(
+                       high_resolution_clock::now() - start
+            ).count();
+        }
+    };
+
+    /// @brief Prevent the compiler from removing the value computation
+    template <typename T>
+    inline void keep(const T& value) {
+#ifdef _MSC_VER
+        static const void* volatile sink;
+        sink = &value;
+#else
+        asm volatile("" : : "g"(&value) : "memory");
+#endif
+    }
+}
+
+#define VC_BENCHMARK(NAME)                                          \
+    static void vc_benchmark_##NAME(bench::Report& report);         \
+    static int vc_benchmark_reg_##NAME =                            \
+        bench::add(#NAME, vc_benchmark_##NAME);                     \
+    static void vc_benchmark_##NAME(bench::Report& report)
@@ -0,0 +1,235 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "coders/binary_json.hpp"
+#include "coders/compression.hpp"
+#include "io/devices/StdfsDevice.hpp"
+#include "io/io.hpp"
+#include "lighting/Lightmap.hpp"
+#include "voxels/Chunk.hpp"
+#include "world/files/WorldRegions.hpp"
+
+// Chunk codecs speed and ratio on regions layers data.
+// Chunks are read from the world set with VC_BENCH_WORLD environment
+// variable (world folder path) or generated
+
+static inline constexpr int MAX_CHUNKS = 256;
+static inline constexpr int GENERATED_AREA_SIZE = 8;
+static inline constexpr int ITERATIONS = 3;
+
+using Sample = std::vector<ubyte>;
+
+namespace {
+    struct LayersSamples {
+        std::vector<Sample> voxels;
+        std::vector<Sample> lights;
+        std::vector<Sample> entities;
+    };
+}
+
+static void read_world(const char* path, LayersSamples& samples) {
+    io::set_device(
+        "benchworld", std::make_shared<io::StdfsDevice>(path, false)
+    );
+    {
+        WorldRegions regions("benchworld:");
+        auto folder = regions.getRegionsFolder(REGION_LAYER_VOXELS);
+        for (const auto& file : io::directory_iterator(folder)) {
+            int regionX, regionZ;
+            auto name = file.stem();
+            if (!WorldRegions::parseRegionFilename(name, regionX, regionZ)) {
+                continue;
+            }
+            for (int i = 0; i < REGION_CHUNKS_COUNT; i++) {
+                if (samples.voxels.size() >= MAX_CHUNKS) {
+                    break;
+                }
+                int x = regionX * REGION_SIZE + i % REGION_SIZE;
+                int z = regionZ * REGION_SIZE + i / REGION_SIZE;
+                Sample voxels(CHUNK_DATA_LEN);
+                if (!regions.getVoxels(x, z, voxels.data())) {
+                    continue;
+                }
+                samples.voxels.push_back(std::move(voxels));
+
+                Sample lights(LIGHTMAP_DATA_LEN);
+                if (regions.getLights(x, z, lights.data())) {
+                    samples.lights.push_back(std::move(lights));
+                }
+                auto entities = regions.fetchEntities(x, z);
+                if (entities != nullptr) {
+                    samples.entities.push_back(json::to_binary(entities));
+                }
+            }
+        }
+    }
+    io::remove_device("benchworld");
+}
+
+static Sample generate_entities(int cx, int cz) {
+    auto root = dv::object();
+    auto& list = root.list("data");
+    for (int i = 0; i < (cx * 7 + cz * 3) % 5 + 1; i++) {
+        auto& entity = list.object();
+        entity["def"] = i % 2 ? "base:drop" : "base:falling_block";
+        entity["uid"] = (cx * 31 + cz) * 16 + i;
+        auto& transform = entity.object("transform");
+        auto& pos = transform.list("pos");
+        pos.add(cx * CHUNK_W + i * 1.75);
+        pos.add(64.0 + i);
+        pos.add(cz * CHUNK_D + i * 0.5);
+        auto& rigidbody = entity.object("rigidbody");
+        auto& vel = rigidbody.list("vel");
+        vel.add(0.0);
+        vel.add(-9.8 * i);
+        vel.add(0.0);
+    }
+    return json::to_binary(root);
+}
+
+/// @brief Terrain with caves and ores lighted by the sky
+static void generate(LayersSamples& samples) {
+    for (int cz = 0; cz < GENERATED_AREA_SIZE; cz++) {
+        for (int cx = 0; cx < GENERATED_AREA_SIZE; cx++) {
+            Chunk chunk(cx, cz, std::make_shared<Lightmap>());
+            for (int z = 0; z < CHUNK_D; z++) {
+                for (int x = 0; x < CHUNK_W; x++) {
+                    int gx = cx * CHUNK_W + x;
+                    int gz = cz * CHUNK_D + z;
+                    int height = 64 + static_cast<int>(
+                        std::sin(gx * 0.07) * 12 + std::cos(gz * 0.05) * 10
+                    );
+                    for (int y = 0; y < CHUNK_H; y++) {
+                        // stone under a layer of dirt
+                        blockid_t id = 0;
+                        if (y < height) {
+                            id = y < height - 4 ? 1 : 2;
+                        }
+                        if (id && y > 20 &&
+                            std::sin(gx * 0.2 + y * 0.3) *
+                                    std::cos(gz * 0.15 - y * 0.1) > 0.6) {
+                            id = 0;
+                        }
+                        uint hash = (gx * 73856093U) ^ (y * 19349663U) ^
+                                    (gz * 83492791U);
+                        if (id == 1 && hash % 97 == 0) {
+                            id = 3 + hash % 4;
+                        }
+                        chunk.getVoxels()[vox_index(x, y, z)].id = id;
+                        if (y >= height) {
+                            chunk.lightmap->setS(x, y, z, 15);
+                        }
+                    }
+                }
+            }
+            auto voxels = chunk.encode();
+            samples.voxels.emplace_back(
+                voxels.get(), voxels.get() + CHUNK_DATA_LEN
+            );
+            auto lights = chunk.lightmap->encode();
+            samples.lights.emplace_back(
+                lights.get(), lights.get() + LIGHTMAP_DATA_LEN
+            );
+            samples.entities.push_back(generate_entities(cx, cz));
+        }
+    }
+}
+
+static void measure(
+    bench::Report& report,
+    const std::string& prefix,
+    const std::vector<Sample>& samples,
+    compression::Method method,
+    const compression::Dictionary* dictionary = nullptr
+) {
+    if (samples.empty()) {
+        return;
+    }
+    size_t srcTotal = 0;
+    size_t dstTotal = 0;
+    bench::Samples encodeSpeed;
+    bench::Samples decodeSpeed;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        std::vector<std::unique_ptr<ubyte[]>> encoded;
+        std::vector<size_t> lengths;
+        srcTotal = dstTotal = 0;
+
+        bench::Stopwatch encodeTimer;
+        for (const auto& sample : samples) {
+            size_t length;
+            encoded.push_back(compression::compress(
+                sample.data(), sample.size(), length, method, dictionary
+            ));
+            lengths.push_back(length);
+            srcTotal += sample.size();
+            dstTotal += length;
+        }
+        encodeSpeed.add(srcTotal / encodeTimer.elapsedMicros());
+
+        bench::Stopwatch decodeTimer;
+        for (size_t i = 0; i < samples.size(); i++) {
+            auto decoded = compression::decompress(
+                encoded[i].get(),
+                lengths[i],
+                samples[i].size(),
+                method,
+                dictionary
+            );
+            bench::keep(decoded);
+        }
+        decodeSpeed.add(srcTotal / decodeTimer.elapsedMicros());
+    }
+    report.add(prefix + "encode", encodeSpeed, "MB/s");
+    report.add(prefix + "decode", decodeSpeed, "MB/s");
+    report.add(
+        prefix + "ratio", static_cast<double>(srcTotal) / dstTotal, "x"
+    );
+}
+
+static compression::Dictionary train(const std::vector<Sample>& samples) {
+    std::vector<util::span<ubyte>> spans;
+    // half of samples is used for training
+    for (size_t i = 0; i < samples.size(); i += 2) {
+        spans.emplace_back(samples[i].data(), samples[i].size());
+    }
+    return compression::train_dictionary(spans);
+}
+
+VC_BENCHMARK(chunk_codecs) {
+    LayersSamples samples;
+    if (const char* world = std::getenv("VC_BENCH_WORLD")) {
+        read_world(world, samples);
+    } else {
+        generate(samples);
+    }
+    using compression::Method;
+    const std::pair<const char*, const std::vector<Sample>*> layers[] {
+        {"voxels", &samples.voxels},
+        {"lights", &samples.lights},
+        {"entities", &samples.entities},
+    };
+    for (const auto& [name, layerSamples] : layers) {
+        std::string prefix = std::string(name) + ".";
+        if (layerSamples != &samples.entities) {
+            measure(
+                report, prefix + "extrle8.", *layerSamples, Method::EXTRLE8
+            );
+            measure(
+                report, prefix + "extrle16.", *layerSamples, Method::EXTRLE16
+            );
+        }
+        measure(report, prefix + "gzip.", *layerSamples, Method::GZIP);
+        measure(report, prefix + "lz4.", *layerSamples, Method::LZ4);
+        auto dictionary = train(*layerSamples);
+        measure(
+            report,
+            prefix + "zlib-dict.",
+            *layerSamples,
+            Method::ZLIB_DICT,
+            &dictionary
+        );
+    }
+}
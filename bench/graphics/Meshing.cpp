@@ -0,0 +1,217 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "assets/Assets.hpp"
+#include "content/Content.hpp"
+#include "content/ContentBuilder.hpp"
+#include "core_defs.hpp"
+#include "frontend/ContentGfxCache.hpp"
+#include "graphics/core/Atlas.hpp"
+#include "graphics/core/ImageData.hpp"
+#include "graphics/core/Mesh.hpp"
+#include "graphics/render/BlocksRenderer.hpp"
+#include "lighting/Lighting.hpp"
+#include "lighting/Lightmap.hpp"
+#include "maths/UVRegion.hpp"
+#include "objects/rigging.hpp"
+#include "settings.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+#include "voxels/VoxelsVolume.hpp"
+
+// Chunks meshing of a generated terrain: rolling hills with plains, caves
+// and ores. Compares triangles count and meshing time of the per-face mode
+// and the greedy meshing mode with and without soft lighting
+
+static inline constexpr int AREA_SIZE = 8;
+static inline constexpr int MESH_PADDING = 2;
+static inline constexpr int ITERATIONS = 5;
+
+namespace {
+    struct Scene {
+        std::unique_ptr<Content> content;
+        Assets assets;
+        EngineSettings settings;
+        std::unique_ptr<ContentGfxCache> cache;
+        std::unique_ptr<Chunks> chunks;
+        blockid_t stone, dirt, grass, ore;
+
+        Scene() {
+            ContentBuilder builder;
+            corecontent::setup(nullptr, builder);
+            auto createBlock = [&builder](const std::string& name) {
+                auto& block = builder.blocks.create("bench:" + name);
+                block.pickingItem = CORE_EMPTY;
+                for (auto& texture : block.defaults.textureFaces) {
+                    texture = name;
+                }
+                return &block;
+            };
+            createBlock("stone");
+            createBlock("dirt");
+            createBlock("ore");
+            createBlock("grass")->defaults.textureFaces = {
+                "grass_side", "grass_side", "dirt",
+                "grass_top", "grass_side", "grass_side"};
+            content = builder.build();
+
+            const auto& blocks = content->blocks;
+            stone = blocks.require("bench:stone").rt.id;
+            dirt = blocks.require("bench:dirt").rt.id;
+            grass = blocks.require("bench:grass").rt.id;
+            ore = blocks.require("bench:ore").rt.id;
+
+            std::unordered_map<std::string, UVRegion> regions;
+            float step = 1.0f / 8.0f;
+            for (const auto& name : {TEXTURE_NOTFOUND, std::string("stone"),
+                                     std::string("dirt"), std::string("ore"),
+                                     std::string("grass_side"),
+                                     std::string("grass_top")}) {
+                float u = regions.size() * step;
+                regions[name] = UVRegion(u, 0.0f, u + step, step);
+            }
+            assets.store(
+                std::make_unique<Atlas>(
+                    std::make_unique<ImageData>(ImageFormat::rgba8888, 1, 1),
+                    std::move(regions),
+                    false
+                ),
+                "blocks"
+            );
+            cache = std::make_unique<ContentGfxCache>(
+                *content, assets, settings.graphics
+            );
+
+            const auto& indices = *content->getIndices();
+            chunks = std::make_unique<Chunks>(
+                AREA_SIZE, AREA_SIZE, 0, 0, nullptr, indices
+            );
+            for (int cz = 0; cz < AREA_SIZE; cz++) {
+                for (int cx = 0; cx < AREA_SIZE; cx++) {
+                    auto chunk = std::make_shared<Chunk>(
+                        cx + chunks->getOffsetX(),
+                        cz + chunks->getOffsetY(),
+                        std::make_shared<Lightmap>()
+                    );
+                    generate(*chunk);
+                    chunk->updateHeights();
+                    Lighting::prebuildSkyLight(*chunk, indices);
+                    chunks->putChunk(chunk);
+                }
+            }
+            Lighting lighting(indices, *chunks);
+            lighting.buildChunksLights(getInnerChunks());
+        }
+
+        static int height(int x, int z) {
+            double hills = std::sin(x * 0.05) * std::cos(z * 0.04) * 12;
+            // plains between the hills
+            return 64 + static_cast<int>(hills > 0 ? hills : hills * 0.1);
+        }
+
+        void generate(Chunk& chunk) {
+            auto voxels = chunk.getVoxels();
+            for (int z = 0; z < CHUNK_D; z++) {
+                for (int x = 0; x < CHUNK_W; x++) {
+                    int gx = chunk.x * CHUNK_W + x;
+                    int gz = chunk.z * CHUNK_D + z;
+                    int top = height(gx, gz);
+                    for (int y = 0; y <= top; y++) {
+                        blockid_t id = y == top     ? grass
+                                       : y > top - 4 ? dirt
+                                                     : stone;
+                        uint hash = (gx * 73856093U) ^ (y * 19349663U) ^
+                                    (gz * 83492791U);
+                        if (id == stone && hash % 61 == 0) {
+                            id = ore;
+                        }
+                        if (y > 20 && y < top - 6 &&
+                            std::sin(gx * 0.15 + y * 0.2) *
+                                    std::cos(gz * 0.15 - y * 0.1) >
+                                0.6) {
+                            id = 0;
+                        }
+                        voxels[vox_index(x, y, z)].id = id;
+                    }
+                }
+            }
+        }
+
+        std::vector<glm::ivec2> getInnerChunks() const {
+            std::vector<glm::ivec2> positions;
+            int ox = chunks->getOffsetX();
+            int oz = chunks->getOffsetY();
+            for (int cz = oz + 1; cz < oz + AREA_SIZE - 1; cz++) {
+                for (int cx = ox + 1; cx < ox + AREA_SIZE - 1; cx++) {
+                    positions.emplace_back(cx, cz);
+                }
+            }
+            return positions;
+        }
+    };
+}
+
+static void run_meshing(
+    Scene& scene,
+    bool greedyMeshing,
+    bool softLighting,
+    bench::Report& report
+) {
+    auto& settings = scene.settings;
+    settings.graphics.greedyMeshing.set(greedyMeshing);
+    settings.graphics.softLighting.set(softLighting);
+    BlocksRenderer renderer(
+        settings.graphics.chunkMaxVertices.get(),
+        *scene.content,
+        *scene.cache,
+        settings
+    );
+    VoxelsVolume volume(
+        CHUNK_W + MESH_PADDING * 2, CHUNK_H, CHUNK_D + MESH_PADDING * 2
+    );
+    bench::Samples meshingTime;
+    size_t triangles = 0;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        triangles = 0;
+        for (const auto& pos : scene.getInnerChunks()) {
+            const auto& chunk = *scene.chunks->getChunk(pos.x, pos.y);
+            volume.setPosition(
+                chunk.x * CHUNK_W - MESH_PADDING,
+                0,
+                chunk.z * CHUNK_D - MESH_PADDING
+            );
+            scene.chunks->getVoxels(volume, false, chunk.top + 1);
+
+            bench::Stopwatch stopwatch;
+            renderer.build(&chunk, volume);
+            auto mesh = renderer.createMesh();
+            meshingTime.add(stopwatch.elapsedMicros());
+            for (const auto& section : mesh.sections) {
+                triangles += section.mesh.indices[0].size() / 3;
+            }
+            bench::keep(mesh);
+        }
+    }
+    auto chunksCount = scene.getInnerChunks().size();
+    auto suffix = std::string(greedyMeshing ? "-greedy" : "-faces") +
+                  (softLighting ? "-ao" : "");
+    report.add("meshing" + suffix, meshingTime, "us/chunk");
+    report.add(
+        "triangles" + suffix,
+        static_cast<double>(triangles) / chunksCount,
+        "per chunk"
+    );
+}
+
+VC_BENCHMARK(chunks_meshing) {
+    Scene scene;
+    for (bool softLighting : {false, true}) {
+        run_meshing(scene, false, softLighting, report);
+        run_meshing(scene, true, softLighting, report);
+    }
+}
@@ -0,0 +1,90 @@
+#include "bench.hpp"
+
+#include <filesystem>
+#include <vector>
+
+#include "io/devices/StdfsDevice.hpp"
+#include "io/devices/ZipFileDevice.hpp"
+#include "io/io.hpp"
+
+// Engine resources folder packed to ZIP and read file by file as content
+// packs are loaded: from the folder, from ZIP read by streams and from
+// memory-mapped ZIP
+
+static inline constexpr int ITERATIONS = 10;
+
+static void collect_files(
+    io::Device& device, const io::path& folder, std::vector<std::string>& dst
+) {
+    auto generator = device.list(folder.pathPart());
+    io::path name;
+    while (generator->next(name)) {
+        auto path = folder / name;
+        if (device.isdir(path.pathPart())) {
+            collect_files(device, path, dst);
+        } else {
+            dst.push_back(path.pathPart());
+        }
+    }
+}
+
+static bench::Samples measure(
+    io::Device& device, const std::vector<std::string>& files
+) {
+    bench::Samples samples;
+    std::vector<char> buffer;
+    for (int i = 0; i < ITERATIONS; i++) {
+        bench::Stopwatch stopwatch;
+        for (const auto& file : files) {
+            buffer.resize(device.size(file));
+            device.read(file)->read(buffer.data(), buffer.size());
+            bench::keep(buffer);
+        }
+        double seconds = stopwatch.elapsedMicros() * 1e-6;
+        samples.add(files.size() / seconds);
+    }
+    return samples;
+}
+
+static std::shared_ptr<io::MappedFile> map_file(const io::path& file) {
+    return io::map(file);
+}
+
+VC_BENCHMARK(zip_reads) {
+    auto tmpFolder =
+        std::filesystem::temp_directory_path() / "voxelcore-bench-zip";
+    io::set_device(
+        "benchres", std::make_shared<io::StdfsDevice>(bench::get_res_folder())
+    );
+    io::set_device("benchtmp", std::make_shared<io::StdfsDevice>(tmpFolder));
+    io::path zipFile = "benchtmp:res.zip";
+    io::write_zip("benchres:", zipFile);
+
+    auto& folder = io::require_device("benchres");
+    std::vector<std::string> files;
+    collect_files(folder, "", files);
+    report.add("files", files.size(), "");
+
+    report.add("folder", measure(folder, files), "files/s");
+
+    io::ZipFileDevice streamed(
+        io::read(zipFile), [zipFile]() { return io::read(zipFile); }
+    );
+    report.add("zip streams", measure(streamed, files), "files/s");
+
+    bench::Samples mounts;
+    for (int i = 0; i < ITERATIONS; i++) {
+        bench::Stopwatch stopwatch;
+        io::ZipFileDevice device(map_file(zipFile));
+        mounts.add(stopwatch.elapsedMicros() * 1e-3);
+    }
+    report.add("zip mapped mount", mounts, "ms");
+
+    io::ZipFileDevice mapped(map_file(zipFile));
+    report.add("zip mapped", measure(mapped, files), "files/s");
+
+    io::remove_device("benchres");
+    io::remove_device("benchtmp");
+    std::error_code error;
+    std::filesystem::remove_all(tmpFolder, error);
+}
@@ -0,0 +1,139 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <thread>
+
+#include "content/Content.hpp"
+#include "lighting/Lighting.hpp"
+#include "lighting/Lightmap.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+
+// Fresh chunks lights building: terrain with caves and torches.
+// Inner chunks are lighted in the loading order (nearest first)
+
+static inline constexpr int AREA_SIZE = 12;
+static inline constexpr int ITERATIONS = 3;
+
+namespace {
+    struct Scene {
+        Block air {"core:air"};
+        Block stone {"stone"};
+        Block torch {"torch"};
+        ContentIndices indices;
+        Chunks chunks;
+
+        Scene()
+            : indices(
+                  std::vector<Block*> {&air, &stone, &torch},
+                  std::vector<ItemDef*> {},
+                  std::vector<EntityDef*> {}
+              ),
+              chunks(AREA_SIZE, AREA_SIZE, 0, 0, nullptr, indices) {
+            air.lightPassing = air.skyLightPassing = true;
+            torch.lightPassing = torch.skyLightPassing = true;
+            torch.emission[0] = 13;
+            torch.emission[1] = 12;
+            torch.emission[2] = 8;
+            torch.rt.emissive = true;
+            for (int cz = 0; cz < AREA_SIZE; cz++) {
+                for (int cx = 0; cx < AREA_SIZE; cx++) {
+                    auto chunk = std::make_shared<Chunk>(
+                        cx + chunks.getOffsetX(),
+                        cz + chunks.getOffsetY(),
+                        std::make_shared<Lightmap>()
+                    );
+                    generate(*chunk);
+                    Lighting::prebuildSkyLight(*chunk, indices);
+                    chunks.putChunk(chunk);
+                }
+            }
+        }
+
+        void generate(Chunk& chunk) {
+            for (int z = 0; z < CHUNK_D; z++) {
+                for (int x = 0; x < CHUNK_W; x++) {
+                    int gx = chunk.x * CHUNK_W + x;
+                    int gz = chunk.z * CHUNK_D + z;
+                    int height = 64 + static_cast<int>(
+                        std::sin(gx * 0.07) * 12 + std::cos(gz * 0.05) * 10
+                    );
+                    for (int y = 0; y < CHUNK_H; y++) {
+                        blockid_t id = y < height ? 1 : 0;
+                        if (id && y > 20 &&
+                            std::sin(gx * 0.2 + y * 0.3) *
+                                    std::cos(gz * 0.15 - y * 0.1) > 0.6) {
+                            id = 0;
+                        }
+                        uint hash = (gx * 73856093U) ^ (y * 19349663U) ^
+                                    (gz * 83492791U);
+                        if (!id && hash % 3001 == 0) {
+                            id = 2;
+                        }
+                        chunk.getVoxels()[vox_index(x, y, z)].id = id;
+                    }
+                }
+            }
+        }
+
+        std::vector<glm::ivec2> getInnerChunks() const {
+            std::vector<glm::ivec2> positions;
+            int center = AREA_SIZE / 2;
+            for (int cz = 1; cz < AREA_SIZE - 1; cz++) {
+                for (int cx = 1; cx < AREA_SIZE - 1; cx++) {
+                    positions.emplace_back(cx, cz);
+                }
+            }
+            std::stable_sort(
+                positions.begin(),
+                positions.end(),
+                [center](const auto& a, const auto& b) {
+                    int da = (a.x - center) * (a.x - center) +
+                             (a.y - center) * (a.y - center);
+                    int db = (b.x - center) * (b.x - center) +
+                             (b.y - center) * (b.y - center);
+                    return da < db;
+                }
+            );
+            for (auto& pos : positions) {
+                pos.x += chunks.getOffsetX();
+                pos.y += chunks.getOffsetY();
+            }
+            return positions;
+        }
+    };
+}
+
+/// @param batchSize number of chunks passed to Lighting::buildChunksLights
+static bench::Samples simulate(int workers, size_t batchSize) {
+    bench::Samples samples;
+    for (int i = 0; i < ITERATIONS; i++) {
+        Scene scene;
+        Lighting lighting(scene.indices, scene.chunks, workers);
+        auto positions = scene.getInnerChunks();
+        for (size_t offset = 0; offset < positions.size(); offset += batchSize) {
+            size_t end = std::min(positions.size(), offset + batchSize);
+            std::vector<glm::ivec2> batch(
+                positions.begin() + offset, positions.begin() + end
+            );
+            bench::Stopwatch stopwatch;
+            lighting.buildChunksLights(batch);
+            samples.add(stopwatch.elapsedMicros() / batch.size());
+        }
+    }
+    return samples;
+}
+
+VC_BENCHMARK(lighting_chunks) {
+    report.add("sequential", simulate(0, 1), "us/chunk");
+    int workers = std::max(1U, std::thread::hardware_concurrency()) - 1;
+    for (size_t batchSize : {4, 8, 16}) {
+        report.add(
+            "workers=" + std::to_string(workers) +
+                " batch=" + std::to_string(batchSize),
+            simulate(workers, batchSize),
+            "us/chunk"
+        );
+    }
+}
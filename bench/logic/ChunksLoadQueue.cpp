@@ -0,0 +1,120 @@
+#include "bench.hpp"
+
+#include "logic/ChunksLoadQueue.hpp"
+#include "util/AreaMap2D.hpp"
+
+// Chunks loading scheduling cost only: chunk creation is a matrix cell store.
+// Player flies along X axis moving to the next chunk every FRAMES_PER_CHUNK
+
+static inline constexpr int MAX_WORK_PER_FRAME = 128;
+static inline constexpr int PADDING = 2;
+static inline constexpr int FRAMES = 400;
+static inline constexpr int FRAMES_PER_CHUNK = 4;
+
+using ChunksMatrix = util::AreaMap2D<int8_t>;
+
+/// @brief Previous ChunksController::loadVisible algorithm
+static bool load_visible_scan(ChunksMatrix& chunks, int padding) {
+    int sizeX = chunks.getWidth();
+    int sizeY = chunks.getHeight();
+    const auto& buffer = chunks.getBuffer();
+
+    int nearX = 0;
+    int nearZ = 0;
+    bool assigned = false;
+    int minDistance = ((sizeX - padding * 2) / 2) * ((sizeY - padding * 2) / 2);
+    int maxDistance = ((sizeX) / 2) * ((sizeY) / 2);
+    for (int z = 0; z < sizeY; z++) {
+        for (int x = 0; x < sizeX; x++) {
+            int lx = x - sizeX / 2;
+            int lz = z - sizeY / 2;
+            int distance = (lx * lx + lz * lz);
+            if (buffer[z * sizeX + x] && distance >= maxDistance) {
+                chunks.set(x + chunks.getOffsetX(), z + chunks.getOffsetY(), 0);
+            }
+        }
+    }
+    for (int z = padding; z < sizeY - padding; z++) {
+        for (int x = padding; x < sizeX - padding; x++) {
+            int lx = x - sizeX / 2;
+            int lz = z - sizeY / 2;
+            int distance = (lx * lx + lz * lz);
+            if (buffer[z * sizeX + x]) {
+                continue;
+            }
+            if (distance < minDistance) {
+                minDistance = distance;
+                nearX = x;
+                nearZ = z;
+                assigned = true;
+            }
+        }
+    }
+    if (!assigned) {
+        return false;
+    }
+    chunks.set(nearX + chunks.getOffsetX(), nearZ + chunks.getOffsetY(), 1);
+    return true;
+}
+
+static bool load_visible_queue(
+    ChunksMatrix& chunks, ChunksLoadQueue& queue, int padding
+) {
+    int sizeX = chunks.getWidth();
+    int sizeY = chunks.getHeight();
+    int offsetX = chunks.getOffsetX();
+    int offsetY = chunks.getOffsetY();
+    queue.update(sizeX, sizeY, padding, offsetX, offsetY);
+
+    int minDistance = ((sizeX - padding * 2) / 2) * ((sizeY - padding * 2) / 2);
+    const auto& buffer = chunks.getBuffer();
+    for (size_t i = queue.getCursor(); i < queue.size(); i++) {
+        const auto& entry = queue[i];
+        queue.setCursor(i + 1);
+        if (buffer[entry.z * sizeX + entry.x] || entry.distance >= minDistance) {
+            continue;
+        }
+        chunks.set(entry.x + offsetX, entry.z + offsetY, 1);
+        return true;
+    }
+    return false;
+}
+
+template <typename Func>
+static bench::Samples simulate(int loadDistance, const Func& loadVisible) {
+    int size = (loadDistance + PADDING) * 2;
+    ChunksMatrix chunks(size, size);
+    chunks.setCenter(0, 0);
+
+    bench::Samples samples;
+    int centerX = 0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        if (frame % FRAMES_PER_CHUNK == 0) {
+            chunks.setCenter(centerX++, 0);
+        }
+        bench::Stopwatch stopwatch;
+        for (int i = 0; i < MAX_WORK_PER_FRAME; i++) {
+            if (!loadVisible(chunks)) {
+                break;
+            }
+        }
+        samples.add(stopwatch.elapsedMicros());
+    }
+    return samples;
+}
+
+VC_BENCHMARK(chunks_load_scheduling) {
+    for (int loadDistance : {8, 16, 32, 48, 64, 80}) {
+        auto prefix = "distance=" + std::to_string(loadDistance) + " ";
+        auto scan = simulate(loadDistance, [](auto& chunks) {
+            return load_visible_scan(chunks, PADDING);
+        });
+        report.add(prefix + "full-scan", scan, "us/frame");
+
+        ChunksLoadQueue queue;
+        auto queued = simulate(loadDistance, [&queue](auto& chunks) {
+            return load_visible_queue(chunks, queue, PADDING);
+        });
+        report.add(prefix + "load-queue", queued, "us/frame");
+    }
+}
@@ -0,0 +1,87 @@
+#include <fstream>
+#include <iostream>
+
+#include "bench.hpp"
+#include "coders/json.hpp"
+#include "util/ArgsReader.hpp"
+
+struct Config {
+    std::string filter;
+    std::string jsonFile;
+    bool list = false;
+};
+
+static bool parse_cmdline(int argc, char** argv, Config& config) {
+    util::ArgsReader reader(argc, argv);
+    reader.skip();
+    while (reader.hasNext()) {
+        std::string token = reader.next();
+        if (token == "--help" || token == "-h") {
+            std::cout << "Options\n\n";
+            std::cout << "  --help, -h                      = show help\n";
+            std::cout << "  --filter <text>, -f <text>      = run benchmarks containing text\n";
+            std::cout << "  --list                          = list benchmarks\n";
+            std::cout << "  --json <file>                   = write results to JSON file\n";
+            std::cout << "  --res <path>                    = engine resources folder (default: res)\n";
+            std::cout << std::endl;
+            return false;
+        } else if (token == "--filter" || token == "-f") {
+            config.filter = reader.next();
+        } else if (token == "--list") {
+            config.list = true;
+        } else if (token == "--json") {
+            config.jsonFile = reader.next();
+        } else if (token == "--res") {
+            bench::set_res_folder(reader.next());
+        } else {
+            std::cerr << "unknown argument " << token << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    try {
+        if (!parse_cmdline(argc, argv, config)) {
+            return 0;
+        }
+    } catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    bench::Report report(std::cout);
+    for (const auto& benchmark : bench::get_all()) {
+        if (benchmark.name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+        if (config.list) {
+            std::cout << benchmark.name << std::endl;
+            continue;
+        }
+        report.begin(benchmark.name);
+        try {
+            benchmark.func(report);
+        } catch (const std::exception& err) {
+            std::cerr << "benchmark " << benchmark.name
+                      << " failed: " << err.what() << std::endl;
+            return 1;
+        }
+        // process-wide peak, includes previous benchmarks
+        report.add("peak-rss", bench::peak_rss() / (1024.0 * 1024.0), "MiB");
+    }
+    if (!config.jsonFile.empty() && !config.list) {
+        auto root = dv::object({
+            {"benchmarks", report.getResults()},
+            {"peak-rss", static_cast<dv::integer_t>(bench::peak_rss())},
+        });
+        std::ofstream file(config.jsonFile);
+        file << json::stringify(root, true) << std::endl;
+        if (!file.good()) {
+            std::cerr << "could not write " << config.jsonFile << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "bench.hpp"
+
+#include <vector>
+
+#include "maths/FastNoiseLite.h"
+#include "maths/noise.hpp"
+
+// Heightmap noise as generated by Heightmap:noise of generator scripts:
+// 4 octaves with domain warp shift maps. Per-sample scalar
+// FastNoiseLite calls are compared with rows evaluation
+
+static inline constexpr int SIZE = 256;
+static inline constexpr int OCTAVES = 4;
+static inline constexpr int ITERATIONS = 20;
+
+namespace {
+    struct Maps {
+        std::vector<float> heights;
+        std::vector<float> shiftX;
+        std::vector<float> shiftY;
+
+        Maps()
+            : heights(SIZE * SIZE),
+              shiftX(SIZE * SIZE),
+              shiftY(SIZE * SIZE) {
+            for (int i = 0; i < SIZE * SIZE; i++) {
+                shiftX[i] = (i * 7919U % 113) * 0.3f;
+                shiftY[i] = (i * 104729U % 127) * 0.3f;
+            }
+        }
+    };
+}
+
+static void generate_scalar(fnl_state& state, Maps& maps, float scale) {
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            int i = y * SIZE + x;
+            for (int c = 0; c < OCTAVES; c++) {
+                float m = scale * (1 << c);
+                float u = x * m + maps.shiftX[i];
+                float v = y * m + maps.shiftY[i];
+                maps.heights[i] += fnlGetNoise2D(&state, u, v) /
+                                   static_cast<float>(1 << c);
+            }
+        }
+    }
+}
+
+static void generate_rows(fnl_state& state, Maps& maps, float scale) {
+    std::vector<float> us(SIZE);
+    std::vector<float> vs(SIZE);
+    std::vector<float> values(SIZE);
+    for (int y = 0; y < SIZE; y++) {
+        for (int c = 0; c < OCTAVES; c++) {
+            float m = scale * (1 << c);
+            for (int x = 0; x < SIZE; x++) {
+                int i = y * SIZE + x;
+                us[x] = x * m + maps.shiftX[i];
+                vs[x] = y * m + maps.shiftY[i];
+            }
+            noise::get_noise_2d(
+                state, us.data(), vs.data(), values.data(), SIZE
+            );
+            for (int x = 0; x < SIZE; x++) {
+                maps.heights[y * SIZE + x] +=
+                    values[x] / static_cast<float>(1 << c);
+            }
+        }
+    }
+}
+
+template <typename Func>
+static bench::Samples measure(fnl_noise_type type, const Func& generate) {
+    bench::Samples samples;
+    fnl_state state = fnlCreateState();
+    state.noise_type = type;
+    for (int i = 0; i < ITERATIONS; i++) {
+        Maps maps;
+        bench::Stopwatch stopwatch;
+        generate(state, maps, 0.5f);
+        double seconds = stopwatch.elapsedMicros() * 1e-6;
+        bench::keep(maps.heights);
+        samples.add(SIZE * SIZE * OCTAVES / seconds * 1e-6);
+    }
+    return samples;
+}
+
+VC_BENCHMARK(heightmap_noise) {
+    std::string simd = noise::get_simd_name();
+    report.add(
+        "opensimplex2 scalar",
+        measure(FNL_NOISE_OPENSIMPLEX2, generate_scalar),
+        "Msamples/s"
+    );
+    report.add(
+        "opensimplex2 rows (" + simd + ")",
+        measure(FNL_NOISE_OPENSIMPLEX2, generate_rows),
+        "Msamples/s"
+    );
+    report.add(
+        "cellular scalar",
+        measure(FNL_NOISE_CELLULAR, generate_scalar),
+        "Msamples/s"
+    );
+    report.add(
+        "cellular rows",
+        measure(FNL_NOISE_CELLULAR, generate_rows),
+        "Msamples/s"
+    );
+}
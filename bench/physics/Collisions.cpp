@@ -0,0 +1,207 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "constants.hpp"
+#include "content/Content.hpp"
+#include "physics/CollisionCache.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+
+// Hitbox collision probes the way PhysicsSolver samples them every substep:
+// direct storage lookups compared to the collision cache gathered once
+// per step. Bodies stand on a rough terrain with slabs. Chunks are looked
+// up through both the player chunks matrix and a hash map like
+// GlobalChunks does
+
+static inline constexpr int AREA_SIZE = 8;
+static inline constexpr int BODIES = 1000;
+static inline constexpr int SUBSTEPS = 4;
+static inline constexpr int ITERATIONS = 10;
+static inline constexpr float DELTA = 1.0f / 20.0f;
+
+namespace {
+    /// @brief Chunks storage with GlobalChunks lookup
+    class ChunksMap {
+        std::unordered_map<uint64_t, std::shared_ptr<Chunk>> chunksMap;
+        const ContentIndices& indices;
+
+        static uint64_t keyfrom(int32_t x, int32_t z) {
+            return static_cast<uint32_t>(x) |
+                   (static_cast<uint64_t>(static_cast<uint32_t>(z)) << 32);
+        }
+    public:
+        ChunksMap(const ContentIndices& indices) : indices(indices) {
+        }
+
+        void putChunk(std::shared_ptr<Chunk> chunk) {
+            chunksMap[keyfrom(chunk->x, chunk->z)] = std::move(chunk);
+        }
+
+        Chunk* getChunk(int cx, int cz) const {
+            const auto& found = chunksMap.find(keyfrom(cx, cz));
+            if (found == chunksMap.end()) {
+                return nullptr;
+            }
+            return found->second.get();
+        }
+
+        const AABB* isObstacleAt(float x, float y, float z) const {
+            return blocks_agent::is_obstacle_at(*this, x, y, z);
+        }
+
+        const ContentIndices& getContentIndices() const {
+            return indices;
+        }
+    };
+
+    struct Scene {
+        Block air {"core:air"};
+        Block stone {"stone"};
+        Block slab {"slab"};
+        ContentIndices indices;
+        Chunks chunks;
+        ChunksMap chunksMap;
+
+        Scene()
+            : indices(
+                  std::vector<Block*> {&air, &stone, &slab},
+                  std::vector<ItemDef*> {},
+                  std::vector<EntityDef*> {}
+              ),
+              chunks(AREA_SIZE, AREA_SIZE, 0, 0, nullptr, indices),
+              chunksMap(indices) {
+            air.obstacle = false;
+            slab.hitboxes = {
+                AABB(glm::vec3(0.0f), glm::vec3(1.0f, 0.5f, 1.0f))};
+            for (int cz = 0; cz < AREA_SIZE; cz++) {
+                for (int cx = 0; cx < AREA_SIZE; cx++) {
+                    auto chunk = std::make_shared<Chunk>(
+                        cx + chunks.getOffsetX(), cz + chunks.getOffsetY()
+                    );
+                    generate(*chunk);
+                    chunks.putChunk(chunk);
+                    chunksMap.putChunk(chunk);
+                }
+            }
+        }
+
+        static int height(int x, int z) {
+            return 64 + static_cast<int>(
+                std::sin(x * 0.3) * 2 + std::cos(z * 0.2) * 2
+            );
+        }
+
+        void generate(Chunk& chunk) {
+            auto voxels = chunk.getVoxels();
+            for (int z = 0; z < CHUNK_D; z++) {
+                for (int x = 0; x < CHUNK_W; x++) {
+                    int gx = chunk.x * CHUNK_W + x;
+                    int gz = chunk.z * CHUNK_D + z;
+                    int top = height(gx, gz);
+                    for (int y = 0; y <= top; y++) {
+                        voxels[vox_index(x, y, z)].id =
+                            y == top && (gx + gz) % 5 == 0 ? 2 : 1;
+                    }
+                }
+            }
+        }
+    };
+}
+
+/// @brief Sample hitbox faces with the PhysicsSolver probes step
+template <class Lookup>
+static int probe_hitbox(
+    const Lookup& lookup, const glm::vec3& pos, const glm::vec3& half
+) {
+    constexpr float E = 0.03f;
+    constexpr float s = 2.0f / BLOCK_AABB_GRID;
+    int found = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        for (float side : {-1.0f, 1.0f}) {
+            glm::vec3 coord;
+            coord[axis] = pos[axis] + (half[axis] + E) * side;
+            for (int iu = 0; iu <= (half[u] - E) * 2 / s; iu++) {
+                coord[u] = pos[u] - half[u] + E + iu * s;
+                for (int iv = 0; iv <= (half[v] - E) * 2 / s; iv++) {
+                    coord[v] = pos[v] - half[v] + E + iv * s;
+                    if (lookup.isObstacleAt(coord.x, coord.y, coord.z)) {
+                        found++;
+                    }
+                }
+            }
+        }
+    }
+    return found;
+}
+
+template <class Storage>
+static void run_probes(
+    const Storage& chunks,
+    const std::vector<glm::vec3>& bodies,
+    const glm::vec3& half,
+    float reach,
+    bench::Report& report,
+    const std::string& suffix
+) {
+    CollisionCache<Storage> cache;
+    bench::Samples directTime;
+    bench::Samples cachedTime;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        int expected = 0;
+        bench::Stopwatch directTimer;
+        for (const auto& pos : bodies) {
+            for (int i = 0; i < SUBSTEPS; i++) {
+                expected += probe_hitbox(chunks, pos, half);
+            }
+        }
+        directTime.add(directTimer.elapsedMicros() / bodies.size());
+
+        int found = 0;
+        bench::Stopwatch cachedTimer;
+        for (const auto& pos : bodies) {
+            cache.gather(chunks, pos, half, reach);
+            for (int i = 0; i < SUBSTEPS; i++) {
+                found += probe_hitbox(cache, pos, half);
+            }
+        }
+        cachedTime.add(cachedTimer.elapsedMicros() / bodies.size());
+
+        if (found != expected) {
+            throw std::runtime_error("collision cache results mismatch");
+        }
+    }
+    report.add("direct" + suffix, directTime, "us/body");
+    report.add("cached" + suffix, cachedTime, "us/body");
+}
+
+VC_BENCHMARK(physics_collisions) {
+    Scene scene;
+    const auto& chunks = scene.chunks;
+    glm::vec3 half(0.3f, 0.9f, 0.3f);
+    float speed = 4.0f;
+
+    std::mt19937 random(2019);
+    std::uniform_real_distribution<float> coord(
+        CHUNK_W, (AREA_SIZE - 1) * CHUNK_W
+    );
+    std::vector<glm::vec3> bodies;
+    for (int i = 0; i < BODIES; i++) {
+        float x = coord(random) + chunks.getOffsetX() * CHUNK_W;
+        float z = coord(random) + chunks.getOffsetY() * CHUNK_D;
+        float y = Scene::height(std::floor(x), std::floor(z)) + 1 + half.y;
+        bodies.emplace_back(x, y, z);
+    }
+    float reach = speed * DELTA + 1.0f;
+    run_probes(chunks, bodies, half, reach, report, "-matrix");
+    run_probes(scene.chunksMap, bodies, half, reach, report, "-map");
+}
@@ -0,0 +1,145 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "physics/SpatialGrid.hpp"
+
+// Entities broadphase: sensors checks and range queries over all entities
+// compared to the spatial grid. Entities keep the same density, so the grid
+// cost must grow linearly with entities count
+
+static inline constexpr float DENSITY = 0.02f;   // entities per block^2
+static inline constexpr float HEIGHT = 32.0f;
+static inline constexpr int SENSOR_EACH = 10;
+static inline constexpr float SENSOR_RADIUS = 2.0f;
+static inline constexpr int QUERIES = 100;
+static inline constexpr float QUERY_RADIUS = 8.0f;
+static inline constexpr int FRAMES = 20;
+static inline constexpr float DELTA = 1.0f / 20.0f;
+
+namespace {
+    struct Body {
+        glm::vec3 position;
+        glm::vec3 velocity;
+        glm::vec3 half {0.3f, 0.9f, 0.3f};
+
+        AABB getAABB() const {
+            return AABB(position - half, position + half);
+        }
+    };
+
+    struct Scene {
+        std::vector<Body> bodies;
+        std::vector<glm::vec3> queries;
+        float side;
+
+        Scene(int count) : side(std::sqrt(count / DENSITY)) {
+            std::mt19937 random(2019);
+            std::uniform_real_distribution<float> x(0.0f, side);
+            std::uniform_real_distribution<float> y(0.0f, HEIGHT);
+            std::uniform_real_distribution<float> speed(-4.0f, 4.0f);
+            for (int i = 0; i < count; i++) {
+                bodies.push_back(Body {
+                    {x(random), y(random), x(random)},
+                    {speed(random), 0.0f, speed(random)}});
+            }
+            for (int i = 0; i < QUERIES; i++) {
+                queries.emplace_back(x(random), y(random), x(random));
+            }
+        }
+
+        void step() {
+            for (auto& body : bodies) {
+                body.position += body.velocity * DELTA;
+                body.position.x = std::fmod(body.position.x + side, side);
+                body.position.z = std::fmod(body.position.z + side, side);
+            }
+        }
+    };
+}
+
+static bool is_triggered(const Body& body, const glm::vec3& sensor) {
+    auto delta = body.position - sensor;
+    return glm::dot(delta, delta) < SENSOR_RADIUS * SENSOR_RADIUS;
+}
+
+static size_t brute_force_frame(const Scene& scene) {
+    size_t found = 0;
+    const auto& bodies = scene.bodies;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        for (size_t j = 0; j < bodies.size(); j += SENSOR_EACH) {
+            if (i != j && is_triggered(bodies[i], bodies[j].position)) {
+                found++;
+            }
+        }
+    }
+    for (const auto& center : scene.queries) {
+        AABB area(center - QUERY_RADIUS, center + QUERY_RADIUS);
+        for (const auto& body : bodies) {
+            if (area.intersect(body.getAABB())) {
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+static size_t grid_frame(
+    const Scene& scene, SpatialGrid& grid, std::vector<entityid_t>& queried
+) {
+    const auto& bodies = scene.bodies;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        grid.update(i, bodies[i].getAABB());
+    }
+    size_t found = 0;
+    for (size_t j = 0; j < bodies.size(); j += SENSOR_EACH) {
+        const auto& sensor = bodies[j].position;
+        queried.clear();
+        grid.query(
+            AABB(sensor - SENSOR_RADIUS, sensor + SENSOR_RADIUS), queried
+        );
+        for (auto i : queried) {
+            if (i != j && is_triggered(bodies[i], sensor)) {
+                found++;
+            }
+        }
+    }
+    for (const auto& center : scene.queries) {
+        queried.clear();
+        grid.query(AABB(center - QUERY_RADIUS, center + QUERY_RADIUS), queried);
+        found += queried.size();
+    }
+    return found;
+}
+
+VC_BENCHMARK(entities_broadphase) {
+    for (int count : {1000, 10000}) {
+        auto suffix = "-" + std::to_string(count);
+        Scene scene(count);
+        SpatialGrid grid(4.0f);
+        std::vector<entityid_t> queried;
+
+        bench::Samples bruteForceTime;
+        bench::Samples gridTime;
+        for (int frame = 0; frame < FRAMES; frame++) {
+            scene.step();
+
+            bench::Stopwatch bruteForceTimer;
+            size_t expected = brute_force_frame(scene);
+            bruteForceTime.add(bruteForceTimer.elapsedMicros());
+
+            bench::Stopwatch gridTimer;
+            size_t found = grid_frame(scene, grid, queried);
+            gridTime.add(gridTimer.elapsedMicros());
+
+            if (found != expected) {
+                throw std::runtime_error("broadphase results mismatch");
+            }
+        }
+        report.add("brute-force" + suffix, bruteForceTime, "us/frame");
+        report.add("grid" + suffix, gridTime, "us/frame");
+    }
+}
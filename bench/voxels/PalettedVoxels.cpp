@@ -0,0 +1,94 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "voxels/Chunk.hpp"
+#include "voxels/PalettedVoxels.hpp"
+
+// Paletted voxels packing speed and memory usage on generated terrain
+
+static inline constexpr int AREA_SIZE = 8;
+static inline constexpr int ITERATIONS = 5;
+
+/// @brief Terrain with caves and ores
+static void generate(voxel* voxels, int cx, int cz) {
+    for (int z = 0; z < CHUNK_D; z++) {
+        for (int x = 0; x < CHUNK_W; x++) {
+            int gx = cx * CHUNK_W + x;
+            int gz = cz * CHUNK_D + z;
+            int height = 64 + static_cast<int>(
+                std::sin(gx * 0.07) * 12 + std::cos(gz * 0.05) * 10
+            );
+            for (int y = 0; y < CHUNK_H; y++) {
+                blockid_t id = 0;
+                if (y < height) {
+                    id = y < height - 4 ? 1 : 2;
+                }
+                if (id && y > 20 &&
+                    std::sin(gx * 0.2 + y * 0.3) *
+                            std::cos(gz * 0.15 - y * 0.1) > 0.6) {
+                    id = 0;
+                }
+                uint hash = (gx * 73856093U) ^ (y * 19349663U) ^
+                            (gz * 83492791U);
+                if (id == 1 && hash % 97 == 0) {
+                    id = 3 + hash % 4;
+                }
+                voxels[vox_index(x, y, z)] = {id, {}};
+            }
+        }
+    }
+}
+
+VC_BENCHMARK(paletted_voxels) {
+    std::vector<std::unique_ptr<voxel[]>> chunks;
+    for (int cz = 0; cz < AREA_SIZE; cz++) {
+        for (int cx = 0; cx < AREA_SIZE; cx++) {
+            auto voxels = std::make_unique<voxel[]>(CHUNK_VOL);
+            generate(voxels.get(), cx, cz);
+            chunks.push_back(std::move(voxels));
+        }
+    }
+    std::vector<PalettedVoxels> packed(chunks.size());
+    auto buffer = std::make_unique<voxel[]>(CHUNK_VOL);
+
+    bench::Samples packTime;
+    bench::Samples unpackTime;
+    bench::Samples sectionTime;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        bench::Stopwatch packTimer;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            packed[i].pack(chunks[i].get());
+        }
+        packTime.add(packTimer.elapsedMicros() / chunks.size());
+
+        bench::Stopwatch unpackTimer;
+        for (const auto& voxels : packed) {
+            voxels.unpack(buffer.get());
+            bench::keep(buffer);
+        }
+        unpackTime.add(unpackTimer.elapsedMicros() / chunks.size());
+
+        bench::Stopwatch sectionTimer;
+        for (const auto& voxels : packed) {
+            for (uint s = 0; s < VOXELS_SECTIONS; s++) {
+                voxels.unpackSection(s, buffer.get());
+                bench::keep(buffer);
+            }
+        }
+        sectionTime.add(
+            sectionTimer.elapsedMicros() / (chunks.size() * VOXELS_SECTIONS)
+        );
+    }
+    size_t memory = 0;
+    for (const auto& voxels : packed) {
+        memory += voxels.getMemoryUsage();
+    }
+    double dense = static_cast<double>(CHUNK_VOL * sizeof(voxel));
+    report.add("pack", packTime, "us/chunk");
+    report.add("unpack", unpackTime, "us/chunk");
+    report.add("unpack-section", sectionTime, "us/section");
+    report.add("memory", memory / chunks.size() / 1024.0, "KiB/chunk");
+    report.add("ratio", dense * chunks.size() / memory, "x");
+}
@@ -0,0 +1,238 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+#include "assets/Assets.hpp"
+#include "content/Content.hpp"
+#include "content/ContentControl.hpp"
+#include "content/ContentPack.hpp"
+#include "core_defs.hpp"
+#include "debug/Profiler.hpp"
+#include "engine/Engine.hpp"
+#include "engine/EnginePaths.hpp"
+#include "frontend/ContentGfxCache.hpp"
+#include "graphics/commons/Model.hpp"
+#include "graphics/core/Atlas.hpp"
+#include "graphics/core/ImageData.hpp"
+#include "graphics/core/Mesh.hpp"
+#include "graphics/render/BlocksRenderer.hpp"
+#include "logic/EngineController.hpp"
+#include "logic/LevelController.hpp"
+#include "objects/Player.hpp"
+#include "objects/Players.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+#include "voxels/VoxelsVolume.hpp"
+#include "world/Level.hpp"
+#include "world/World.hpp"
+
+// Headless engine with the default generator. A player flies along X axis
+// and back: chunks are generated and saved on the way there and loaded
+// from regions on the way back. Lighted chunks are meshed on CPU the same
+// way the client chunks renderer does
+
+static inline constexpr int LOAD_DISTANCE = 12;
+static inline constexpr float FLIGHT_DISTANCE = 768.0f;
+static inline constexpr float FLIGHT_SPEED = 32.0f;
+static inline constexpr float FLIGHT_HEIGHT = 120.0f;
+static inline constexpr float DELTA = 1.0f / 20.0f;
+static inline constexpr int MESH_PADDING = 2;
+
+namespace {
+    /// @brief Engine running headless in a temporary user folder
+    class HeadlessEngine {
+        std::filesystem::path userFolder;
+    public:
+        Engine& engine;
+
+        HeadlessEngine()
+            : userFolder(
+                  std::filesystem::temp_directory_path() / "voxelcore-bench"
+              ),
+              engine(Engine::getInstance()) {
+            std::filesystem::remove_all(userFolder);
+            std::filesystem::create_directories(userFolder);
+
+            CoreParameters params;
+            params.headless = true;
+            params.testMode = true;
+            params.resFolder = bench::get_res_folder();
+            params.userFolder = userFolder;
+            engine.initialize(std::move(params));
+        }
+
+        ~HeadlessEngine() {
+            debug::profiler::set_listener(nullptr);
+            Engine::terminate();
+            std::error_code error;
+            std::filesystem::remove_all(userFolder, error);
+        }
+    };
+}
+
+/// @brief Blocks atlas and models placeholders as meshes are not drawn
+static std::unique_ptr<Assets> create_meshing_assets(const Content& content) {
+    auto assets = std::make_unique<Assets>();
+    assets->store(
+        std::make_unique<Atlas>(
+            std::make_unique<ImageData>(ImageFormat::rgba8888, 1, 1),
+            std::unordered_map<std::string, UVRegion> {
+                {TEXTURE_NOTFOUND, UVRegion()}},
+            false
+        ),
+        "blocks"
+    );
+    auto storeModel = [&assets](const Variant& variant) {
+        if (variant.model.type == BlockModelType::CUSTOM) {
+            assets->store(
+                std::make_unique<model::Model>(), variant.model.name
+            );
+        }
+    };
+    for (const auto& def : content.getIndices()->blocks.getIterable()) {
+        storeModel(def->defaults);
+        if (def->variants) {
+            for (const auto& variant : def->variants->variants) {
+                storeModel(variant);
+            }
+        }
+    }
+    return assets;
+}
+
+static glm::vec3 flight_position(float time) {
+    float distance = std::fmod(time * FLIGHT_SPEED, FLIGHT_DISTANCE * 2);
+    if (distance > FLIGHT_DISTANCE) {
+        distance = FLIGHT_DISTANCE * 2 - distance;
+    }
+    return glm::vec3(distance, FLIGHT_HEIGHT, 0.0f);
+}
+
+/// @brief Build meshes of lighted chunks modified since the last build
+static void build_meshes(
+    BlocksRenderer& renderer,
+    const Chunks& chunks,
+    VoxelsVolume& volume,
+    bool backlight,
+    bench::Samples& samples
+) {
+    for (const auto& chunk : chunks.getChunks()) {
+        if (chunk == nullptr || !chunk->flags.lighted ||
+            !chunk->flags.modified) {
+            continue;
+        }
+        volume.setPosition(
+            chunk->x * CHUNK_W - MESH_PADDING,
+            0,
+            chunk->z * CHUNK_D - MESH_PADDING
+        );
+        chunks.getVoxels(volume, backlight, chunk->top + 1);
+
+        bench::Stopwatch stopwatch;
+        renderer.build(chunk.get(), volume);
+        if (renderer.isCancelled()) {
+            continue;
+        }
+        auto mesh = renderer.createMesh();
+        bench::keep(mesh);
+        samples.add(stopwatch.elapsedMicros());
+        chunk->flags.modified = false;
+    }
+}
+
+VC_BENCHMARK(world_streaming) {
+    HeadlessEngine headless;
+    auto& engine = headless.engine;
+    auto& settings = engine.getSettings();
+    settings.chunks.loadDistance.set(LOAD_DISTANCE);
+
+    std::mutex stagesMutex;
+    std::vector<bench::Samples> stages(
+        static_cast<size_t>(debug::ProfileStage::COUNT)
+    );
+    debug::profiler::set_listener([&](auto stage, double micros) {
+        std::lock_guard lock(stagesMutex);
+        stages[static_cast<size_t>(stage)].add(micros);
+    });
+
+    std::unique_ptr<LevelController> controller;
+    Player* player = nullptr;
+    engine.setLevelConsumer([&](auto level, auto) {
+        if (level == nullptr) {
+            controller->onWorldQuit();
+            engine.getPaths().setCurrentWorldFolder("");
+            controller = nullptr;
+            return;
+        }
+        player = level->players->create();
+        player->setFlight(true);
+        player->setNoclip(true);
+        player->teleport(flight_position(0.0f));
+        // the player is passed as the client one to get chunks lighted
+        controller = std::make_unique<LevelController>(
+            &engine, std::move(level), player
+        );
+    });
+    auto engineController = engine.getController();
+    const auto& packs = engine.getContentControl().getContentPacks();
+    if (std::find_if(packs.begin(), packs.end(), [](const auto& pack) {
+            return pack.id == "base";
+        }) == packs.end()) {
+        engineController->reconfigPacks(nullptr, {"base"}, {});
+    }
+    engineController->createWorld("streaming", "2019", "core:default");
+    if (controller == nullptr) {
+        throw std::runtime_error("world is not open");
+    }
+    auto level = controller->getLevel();
+
+    auto assets = create_meshing_assets(level->content);
+    ContentGfxCache cache(level->content, *assets, settings.graphics);
+    BlocksRenderer renderer(
+        settings.graphics.chunkMaxVertices.get(),
+        level->content,
+        cache,
+        settings
+    );
+    VoxelsVolume volume(
+        CHUNK_W + MESH_PADDING * 2, CHUNK_H, CHUNK_D + MESH_PADDING * 2
+    );
+    bool backlight = settings.graphics.backlight.get();
+
+    bench::Samples frameTime;
+    bench::Samples meshingTime;
+    int frames = FLIGHT_DISTANCE * 2 / FLIGHT_SPEED / DELTA;
+    for (int frame = 0; frame < frames; frame++) {
+        player->teleport(flight_position(frame * DELTA));
+        engine.getTime().step(DELTA);
+
+        bench::Stopwatch frameTimer;
+        level->getWorld()->updateTimers(DELTA);
+        controller->update(DELTA, false);
+        engine.applicationTick();
+        engine.postUpdate();
+        frameTime.add(frameTimer.elapsedMicros());
+
+        build_meshes(renderer, *player->chunks, volume, backlight, meshingTime);
+    }
+
+    bench::Stopwatch saveTimer;
+    controller->processBeforeQuit();
+    controller->saveWorld();
+    engine.onWorldClosed();
+    double saveTime = saveTimer.elapsedMicros();
+    debug::profiler::set_listener(nullptr);
+
+    report.add("frame", frameTime, "us");
+    for (size_t i = 0; i < stages.size(); i++) {
+        auto stage = static_cast<debug::ProfileStage>(i);
+        report.add(debug::profiler::to_string(stage), stages[i], "us");
+    }
+    report.add("meshing", meshingTime, "us/chunk");
+    report.add("world-save", saveTime / 1000.0, "ms");
+}
@@ -0,0 +1,38 @@
+local util = require "core:tests_util"
+
+-- Create world and prepare settings
+util.create_demo_world("core:default")
+app.set_setting("chunks.load-distance", 3)
+app.set_setting("chunks.load-speed", 1)
+
+-- Create player
+local pid = player.create("Xerxes")
+player.set_pos(pid, 0, 100, 0)
+
+-- Wait for chunk to load
+app.sleep_until(function () return block.get(0, 0, 0) ~= -1 end)
+
+local stone = block.index("base:stone")
+local wood = block.index("base:wood")
+for x = 0, 2 do
+    block.set(x, 120, 0, stone)
+end
+
+-- Handler replacing the next queued block
+local event = "base:random_update_test.randupdate"
+local updated = {}
+events.on(event, function(x, y, z)
+    table.insert(updated, x)
+    block.set(x + 1, y, z, wood)
+end)
+
+-- Emitted the same way as random block updates
+events.__emit_batch(
+    events.intern(event), {0, 120, 0, 1, 120, 0, 2, 120, 0}, nil, stone
+)
+
+-- The replaced block is skipped
+assert(#updated == 2)
+assert(updated[1] == 0)
+assert(updated[2] == 2)
+assert(block.get(1, 120, 0) == wood)
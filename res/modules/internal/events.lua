@@ -2,6 +2,20 @@ local events = {
     handlers = {}
 }
 
+-- Interned events (see events.intern): ids by name, names and handlers
+-- lists by id
+local ids = {}
+local names = {}
+local handlers_by_id = {}
+
+local function set_handlers(event, handlers)
+    events.handlers[event] = handlers
+    local id = ids[event]
+    if id then
+        handlers_by_id[id] = handlers
+    end
+end
+
 local __parse_path = parse_path
 local __pack_is_installed = pack.is_installed
 
@@ -11,16 +25,16 @@ function events.on(event, func)
         error("pack prefix required")
     end
     if events.handlers[event] == nil then
-        events.handlers[event] = {}
+        set_handlers(event, {})
     end
     table.insert(events.handlers[event], func)
 end
 
 function events.reset(event, func)
     if func == nil then
-        events.handlers[event] = nil
+        set_handlers(event, nil)
     else
-        events.handlers[event] = {func}
+        set_handlers(event, {func})
     end
 end
 
@@ -31,17 +45,31 @@ function events.remove_by_prefix(prefix)
             actualname = name[1]
         end
         if actualname:sub(1, #prefix+1) == prefix..':' then
-            events.handlers[actualname] = nil
+            set_handlers(actualname, nil)
         end
     end
 end
 
-function events.emit(event, ...)
-    local result = nil
-    local handlers = events.handlers[event]
-    if handlers == nil then
-        return nil
+--- Get integer id of the event to be emitted with events.emit_id.
+--- Ids are kept for the state lifetime
+function events.intern(event)
+    local id = ids[event]
+    if id == nil then
+        id = #names + 1
+        names[id] = event
+        ids[event] = id
+        handlers_by_id[id] = events.handlers[event]
     end
+    return id
+end
+
+--- Get handlers list and name of the interned event
+function events.__get_by_id(id)
+    return handlers_by_id[id], names[id]
+end
+
+local function emit_handlers(event, handlers, ...)
+    local result = nil
     for _, func in ipairs(handlers) do
         local status, newres = xpcall(func, __vc__error, ...)
         if not status then
@@ -52,4 +80,20 @@ function events.emit(event, ...)
     end
     return result
 end
+
+function events.emit(event, ...)
+    local handlers = events.handlers[event]
+    if handlers == nil then
+        return nil
+    end
+    return emit_handlers(event, handlers, ...)
+end
+
+function events.emit_id(id, ...)
+    local handlers = handlers_by_id[id]
+    if handlers == nil then
+        return nil
+    end
+    return emit_handlers(names[id], handlers, ...)
+end
 return events
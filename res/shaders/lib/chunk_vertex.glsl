@@ -0,0 +1,55 @@
+#ifndef CHUNK_VERTEX_GLSL_
+#define CHUNK_VERTEX_GLSL_
+
+// Chunk mesh vertex attributes. COMPACT_VERTICES selects the 16 bytes
+// format of CompactChunkVertex: fixed point position with the octahedral
+// normal and emission packed into w, normalized texture coordinates.
+// Positions are relative to the chunk origin.
+
+#ifdef COMPACT_VERTICES
+layout (location = 0) in vec4 v_packed;
+layout (location = 1) in vec2 v_texCoord;
+layout (location = 2) in vec4 v_light;
+
+#define POSITION_SCALE 128.0
+#define POSITION_MIN -128.0
+#define NORMAL_STEPS 62.0
+#define EMISSION_STEPS 15.0
+
+vec3 chunk_vertex_position() {
+    return v_packed.xyz * (65535.0 / POSITION_SCALE) + POSITION_MIN;
+}
+
+// Returns normal (xyz) and emission (w)
+vec4 chunk_vertex_normal() {
+    uint bits = uint(v_packed.w * 65535.0 + 0.5);
+    vec2 oct = vec2(bits & 0x3Fu, (bits >> 6u) & 0x3Fu) *
+               (2.0 / NORMAL_STEPS) - 1.0;
+    vec3 normal = vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));
+    float t = max(-normal.z, 0.0);
+    normal.xy -= t * vec2(
+        normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0
+    );
+    return vec4(normalize(normal), float(bits >> 12u) / EMISSION_STEPS);
+}
+#else
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec2 v_texCoord;
+layout (location = 2) in vec4 v_light;
+layout (location = 3) in vec4 v_normal;
+
+vec3 chunk_vertex_position() {
+    return v_position;
+}
+
+// Returns normal (xyz) and emission (w)
+vec4 chunk_vertex_normal() {
+    return vec4(v_normal.xyz * 2.0 - 1.0, v_normal.w);
+}
+#endif
+
+// Chunk origin in the world. Fetched per draw command from the offsets
+// buffer or set as a constant attribute value per chunk
+layout (location = 4) in vec3 v_chunkOffset;
+
+#endif // CHUNK_VERTEX_GLSL_
@@ -0,0 +1,38 @@
+#ifndef TILING_GLSL_
+#define TILING_GLSL_
+
+// Quads merged by greedy meshing span multiple blocks. Their texture
+// coordinates hold the packed atlas region (negative values) and the
+// texture is repeated once per block.
+
+// Block texture coordinates of a cube face vertex.
+// Axes are the same as in BlocksRenderer::blockCube
+vec2 calc_tile_coord(vec3 position, vec3 normal) {
+    vec3 pos = position + 0.5;
+    vec3 n = round(normal);
+    if (n.y != 0.0) {
+        return vec2(pos.x, -n.y * pos.z);
+    } else if (n.x != 0.0) {
+        return vec2(-n.x * pos.z, pos.y);
+    }
+    return vec2(n.z * pos.x, pos.y);
+}
+
+vec4 sample_tiled(
+    sampler2D tex, vec2 texCoord, vec2 texRegion, vec2 tileCoord
+) {
+    // derivatives must be taken in uniform control flow
+    vec2 dx = dFdx(tileCoord);
+    vec2 dy = dFdy(tileCoord);
+    if (texRegion.x >= 0.0) {
+        return texture(tex, texCoord);
+    }
+    uvec2 bits = floatBitsToUint(texRegion);
+    vec2 offset = vec2(bits & 0x3FFFu) / 16383.0;
+    vec2 size = vec2((bits >> 14u) & 0x3FFFu) / 16383.0;
+    return textureGrad(
+        tex, offset + fract(tileCoord) * size, dx * size, dy * size
+    );
+}
+
+#endif // TILING_GLSL_
@@ -1,11 +1,17 @@
 #include "compression.hpp"
 
-#include <string>
+#include <algorithm>
 #include <cstring>
+#include <queue>
 #include <stdexcept>
+#include <string>
+
+#define ZLIB_CONST
+#include <zlib.h>
 
-#include "rle.hpp"
 #include "gzip.hpp"
+#include "lz4.hpp"
+#include "rle.hpp"
 #include "util/BufferPool.hpp"
 
 using namespace compression;
@@ -27,13 +33,12 @@ static std::shared_ptr<ubyte[]> get_buffer(size_t minSize) {
     return nullptr;
 }
 
-static auto compress_rle(
-    const ubyte* src,
-    size_t srclen,
-    size_t& len,
-    size_t(*encodefunc)(const ubyte*, size_t, ubyte*)
+/// @param bufferSize max encoded data length
+/// @param encodefunc encoder writing to the given buffer returning length
+template <typename Encoder>
+static std::unique_ptr<ubyte[]> compress_to_buffer(
+    size_t bufferSize, size_t& len, const Encoder& encodefunc
 ) {
-    size_t bufferSize = srclen * 2;
     auto buffer = get_buffer(bufferSize);
     auto bytes = buffer.get();
     std::unique_ptr<ubyte[]> uptr;
@@ -41,7 +46,7 @@ static auto compress_rle(
         uptr = std::make_unique<ubyte[]>(bufferSize);
         bytes = uptr.get();
     }
-    len = encodefunc(src, srclen, bytes);
+    len = encodefunc(bytes);
     if (uptr) {
         if (len < bufferSize * BUFFER_NOCROP_THRESOLD) {
             auto cropped = std::make_unique<ubyte[]>(len);
@@ -55,8 +60,220 @@ static auto compress_rle(
     return data;
 }
 
+static auto compress_rle(
+    const ubyte* src,
+    size_t srclen,
+    size_t& len,
+    size_t(*encodefunc)(const ubyte*, size_t, ubyte*)
+) {
+    return compress_to_buffer(srclen * 2, len, [=](ubyte* dst) {
+        return encodefunc(src, srclen, dst);
+    });
+}
+
+namespace {
+    /// @brief zlib streams reused by the thread to avoid state allocations
+    struct ZlibStreams {
+        z_stream deflater {};
+        z_stream inflater {};
+        bool deflaterReady = false;
+        bool inflaterReady = false;
+
+        ~ZlibStreams() {
+            if (deflaterReady) {
+                deflateEnd(&deflater);
+            }
+            if (inflaterReady) {
+                inflateEnd(&inflater);
+            }
+        }
+    };
+    thread_local ZlibStreams zlib_streams;
+}
+
+static const Dictionary& require_dictionary(const Dictionary* dictionary) {
+    if (dictionary == nullptr) {
+        throw std::invalid_argument("compression dictionary is required");
+    }
+    return *dictionary;
+}
+
+static std::unique_ptr<ubyte[]> compress_zlib_dict(
+    const ubyte* src, size_t srclen, size_t& len, const Dictionary& dictionary
+) {
+    auto& stream = zlib_streams.deflater;
+    if (!zlib_streams.deflaterReady) {
+        if (deflateInit2(
+                &stream,
+                Z_BEST_COMPRESSION,
+                Z_DEFLATED,
+                MAX_WBITS,
+                9,
+                Z_DEFAULT_STRATEGY
+            ) != Z_OK) {
+            throw std::runtime_error("could not initialize deflate stream");
+        }
+        zlib_streams.deflaterReady = true;
+    } else {
+        deflateReset(&stream);
+    }
+    deflateSetDictionary(
+        &stream, dictionary.bytes.data(), dictionary.bytes.size()
+    );
+    size_t bufferSize = deflateBound(&stream, srclen);
+    return compress_to_buffer(bufferSize, len, [&](ubyte* dst) {
+        stream.next_in = src;
+        stream.avail_in = srclen;
+        stream.next_out = dst;
+        stream.avail_out = bufferSize;
+        if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+            throw std::runtime_error("deflate error");
+        }
+        return static_cast<size_t>(stream.total_out);
+    });
+}
+
+static void decompress_zlib_dict(
+    const ubyte* src,
+    size_t srclen,
+    ubyte* dst,
+    size_t dstlen,
+    const Dictionary& dictionary
+) {
+    auto& stream = zlib_streams.inflater;
+    if (!zlib_streams.inflaterReady) {
+        if (inflateInit2(&stream, MAX_WBITS) != Z_OK) {
+            throw std::runtime_error("could not initialize inflate stream");
+        }
+        zlib_streams.inflaterReady = true;
+    } else {
+        inflateReset(&stream);
+    }
+    stream.next_in = src;
+    stream.avail_in = srclen;
+    stream.next_out = dst;
+    stream.avail_out = dstlen;
+    int result = inflate(&stream, Z_FINISH);
+    if (result == Z_NEED_DICT) {
+        if (stream.adler != dictionary.id) {
+            throw std::runtime_error("compression dictionary mismatch");
+        }
+        inflateSetDictionary(
+            &stream, dictionary.bytes.data(), dictionary.bytes.size()
+        );
+        result = inflate(&stream, Z_FINISH);
+    }
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error("corrupted zlib data");
+    }
+    if (stream.total_out != dstlen) {
+        throw std::runtime_error(
+            "expected decompressed size " + std::to_string(dstlen) +
+            " got " + std::to_string(stream.total_out)
+        );
+    }
+}
+
+Dictionary::Dictionary(std::vector<ubyte> bytes) : bytes(std::move(bytes)) {
+    id = adler32(
+        adler32(0L, Z_NULL, 0), this->bytes.data(), this->bytes.size()
+    );
+}
+
+/// @brief Length of strings counted by dictionary training
+static constexpr size_t GRAM_SIZE = 8;
+/// @brief Dictionary is composed of samples segments of this size
+static constexpr size_t SEGMENT_SIZE = 64;
+static constexpr int FREQUENCIES_LOG = 20;
+
+static inline uint32_t gram_hash(const ubyte* src) {
+    uint64_t value;
+    std::memcpy(&value, src, sizeof(value));
+    return (value * 0x9E3779B97F4A7C15ULL) >> (64 - FREQUENCIES_LOG);
+}
+
+Dictionary compression::train_dictionary(
+    const std::vector<util::span<ubyte>>& samples, size_t capacity
+) {
+    capacity = std::min(capacity, MAX_DICTIONARY_SIZE);
+
+    // number of samples containing the string (hash collisions are ignored)
+    std::vector<uint32_t> frequencies(1 << FREQUENCIES_LOG);
+    std::vector<uint32_t> lastSample(1 << FREQUENCIES_LOG, UINT32_MAX);
+    // short samples and sample tails make shorter segments
+    std::vector<util::span<ubyte>> segments;
+    for (uint32_t i = 0; i < samples.size(); i++) {
+        const auto& sample = samples[i];
+        for (size_t pos = 0; pos + GRAM_SIZE <= sample.size(); pos++) {
+            uint32_t hash = gram_hash(sample.data() + pos);
+            if (lastSample[hash] != i) {
+                lastSample[hash] = i;
+                frequencies[hash]++;
+            }
+        }
+        for (size_t pos = 0; pos + GRAM_SIZE <= sample.size();
+             pos += SEGMENT_SIZE) {
+            size_t length = std::min(SEGMENT_SIZE, sample.size() - pos);
+            segments.emplace_back(sample.data() + pos, length);
+        }
+    }
+    auto score = [&frequencies](util::span<ubyte> segment) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i + GRAM_SIZE <= segment.size(); i++) {
+            uint32_t frequency = frequencies[gram_hash(segment.data() + i)];
+            // strings found in a single sample are useless
+            if (frequency > 1) {
+                sum += frequency;
+            }
+        }
+        return sum;
+    };
+    std::priority_queue<std::pair<uint64_t, size_t>> heap;
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (uint64_t value = score(segments[i])) {
+            heap.emplace(value, i);
+        }
+    }
+    // greedy selection with lazy scores update: strings of selected
+    // segments are not counted anymore
+    std::vector<util::span<ubyte>> selected;
+    size_t size = 0;
+    while (!heap.empty()) {
+        auto [expected, index] = heap.top();
+        heap.pop();
+        auto segment = segments[index];
+        if (size + segment.size() > capacity) {
+            continue;
+        }
+        uint64_t actual = score(segment);
+        if (actual == 0) {
+            continue;
+        }
+        if (actual < expected) {
+            heap.emplace(actual, index);
+            continue;
+        }
+        selected.push_back(segment);
+        size += segment.size();
+        for (size_t i = 0; i + GRAM_SIZE <= segment.size(); i++) {
+            frequencies[gram_hash(segment.data() + i)] = 0;
+        }
+    }
+    // the most common strings are placed at the end to be closer to the data
+    std::vector<ubyte> bytes;
+    bytes.reserve(size);
+    for (auto it = selected.rbegin(); it != selected.rend(); ++it) {
+        bytes.insert(bytes.end(), it->begin(), it->end());
+    }
+    return Dictionary(std::move(bytes));
+}
+
 std::unique_ptr<ubyte[]> compression::compress(
-    const ubyte* src, size_t srclen, size_t& len, Method method
+    const ubyte* src,
+    size_t srclen,
+    size_t& len,
+    Method method,
+    const Dictionary* dictionary
 ) {
     switch (method) {
         case Method::NONE:
@@ -72,77 +289,80 @@ std::unique_ptr<ubyte[]> compression::compress(
             len = buffer.size();
             return data;
         }
+        case Method::LZ4:
+            return compress_to_buffer(
+                lz4::max_encoded_size(srclen),
+                len,
+                [=](ubyte* dst) { return lz4::encode(src, srclen, dst); }
+            );
+        case Method::ZLIB_DICT:
+            return compress_zlib_dict(
+                src, srclen, len, require_dictionary(dictionary)
+            );
         default:
             throw std::runtime_error("not implemented");
     }
 }
 
 std::unique_ptr<ubyte[]> compression::decompress(
-    const ubyte* src, size_t srclen, size_t dstlen, Method method
+    const ubyte* src,
+    size_t srclen,
+    size_t dstlen,
+    Method method,
+    const Dictionary* dictionary
 ) {
-    switch (method) {
-        case Method::NONE:
-            throw std::invalid_argument("compression method is NONE");
-        case Method::EXTRLE8: {
-            auto decompressed = std::make_unique<ubyte[]>(dstlen);
-            extrle::decode(src, srclen, decompressed.get(), dstlen);
-            return decompressed;
-        }
-        case Method::EXTRLE16: {
-            auto decompressed = std::make_unique<ubyte[]>(dstlen);
-            size_t decoded = extrle::decode16(src, srclen, decompressed.get(), dstlen);
-            if (decoded != dstlen) {
-                throw std::runtime_error(
-                    "expected decompressed size " + std::to_string(dstlen) +
-                    " got " + std::to_string(decoded));
-            }
-            return decompressed;
-        }
-        case Method::GZIP: {
-            auto buffer = gzip::decompress(src, srclen);
-            if (buffer.size() != dstlen) {
-                throw std::runtime_error(
-                    "expected decompressed size " + std::to_string(dstlen) +
-                    " got " + std::to_string(buffer.size()));
-            }
-            auto decompressed = std::make_unique<ubyte[]>(buffer.size());
-            std::memcpy(decompressed.get(), buffer.data(), buffer.size());
-            return decompressed;
-        }
-        default:
-            throw std::runtime_error("method not implemented");
+    auto decompressed = std::make_unique<ubyte[]>(dstlen);
+    decompress({src, srclen}, decompressed.get(), dstlen, method, dictionary);
+    return decompressed;
+}
+
+static void check_decompressed_size(size_t expected, size_t decoded) {
+    if (decoded != expected) {
+        throw std::runtime_error(
+            "expected decompressed size " + std::to_string(expected) +
+            " got " + std::to_string(decoded)
+        );
     }
 }
 
-void compression::decompress(const util::span<ubyte> src, ubyte* dst, size_t dstlen, Method method) {
+void compression::decompress(
+    const util::span<ubyte> src,
+    ubyte* dst,
+    size_t dstlen,
+    Method method,
+    const Dictionary* dictionary
+) {
     switch (method) {
         case Method::NONE:
             throw std::invalid_argument("compression method is NONE");
         case Method::EXTRLE8:
             extrle::decode(src.data(), src.size(), dst, dstlen);
             break;
-        case Method::EXTRLE16: {
-            size_t decoded =
-                extrle::decode16(src.data(), src.size(), dst, dstlen);
-            if (decoded != dstlen) {
-                throw std::runtime_error(
-                    "expected decompressed size " + std::to_string(dstlen) +
-                    " got " + std::to_string(decoded)
-                );
-            }
+        case Method::EXTRLE16:
+            check_decompressed_size(
+                dstlen, extrle::decode16(src.data(), src.size(), dst, dstlen)
+            );
             break;
-        }
         case Method::GZIP: {
             auto buffer = gzip::decompress(src.data(), src.size());
-            if (buffer.size() != dstlen) {
-                throw std::runtime_error(
-                    "expected decompressed size " + std::to_string(dstlen) +
-                    " got " + std::to_string(buffer.size())
-                );
-            }
+            check_decompressed_size(dstlen, buffer.size());
             std::memcpy(dst, buffer.data(), buffer.size());
             break;
         }
+        case Method::LZ4:
+            check_decompressed_size(
+                dstlen, lz4::decode(src.data(), src.size(), dst, dstlen)
+            );
+            break;
+        case Method::ZLIB_DICT:
+            decompress_zlib_dict(
+                src.data(),
+                src.size(),
+                dst,
+                dstlen,
+                require_dictionary(dictionary)
+            );
+            break;
         default:
             throw std::runtime_error("method not implemented");
     }
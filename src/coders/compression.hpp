@@ -1,35 +1,81 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "typedefs.hpp"
 #include "util/span.hpp"
 
 namespace compression {
+    /// @brief Compression method. Values are stored in region files
     enum class Method {
-        NONE, EXTRLE8, EXTRLE16, GZIP
+        NONE,
+        EXTRLE8,
+        EXTRLE16,
+        GZIP,
+        /// @brief LZ4 block format. Fast for any data
+        LZ4,
+        /// @brief zlib stream with preset dictionary. High ratio for small
+        /// data similar to the dictionary
+        ZLIB_DICT
     };
 
+    /// @brief Max preset dictionary size (deflate window size)
+    inline constexpr size_t MAX_DICTIONARY_SIZE = 32 * 1024;
+
+    /// @brief Preset dictionary of strings likely to be found in the data
+    struct Dictionary {
+        std::vector<ubyte> bytes;
+        /// @brief Dictionary identifier (adler32 of the bytes)
+        uint32_t id;
+
+        Dictionary(std::vector<ubyte> bytes);
+    };
+
+    /// @brief Build dictionary from the most common strings of the samples
+    /// @param samples data similar to data to be compressed
+    /// @param capacity max dictionary size
+    Dictionary train_dictionary(
+        const std::vector<util::span<ubyte>>& samples,
+        size_t capacity = MAX_DICTIONARY_SIZE
+    );
+
     /// @brief Compress buffer
     /// @param src source buffer
     /// @param srclen length of the source buffer
     /// @param len (out argument) length of result buffer
     /// @param method compression method
+    /// @param dictionary dictionary required by ZLIB_DICT method
     /// @return compressed bytes array
-    /// @throws std::invalid_argument if compression method is NONE
+    /// @throws std::invalid_argument if compression method is NONE or
+    /// the dictionary is missing
     std::unique_ptr<ubyte[]> compress(
-        const ubyte* src, size_t srclen, size_t& len, Method method
+        const ubyte* src,
+        size_t srclen,
+        size_t& len,
+        Method method,
+        const Dictionary* dictionary = nullptr
     );
 
     /// @brief Decompress buffer
     /// @param src compressed buffer
     /// @param srclen length of compressed buffer
     /// @param dstlen max expected length of source buffer
+    /// @param dictionary dictionary used to compress the buffer
     /// @return decompressed bytes array
     std::unique_ptr<ubyte[]> decompress(
-        const ubyte* src, size_t srclen, size_t dstlen, Method method);
+        const ubyte* src,
+        size_t srclen,
+        size_t dstlen,
+        Method method,
+        const Dictionary* dictionary = nullptr
+    );
 
     void decompress(
-        const util::span<ubyte> src, ubyte* dst, size_t dstlen, Method method
+        const util::span<ubyte> src,
+        ubyte* dst,
+        size_t dstlen,
+        Method method,
+        const Dictionary* dictionary = nullptr
     );
 }
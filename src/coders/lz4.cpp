@@ -0,0 +1,166 @@
+#include "lz4.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static constexpr int HASH_LOG = 12;
+static constexpr size_t MIN_MATCH = 4;
+/// @brief Last match must start this number of bytes before the end
+static constexpr size_t MFLIMIT = 12;
+/// @brief Last bytes are always encoded as literals
+static constexpr size_t LAST_LITERALS = 5;
+static constexpr size_t MAX_DISTANCE = 0xFFFF;
+/// @brief Search step grows each 2^SKIP_TRIGGER misses
+static constexpr int SKIP_TRIGGER = 6;
+
+static inline uint32_t read32(const ubyte* src) {
+    uint32_t value;
+    std::memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+static inline ubyte* write_length(ubyte* dst, size_t length) {
+    while (length >= 255) {
+        *dst++ = 255;
+        length -= 255;
+    }
+    *dst++ = static_cast<ubyte>(length);
+    return dst;
+}
+
+static inline ubyte* write_literals(
+    ubyte* dst, const ubyte* literals, size_t count, ubyte matchToken
+) {
+    ubyte* token = dst++;
+    *token = (std::min<size_t>(count, 15) << 4) | matchToken;
+    if (count >= 15) {
+        dst = write_length(dst, count - 15);
+    }
+    if (count) {
+        std::memcpy(dst, literals, count);
+    }
+    return dst + count;
+}
+
+size_t lz4::encode(const ubyte* src, size_t length, ubyte* dst) {
+    const ubyte* end = src + length;
+    const ubyte* anchor = src;
+    ubyte* op = dst;
+
+    if (length > MFLIMIT) {
+        uint32_t table[1 << HASH_LOG] {};
+        const ubyte* matchLimit = end - MFLIMIT;
+        const ubyte* extendLimit = end - LAST_LITERALS;
+        const ubyte* ip = src + 1;
+        uint misses = 0;
+        while (ip < matchLimit) {
+            uint32_t sequence = read32(ip);
+            uint32_t& entry = table[hash(sequence)];
+            const ubyte* ref = src + entry;
+            entry = static_cast<uint32_t>(ip - src);
+            if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_DISTANCE ||
+                read32(ref) != sequence) {
+                ip += 1 + (misses++ >> SKIP_TRIGGER);
+                continue;
+            }
+            misses = 0;
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            const ubyte* matchEnd = ip + MIN_MATCH;
+            const ubyte* refEnd = ref + MIN_MATCH;
+            while (matchEnd < extendLimit && *matchEnd == *refEnd) {
+                matchEnd++;
+                refEnd++;
+            }
+            size_t matchLength = matchEnd - ip - MIN_MATCH;
+            op = write_literals(
+                op, anchor, ip - anchor, std::min<size_t>(matchLength, 15)
+            );
+            uint16_t offset = static_cast<uint16_t>(ip - ref);
+            *op++ = offset & 0xFF;
+            *op++ = offset >> 8;
+            if (matchLength >= 15) {
+                op = write_length(op, matchLength - 15);
+            }
+            ip = matchEnd;
+            anchor = ip;
+            // position inside of the match improves ratio of repeats
+            if (ip < matchLimit) {
+                table[hash(read32(ip - 2))] =
+                    static_cast<uint32_t>(ip - 2 - src);
+            }
+        }
+    }
+    op = write_literals(op, anchor, end - anchor, 0);
+    return op - dst;
+}
+
+static inline size_t read_length(
+    const ubyte*& ip, const ubyte* end, size_t length
+) {
+    if (length != 15) {
+        return length;
+    }
+    ubyte value;
+    do {
+        if (ip >= end) {
+            throw std::runtime_error("unexpected end of lz4 data");
+        }
+        value = *ip++;
+        length += value;
+    } while (value == 255);
+    return length;
+}
+
+size_t lz4::decode(
+    const ubyte* src, size_t length, ubyte* dst, size_t dstLength
+) {
+    const ubyte* ip = src;
+    const ubyte* end = src + length;
+    ubyte* op = dst;
+    ubyte* dstEnd = dst + dstLength;
+    while (ip < end) {
+        ubyte token = *ip++;
+        size_t literals = read_length(ip, end, token >> 4);
+        if (literals > static_cast<size_t>(end - ip) ||
+            literals > static_cast<size_t>(dstEnd - op)) {
+            throw std::runtime_error("corrupted lz4 data");
+        }
+        if (literals) {
+            std::memcpy(op, ip, literals);
+        }
+        ip += literals;
+        op += literals;
+        if (ip == end) {
+            break;
+        }
+        if (end - ip < 2) {
+            throw std::runtime_error("unexpected end of lz4 data");
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t matchLength = read_length(ip, end, token & 0xF) + MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst) ||
+            matchLength > static_cast<size_t>(dstEnd - op)) {
+            throw std::runtime_error("corrupted lz4 data");
+        }
+        const ubyte* ref = op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(op, ref, matchLength);
+            op += matchLength;
+        } else {
+            // overlapping match repeats the last bytes
+            for (size_t i = 0; i < matchLength; i++) {
+                *op++ = *ref++;
+            }
+        }
+    }
+    return op - dst;
+}
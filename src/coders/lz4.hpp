@@ -0,0 +1,21 @@
+#pragma once
+
+#include "typedefs.hpp"
+
+/// @brief LZ4 block format codec (no frame, no checksums)
+namespace lz4 {
+    /// @return max encoded data length for source of the given length
+    constexpr size_t max_encoded_size(size_t length) {
+        return length + length / 255 + 16;
+    }
+
+    /// @brief Encode bytes array
+    /// @param dst destination buffer of at least max_encoded_size(length)
+    /// @return encoded data length
+    size_t encode(const ubyte* src, size_t length, ubyte* dst);
+
+    /// @brief Decode bytes array
+    /// @return decoded data length
+    /// @throws std::runtime_error if data is corrupted or does not fit dst
+    size_t decode(const ubyte* src, size_t length, ubyte* dst, size_t dstLength);
+}
@@ -17,7 +17,10 @@ inline constexpr bool ENGINE_DEBUG_BUILD = true;
 inline const std::string ENGINE_VERSION_STRING = "0.31";
 
 /// @brief world regions format version
-inline constexpr uint REGION_FORMAT_VERSION = 3;
+inline constexpr uint REGION_FORMAT_VERSION = 4;
+
+/// @brief oldest world regions format version loaded without conversion
+inline constexpr uint REGION_FORMAT_MIN_VERSION = 3;
 
 /// @brief max simultaneously open world region files
 inline constexpr uint MAX_OPEN_REGION_FILES = 32;
@@ -33,6 +36,10 @@ inline constexpr int CHUNK_W = 16;
 inline constexpr int CHUNK_H = 256;
 inline constexpr int CHUNK_D = 16;
 
+/// @brief height of chunk vertical section meshed separately
+inline constexpr int CHUNK_SECTION_H = 16;
+inline constexpr int CHUNK_SECTIONS = CHUNK_H / CHUNK_SECTION_H;
+
 inline constexpr uint VOXEL_USER_BITS = 8;
 inline constexpr uint VOXEL_USER_BITS_OFFSET = sizeof(blockstate_t)*8-VOXEL_USER_BITS;
 
@@ -7,11 +7,17 @@
 #include "ContentBuilder.hpp"
 #include "ContentLoader.hpp"
 #include "PacksManager.hpp"
+#include "loading/ContentDefsCache.hpp"
 #include "objects/rigging.hpp"
+#include "debug/Logger.hpp"
 #include "devtools/Project.hpp"
 #include "logic/scripting/scripting.hpp"
+#include "util/ParallelExecutor.hpp"
+#include "util/timeutil.hpp"
 #include "core_defs.hpp"
 
+static debug::Logger logger("content-control");
+
 static void load_configs(Input* input, const io::path& root) {
     auto configFolder = root / "config";
 }
@@ -108,15 +114,38 @@ void ContentControl::loadContent() {
         resRoots.push_back({pack.id, pack.folder});
     }
     paths.resPaths = ResPaths(resRoots);
+
+    // Definition files are parsed in parallel, then registered in packs
+    // order on the main thread
+    timeutil::Timer timer;
+    ContentDefsCache defs;
+    {
+        util::ParallelExecutor executor("content-loader", 0);
+        defs.parse(ContentDefsCache::discover(allPacks), executor);
+    }
+    int64_t parseTime = timer.stop();
+
     // Load content
     for (auto& pack : allPacks) {
-        ContentLoader(&pack, contentBuilder, paths.resPaths).load();
+        ContentLoader(&pack, contentBuilder, paths.resPaths, defs).load();
         load_configs(input, pack.folder);
     }
+    int64_t registerTime = timer.stop() - parseTime;
+
     content = contentBuilder.build();
     scripting::on_content_load(content.get());
+    int64_t buildTime = timer.stop() - parseTime - registerTime;
 
     ContentLoader::loadScripts(*content);
+    int64_t totalTime = timer.stop();
+
+    logger.info() << "loaded " << allPacks.size() << " packs in "
+                  << totalTime / 1000 << " ms: parsing " << defs.size()
+                  << " definitions " << parseTime / 1000
+                  << " ms, registration " << registerTime / 1000
+                  << " ms, build " << buildTime / 1000 << " ms, scripts "
+                  << (totalTime - parseTime - registerTime - buildTime) / 1000
+                  << " ms";
 
     postContent();
 }
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <iostream>
 
+#include "loading/ContentDefsCache.hpp"
 #include "loading/ContentUnitLoader.hpp"
 #include "ContentBuilder.hpp"
 #include "ContentPack.hpp"
@@ -18,9 +19,12 @@
 static debug::Logger logger("content-loader");
 
 ContentLoader::ContentLoader(
-    ContentPack* pack, ContentBuilder& builder, const ResPaths& paths
+    ContentPack* pack,
+    ContentBuilder& builder,
+    const ResPaths& paths,
+    const ContentDefsCache& defs
 )
-    : pack(pack), builder(builder), paths(paths) {
+    : pack(pack), builder(builder), paths(paths), defs(defs) {
     auto runtime = std::make_unique<ContentPackRuntime>(
         *pack, scripting::create_pack_environment(*pack)
     );
@@ -33,7 +37,8 @@ ContentLoader::ContentLoader(
 static void detect_defs(
     const io::path& folder,
     const std::string& prefix,
-    std::vector<std::string>& detected
+    std::vector<std::string>& detected,
+    const ContentDefsCache& defs
 ) {
     if (!io::is_directory(folder)) {
         return;
@@ -44,11 +49,11 @@ static void detect_defs(
             continue;
         }
         if (io::is_regular_file(file) && io::is_data_file(file)) {
-            auto map = io::read_object(file);
+            auto map = defs.read(file);
             std::string id = prefix.empty() ? name : prefix + ":" + name;
             detected.emplace_back(id);
         } else if (io::is_directory(file) && file.extension() != ".files") {
-            detect_defs(file, name, detected);
+            detect_defs(file, name, detected, defs);
         }
     }
 }
@@ -94,10 +99,11 @@ std::vector<std::tuple<std::string, std::string>> ContentLoader::scanContent(
 bool ContentLoader::fixPackIndices(
     const io::path& folder,
     dv::value& indicesRoot,
-    const std::string& contentSection
+    const std::string& contentSection,
+    const ContentDefsCache& defs
 ) {
     std::vector<std::string> detected;
-    detect_defs(folder, "", detected);
+    detect_defs(folder, "", detected, defs);
 
     std::vector<std::string> indexed;
     bool modified = false;
@@ -139,9 +145,9 @@ void ContentLoader::fixPackIndices() {
     }
 
     bool modified = false;
-    modified |= fixPackIndices(blocksFolder, root, "blocks");
-    modified |= fixPackIndices(itemsFolder, root, "items");
-    modified |= fixPackIndices(entitiesFolder, root, "entities");
+    modified |= fixPackIndices(blocksFolder, root, "blocks", defs);
+    modified |= fixPackIndices(itemsFolder, root, "items", defs);
+    modified |= fixPackIndices(entitiesFolder, root, "entities", defs);
 
     if (modified) {
         // rewrite modified json
@@ -186,7 +192,7 @@ void ContentUnitLoader<DefT>::loadUnit(
 void ContentLoader::loadBlockMaterial(
     BlockMaterial& def, const io::path& file
 ) {
-    def.deserialize(io::read_json(file));
+    def.deserialize(defs.read(file));
     if (def.hitSound.empty()) {
         def.hitSound = def.stepsSound;
     }
@@ -205,7 +211,7 @@ void ContentUnitLoader<DefT>::loadDefs(const dv::value& root) {
         auto configFile = pack.folder / (prefix + "/" + name + ".json");
         std::string parent;
         if (io::exists(configFile)) {
-            auto root = io::read_json(configFile);
+            auto root = defs.read(configFile);
             root.at("parent").get(parent);
         }
         return parent;
@@ -278,7 +284,7 @@ void ContentLoader::loadContent(const dv::value& root) {
         builder.entities.defs.size(),
     };
 
-    ContentUnitLoader<Block>(*pack, builder.blocks, "blocks", 
+    ContentUnitLoader<Block>(*pack, builder.blocks, defs, "blocks", 
         [this](Block& def) {
         if (!def.hidden) {
             bool created;
@@ -297,8 +303,8 @@ void ContentLoader::loadContent(const dv::value& root) {
         }
     }).loadDefs(root);
 
-    ContentUnitLoader(*pack, builder.items, "items").loadDefs(root);
-    ContentUnitLoader(*pack, builder.entities, "entities").loadDefs(root);
+    ContentUnitLoader(*pack, builder.items, defs, "items").loadDefs(root);
+    ContentUnitLoader(*pack, builder.entities, defs, "entities").loadDefs(root);
 
     stats->totalBlocks = builder.blocks.defs.size() - prevStats.totalBlocks;
     stats->totalItems = builder.items.defs.size() - prevStats.totalItems;
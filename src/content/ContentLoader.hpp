@@ -18,6 +18,7 @@ class ResPaths;
 class Content;
 class ContentBuilder;
 class ContentPackRuntime;
+class ContentDefsCache;
 struct ContentPackStats;
 
 class ContentLoader {
@@ -27,27 +28,31 @@ class ContentLoader {
     ContentBuilder& builder;
     ContentPackStats* stats;
     const ResPaths& paths;
+    const ContentDefsCache& defs;
 
     void loadGenerator(
         GeneratorDef& def, const std::string& full, const std::string& name
     );
-    static void loadBlockMaterial(BlockMaterial& def, const io::path& file);
+    void loadBlockMaterial(BlockMaterial& def, const io::path& file);
     void loadResources(ResourceType type, const dv::value& list);
     void loadResourceAliases(ResourceType type, const dv::value& aliases);
 
     void loadContent(const dv::value& map);
 public:
+    /// @param defs definition files parsed ahead
     ContentLoader(
         ContentPack* pack,
         ContentBuilder& builder,
-        const ResPaths& paths
+        const ResPaths& paths,
+        const ContentDefsCache& defs
     );
 
     // Refresh pack content.json
     static bool fixPackIndices(
         const io::path& folder,
         dv::value& indicesRoot,
-        const std::string& contentSection
+        const std::string& contentSection,
+        const ContentDefsCache& defs
     );
 
     static std::vector<std::tuple<std::string, std::string>> scanContent(
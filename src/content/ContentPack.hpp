@@ -116,6 +116,20 @@ struct ContentPack {
     }
 };
 
+/// @brief Interned ids of world script events (see lua::intern_event)
+struct WorldEventIds {
+    int blockplaced;
+    int blockreplaced;
+    int blockbreaking;
+    int blockbroken;
+    int blockinteract;
+    int playertick;
+    int chunkpresent;
+    int chunkremove;
+    int inventoryopen;
+    int inventoryclosed;
+};
+
 struct WorldFuncsSet {
     bool onblockplaced;
     bool onblockreplaced;
@@ -127,6 +141,7 @@ struct WorldFuncsSet {
     bool onchunkremove;
     bool oninventoryopen;
     bool oninventoryclosed;
+    WorldEventIds events;
 };
 
 class ContentPackRuntime {
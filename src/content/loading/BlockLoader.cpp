@@ -1,5 +1,6 @@
 #define VC_ENABLE_REFLECTION
 #include "ContentUnitLoader.hpp"
+#include "ContentDefsCache.hpp"
 #include "ContentLoadingCommons.hpp"
 
 #include "../ContentBuilder.hpp"
@@ -87,7 +88,7 @@ static void load_variant(
 template<> void ContentUnitLoader<Block>::loadUnit(
     Block& def, const std::string& name, const io::path& file
 ) {
-    auto root = io::read_json(file);
+    auto root = defs.read(file);
     process_properties(def, name, root);
     process_tags(def, root);
 
@@ -0,0 +1,67 @@
+#include "ContentDefsCache.hpp"
+
+#include "../ContentPack.hpp"
+#include "io/io.hpp"
+#include "util/ParallelExecutor.hpp"
+
+static void discover_files(
+    const io::path& folder, bool recursive, std::vector<io::path>& dst
+) {
+    if (!io::is_directory(folder)) {
+        return;
+    }
+    for (const auto& file : io::directory_iterator(folder)) {
+        if (io::is_directory(file)) {
+            // generators and other units resources are not definitions
+            if (recursive && file.extension() != ".files") {
+                discover_files(file, recursive, dst);
+            }
+        } else if (io::is_data_file(file)) {
+            dst.push_back(file);
+        }
+    }
+}
+
+std::vector<io::path> ContentDefsCache::discover(
+    const std::vector<ContentPack>& packs
+) {
+    std::vector<io::path> files;
+    for (const auto& pack : packs) {
+        const auto& folder = pack.folder;
+        discover_files(folder / ContentPack::BLOCKS_FOLDER, true, files);
+        discover_files(folder / ContentPack::ITEMS_FOLDER, true, files);
+        discover_files(folder / ContentPack::ENTITIES_FOLDER, true, files);
+        discover_files(folder / "block_materials", false, files);
+        discover_files(folder / ContentPack::GENERATORS_FOLDER, false, files);
+    }
+    return files;
+}
+
+void ContentDefsCache::parse(
+    const std::vector<io::path>& files, util::ParallelExecutor& executor
+) {
+    std::vector<Entry> parsed(files.size());
+    executor.run(files.size(), [&files, &parsed](size_t index, uint) {
+        auto& entry = parsed[index];
+        try {
+            entry.value = io::read_object(files[index]);
+        } catch (...) {
+            entry.error = std::current_exception();
+        }
+    });
+    for (size_t i = 0; i < files.size(); i++) {
+        entries[files[i].string()] = std::move(parsed[i]);
+    }
+}
+
+dv::value ContentDefsCache::read(const io::path& file) const {
+    const auto& found = entries.find(file.string());
+    if (found == entries.end()) {
+        return io::read_object(file);
+    }
+    const auto& entry = found->second;
+    if (entry.error) {
+        std::rethrow_exception(entry.error);
+    }
+    return entry.value;
+}
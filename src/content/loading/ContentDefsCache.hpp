@@ -0,0 +1,45 @@
+#pragma once
+
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "data/dv.hpp"
+#include "io/path.hpp"
+
+struct ContentPack;
+
+namespace util {
+    class ParallelExecutor;
+}
+
+/// @brief Content packs definition files parsed ahead on worker threads.
+/// Loaders take parsed definitions in the registration order on the main
+/// thread, so parsing errors are reported the same way as without cache
+class ContentDefsCache {
+    struct Entry {
+        dv::value value;
+        std::exception_ptr error;
+    };
+    std::unordered_map<std::string, Entry> entries;
+public:
+    /// @brief Find definition files of the packs: blocks, items, entities,
+    /// block materials and world generators
+    static std::vector<io::path> discover(
+        const std::vector<ContentPack>& packs
+    );
+
+    /// @brief Read and parse files in parallel
+    void parse(
+        const std::vector<io::path>& files, util::ParallelExecutor& executor
+    );
+
+    /// @brief Get parsed file. Files missing in cache are read in place
+    /// @throw std::runtime_error if file could not be read or parsed
+    dv::value read(const io::path& file) const;
+
+    size_t size() const {
+        return entries.size();
+    }
+};
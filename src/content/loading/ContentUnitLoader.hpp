@@ -7,6 +7,7 @@
 #include "data/dv_fwd.hpp"
 
 struct ContentPack;
+class ContentDefsCache;
 
 template<typename T> class ContentUnitBuilder;
 
@@ -16,11 +17,13 @@ public:
     ContentUnitLoader(
         const ContentPack& pack,
         ContentUnitBuilder<DefT>& builder,
+        const ContentDefsCache& defs,
         const std::string& defsDir,
         std::function<void(DefT&)> postFunc = nullptr
     )
         : pack(pack),
           builder(builder),
+          defs(defs),
           defsDir(defsDir),
           postFunc(std::move(postFunc)) {
     }
@@ -30,6 +33,7 @@ public:
 private:
     const ContentPack& pack;
     ContentUnitBuilder<DefT>& builder;
+    const ContentDefsCache& defs;
     std::string defsDir;
     std::function<void(DefT&)> postFunc;
 };
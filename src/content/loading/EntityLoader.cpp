@@ -1,5 +1,6 @@
 #define VC_ENABLE_REFLECTION
 #include "ContentUnitLoader.hpp"
+#include "ContentDefsCache.hpp"
 
 #include "../ContentBuilder.hpp"
 #include "coders/json.hpp"
@@ -15,7 +16,7 @@ static debug::Logger logger("entity-content-loader");
 template<> void ContentUnitLoader<EntityDef>::loadUnit(
     EntityDef& def, const std::string& name, const io::path& file
 ) {
-    auto root = io::read_json(file);
+    auto root = defs.read(file);
 
     if (root.has("parent")) {
         const auto& parentName = root["parent"].asString();
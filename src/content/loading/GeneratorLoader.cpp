@@ -4,6 +4,7 @@
 #include <algorithm>
 
 #include "../ContentPack.hpp"
+#include "ContentDefsCache.hpp"
 
 #include "io/io.hpp"
 #include "engine/EnginePaths.hpp"
@@ -204,7 +205,7 @@ void ContentLoader::loadGenerator(
     if (!io::exists(generatorFile)) {
         return;
     }
-    auto map = io::read_toml(generatorsDir / (name + ".toml"));
+    auto map = defs.read(generatorFile);
     map.at("caption").get(def.caption);
     map.at("biome-parameters").get(def.biomeParameters);
     map.at("biome-bpd").get(def.biomesBPD);
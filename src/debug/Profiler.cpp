@@ -0,0 +1,50 @@
+#include "Profiler.hpp"
+
+#include <atomic>
+
+using namespace debug;
+
+static ProfileListener listener = nullptr;
+static std::atomic<bool> enabled = false;
+
+void profiler::set_listener(ProfileListener newListener) {
+    enabled = false;
+    listener = std::move(newListener);
+    enabled = listener != nullptr;
+}
+
+bool profiler::is_enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void profiler::record(ProfileStage stage, double micros) {
+    if (is_enabled()) {
+        listener(stage, micros);
+    }
+}
+
+const char* profiler::to_string(ProfileStage stage) {
+    const char* names[] = {
+        "generation", "lighting", "region-load", "region-save", "scripting"
+    };
+    return names[static_cast<int>(stage)];
+}
+
+ProfileScope::ProfileScope(ProfileStage stage)
+    : stage(stage), enabled(profiler::is_enabled()) {
+    if (enabled) {
+        start = std::chrono::high_resolution_clock::now();
+    }
+}
+
+ProfileScope::~ProfileScope() {
+    if (!enabled) {
+        return;
+    }
+    using namespace std::chrono;
+    profiler::record(
+        stage,
+        duration<double, std::micro>(high_resolution_clock::now() - start)
+            .count()
+    );
+}
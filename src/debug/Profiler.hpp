@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+namespace debug {
+    /// @brief Engine stages measured with ProfileScope
+    enum class ProfileStage {
+        GENERATION,
+        LIGHTING,
+        REGION_LOAD,
+        REGION_SAVE,
+        SCRIPTING,
+        COUNT
+    };
+
+    /// @brief Stage duration receiver (duration is in microseconds).
+    /// Called from worker threads too
+    using ProfileListener = std::function<void(ProfileStage, double)>;
+
+    namespace profiler {
+        /// @brief Set stages durations receiver, nullptr disables profiling.
+        /// Must not be changed while a world is open
+        void set_listener(ProfileListener listener);
+
+        bool is_enabled();
+
+        void record(ProfileStage stage, double micros);
+
+        const char* to_string(ProfileStage stage);
+    }
+
+    /// @brief Measures the scope duration if profiling is enabled
+    class ProfileScope {
+        ProfileStage stage;
+        bool enabled;
+        std::chrono::high_resolution_clock::time_point start;
+    public:
+        ProfileScope(ProfileStage stage);
+        ~ProfileScope();
+
+        /// @brief Do not record the scope duration
+        void cancel() {
+            enabled = false;
+        }
+    };
+}
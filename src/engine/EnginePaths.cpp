@@ -156,10 +156,15 @@ void EnginePaths::setCurrentWorldFolder(io::path folder) {
 
 std::string EnginePaths::mount(const io::path& file) {
     if (file.extension() == ".zip") {
-        auto stream = io::read(file);
-        auto device = std::make_unique<io::ZipFileDevice>(
-            std::move(stream), [file]() { return io::read(file); }
-        );
+        std::unique_ptr<io::ZipFileDevice> device;
+        if (std::shared_ptr<io::MappedFile> mapped = io::map(file)) {
+            device = std::make_unique<io::ZipFileDevice>(std::move(mapped));
+        } else {
+            auto stream = io::read(file);
+            device = std::make_unique<io::ZipFileDevice>(
+                std::move(stream), [file]() { return io::read(file); }
+            );
+        }
         std::string name;
         do {
             name = std::string("M.") + generate_random_base64<6>();
@@ -1,5 +1,8 @@
 #include "BlocksRenderer.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include "graphics/core/Mesh.hpp"
 #include "graphics/commons/Model.hpp"
 #include "maths/UVRegion.hpp"
@@ -12,6 +15,54 @@
 const glm::vec3 BlocksRenderer::SUN_VECTOR(0.528265, 0.833149, -0.163704);
 const float DIRECTIONAL_LIGHT_FACTOR = 0.3f;
 
+namespace {
+    struct CubeSide {
+        glm::ivec3 axisX;
+        glm::ivec3 axisY;
+        glm::ivec3 axisZ;
+        int texture;
+    };
+}
+
+/// @brief Cube sides axes in blockCube order
+static const CubeSide CUBE_SIDES[6] {
+    {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, 5},
+    {{-1, 0, 0}, {0, 1, 0}, {0, 0, -1}, 4},
+    {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}, 3},
+    {{1, 0, 0}, {0, 0, 1}, {0, -1, 0}, 2},
+    {{0, 0, -1}, {0, 1, 0}, {1, 0, 0}, 1},
+    {{0, 0, 1}, {0, 1, 0}, {-1, 0, 0}, 0},
+};
+
+/// @brief Pack atlas region segment to a merged quad texture coordinate.
+/// Decoded by the chunk shaders (see res/shaders/lib/tiling.glsl)
+static float pack_tiled_coord(float begin, float end) {
+    constexpr uint32_t MAX_VALUE = 0x3FFF;
+    auto offset = static_cast<uint32_t>(
+        std::round(glm::clamp(begin, 0.0f, 1.0f) * MAX_VALUE)
+    );
+    auto size = static_cast<uint32_t>(
+        std::round(glm::clamp(end - begin, 0.0f, 1.0f) * MAX_VALUE)
+    );
+    // sign and exponent bits keep the value negative, finite and normal
+    uint32_t bits = 0xC0000000 | (size << 14) | offset;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// @brief Pack light the same way as vertex color
+static uint32_t pack_color(const glm::vec4& light) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(light.r * 255)) |
+           static_cast<uint32_t>(static_cast<uint8_t>(light.g * 255)) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(light.b * 255)) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(light.a * 255)) << 24;
+}
+
+static bool is_same_region(const UVRegion& a, const UVRegion& b) {
+    return a.u1 == b.u1 && a.v1 == b.v1 && a.u2 == b.u2 && a.v2 == b.v2;
+}
+
 BlocksRenderer::BlocksRenderer(
     size_t capacity,
     const Content& content,
@@ -24,7 +75,9 @@ BlocksRenderer::BlocksRenderer(
     vertexCount(0),
     vertexOffset(0),
     indexCount(0),
+    denseIndexCount(0),
     capacity(capacity),
+    chunkVoxels(std::make_unique<voxel[]>(CHUNK_VOL)),
     cache(cache),
     settings(settings)
 {
@@ -60,12 +113,12 @@ void BlocksRenderer::vertex(
 }
 
 void BlocksRenderer::index(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t e, uint32_t f) {
-    indexBuffer[indexCount++] = static_cast<uint32_t>(vertexOffset + a);
-    indexBuffer[indexCount++] = static_cast<uint32_t>(vertexOffset + b);
-    indexBuffer[indexCount++] = static_cast<uint32_t>(vertexOffset + c);
-    indexBuffer[indexCount++] = static_cast<uint32_t>(vertexOffset + d);
-    indexBuffer[indexCount++] = static_cast<uint32_t>(vertexOffset + e);
-    indexBuffer[indexCount++] = static_cast<uint32_t>(vertexOffset + f);
+    putIndex(static_cast<uint32_t>(vertexOffset + a));
+    putIndex(static_cast<uint32_t>(vertexOffset + b));
+    putIndex(static_cast<uint32_t>(vertexOffset + c));
+    putIndex(static_cast<uint32_t>(vertexOffset + d));
+    putIndex(static_cast<uint32_t>(vertexOffset + e));
+    putIndex(static_cast<uint32_t>(vertexOffset + f));
     vertexOffset += 4;
 }
 
@@ -80,7 +133,7 @@ void BlocksRenderer::face(
     const glm::vec4(&lights)[4],
     const glm::vec4& tint
 ) {
-    if (vertexCount + 4 >= capacity || indexCount + 6 >= capacity) {
+    if (isOverflow(4, 6)) {
         overflow = true;
         return;
     }
@@ -120,7 +173,7 @@ void BlocksRenderer::faceAO(
     const UVRegion& region,
     bool lights
 ) {
-    if (vertexCount + 4 >= capacity || indexCount + 6 >= capacity) {
+    if (isOverflow(4, 6)) {
         overflow = true;
         return;
     }
@@ -159,7 +212,7 @@ void BlocksRenderer::face(
     glm::vec4 tint,
     bool lights
 ) {
-    if (vertexCount + 4 >= capacity || indexCount + 6 >= capacity) {
+    if (isOverflow(4, 6)) {
         overflow = true;
         return;
     }
@@ -309,8 +362,7 @@ void BlocksRenderer::blockCustomModel(
 
     const auto& model = cache.getModel(block.rt.id, block.getVariantIndex(states.userbits));
     for (const auto& mesh : model.meshes) {
-        if (vertexCount + mesh.vertices.size() >= capacity
-            || indexCount + mesh.vertices.size() >= capacity) {
+        if (isOverflow(mesh.vertices.size(), mesh.vertices.size())) {
             overflow = true;
             return;
         }
@@ -371,7 +423,7 @@ void BlocksRenderer::blockCustomModel(
                     n,
                     shading ? 0.0f : 1.0
                 );
-                indexBuffer[indexCount++] = vertexOffset++;
+                putIndex(vertexOffset++);
             }
         }
     }
@@ -440,6 +492,180 @@ void BlocksRenderer::blockCube(
     }
 }
 
+bool BlocksRenderer::isMergeable(const Block& def, blockstate states) const {
+    if (!def.rotatable) {
+        return true;
+    }
+    const auto& axes = def.rotations.variants[states.rotation].axes;
+    return axes[0] == glm::ivec3(1, 0, 0) && axes[1] == glm::ivec3(0, 1, 0) &&
+           axes[2] == glm::ivec3(0, 0, 1);
+}
+
+void BlocksRenderer::blockCubeMerged(
+    const glm::ivec3& coord,
+    const Block& block,
+    uint8_t variantId,
+    bool lights,
+    bool ao
+) {
+    const auto& variant = block.getVariant(variantId);
+    int index = vox_index(coord.x, coord.y, coord.z);
+    for (int i = 0; i < 6; i++) {
+        const auto& side = CUBE_SIDES[i];
+        const auto& X = side.axisX;
+        const auto& Y = side.axisY;
+        const auto& Z = side.axisZ;
+        if (!isOpen(coord + Z, block, variant)) {
+            continue;
+        }
+        const auto& region =
+            cache.getRegion(block.rt.id, variantId, side.texture, densePass);
+        float d = glm::dot(glm::vec3(Z), SUN_VECTOR);
+        d = (1.0f - DIRECTIONAL_LIGHT_FACTOR) + d * DIRECTIONAL_LIGHT_FACTOR;
+
+        // the same lights as faceAO and face calculate
+        glm::vec4 corners[4];
+        if (ao && lights) {
+            corners[0] = pickSoftLight(coord + Z, X, Y);
+            corners[1] = pickSoftLight(coord + Z + X, X, Y);
+            corners[2] = pickSoftLight(coord + Z + X + Y, X, Y);
+            corners[3] = pickSoftLight(coord + Z + Y, X, Y);
+            for (auto& corner : corners) {
+                corner *= glm::vec4(d);
+            }
+        } else if (ao) {
+            std::fill(std::begin(corners), std::end(corners), glm::vec4(1.0f));
+        } else {
+            auto tint = lights ? pickLight(coord + Z) * d
+                               : glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+            std::fill(std::begin(corners), std::end(corners), tint);
+        }
+        uint32_t color = pack_color(corners[0]);
+        if (color != pack_color(corners[1]) ||
+            color != pack_color(corners[2]) ||
+            color != pack_color(corners[3])) {
+            faceAO(coord, X, Y, Z, region, lights);
+            continue;
+        }
+        mergedFaces[i].push_back(MergedFace {
+            &region,
+            corners[0],
+            color,
+            lights ? 0.0f : 1.0f,
+            indexStreams,
+            index});
+    }
+}
+
+void BlocksRenderer::mergedFace(
+    const glm::ivec3& begin,
+    const glm::ivec3& end,
+    const glm::ivec3& axisX,
+    const glm::ivec3& axisY,
+    const glm::ivec3& axisZ,
+    const MergedFace& face
+) {
+    if (isOverflow(4, 6)) {
+        overflow = true;
+        return;
+    }
+    const auto& region = *face.region;
+    float u1 = region.u1;
+    float v1 = region.v1;
+    float u2 = region.u2;
+    float v2 = region.v2;
+    if (begin != end) {
+        u1 = u2 = pack_tiled_coord(region.u1, region.u2);
+        v1 = v2 = pack_tiled_coord(region.v1, region.v2);
+    }
+    glm::vec3 coord = glm::vec3(begin + end) * 0.5f;
+    glm::vec3 size = glm::vec3(end - begin) + 1.0f;
+    glm::vec3 X = glm::vec3(axisX) * size;
+    glm::vec3 Y = glm::vec3(axisY) * size;
+    glm::vec3 Z = axisZ;
+
+    float s = 0.5f;
+    vertex(coord + (-X - Y + Z) * s, u1, v1, face.light, Z, face.emission);
+    vertex(coord + ( X - Y + Z) * s, u2, v1, face.light, Z, face.emission);
+    vertex(coord + ( X + Y + Z) * s, u2, v2, face.light, Z, face.emission);
+    vertex(coord + (-X + Y + Z) * s, u1, v2, face.light, Z, face.emission);
+    index(0, 1, 2, 0, 2, 3);
+}
+
+void BlocksRenderer::mergeFaces() {
+    for (int i = 0; i < 6; i++) {
+        auto& faces = mergedFaces[i];
+        const auto& side = CUBE_SIDES[i];
+        // rectangles grow along positive voxel axes
+        glm::ivec3 axisU = glm::abs(side.axisX);
+        glm::ivec3 axisV = glm::abs(side.axisY);
+
+        for (size_t j = 0; j < faces.size(); j++) {
+            mergeMask[faces[j].index] = j;
+        }
+        for (size_t j = 0; j < faces.size() && !overflow; j++) {
+            const auto& face = faces[j];
+            if (mergeMask[face.index] != static_cast<int>(j)) {
+                continue;
+            }
+            glm::ivec3 begin(
+                face.index % CHUNK_W,
+                face.index / (CHUNK_D * CHUNK_W),
+                (face.index / CHUNK_D) % CHUNK_W
+            );
+            auto matches = [this, &faces, &face](const glm::ivec3& pos) {
+                if (pos.x >= CHUNK_W || pos.y >= CHUNK_H || pos.z >= CHUNK_D) {
+                    return false;
+                }
+                int found = mergeMask[vox_index(pos.x, pos.y, pos.z)];
+                if (found == -1) {
+                    return false;
+                }
+                const auto& other = faces[found];
+                return other.color == face.color &&
+                       other.emission == face.emission &&
+                       other.indexStreams == face.indexStreams &&
+                       is_same_region(*other.region, *face.region);
+            };
+            int width = 1;
+            while (matches(begin + axisU * width)) {
+                width++;
+            }
+            auto matchesRow = [&](int v) {
+                for (int u = 0; u < width; u++) {
+                    if (!matches(begin + axisU * u + axisV * v)) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            int height = 1;
+            while (matchesRow(height)) {
+                height++;
+            }
+            for (int v = 0; v < height; v++) {
+                for (int u = 0; u < width; u++) {
+                    auto pos = begin + axisU * u + axisV * v;
+                    mergeMask[vox_index(pos.x, pos.y, pos.z)] = -1;
+                }
+            }
+            indexStreams = face.indexStreams;
+            mergedFace(
+                begin,
+                begin + axisU * (width - 1) + axisV * (height - 1),
+                side.axisX,
+                side.axisY,
+                side.axisZ,
+                face
+            );
+        }
+        for (const auto& face : faces) {
+            mergeMask[face.index] = -1;
+        }
+        faces.clear();
+    }
+}
+
 bool BlocksRenderer::isOpenForLight(int x, int y, int z) const {
     blockid_t id = voxelsBuffer->pickBlockId(chunk->x * CHUNK_W + x,
                                              y,
@@ -487,12 +713,58 @@ glm::vec4 BlocksRenderer::pickSoftLight(
         right, up);
 }
 
+void BlocksRenderer::renderBlock(
+    const glm::ivec3& coord,
+    const Block& def,
+    uint8_t variantId,
+    blockstate states,
+    bool enableAO
+) {
+    blockid_t id = def.rt.id;
+    const UVRegion texfaces[6] {
+        cache.getRegion(id, variantId, 0, densePass),
+        cache.getRegion(id, variantId, 1, densePass),
+        cache.getRegion(id, variantId, 2, densePass),
+        cache.getRegion(id, variantId, 3, densePass),
+        cache.getRegion(id, variantId, 4, densePass),
+        cache.getRegion(id, variantId, 5, densePass)
+    };
+    bool lights = !def.shadeless;
+    bool ao = def.ambientOcclusion && enableAO;
+    switch (def.getModel(states.userbits).type) {
+        case BlockModelType::BLOCK:
+            if (greedyMeshing && !densePass && !def.translucent &&
+                isMergeable(def, states)) {
+                blockCubeMerged(coord, def, variantId, lights, ao);
+                break;
+            }
+            blockCube(coord, texfaces, def, states, lights, ao);
+            break;
+        case BlockModelType::XSPRITE: {
+            blockXSprite(coord.x, coord.y, coord.z, glm::vec3(1.0f),
+                        texfaces[FACE_MX], texfaces[FACE_MZ], 1.0f);
+            break;
+        }
+        case BlockModelType::AABB: {
+            blockAABB(coord, texfaces, &def, states.rotation, lights, ao);
+            break;
+        }
+        case BlockModelType::CUSTOM: {
+            blockCustomModel(coord, def, states, lights, ao);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
 void BlocksRenderer::render(
     const voxel* voxels, const int beginEnds[256][2]
 ) {
-    bool denseRender = this->denseRender;
-    bool densePass = this->densePass;
     bool enableAO = settings.graphics.softLighting.get();
+    for (auto& faces : mergedFaces) {
+        faces.clear();
+    }
     for (const auto drawGroup : *content.drawGroups) {
         int begin = beginEnds[drawGroup][0];
         if (begin == 0) {
@@ -509,59 +781,33 @@ void BlocksRenderer::render(
             if (id == 0 || variant.drawGroup != drawGroup || state.segment) {
                 continue;
             }
-            if (denseRender != (variant.culling == CullingMode::OPTIONAL)) {
-                continue;
-            }
             if (def.translucent) {
                 continue;
             }
-            const UVRegion texfaces[6] {
-                cache.getRegion(id, variantId, 0, densePass),
-                cache.getRegion(id, variantId, 1, densePass),
-                cache.getRegion(id, variantId, 2, densePass),
-                cache.getRegion(id, variantId, 3, densePass),
-                cache.getRegion(id, variantId, 4, densePass),
-                cache.getRegion(id, variantId, 5, densePass)
-            };
             int x = i % CHUNK_W;
             int y = i / (CHUNK_D * CHUNK_W);
             int z = (i / CHUNK_D) % CHUNK_W;
-            switch (def.getModel(state.userbits).type) {
-                case BlockModelType::BLOCK:
-                    blockCube({x, y, z}, texfaces, def, vox.state, !def.shadeless,
-                              def.ambientOcclusion && enableAO);
-                    break;
-                case BlockModelType::XSPRITE: {
-                    if (!denseRender)
-                    blockXSprite(x, y, z, glm::vec3(1.0f),
-                                texfaces[FACE_MX], texfaces[FACE_MZ], 1.0f);
-                    break;
-                }
-                case BlockModelType::AABB: {
-                    if (!denseRender)
-                    blockAABB({x, y, z}, texfaces, &def, vox.state.rotation,
-                              !def.shadeless, def.ambientOcclusion && enableAO);
-                    break;
-                }
-                case BlockModelType::CUSTOM: {
-                    if (!denseRender)
-                    blockCustomModel(
-                        {x, y, z},
-                        def,
-                        vox.state,
-                        !def.shadeless,
-                        def.ambientOcclusion && enableAO
-                    );
-                    break;
-                }
-                default:
-                    break;
+            if (variant.culling != CullingMode::OPTIONAL) {
+                indexStreams = NORMAL_INDICES | DENSE_INDICES;
+                renderBlock({x, y, z}, def, variantId, state, enableAO);
+            } else if (def.getModel(state.userbits).type ==
+                       BlockModelType::BLOCK) {
+                // visible faces and textures differ between the streams
+                densePass = true;
+                indexStreams = DENSE_INDICES;
+                renderBlock({x, y, z}, def, variantId, state, enableAO);
+                densePass = false;
+                indexStreams = NORMAL_INDICES;
+                renderBlock({x, y, z}, def, variantId, state, enableAO);
             }
             if (overflow) {
                 return;
             }
         }
     }
+    if (greedyMeshing) {
+        mergeFaces();
+    }
 }
 
 SortingMeshData BlocksRenderer::renderTranslucent(
@@ -573,7 +819,6 @@ SortingMeshData BlocksRenderer::renderTranslucent(
     bool aabbInit = false;
     size_t totalSize = 0;
 
-    bool densePass = this->densePass;
     bool enableAO = settings.graphics.softLighting.get();
     for (const auto drawGroup : *content.drawGroups) {
         int begin = beginEnds[drawGroup][0];
@@ -594,51 +839,10 @@ SortingMeshData BlocksRenderer::renderTranslucent(
             if (!def.translucent) {
                 continue;
             }
-            const UVRegion texfaces[6] {
-                cache.getRegion(id, variantId, 0, densePass),
-                cache.getRegion(id, variantId, 1, densePass),
-                cache.getRegion(id, variantId, 2, densePass),
-                cache.getRegion(id, variantId, 3, densePass),
-                cache.getRegion(id, variantId, 4, densePass),
-                cache.getRegion(id, variantId, 5, densePass)
-            };
             int x = i % CHUNK_W;
             int y = i / (CHUNK_D * CHUNK_W);
             int z = (i / CHUNK_D) % CHUNK_W;
-            switch (def.getModel(state.userbits).type) {
-                case BlockModelType::BLOCK:
-                    blockCube({x, y, z}, texfaces, def, vox.state, !def.shadeless,
-                              def.ambientOcclusion && enableAO);
-                    break;
-                case BlockModelType::XSPRITE: {
-                    blockXSprite(x, y, z, glm::vec3(1.0f),
-                                texfaces[FACE_MX], texfaces[FACE_MZ], 1.0f);
-                    break;
-                }
-                case BlockModelType::AABB: {
-                    blockAABB(
-                        {x, y, z},
-                        texfaces,
-                        &def,
-                        vox.state.rotation,
-                        !def.shadeless,
-                        def.ambientOcclusion && enableAO
-                    );
-                    break;
-                }
-                case BlockModelType::CUSTOM: {
-                    blockCustomModel(
-                        {x, y, z},
-                        def,
-                        vox.state,
-                        !def.shadeless,
-                        def.ambientOcclusion && enableAO
-                    );
-                    break;
-                }
-                default:
-                    break;
-            }
+            renderBlock({x, y, z}, def, variantId, state, enableAO);
             if (vertexCount == 0) {
                 continue;
             }
@@ -700,104 +904,195 @@ SortingMeshData BlocksRenderer::renderTranslucent(
     return sortingMesh;
 }
 
-void BlocksRenderer::build(const Chunk* chunk, const VoxelsVolume& volume) {
-    this->chunk = chunk;
-    this->voxelsBuffer = &volume;
-    if (voxelsBuffer->pickBlockId(
-        chunk->x * CHUNK_W, 0, chunk->z * CHUNK_D
-    ) == BLOCK_VOID) {
-        cancelled = true;
-        return;
+void BlocksRenderer::copyChunkVoxels(int begin, int end) {
+    const voxel* src = voxelsBuffer->getVoxels();
+    int w = voxelsBuffer->getW();
+    int d = voxelsBuffer->getD();
+    int ox = chunk->x * CHUNK_W - voxelsBuffer->getX();
+    int oz = chunk->z * CHUNK_D - voxelsBuffer->getZ();
+    for (int y = begin; y < end; y++) {
+        for (int z = 0; z < CHUNK_D; z++) {
+            const voxel* row =
+                src + vox_index(ox, y - voxelsBuffer->getY(), oz + z, w, d);
+            voxel* dst = chunkVoxels.get() + vox_index(0, y, z);
+            for (int x = 0; x < CHUNK_W; x++) {
+                // heights may be changed after the volume is filled
+                dst[x] = row[x].id == BLOCK_VOID ? voxel {} : row[x];
+            }
+        }
     }
-    const voxel* voxels = chunk->voxels;
-
-    int totalBegin = chunk->bottom * (CHUNK_W * CHUNK_D);
-    int totalEnd = chunk->top * (CHUNK_W * CHUNK_D);
+}
 
-    int beginEnds[256][2] {};
-    for (int i = totalBegin; i < totalEnd; i++) {
+bool BlocksRenderer::findDrawGroups(
+    const voxel* voxels, int begin, int end, int beginEnds[256][2]
+) const {
+    bool hasTranslucent = false;
+    for (int i = begin; i < end; i++) {
         const voxel& vox = voxels[i];
         blockid_t id = vox.id;
         const auto& def = *blockDefsCache[id];
         const auto& variant = def.getVariantByBits(vox.state.userbits);
+        hasTranslucent |= def.translucent;
 
         if (beginEnds[variant.drawGroup][0] == 0) {
             beginEnds[variant.drawGroup][0] = i+1;
         }
         beginEnds[variant.drawGroup][1] = i;
     }
-    cancelled = false;
+    return hasTranslucent;
+}
 
-    overflow = false;
-    vertexCount = 0;
-    vertexOffset = indexCount = 0;
+void BlocksRenderer::build(
+    const Chunk* chunk, const VoxelsVolume& volume, uint32_t sections
+) {
+    this->chunk = chunk;
+    this->voxelsBuffer = &volume;
+    if (voxelsBuffer->pickBlockId(
+        chunk->x * CHUNK_W, 0, chunk->z * CHUNK_D
+    ) == BLOCK_VOID) {
+        cancelled = true;
+        return;
+    }
+    compactVertices = settings.graphics.compactVertices.get();
+    // merged quads hold packed atlas regions not fitting the compact format
+    greedyMeshing =
+        settings.graphics.greedyMeshing.get() && !compactVertices;
+    if (greedyMeshing && mergeMask == nullptr) {
+        mergeMask = std::make_unique<int[]>(CHUNK_VOL);
+        std::fill(mergeMask.get(), mergeMask.get() + CHUNK_VOL, -1);
+    }
+    int bottom = chunk->bottom;
+    int top = chunk->top;
+    copyChunkVoxels(bottom, top);
+    const voxel* voxels = chunkVoxels.get();
 
-    denseRender = false;
-    densePass = false;
+    int totalBegin = bottom * (CHUNK_W * CHUNK_D);
+    int totalEnd = top * (CHUNK_W * CHUNK_D);
 
-    sortingMesh = renderTranslucent(voxels, beginEnds);
+    int beginEnds[256][2] {};
+    bool hasTranslucent =
+        findDrawGroups(voxels, totalBegin, totalEnd, beginEnds);
+    cancelled = false;
 
     overflow = false;
     vertexCount = 0;
-    vertexOffset = 0;
-    indexCount = 0;
-    denseIndexCount = 0;
+    vertexOffset = indexCount = denseIndexCount = 0;
 
-    denseRender = false;
     densePass = false;
-    render(voxels, beginEnds);
+    indexStreams = NORMAL_INDICES;
 
-    size_t endIndex = indexCount;
-    
-    denseRender = true;
-    densePass = true;
-    render(voxels, beginEnds);
+    // translucent blocks are sorted chunk-wide so always rebuilt
+    if (hasTranslucent) {
+        sortingMesh = renderTranslucent(voxels, beginEnds);
+    } else {
+        sortingMesh = SortingMeshData {};
+    }
 
-    denseIndexCount = indexCount;
-    for (size_t i = 0; i < denseIndexCount; i++) {
-        denseIndexBuffer[i] = indexBuffer[i];
+    sectionMeshes.clear();
+    for (int index = 0; index < CHUNK_SECTIONS; index++) {
+        if ((sections & (1U << index)) == 0) {
+            continue;
+        }
+        overflow = false;
+        vertexCount = 0;
+        vertexOffset = 0;
+        indexCount = 0;
+        denseIndexCount = 0;
+
+        int begin = std::max(index * CHUNK_SECTION_H, bottom);
+        int end = std::min((index + 1) * CHUNK_SECTION_H, top);
+        if (begin < end) {
+            int sectionBeginEnds[256][2] {};
+            findDrawGroups(
+                voxels,
+                begin * (CHUNK_W * CHUNK_D),
+                end * (CHUNK_W * CHUNK_D),
+                sectionBeginEnds
+            );
+            render(voxels, sectionBeginEnds);
+        }
+        sectionMeshes.push_back(createSectionMesh(index));
+        sectionMeshes.back().connectivity =
+            computeConnectivity(voxels, index, begin, end);
     }
+}
 
-    indexCount = endIndex;
-    densePass = false;
-    render(voxels, beginEnds);
+SectionConnectivity BlocksRenderer::computeConnectivity(
+    const voxel* voxels, int index, int begin, int end
+) const {
+    if (begin >= end) {
+        return SectionConnectivity::open();
+    }
+    std::array<bool, SectionConnectivity::SECTION_VOLUME> occluders {};
+    int sectionY = index * CHUNK_SECTION_H;
+    for (int y = begin; y < end; y++) {
+        const voxel* row = voxels + vox_index(0, y, 0);
+        bool* dst = occluders.data() + vox_index(0, y - sectionY, 0);
+        for (int i = 0; i < CHUNK_W * CHUNK_D; i++) {
+            const auto& def = *blockDefsCache[row[i].id];
+            const auto& variant = def.getVariantByBits(row[i].state.userbits);
+            dst[i] = variant.rt.solid && variant.drawGroup == 0 &&
+                     variant.culling == CullingMode::DEFAULT &&
+                     !def.lightPassing && !def.translucent;
+        }
+    }
+    return SectionConnectivity::compute(occluders.data());
 }
 
-ChunkMeshData BlocksRenderer::createMesh() {
-    return ChunkMeshData {
-        MeshData(
+static util::Buffer<CompactChunkVertex> pack_vertices(
+    const ChunkVertex* vertices, size_t count
+) {
+    util::Buffer<CompactChunkVertex> packed(count);
+    for (size_t i = 0; i < count; i++) {
+        packed[i] = CompactChunkVertex::pack(vertices[i]);
+    }
+    return packed;
+}
+
+ChunkSectionMeshData BlocksRenderer::createSectionMesh(int index) {
+    std::vector<util::Buffer<uint32_t>> indices {
+        util::Buffer(indexBuffer.get(), indexCount),
+        util::Buffer(denseIndexBuffer.get(), denseIndexCount),
+    };
+    ChunkSectionMeshData section {index};
+    if (compactVertices) {
+        section.compactMesh = MeshData(
+            pack_vertices(vertexBuffer.get(), vertexCount),
+            std::move(indices),
+            util::Buffer(
+                CompactChunkVertex::ATTRIBUTES,
+                sizeof(CompactChunkVertex::ATTRIBUTES) /
+                    sizeof(VertexAttribute)
+            )
+        );
+    } else {
+        section.mesh = MeshData(
             util::Buffer(vertexBuffer.get(), vertexCount),
-            std::vector<util::Buffer<uint32_t>> {
-                util::Buffer(indexBuffer.get(), indexCount),
-                util::Buffer(denseIndexBuffer.get(), denseIndexCount),
-            },
+            std::move(indices),
             util::Buffer(
                 ChunkVertex::ATTRIBUTES,
                 sizeof(ChunkVertex::ATTRIBUTES) / sizeof(VertexAttribute)
             )
-        ),
-        std::move(sortingMesh)
-    };
+        );
+    }
+    for (size_t i = 0; i < vertexCount; i++) {
+        const auto& position = vertexBuffer[i].position;
+        if (i == 0) {
+            section.min = section.max = position;
+        }
+        section.min = glm::min(section.min, position);
+        section.max = glm::max(section.max, position);
+    }
+    return section;
 }
 
-ChunkMesh BlocksRenderer::render(
-    const Chunk* chunk, const VoxelsVolume& volume
-) {
-    build(chunk, volume);
-    
-    assert(vertexCount <= capacity);
-    assert(indexCount <= capacity);
-    assert(denseIndexCount <= capacity);
-
-    return ChunkMesh{std::make_unique<Mesh<ChunkVertex>>(
-        vertexBuffer.get(), vertexCount, 
-        std::vector<IndexBufferData> {
-            IndexBufferData {indexBuffer.get(), indexCount},
-            IndexBufferData {denseIndexBuffer.get(), denseIndexCount},
-        }
-    ), std::move(sortingMesh)};
+ChunkMeshData BlocksRenderer::createMesh() {
+    return ChunkMeshData {
+        std::move(sectionMeshes), std::move(sortingMesh)
+    };
 }
 
-size_t BlocksRenderer::getMemoryConsumption() const {
-    return capacity * (sizeof(ChunkVertex) + sizeof(uint32_t) * 2);
+size_t BlocksRenderer::getMemoryConsumption(size_t capacity) {
+    return capacity * (sizeof(ChunkVertex) + sizeof(uint32_t) * 2) +
+           CHUNK_VOL * sizeof(voxel) + CHUNK_VOL * sizeof(int);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 #include <glm/glm.hpp>
 #include "voxels/voxel.hpp"
 #include "typedefs.hpp"
@@ -34,10 +36,18 @@ class BlocksRenderer {
     size_t capacity;
     bool overflow = false;
     bool cancelled = false;
+    /// @brief Optional culling blocks faces are rendered for dense indices
     bool densePass = false;
-    bool denseRender = false;
+    /// @brief Index streams flags
+    static inline constexpr uint8_t NORMAL_INDICES = 1;
+    static inline constexpr uint8_t DENSE_INDICES = 2;
+    /// @brief Index streams written by index()
+    uint8_t indexStreams = NORMAL_INDICES;
     const Chunk* chunk = nullptr;
     const VoxelsVolume* voxelsBuffer = nullptr;
+    /// @brief Chunk voxels copied from the volume, so the chunk voxels are
+    /// not accessed by the worker thread
+    std::unique_ptr<voxel[]> chunkVoxels;
 
     const Block* const* blockDefsCache;
     const ContentGfxCache& cache;
@@ -46,6 +56,27 @@ class BlocksRenderer {
     util::PseudoRandom randomizer;
 
     SortingMeshData sortingMesh;
+    std::vector<ChunkSectionMeshData> sectionMeshes;
+
+    /// @brief Visible full cube face waiting for greedy merging
+    struct MergedFace {
+        const UVRegion* region;
+        /// @brief Light of all face vertices
+        glm::vec4 light;
+        /// @brief Light packed the same way as vertex color
+        uint32_t color;
+        float emission;
+        uint8_t indexStreams;
+        /// @brief Chunk voxel index
+        int index;
+    };
+    bool greedyMeshing = false;
+    /// @brief Pack vertices into the CompactChunkVertex format
+    bool compactVertices = false;
+    /// @brief Faces for greedy merging by direction (blockCube order)
+    std::vector<MergedFace> mergedFaces[6];
+    /// @brief Voxel index to merged face index of the current direction
+    std::unique_ptr<int[]> mergeMask;
 
     void vertex(
         const glm::vec3& coord,
@@ -57,6 +88,21 @@ class BlocksRenderer {
     );
     void index(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t e, uint32_t f);
 
+    inline void putIndex(uint32_t index) {
+        if (indexStreams & NORMAL_INDICES) {
+            indexBuffer[indexCount++] = index;
+        }
+        if (indexStreams & DENSE_INDICES) {
+            denseIndexBuffer[denseIndexCount++] = index;
+        }
+    }
+
+    /// @brief Check if vertices and indices do not fit into the buffers
+    inline bool isOverflow(size_t vertices, size_t indices) const {
+        return vertexCount + vertices >= capacity ||
+               std::max(indexCount, denseIndexCount) + indices >= capacity;
+    }
+
     void vertexAO(
         const glm::vec3& coord, float u, float v, 
         const glm::vec4& brightness,
@@ -99,6 +145,27 @@ class BlocksRenderer {
         bool lights,
         bool ao
     );
+    /// @brief Check if the block may be rendered with merged faces
+    bool isMergeable(const Block& def, blockstate states) const;
+    /// @brief Collect cube faces having uniform light for greedy merging.
+    /// Other faces are rendered immediately
+    void blockCubeMerged(
+        const glm::ivec3& coord,
+        const Block& block,
+        uint8_t variantId,
+        bool lights,
+        bool ao
+    );
+    /// @brief Merge collected faces into larger quads and render them
+    void mergeFaces();
+    void mergedFace(
+        const glm::ivec3& begin,
+        const glm::ivec3& end,
+        const glm::ivec3& axisX,
+        const glm::ivec3& axisY,
+        const glm::ivec3& axisZ,
+        const MergedFace& face
+    );
     void blockAABB(
         const glm::ivec3& coord,
         const UVRegion(&faces)[6], 
@@ -158,8 +225,27 @@ class BlocksRenderer {
         float x, float y, float z, const glm::ivec3& right, const glm::ivec3& up
     ) const;
 
+    void copyChunkVoxels(int begin, int end);
+    void renderBlock(
+        const glm::ivec3& coord,
+        const Block& def,
+        uint8_t variantId,
+        blockstate states,
+        bool enableAO
+    );
+    /// @brief Render opaque blocks writing both index streams in one sweep
     void render(const voxel* voxels, const int beginEnds[256][2]);
     SortingMeshData renderTranslucent(const voxel* voxels, int beginEnds[256][2]);
+    /// @brief Find voxels range of each draw group in [begin, end) range
+    /// @return true if there are translucent blocks in the range
+    bool findDrawGroups(
+        const voxel* voxels, int begin, int end, int beginEnds[256][2]
+    ) const;
+    ChunkSectionMeshData createSectionMesh(int index);
+    /// @brief Flood fill section through non-occluding blocks
+    SectionConnectivity computeConnectivity(
+        const voxel* voxels, int index, int begin, int end
+    ) const;
 public:
     BlocksRenderer(
         size_t capacity,
@@ -169,13 +255,17 @@ public:
     );
     virtual ~BlocksRenderer();
 
-    void build(const Chunk* chunk, const VoxelsVolume& volume);
-    ChunkMesh render(
-        const Chunk* chunk, const VoxelsVolume& volume
+    /// @brief Build chunk translucent mesh and meshes of the sections
+    /// @param sections bit mask of sections to build
+    void build(
+        const Chunk* chunk,
+        const VoxelsVolume& volume,
+        uint32_t sections = Chunk::ALL_SECTIONS
     );
     ChunkMeshData createMesh();
 
-    size_t getMemoryConsumption() const;
+    /// @brief Max memory used by a renderer of the given capacity
+    static size_t getMemoryConsumption(size_t capacity);
 
     bool isCancelled() const {
         return cancelled;
@@ -0,0 +1,158 @@
+#include "CaveCulling.hpp"
+
+#include <algorithm>
+
+#include "maths/FrustumCulling.hpp"
+#include "maths/voxmaths.hpp"
+
+static inline constexpr uint8_t ALL_FACES = 0b111111;
+static inline constexpr uint32_t ALL_SECTIONS =
+    (1ULL << CHUNK_SECTIONS) - 1;
+
+/// @brief Offsets of neighbour sections by face (-x, +x, -y, +y, -z, +z)
+static inline constexpr int FACE_OFFSETS[SectionConnectivity::FACES][3] {
+    {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+void SectionConnectivity::connect(uint8_t faces) {
+    for (int a = 0; a < FACES; a++) {
+        if ((faces >> a) & 1) {
+            bits |= static_cast<uint64_t>(faces) << (a * FACES);
+        }
+    }
+}
+
+SectionConnectivity SectionConnectivity::open() {
+    SectionConnectivity connectivity;
+    connectivity.connect(ALL_FACES);
+    return connectivity;
+}
+
+static uint8_t boundary_faces(int x, int y, int z) {
+    return (x == 0) | ((x == CHUNK_W - 1) << 1) | ((y == 0) << 2) |
+           ((y == CHUNK_SECTION_H - 1) << 3) | ((z == 0) << 4) |
+           ((z == CHUNK_D - 1) << 5);
+}
+
+SectionConnectivity SectionConnectivity::compute(const bool* occluders) {
+    SectionConnectivity connectivity;
+    std::array<bool, SECTION_VOLUME> visited {};
+    std::vector<int> stack;
+    for (int i = 0; i < SECTION_VOLUME; i++) {
+        int x = i % CHUNK_W;
+        int z = i / CHUNK_W % CHUNK_D;
+        int y = i / (CHUNK_W * CHUNK_D);
+        // pockets not touching the section faces do not connect anything
+        if (occluders[i] || visited[i] || boundary_faces(x, y, z) == 0) {
+            continue;
+        }
+        uint8_t faces = 0;
+        visited[i] = true;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+            x = index % CHUNK_W;
+            z = index / CHUNK_W % CHUNK_D;
+            y = index / (CHUNK_W * CHUNK_D);
+            faces |= boundary_faces(x, y, z);
+            for (const auto& offset : FACE_OFFSETS) {
+                int nx = x + offset[0];
+                int ny = y + offset[1];
+                int nz = z + offset[2];
+                if (nx < 0 || ny < 0 || nz < 0 || nx >= CHUNK_W ||
+                    ny >= CHUNK_SECTION_H || nz >= CHUNK_D) {
+                    continue;
+                }
+                int neighbour = vox_index(nx, ny, nz);
+                if (!occluders[neighbour] && !visited[neighbour]) {
+                    visited[neighbour] = true;
+                    stack.push_back(neighbour);
+                }
+            }
+        }
+        connectivity.connect(faces);
+        if (connectivity == open()) {
+            break;
+        }
+    }
+    return connectivity;
+}
+
+void CaveCulling::update(
+    const glm::vec3& cameraPosition,
+    int width,
+    int depth,
+    int offsetX,
+    int offsetZ,
+    const std::vector<const SectionsConnectivity*>& graphs,
+    const Frustum* frustum
+) {
+    size_t volume = width * depth;
+    int cx = floordiv<CHUNK_W>(floor_int(cameraPosition.x)) - offsetX;
+    int cz = floordiv<CHUNK_D>(floor_int(cameraPosition.z)) - offsetZ;
+    int cy = floor_int(cameraPosition.y);
+    if (cx < 0 || cz < 0 || cx >= width || cz >= depth || cy < 0 ||
+        cy >= CHUNK_H || graphs.size() != volume) {
+        visible.assign(volume, ALL_SECTIONS);
+        return;
+    }
+    visible.assign(volume, 0);
+    entered.assign(volume * CHUNK_SECTIONS, 0);
+    queue.clear();
+
+    int start = cz * width + cx;
+    int startSection = cy / CHUNK_SECTION_H;
+    visible[start] |= 1U << startSection;
+    entered[start * CHUNK_SECTIONS + startSection] = ALL_FACES;
+    queue.push_back({start, startSection, -1, 0});
+
+    // the queue grows while iterating
+    for (size_t i = 0; i < queue.size(); i++) {
+        Entry entry = queue[i];
+        const auto* graph = graphs[entry.index];
+        int x = entry.index % width;
+        int z = entry.index / width;
+        for (int face = 0; face < SectionConnectivity::FACES; face++) {
+            int opposite = face ^ 1;
+            if (entry.directions & (1 << opposite)) {
+                continue;
+            }
+            if (entry.from >= 0 && graph &&
+                !(*graph)[entry.section].isConnected(entry.from, face)) {
+                continue;
+            }
+            int nx = x + FACE_OFFSETS[face][0];
+            int section = entry.section + FACE_OFFSETS[face][1];
+            int nz = z + FACE_OFFSETS[face][2];
+            if (nx < 0 || nz < 0 || nx >= width || nz >= depth ||
+                section < 0 || section >= CHUNK_SECTIONS) {
+                continue;
+            }
+            int index = nz * width + nx;
+            uint8_t& faces = entered[index * CHUNK_SECTIONS + section];
+            if (faces & (1 << opposite)) {
+                continue;
+            }
+            if (frustum) {
+                glm::vec3 min(
+                    (nx + offsetX) * CHUNK_W,
+                    section * CHUNK_SECTION_H,
+                    (nz + offsetZ) * CHUNK_D
+                );
+                glm::vec3 max = min + glm::vec3(
+                    CHUNK_W, CHUNK_SECTION_H, CHUNK_D
+                );
+                if (!frustum->isBoxVisible(min, max)) {
+                    continue;
+                }
+            }
+            faces |= 1 << opposite;
+            visible[index] |= 1U << section;
+            queue.push_back({
+                index,
+                section,
+                opposite,
+                static_cast<uint8_t>(entry.directions | (1 << face))});
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <stdint.h>
+
+#include <glm/vec3.hpp>
+
+#include "constants.hpp"
+
+class Frustum;
+
+/// @brief Pairs of chunk section faces connected by a path through
+/// non-occluding blocks. Faces order is -x, +x, -y, +y, -z, +z
+class SectionConnectivity {
+    uint64_t bits = 0;
+public:
+    static inline constexpr int FACES = 6;
+    static inline constexpr int SECTION_VOLUME =
+        CHUNK_W * CHUNK_SECTION_H * CHUNK_D;
+
+    /// @brief Connect all pairs of faces in the mask
+    void connect(uint8_t faces);
+
+    bool isConnected(int from, int to) const {
+        return (bits >> (from * FACES + to)) & 1;
+    }
+
+    bool operator==(const SectionConnectivity& other) const {
+        return bits == other.bits;
+    }
+
+    /// @brief All faces are connected (empty or not meshed section)
+    static SectionConnectivity open();
+
+    /// @brief Flood fill of a section
+    /// @param occluders section voxels opacity indexed as chunk voxels
+    /// (vox_index) with section local y
+    static SectionConnectivity compute(const bool* occluders);
+};
+
+using SectionsConnectivity =
+    std::array<SectionConnectivity, CHUNK_SECTIONS>;
+
+/// @brief Finds chunk sections visible through non-occluding blocks from
+/// the camera section, going away from the camera only
+/// (cave culling)
+class CaveCulling {
+    struct Entry {
+        int index;
+        int section;
+        /// @brief Face the section is entered through
+        int from;
+        /// @brief Mask of traversed directions
+        uint8_t directions;
+    };
+    std::vector<Entry> queue;
+    /// @brief Faces each section has been entered through
+    std::vector<uint8_t> entered;
+    std::vector<uint32_t> visible;
+public:
+    /// @param graphs sections connectivity of chunks area by chunk index,
+    /// nullptr if the chunk is not meshed (all faces are connected)
+    /// @param frustum optional frustum to skip sections out of view
+    void update(
+        const glm::vec3& cameraPosition,
+        int width,
+        int depth,
+        int offsetX,
+        int offsetZ,
+        const std::vector<const SectionsConnectivity*>& graphs,
+        const Frustum* frustum
+    );
+
+    /// @return bit mask of visible sections of the chunk, all sections of
+    /// chunks out of the last update area
+    uint32_t getVisibleSections(size_t index) const {
+        return index < visible.size() ? visible[index] : ~0U;
+    }
+};
@@ -0,0 +1,315 @@
+#include "ChunksArena.hpp"
+
+#include <unordered_map>
+
+#include "ChunksDrawList.hpp"
+#include "debug/Logger.hpp"
+#include "graphics/core/Mesh.hpp"
+#include "graphics/core/gl_util.hpp"
+
+static debug::Logger logger("chunks-arena");
+
+static inline constexpr size_t INITIAL_VERTEX_CAPACITY = 1 << 18;
+static inline constexpr size_t INITIAL_INDEX_CAPACITY = 1 << 20;
+
+ChunksArena::Region::Region(Region&& other) noexcept
+    : arena(other.arena), id(other.id) {
+    other.arena = nullptr;
+}
+
+ChunksArena::Region::~Region() {
+    if (arena) {
+        arena->remove(id);
+    }
+}
+
+ChunksArena::Region& ChunksArena::Region::operator=(Region&& other) noexcept {
+    if (this != &other) {
+        if (arena) {
+            arena->remove(id);
+        }
+        arena = other.arena;
+        id = other.id;
+        other.arena = nullptr;
+    }
+    return *this;
+}
+
+static unsigned int create_buffer(size_t size) {
+    unsigned int buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return buffer;
+}
+
+ChunksArena::ChunksArena(const VertexAttribute* attrs, size_t vertexSize)
+    : attrs(attrs),
+      vertexSize(vertexSize),
+      vertexRanges(INITIAL_VERTEX_CAPACITY),
+      indexRanges(INITIAL_INDEX_CAPACITY),
+      multiDrawIndirect(GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance) {
+    glGenVertexArrays(1, &vao);
+    vbo = create_buffer(INITIAL_VERTEX_CAPACITY * vertexSize);
+    ibo = create_buffer(INITIAL_INDEX_CAPACITY * sizeof(uint32_t));
+    glGenBuffers(1, &offsetsBuffer);
+    glGenBuffers(1, &commandsBuffer);
+    setupVertexArray();
+    logger.info() << "created arena with "
+                  << (multiDrawIndirect ? "multi-draw-indirect"
+                                        : "multi-draw-base-vertex")
+                  << " submission";
+}
+
+ChunksArena::~ChunksArena() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+    glDeleteBuffers(1, &offsetsBuffer);
+    glDeleteBuffers(1, &commandsBuffer);
+}
+
+void ChunksArena::setupVertexArray() {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    size_t offset = 0;
+    for (int i = 0; attrs[i].count; i++) {
+        const VertexAttribute& attr = attrs[i];
+        glVertexAttribPointer(
+            i,
+            attr.count,
+            gl::to_glenum(attr.type),
+            attr.normalized,
+            vertexSize,
+            (GLvoid*)offset
+        );
+        glEnableVertexAttribArray(i);
+        offset += attr.size();
+    }
+    if (multiDrawIndirect) {
+        // offset of a command is fetched at its base instance
+        glBindBuffer(GL_ARRAY_BUFFER, offsetsBuffer);
+        glVertexAttribPointer(
+            OFFSET_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr
+        );
+        glVertexAttribDivisor(OFFSET_ATTRIBUTE, 1);
+        glEnableVertexAttribArray(OFFSET_ATTRIBUTE);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ChunksArena::relocate(
+    util::RangeAllocator& ranges, bool vertices, size_t capacity
+) {
+    size_t elementSize = vertices ? vertexSize : sizeof(uint32_t);
+    unsigned int& buffer = vertices ? vbo : ibo;
+
+    auto moves = ranges.defragment();
+    ranges.grow(capacity);
+    unsigned int newBuffer = create_buffer(ranges.getCapacity() * elementSize);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    std::unordered_map<size_t, size_t> places;
+    for (size_t i = 0; i < moves.size();) {
+        const auto& move = moves[i];
+        size_t size = move.size;
+        places[move.from] = move.to;
+        // copy adjacent ranges at once
+        size_t next = i + 1;
+        for (; next < moves.size() && moves[next].from == move.from + size;
+             next++) {
+            places[moves[next].from] = moves[next].to;
+            size += moves[next].size;
+        }
+        glCopyBufferSubData(
+            GL_COPY_READ_BUFFER,
+            GL_COPY_WRITE_BUFFER,
+            move.from * elementSize,
+            move.to * elementSize,
+            size * elementSize
+        );
+        i = next;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer = newBuffer;
+
+    for (auto& section : sections) {
+        if (vertices) {
+            if (section.vertexCount) {
+                section.vertexOffset = places.at(section.vertexOffset);
+            }
+            continue;
+        }
+        for (int i = 0; i < INDEX_STREAMS; i++) {
+            if (section.indexCounts[i]) {
+                section.indexOffsets[i] = places.at(section.indexOffsets[i]);
+            }
+        }
+    }
+    setupVertexArray();
+}
+
+size_t ChunksArena::allocate(
+    util::RangeAllocator& ranges, size_t size, bool vertices
+) {
+    size_t offset = ranges.allocate(size);
+    if (offset != util::RangeAllocator::INVALID) {
+        return offset;
+    }
+    size_t capacity = ranges.getCapacity();
+    // defragmentation only if it leaves enough free space
+    if (ranges.getFreeSpace() < size + capacity / 4) {
+        capacity = std::max(capacity * 2, capacity + size);
+        logger.info() << "growing " << (vertices ? "vertex" : "index")
+                      << " buffer to " << capacity << " elements";
+    }
+    relocate(ranges, vertices, capacity);
+    return ranges.allocate(size);
+}
+
+ChunksArena::Region ChunksArena::add(
+    const void* vertices,
+    size_t vertexCount,
+    const std::vector<util::Buffer<uint32_t>>& indices
+) {
+    if (vertexCount == 0) {
+        return Region();
+    }
+    uint32_t id;
+    if (freeIds.empty()) {
+        id = sections.size();
+        sections.emplace_back();
+    } else {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    // registered before allocation to be updated by relocations
+    size_t offset = allocate(vertexRanges, vertexCount, true);
+    sections[id].vertexOffset = offset;
+    sections[id].vertexCount = vertexCount;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER,
+        offset * vertexSize,
+        vertexCount * vertexSize,
+        vertices
+    );
+    for (size_t i = 0; i < indices.size() && i < INDEX_STREAMS; i++) {
+        const auto& stream = indices[i];
+        if (stream.size() == 0) {
+            continue;
+        }
+        offset = allocate(indexRanges, stream.size(), false);
+        sections[id].indexOffsets[i] = offset;
+        sections[id].indexCounts[i] = stream.size();
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ibo);
+        glBufferSubData(
+            GL_COPY_WRITE_BUFFER,
+            offset * sizeof(uint32_t),
+            stream.size() * sizeof(uint32_t),
+            stream.data()
+        );
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return Region(this, id);
+}
+
+void ChunksArena::remove(uint32_t id) {
+    auto& section = sections.at(id);
+    if (section.vertexCount) {
+        vertexRanges.free(section.vertexOffset);
+    }
+    for (int i = 0; i < INDEX_STREAMS; i++) {
+        if (section.indexCounts[i]) {
+            indexRanges.free(section.indexOffsets[i]);
+        }
+    }
+    section = {};
+    freeIds.push_back(id);
+}
+
+void ChunksArena::addCommand(
+    ChunksDrawList& list,
+    const Region& region,
+    int stream,
+    const glm::vec3& offset
+) const {
+    const auto& section = sections.at(region.getId());
+    list.add(
+        offset,
+        section.indexCounts[stream],
+        section.indexOffsets[stream],
+        section.vertexOffset
+    );
+}
+
+void ChunksArena::draw(const ChunksDrawList& list) {
+    if (list.empty()) {
+        return;
+    }
+    glBindVertexArray(vao);
+    if (multiDrawIndirect) {
+        const auto& commands = list.getCommands();
+        const auto& offsets = list.getOffsets();
+        glBindBuffer(GL_ARRAY_BUFFER, offsetsBuffer);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            offsets.size() * sizeof(glm::vec3),
+            offsets.data(),
+            GL_STREAM_DRAW
+        );
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandsBuffer);
+        glBufferData(
+            GL_DRAW_INDIRECT_BUFFER,
+            commands.size() * sizeof(DrawElementsIndirectCommand),
+            commands.data(),
+            GL_STREAM_DRAW
+        );
+        glMultiDrawElementsIndirect(
+            GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, commands.size(), 0
+        );
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        MeshStats::drawCalls++;
+    } else {
+        const auto& commands = list.getCommands();
+        for (const auto& batch : list.getBatches()) {
+            counts.clear();
+            indexPointers.clear();
+            baseVertices.clear();
+            for (size_t i = batch.first; i < batch.first + batch.count; i++) {
+                const auto& command = commands[i];
+                counts.push_back(command.count);
+                indexPointers.push_back(reinterpret_cast<const void*>(
+                    command.firstIndex * sizeof(uint32_t)
+                ));
+                baseVertices.push_back(command.baseVertex);
+            }
+            // constant attribute value while the array is disabled
+            const auto& offset = batch.offset;
+            glVertexAttrib3f(OFFSET_ATTRIBUTE, offset.x, offset.y, offset.z);
+            glMultiDrawElementsBaseVertex(
+                GL_TRIANGLES,
+                counts.data(),
+                GL_UNSIGNED_INT,
+                indexPointers.data(),
+                counts.size(),
+                baseVertices.data()
+            );
+            MeshStats::drawCalls++;
+        }
+        glVertexAttrib3f(OFFSET_ATTRIBUTE, 0.0f, 0.0f, 0.0f);
+    }
+    glBindVertexArray(0);
+}
+
+size_t ChunksArena::getMemoryConsumption() const {
+    return vertexRanges.getCapacity() * vertexSize +
+           indexRanges.getCapacity() * sizeof(uint32_t);
+}
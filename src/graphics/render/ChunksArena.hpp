@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+#include <glm/vec3.hpp>
+
+#include "graphics/core/MeshData.hpp"
+#include "util/RangeAllocator.hpp"
+
+class ChunksDrawList;
+
+/// @brief Chunk sections geometry stored in a single vertex buffer and a
+/// single index buffer, drawn by one multi-draw call per pass.
+/// Regions are moved on defragmentation or growth, so they are referenced
+/// by ids
+class ChunksArena {
+public:
+    /// @brief Vertex attribute location of the chunk offset
+    static inline constexpr int OFFSET_ATTRIBUTE = 4;
+    static inline constexpr int INDEX_STREAMS = 2;
+
+    /// @brief Owning reference to an arena region, frees it on destruction
+    class Region {
+        ChunksArena* arena = nullptr;
+        uint32_t id = 0;
+    public:
+        Region() = default;
+        Region(ChunksArena* arena, uint32_t id) : arena(arena), id(id) {}
+        Region(Region&& other) noexcept;
+        Region(const Region&) = delete;
+        ~Region();
+
+        Region& operator=(Region&& other) noexcept;
+        Region& operator=(const Region&) = delete;
+
+        explicit operator bool() const {
+            return arena != nullptr;
+        }
+
+        ChunksArena* getArena() const {
+            return arena;
+        }
+
+        uint32_t getId() const {
+            return id;
+        }
+    };
+private:
+    struct Section {
+        size_t vertexOffset = 0;
+        size_t vertexCount = 0;
+        std::array<size_t, INDEX_STREAMS> indexOffsets {};
+        std::array<size_t, INDEX_STREAMS> indexCounts {};
+    };
+    const VertexAttribute* attrs;
+    size_t vertexSize;
+    util::RangeAllocator vertexRanges;
+    util::RangeAllocator indexRanges;
+    std::vector<Section> sections;
+    std::vector<uint32_t> freeIds;
+    bool multiDrawIndirect;
+
+    unsigned int vao = 0;
+    unsigned int vbo = 0;
+    unsigned int ibo = 0;
+    unsigned int offsetsBuffer = 0;
+    unsigned int commandsBuffer = 0;
+    /// @brief Fallback path multi-draw arguments
+    std::vector<int> counts;
+    std::vector<const void*> indexPointers;
+    std::vector<int> baseVertices;
+
+    size_t allocate(util::RangeAllocator& ranges, size_t size, bool vertices);
+    /// @brief Move buffer data to a new buffer of the given capacity,
+    /// packing regions
+    void relocate(util::RangeAllocator& ranges, bool vertices, size_t capacity);
+    void setupVertexArray();
+public:
+    /// @param attrs null-terminated vertex attributes
+    /// @param vertexSize vertex structure size
+    ChunksArena(const VertexAttribute* attrs, size_t vertexSize);
+    ~ChunksArena();
+
+    template <typename VertexStructure>
+    static std::unique_ptr<ChunksArena> create() {
+        return std::make_unique<ChunksArena>(
+            VertexStructure::ATTRIBUTES, sizeof(VertexStructure)
+        );
+    }
+
+    template <typename VertexStructure>
+    bool isFormatOf() const {
+        return attrs == VertexStructure::ATTRIBUTES;
+    }
+
+    /// @brief Upload section geometry to the arena
+    /// @return empty region if there are no vertices
+    template <typename VertexStructure>
+    Region add(const MeshData<VertexStructure>& mesh) {
+        return add(
+            mesh.vertices.data(), mesh.vertices.size(), mesh.indices
+        );
+    }
+
+    /// @param indices index streams (normal and dense)
+    Region add(
+        const void* vertices,
+        size_t vertexCount,
+        const std::vector<util::Buffer<uint32_t>>& indices
+    );
+
+    void remove(uint32_t id);
+
+    /// @brief Add region draw command
+    /// @param stream index stream (dense if 1)
+    /// @param offset chunk mesh origin in the world
+    void addCommand(
+        ChunksDrawList& list,
+        const Region& region,
+        int stream,
+        const glm::vec3& offset
+    ) const;
+
+    /// @brief Submit the draw list
+    void draw(const ChunksDrawList& list);
+
+    size_t getMemoryConsumption() const;
+};
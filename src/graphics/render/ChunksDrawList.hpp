@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+#include <glm/vec3.hpp>
+
+/// @brief Layout of a glMultiDrawElementsIndirect command
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+/// @brief Chunk sections draw commands gathered for a single multi-draw
+/// call. Chunk offset of a command is stored in the offsets buffer at
+/// index of the command, passed as the command base instance
+class ChunksDrawList {
+public:
+    /// @brief Consecutive commands sharing chunk offset
+    struct Batch {
+        glm::vec3 offset;
+        size_t first;
+        size_t count;
+    };
+private:
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<glm::vec3> offsets;
+    std::vector<Batch> batches;
+public:
+    void clear() {
+        commands.clear();
+        offsets.clear();
+        batches.clear();
+    }
+
+    /// @param offset chunk mesh origin in the world
+    /// @param count number of indices, empty commands are skipped
+    /// @param firstIndex offset of the indices in the index buffer
+    /// @param baseVertex offset of the vertices in the vertex buffer
+    void add(
+        const glm::vec3& offset,
+        uint32_t count,
+        uint32_t firstIndex,
+        int32_t baseVertex
+    ) {
+        if (count == 0) {
+            return;
+        }
+        uint32_t index = commands.size();
+        commands.push_back(
+            DrawElementsIndirectCommand {count, 1, firstIndex, baseVertex, index}
+        );
+        offsets.push_back(offset);
+        if (batches.empty() || batches.back().offset != offset) {
+            batches.push_back(Batch {offset, index, 0});
+        }
+        batches.back().count++;
+    }
+
+    bool empty() const {
+        return commands.empty();
+    }
+
+    const std::vector<DrawElementsIndirectCommand>& getCommands() const {
+        return commands;
+    }
+
+    const std::vector<glm::vec3>& getOffsets() const {
+        return offsets;
+    }
+
+    const std::vector<Batch>& getBatches() const {
+        return batches;
+    }
+};
@@ -19,6 +19,12 @@ static debug::Logger logger("chunks-render");
 
 size_t ChunksRenderer::visibleChunks = 0;
 
+static size_t get_renderer_capacity(const EngineSettings& settings) {
+    return settings.graphics.denseRender.get()
+               ? settings.graphics.chunkMaxVerticesDense.get()
+               : settings.graphics.chunkMaxVertices.get();
+}
+
 class RendererWorker : public util::Worker<RendererJob, RendererResult> {
     BlocksRenderer renderer;
 public:
@@ -28,9 +34,7 @@ public:
         const EngineSettings& settings
     )
         : renderer(
-              settings.graphics.denseRender.get()
-                  ? settings.graphics.chunkMaxVerticesDense.get()
-                  : settings.graphics.chunkMaxVertices.get(),
+              get_renderer_capacity(settings),
               level.content,
               cache,
               settings
@@ -40,20 +44,48 @@ public:
     RendererResult operator()(const RendererJob& job) override {
         auto chunk = job.chunk;
         auto volume = job.volume;
-        renderer.build(chunk.get(), *volume);
+        glm::ivec2 key(chunk->x, chunk->z);
+        renderer.build(chunk.get(), *volume, job.sections);
         if (renderer.isCancelled()) {
             return RendererResult {
-                glm::ivec2(chunk->x, chunk->z), true, ChunkMeshData {}};
+                key, true, ChunkMeshData {}, job.sections, job.generation};
         }
         auto meshData = renderer.createMesh();
         return RendererResult {
-            glm::ivec2(chunk->x, chunk->z), false, std::move(meshData)};
+            key, false, std::move(meshData), job.sections, job.generation};
     }
 };
 
 static util::ObjectsPool<VoxelsVolume> voxelsVolumesPool {};
 static inline const int VOXELS_BUFFER_PADDING = 2;
 
+/// @param position chunk mesh origin in the world
+/// @param frustum frustum to cull sections or nullptr
+/// @param visibleSections mask of sections not hidden by cave culling
+static void add_chunk_commands(
+    ChunksDrawList& list,
+    const ChunkMesh& mesh,
+    bool dense,
+    const glm::vec3& position,
+    const Frustum* frustum,
+    uint32_t visibleSections = Chunk::ALL_SECTIONS
+) {
+    for (int i = 0; i < CHUNK_SECTIONS; i++) {
+        const auto& section = mesh.sections[i];
+        if (!section.region || ((visibleSections >> i) & 1) == 0) {
+            continue;
+        }
+        if (frustum && !frustum->isBoxVisible(
+                           position + section.min, position + section.max
+                       )) {
+            continue;
+        }
+        section.region.getArena()->addCommand(
+            list, section.region, dense, position
+        );
+    }
+}
+
 ChunksRenderer::ChunksRenderer(
     const Level* level,
     const Chunks& chunks,
@@ -74,25 +106,32 @@ ChunksRenderer::ChunksRenderer(
               );
           },
           [&](RendererResult& result) {
-              if (!result.cancelled) {
-                  auto meshData = std::move(result.meshData);
-                  meshes[result.key] = ChunkMesh {
-                      std::make_unique<Mesh<ChunkVertex>>(meshData.mesh),
-                      std::move(meshData.sortingMesh)};
+              if (result.generation != generation) {
+                  // meshes were cleared after the job was enqueued
+                  return;
               }
               inwork.erase(result.key);
+              if (result.cancelled) {
+                  return;
+              }
+              auto found = meshes.find(result.key);
+              if (found == meshes.end()) {
+                  // the chunk was unloaded while in work
+                  if (result.sections != Chunk::ALL_SECTIONS) {
+                      return;
+                  }
+                  found = meshes.emplace(result.key, ChunkMesh {}).first;
+              }
+              updateMesh(found->second, std::move(result.meshData));
           },
           settings.graphics.chunkMaxRenderers.get()
       ) {
     threadPool.setStopOnFail(false);
-    renderer = std::make_unique<BlocksRenderer>(
-        settings.graphics.chunkMaxVertices.get(), 
-        level->content, cache, settings
-    );
     logger.info() << "created " << threadPool.getWorkersCount() << " workers";
     logger.info() << "memory consumption is "
-                  << renderer->getMemoryConsumption() *
-                             threadPool.getWorkersCount() +
+                  << BlocksRenderer::getMemoryConsumption(
+                         get_renderer_capacity(settings)
+                     ) * threadPool.getWorkersCount() +
                          voxelsVolumesPool.countTotal() *
                              (sizeof(VoxelsVolume) +
                               (CHUNK_W + VOXELS_BUFFER_PADDING * 2) * CHUNK_H *
@@ -121,30 +160,53 @@ std::shared_ptr<VoxelsVolume> ChunksRenderer::prepareVoxelsVolume(
     return voxelsBuffer;
 }
 
-const Mesh<ChunkVertex>* ChunksRenderer::render(
-    const std::shared_ptr<Chunk>& chunk, bool important
+void ChunksRenderer::render(
+    const std::shared_ptr<Chunk>& chunk, uint32_t sections, bool important
 ) {
     glm::ivec2 key(chunk->x, chunk->z);
-    chunk->flags.modified = false;
-    if (important) {
-        auto voxelsBuffer = prepareVoxelsVolume(*chunk);
-
-        auto mesh = renderer->render(chunk.get(), *voxelsBuffer);
-        meshes[key] =
-            ChunkMesh {std::move(mesh.mesh), std::move(mesh.sortingMeshData)};
-        return meshes[key].mesh.get();
-    }
     if (inwork.find(key) != inwork.end()) {
-        return nullptr;
+        // stays modified to be remeshed when the running job is done
+        return;
     }
+    chunk->flags.modified = false;
+    chunk->modifiedSections = 0;
     auto voxelsBuffer = prepareVoxelsVolume(*chunk);
     inwork[key] = true;
-    chunks.getVoxels(
-        *voxelsBuffer, settings.graphics.backlight.get(), chunk->top + 1
+
+    threadPool.enqueueJob(
+        {chunk, std::move(voxelsBuffer), sections, generation}, important
     );
+}
 
-    threadPool.enqueueJob({chunk, std::move(voxelsBuffer)});
-    return nullptr;
+template <typename VertexStructure>
+ChunksArena::Region ChunksRenderer::upload(
+    const MeshData<VertexStructure>& mesh
+) {
+    if (arena == nullptr) {
+        arena = ChunksArena::create<VertexStructure>();
+    } else if (!arena->isFormatOf<VertexStructure>()) {
+        // vertex format is changed with meshes clear
+        return {};
+    }
+    return arena->add(mesh);
+}
+
+/// @brief Replace rebuilt sections meshes and the translucent mesh
+void ChunksRenderer::updateMesh(ChunkMesh& mesh, ChunkMeshData&& meshData) {
+    for (const auto& section : meshData.sections) {
+        auto& target = mesh.sections[section.index];
+        target.region = {};
+        target.min = section.min;
+        target.max = section.max;
+        mesh.connectivity[section.index] = section.connectivity;
+        if (section.compactMesh.vertices.size() != 0) {
+            target.region = upload(section.compactMesh);
+        } else if (section.mesh.vertices.size() != 0) {
+            target.region = upload(section.mesh);
+        }
+    }
+    mesh.sortingMeshData = std::move(meshData.sortingMesh);
+    mesh.sortedMesh = nullptr;
 }
 
 void ChunksRenderer::unload(const Chunk* chunk) {
@@ -156,28 +218,34 @@ void ChunksRenderer::unload(const Chunk* chunk) {
 
 void ChunksRenderer::clear() {
     meshes.clear();
+    // the next meshes may have another vertex format
+    arena = nullptr;
     inwork.clear();
     threadPool.clearQueue();
+    generation++;
 }
 
-const Mesh<ChunkVertex>* ChunksRenderer::getOrRender(
+const ChunkMesh* ChunksRenderer::getOrRender(
     const std::shared_ptr<Chunk>& chunk, bool important
 ) {
     auto found = meshes.find(glm::ivec2(chunk->x, chunk->z));
     if (found == meshes.end()) {
-        return render(chunk, important);
+        render(chunk, Chunk::ALL_SECTIONS, important);
+        return nullptr;
     }
     if (chunk->flags.modified && chunk->flags.lighted) {
-        render(chunk, important);
+        // the old mesh is drawn until the new sections arrive
+        auto sections = chunk->modifiedSections;
+        render(chunk, sections ? sections : Chunk::ALL_SECTIONS, important);
     }
-    return found->second.mesh.get();
+    return &found->second;
 }
 
 void ChunksRenderer::update() {
     threadPool.update();
 }
 
-const Mesh<ChunkVertex>* ChunksRenderer::retrieveChunk(
+const ChunkMesh* ChunksRenderer::retrieveChunk(
     size_t index, const Camera& camera, bool culling
 ) {
     auto chunk = chunks.getChunks()[index];
@@ -189,7 +257,7 @@ const Mesh<ChunkVertex>* ChunksRenderer::retrieveChunk(
         if (found == meshes.end()) {
             return nullptr;
         } else {
-            return found->second.mesh.get();
+            return &found->second;
         }
     }
     float distance = glm::distance(
@@ -233,6 +301,8 @@ void ChunksRenderer::drawShadowsPass(
     auto denseDistance = settings.graphics.denseRenderDistance.get();
     auto denseDistance2 = denseDistance * denseDistance;
 
+    shader.uniformMatrix("u_model", glm::mat4(1.0f));
+    drawList.clear();
     for (const auto& chunk : chunks.getChunks()) {
         if (chunk == nullptr) {
             continue;
@@ -257,14 +327,41 @@ void ChunksRenderer::drawShadowsPass(
         if (!frustum.isBoxVisible(min, max)) {
             continue;
         }
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), coord);
-        shader.uniformMatrix("u_model", model);
-        found->second.mesh->draw(GL_TRIANGLES, 
+        add_chunk_commands(drawList, found->second, 
             glm::distance2(playerCamera.position * glm::vec3(1, 0, 1), 
-                           (min + max) * 0.5f * glm::vec3(1, 0, 1)) < denseDistance2);
+                           (min + max) * 0.5f * glm::vec3(1, 0, 1)) < denseDistance2,
+            coord, &frustum);
+    }
+    if (arena) {
+        arena->draw(drawList);
     }
 }
 
+void ChunksRenderer::updateCaveCulling(const Camera& camera, bool culling) {
+    const auto& chunksList = chunks.getChunks();
+    connectivity.resize(chunksList.size());
+    for (size_t i = 0; i < chunksList.size(); i++) {
+        const auto& chunk = chunksList[i];
+        connectivity[i] = nullptr;
+        if (chunk == nullptr) {
+            continue;
+        }
+        const auto& found = meshes.find({chunk->x, chunk->z});
+        if (found != meshes.end()) {
+            connectivity[i] = &found->second.connectivity;
+        }
+    }
+    caveCulling.update(
+        camera.position,
+        chunks.getWidth(),
+        chunks.getHeight(),
+        chunks.getOffsetX(),
+        chunks.getOffsetY(),
+        connectivity,
+        culling ? &frustum : nullptr
+    );
+}
+
 void ChunksRenderer::drawChunks(
     const Camera& camera, Shader& shader
 ) {
@@ -294,6 +391,10 @@ void ChunksRenderer::drawChunks(
     util::insertion_sort(indices.begin(), indices.end());
 
     bool culling = settings.graphics.frustumCulling.get();
+    bool caveCullingEnabled = settings.graphics.caveCulling.get();
+    if (caveCullingEnabled) {
+        updateCaveCulling(camera, culling);
+    }
 
     visibleChunks = 0;
     shader.uniform1i("u_alphaClip", true);
@@ -301,7 +402,9 @@ void ChunksRenderer::drawChunks(
     auto denseDistance = settings.graphics.denseRenderDistance.get();
     auto denseDistance2 = denseDistance * denseDistance;
 
-    // TODO: minimize draw calls number
+    // sections of all chunks are drawn by a single multi-draw call
+    shader.uniformMatrix("u_model", glm::mat4(1.0f));
+    drawList.clear();
     for (int i = indices.size()-1; i >= 0; i--) {
         auto& chunk = chunks.getChunks()[indices[i].index];
         auto mesh = retrieveChunk(indices[i].index, camera, culling);
@@ -310,13 +413,19 @@ void ChunksRenderer::drawChunks(
             glm::vec3 coord(
                 chunk->x * CHUNK_W + 0.5f, 0.5f, chunk->z * CHUNK_D + 0.5f
             );
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), coord);
-            shader.uniformMatrix("u_model", model);
-            mesh->draw(GL_TRIANGLES, glm::distance2(camera.position * glm::vec3(1, 0, 1), 
-                (coord + glm::vec3(CHUNK_W * 0.5f, 0.0f, CHUNK_D * 0.5f))) < denseDistance2);
+            add_chunk_commands(drawList, *mesh, glm::distance2(camera.position * glm::vec3(1, 0, 1), 
+                (coord + glm::vec3(CHUNK_W * 0.5f, 0.0f, CHUNK_D * 0.5f))) < denseDistance2,
+                coord,
+                culling ? &frustum : nullptr,
+                caveCullingEnabled
+                    ? caveCulling.getVisibleSections(indices[i].index)
+                    : Chunk::ALL_SECTIONS);
             visibleChunks++;
         }
     }
+    if (arena) {
+        arena->draw(drawList);
+    }
 }
 
 static inline void write_sorting_mesh_entries(
@@ -339,6 +448,7 @@ void ChunksRenderer::drawSortedMeshes(const Camera& camera, Shader& shader) {
     frameid++;
 
     bool culling = settings.graphics.frustumCulling.get();
+    bool caveCullingEnabled = settings.graphics.caveCulling.get();
     const auto& chunks = this->chunks.getChunks();
     const auto& cameraPos = camera.position;
     const auto& atlas = assets.require<Atlas>("blocks");
@@ -353,6 +463,10 @@ void ChunksRenderer::drawSortedMeshes(const Camera& camera, Shader& shader) {
         if (chunk == nullptr || !chunk->flags.lighted) {
             continue;
         }
+        if (caveCullingEnabled &&
+            caveCulling.getVisibleSections(index.index) == 0) {
+            continue;
+        }
         const auto& found = meshes.find(glm::ivec2(chunk->x, chunk->z));
         if (found == meshes.end() || found->second.sortingMeshData.entries.empty()) {
             continue;
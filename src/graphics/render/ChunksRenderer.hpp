@@ -10,6 +10,8 @@
 
 #include "util/ThreadPool.hpp"
 #include "commons.hpp"
+#include "CaveCulling.hpp"
+#include "ChunksDrawList.hpp"
 
 template<typename VertexStructure> class Mesh;
 class Chunk;
@@ -37,11 +39,17 @@ struct RendererResult {
     glm::ivec2 key;
     bool cancelled;
     ChunkMeshData meshData;
+    uint32_t sections;
+    uint generation;
 };
 
 struct RendererJob {
     std::shared_ptr<Chunk> chunk;
     std::shared_ptr<VoxelsVolume> volume;
+    /// @brief Bit mask of sections to mesh
+    uint32_t sections;
+    /// @brief Meshes generation, incremented on clear
+    uint generation;
 };
 
 class ChunksRenderer {
@@ -50,15 +58,24 @@ class ChunksRenderer {
     const Frustum& frustum;
     const EngineSettings& settings;
 
-    std::unique_ptr<BlocksRenderer> renderer;
+    /// @brief Geometry of all chunk meshes, outlives the meshes
+    std::unique_ptr<ChunksArena> arena;
     std::unordered_map<glm::ivec2, ChunkMesh> meshes;
     std::unordered_map<glm::ivec2, bool> inwork;
     std::vector<ChunksSortEntry> indices;
     util::ThreadPool<RendererJob, RendererResult> threadPool;
-    const Mesh<ChunkVertex>* retrieveChunk(
+    uint generation = 0;
+    CaveCulling caveCulling;
+    std::vector<const SectionsConnectivity*> connectivity;
+    ChunksDrawList drawList;
+    const ChunkMesh* retrieveChunk(
         size_t index, const Camera& camera, bool culling
     );
     std::shared_ptr<VoxelsVolume> prepareVoxelsVolume(const Chunk& chunk);
+    void updateCaveCulling(const Camera& camera, bool culling);
+    void updateMesh(ChunkMesh& mesh, ChunkMeshData&& meshData);
+    template <typename VertexStructure>
+    ChunksArena::Region upload(const MeshData<VertexStructure>& mesh);
 public:
     ChunksRenderer(
         const Level* level,
@@ -70,13 +87,15 @@ public:
     );
     virtual ~ChunksRenderer();
 
-    const Mesh<ChunkVertex>* render(
-        const std::shared_ptr<Chunk>& chunk, bool important
+    /// @brief Enqueue chunk sections meshing
+    /// @param important use the high priority lane
+    void render(
+        const std::shared_ptr<Chunk>& chunk, uint32_t sections, bool important
     );
     void unload(const Chunk* chunk);
     void clear();
 
-    const Mesh<ChunkVertex>* getOrRender(
+    const ChunkMesh* getOrRender(
         const std::shared_ptr<Chunk>& chunk, bool important
     );
 
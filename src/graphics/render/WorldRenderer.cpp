@@ -299,6 +299,7 @@ void WorldRenderer::renderFrame(
     auto& entityShader = assets.require<Shader>("entity");
     auto& translucentShader = assets.require<Shader>("translucent");
     auto& deferredShader = assets.require<PostEffect>("deferred_lighting").getShader();
+    auto& shadowsShader = assets.require<Shader>("shadows");
     const auto& settings = engine.getSettings();
 
     Shader* affectedShaders[] {
@@ -312,20 +313,39 @@ void WorldRenderer::renderFrame(
     CompileTimeShaderSettings currentSettings {
         gbufferPipeline,
         shadowsQuality != 0,
-        settings.graphics.ssao.get() && gbufferPipeline
+        settings.graphics.ssao.get() && gbufferPipeline,
+        settings.graphics.compactVertices.get()
     };
     if (
         prevCTShaderSettings.advancedRender != currentSettings.advancedRender ||
         prevCTShaderSettings.shadows != currentSettings.shadows ||
-        prevCTShaderSettings.ssao != currentSettings.ssao
+        prevCTShaderSettings.ssao != currentSettings.ssao ||
+        prevCTShaderSettings.compactVertices != currentSettings.compactVertices
     ) {
         std::vector<std::string> defines;
         if (currentSettings.shadows) defines.emplace_back("ENABLE_SHADOWS");
         if (currentSettings.ssao) defines.emplace_back("ENABLE_SSAO");
         if (currentSettings.advancedRender) defines.emplace_back("ADVANCED_RENDER");
 
+        // opaque chunk meshes may use the compact vertex format
+        std::vector<std::string> chunkDefines;
+        if (currentSettings.compactVertices) {
+            chunkDefines.emplace_back("COMPACT_VERTICES");
+        }
         for (auto shader : affectedShaders) {
-            shader->recompile(defines);
+            if (shader == &mainShader) {
+                auto mainDefines = defines;
+                mainDefines.insert(
+                    mainDefines.end(), chunkDefines.begin(), chunkDefines.end()
+                );
+                shader->recompile(mainDefines);
+            } else {
+                shader->recompile(defines);
+            }
+        }
+        if (prevCTShaderSettings.compactVertices !=
+            currentSettings.compactVertices) {
+            shadowsShader.recompile(chunkDefines);
         }
         prevCTShaderSettings = currentSettings;
     }
@@ -41,6 +41,7 @@ struct CompileTimeShaderSettings {
     bool advancedRender = false;
     bool shadows = false;
     bool ssao = false;
+    bool compactVertices = false;
 };
 
 class WorldRenderer {
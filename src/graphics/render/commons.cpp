@@ -0,0 +1,77 @@
+#include "commons.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "graphics/core/Mesh.hpp"
+
+/// @brief Octahedral normal coordinates steps. Even number keeps axes exact
+static inline constexpr int NORMAL_STEPS = 62;
+static inline constexpr int EMISSION_STEPS = 15;
+static inline constexpr float USHORT_MAX = 65535.0f;
+
+static uint16_t quantize(float value) {
+    return static_cast<uint16_t>(
+        std::clamp(std::round(value), 0.0f, USHORT_MAX)
+    );
+}
+
+static float sign_not_zero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+CompactChunkVertex CompactChunkVertex::pack(const ChunkVertex& vertex) {
+    CompactChunkVertex packed {};
+    for (int i = 0; i < 3; i++) {
+        packed.position[i] =
+            quantize((vertex.position[i] - POSITION_MIN) * POSITION_SCALE);
+    }
+    float x = (vertex.normal[0] - 128) / 127.0f;
+    float y = (vertex.normal[1] - 128) / 127.0f;
+    float z = (vertex.normal[2] - 128) / 127.0f;
+    float sum = std::abs(x) + std::abs(y) + std::abs(z);
+    if (sum > 0.0f) {
+        x /= sum;
+        y /= sum;
+    }
+    if (z < 0.0f) {
+        float fx = (1.0f - std::abs(y)) * sign_not_zero(x);
+        float fy = (1.0f - std::abs(x)) * sign_not_zero(y);
+        x = fx;
+        y = fy;
+    }
+    int nx = std::lround((x * 0.5f + 0.5f) * NORMAL_STEPS);
+    int ny = std::lround((y * 0.5f + 0.5f) * NORMAL_STEPS);
+    int emission = std::lround(vertex.normal[3] / 255.0f * EMISSION_STEPS);
+    packed.position[3] = nx | (ny << 6) | (emission << 12);
+
+    packed.uv[0] = quantize(vertex.uv.x * USHORT_MAX);
+    packed.uv[1] = quantize(vertex.uv.y * USHORT_MAX);
+    packed.color = vertex.color;
+    return packed;
+}
+
+ChunkVertex CompactChunkVertex::unpack() const {
+    ChunkVertex vertex {};
+    for (int i = 0; i < 3; i++) {
+        vertex.position[i] = position[i] / POSITION_SCALE + POSITION_MIN;
+    }
+    float x = (position[3] & 0x3F) * 2.0f / NORMAL_STEPS - 1.0f;
+    float y = ((position[3] >> 6) & 0x3F) * 2.0f / NORMAL_STEPS - 1.0f;
+    float z = 1.0f - std::abs(x) - std::abs(y);
+    float t = std::max(-z, 0.0f);
+    x -= t * sign_not_zero(x);
+    y -= t * sign_not_zero(y);
+    float length = std::sqrt(x * x + y * y + z * z);
+    vertex.normal = {
+        static_cast<uint8_t>(std::lround(x / length * 127 + 128)),
+        static_cast<uint8_t>(std::lround(y / length * 127 + 128)),
+        static_cast<uint8_t>(std::lround(z / length * 127 + 128)),
+        static_cast<uint8_t>(
+            std::lround((position[3] >> 12) * 255.0f / EMISSION_STEPS)
+        )};
+
+    vertex.uv = {uv[0] / USHORT_MAX, uv[1] / USHORT_MAX};
+    vertex.color = color;
+    return vertex;
+}
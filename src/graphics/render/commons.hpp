@@ -6,6 +6,9 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include "constants.hpp"
+#include "CaveCulling.hpp"
+#include "ChunksArena.hpp"
 #include "graphics/core/MeshData.hpp"
 #include "util/Buffer.hpp"
 
@@ -24,6 +27,33 @@ struct ChunkVertex {
         {{}, 0}};
 };
 
+/// @brief Compact chunk mesh vertex format decoded in the chunk shaders
+/// (see res/shaders/lib/chunk_vertex.glsl)
+struct CompactChunkVertex {
+    /// @brief Fixed point chunk-local position (xyz) and normal with
+    /// emission packed into w: 6 + 6 bits octahedral normal, 4 bits emission
+    std::array<uint16_t, 4> position;
+    std::array<uint16_t, 2> uv;
+    std::array<uint8_t, 4> color;
+
+    /// @brief Position units per block
+    static constexpr float POSITION_SCALE = 128.0f;
+    /// @brief Lowest position that may be stored
+    static constexpr float POSITION_MIN = -128.0f;
+
+    static constexpr VertexAttribute ATTRIBUTES[] = {
+        {VertexAttribute::Type::UNSIGNED_SHORT, true, 4},
+        {VertexAttribute::Type::UNSIGNED_SHORT, true, 2},
+        {VertexAttribute::Type::UNSIGNED_BYTE, true, 4},
+        {{}, 0}};
+
+    /// @brief Quantize vertex. Texture coordinates must be in [0, 1]
+    static CompactChunkVertex pack(const ChunkVertex& vertex);
+
+    /// @brief Decode vertex the same way the chunk shaders do
+    ChunkVertex unpack() const;
+};
+
 template<typename VertexStructure>
 class Mesh;
 
@@ -41,13 +71,36 @@ struct SortingMeshData {
     std::vector<SortingMeshEntry> entries;
 };
 
+/// @brief Opaque geometry of a chunk vertical section
+struct ChunkSectionMeshData {
+    int index;
+    MeshData<ChunkVertex> mesh {};
+    /// @brief Mesh in the compact vertex format, used instead of the mesh
+    /// if compact vertices are enabled
+    MeshData<CompactChunkVertex> compactMesh {};
+    SectionConnectivity connectivity {};
+    /// @brief Vertices bounds relative to the chunk origin
+    glm::vec3 min {};
+    glm::vec3 max {};
+};
+
 struct ChunkMeshData {
-    MeshData<ChunkVertex> mesh;
+    /// @brief Meshes of the rebuilt sections (empty ones included).
+    /// Other sections are kept unchanged
+    std::vector<ChunkSectionMeshData> sections;
     SortingMeshData sortingMesh;
 };
 
+struct ChunkSectionMesh {
+    /// @brief Section geometry in the chunks arena, empty if there is none
+    ChunksArena::Region region;
+    glm::vec3 min {};
+    glm::vec3 max {};
+};
+
 struct ChunkMesh {
-    std::unique_ptr<Mesh<ChunkVertex>> mesh;
+    std::array<ChunkSectionMesh, CHUNK_SECTIONS> sections;
+    SectionsConnectivity connectivity;
     SortingMeshData sortingMeshData;
     std::unique_ptr<Mesh<ChunkVertex> > sortedMesh = nullptr;
 };
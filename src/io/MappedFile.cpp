@@ -0,0 +1,123 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace io;
+
+MappedFile::MappedFile(util::Buffer<ubyte> buffer)
+    : bytes(buffer.data()), length(buffer.size()), buffer(std::move(buffer)) {
+}
+
+MappedFile::MappedFile(
+    std::shared_ptr<const MappedFile> source, size_t offset, size_t length
+)
+    : length(length), source(std::move(source)) {
+    if (offset + length > this->source->size()) {
+        throw std::out_of_range("mapped file part is out of range");
+    }
+    bytes = this->source->data() + offset;
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& file) {
+    HANDLE handle = CreateFileW(
+        file.c_str(),
+        GENERIC_READ,
+        // region files may be open for writing while being read
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("could not to open file " + file.string());
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        throw std::runtime_error("could not get size of " + file.string());
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    fileHandle = handle;
+    if (length == 0) {
+        return;
+    }
+    HANDLE mapping =
+        CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(handle);
+        throw std::runtime_error("could not map file " + file.string());
+    }
+    mappingHandle = mapping;
+    bytes = static_cast<const ubyte*>(
+        MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+    );
+    if (bytes == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        throw std::runtime_error("could not map file " + file.string());
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (source || buffer != nullptr) {
+        return;
+    }
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& file) {
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("could not to open file " + file.string());
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw std::runtime_error("could not get size of " + file.string());
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0) {
+        close(fd);
+        return;
+    }
+    void* ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // mapping stays valid after the descriptor is closed
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        throw std::runtime_error("could not map file " + file.string());
+    }
+    bytes = static_cast<const ubyte*>(ptr);
+}
+
+MappedFile::~MappedFile() {
+    if (source || buffer != nullptr) {
+        return;
+    }
+    if (bytes) {
+        munmap(const_cast<ubyte*>(bytes), length);
+    }
+}
+
+#endif
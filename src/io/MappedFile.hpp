@@ -0,0 +1,53 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+
+#include "typedefs.hpp"
+#include "util/Buffer.hpp"
+#include "util/span.hpp"
+
+namespace io {
+    /// @brief Read-only memory-mapped file. Also used for file bytes
+    /// which are a part of another mapped file or loaded to memory
+    class MappedFile {
+        const ubyte* bytes = nullptr;
+        size_t length = 0;
+        /// @brief Owned bytes if loaded to memory
+        util::Buffer<ubyte> buffer = nullptr;
+        /// @brief Mapped file the bytes are a part of
+        std::shared_ptr<const MappedFile> source;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    public:
+        /// @throw std::runtime_error if file cannot be opened or mapped
+        MappedFile(const std::filesystem::path& file);
+        /// @brief Take ownership over file bytes loaded to memory
+        explicit MappedFile(util::Buffer<ubyte> buffer);
+        /// @brief Part of the mapped file, kept alive while used
+        MappedFile(
+            std::shared_ptr<const MappedFile> source,
+            size_t offset,
+            size_t length
+        );
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /// @return nullptr if file is empty
+        const ubyte* data() const {
+            return bytes;
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+        util::span<ubyte> view() const {
+            return util::span<ubyte>(bytes, length);
+        }
+    };
+}
@@ -0,0 +1,192 @@
+#include "RandomAccessFile.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace io;
+
+#ifdef _WIN32
+
+RandomAccessFile::RandomAccessFile(
+    const std::filesystem::path& file, bool truncate
+)
+    : filename(file) {
+    HANDLE fileHandle = CreateFileW(
+        file.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,
+        nullptr,
+        truncate ? CREATE_ALWAYS : OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("could not to open file " + file.string());
+    }
+    handle = fileHandle;
+}
+
+void RandomAccessFile::read(size_t offset, void* dst, size_t size) {
+    auto bytes = static_cast<char*>(dst);
+    while (size > 0) {
+        OVERLAPPED overlapped {};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD read = 0;
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1 << 30));
+        if (!ReadFile(handle, bytes, chunk, &read, &overlapped) || read == 0) {
+            throw std::runtime_error("could not read " + filename.string());
+        }
+        bytes += read;
+        offset += read;
+        size -= read;
+    }
+}
+
+void RandomAccessFile::write(size_t offset, const void* src, size_t size) {
+    auto bytes = static_cast<const char*>(src);
+    while (size > 0) {
+        OVERLAPPED overlapped {};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD written = 0;
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1 << 30));
+        if (!WriteFile(handle, bytes, chunk, &written, &overlapped)) {
+            throw std::runtime_error("could not write " + filename.string());
+        }
+        bytes += written;
+        offset += written;
+        size -= written;
+    }
+}
+
+size_t RandomAccessFile::length() const {
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        throw std::runtime_error("could not get size of " + filename.string());
+    }
+    return static_cast<size_t>(size.QuadPart);
+}
+
+void RandomAccessFile::truncate(size_t length) {
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(length);
+    if (!SetFilePointerEx(handle, position, nullptr, FILE_BEGIN) ||
+        !SetEndOfFile(handle)) {
+        throw std::runtime_error("could not truncate " + filename.string());
+    }
+}
+
+void RandomAccessFile::sync() {
+    if (!FlushFileBuffers(handle)) {
+        throw std::runtime_error("could not flush " + filename.string());
+    }
+}
+
+void RandomAccessFile::close() {
+    if (handle) {
+        CloseHandle(handle);
+        handle = nullptr;
+    }
+}
+
+void io::sync_directory(const std::filesystem::path&) {
+    // NTFS journals metadata changes, directory handles can't be flushed
+}
+
+#else
+
+RandomAccessFile::RandomAccessFile(
+    const std::filesystem::path& file, bool truncate
+)
+    : filename(file) {
+    int flags = O_RDWR | O_CREAT;
+    if (truncate) {
+        flags |= O_TRUNC;
+    }
+    fd = open(file.c_str(), flags, 0644);
+    if (fd == -1) {
+        throw std::runtime_error("could not to open file " + file.string());
+    }
+}
+
+void RandomAccessFile::read(size_t offset, void* dst, size_t size) {
+    auto bytes = static_cast<char*>(dst);
+    while (size > 0) {
+        ssize_t read = pread(fd, bytes, size, offset);
+        if (read <= 0) {
+            throw std::runtime_error("could not read " + filename.string());
+        }
+        bytes += read;
+        offset += read;
+        size -= read;
+    }
+}
+
+void RandomAccessFile::write(size_t offset, const void* src, size_t size) {
+    auto bytes = static_cast<const char*>(src);
+    while (size > 0) {
+        ssize_t written = pwrite(fd, bytes, size, offset);
+        if (written < 0) {
+            throw std::runtime_error("could not write " + filename.string());
+        }
+        bytes += written;
+        offset += written;
+        size -= written;
+    }
+}
+
+size_t RandomAccessFile::length() const {
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("could not get size of " + filename.string());
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+void RandomAccessFile::truncate(size_t length) {
+    if (ftruncate(fd, length) == -1) {
+        throw std::runtime_error("could not truncate " + filename.string());
+    }
+}
+
+void RandomAccessFile::sync() {
+    if (fsync(fd) == -1) {
+        throw std::runtime_error("could not flush " + filename.string());
+    }
+}
+
+void RandomAccessFile::close() {
+    if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void io::sync_directory(const std::filesystem::path& directory) {
+    int dirfd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirfd == -1) {
+        throw std::runtime_error(
+            "could not open directory " + directory.string()
+        );
+    }
+    int result = fsync(dirfd);
+    ::close(dirfd);
+    if (result == -1) {
+        throw std::runtime_error("could not flush " + directory.string());
+    }
+}
+
+#endif
+
+RandomAccessFile::~RandomAccessFile() {
+    close();
+}
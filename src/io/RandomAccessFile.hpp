@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+
+#include "typedefs.hpp"
+
+namespace io {
+    /// @brief Binary file opened for reading and writing at arbitrary offsets
+    class RandomAccessFile {
+#ifdef _WIN32
+        void* handle = nullptr;
+#else
+        int fd = -1;
+#endif
+        std::filesystem::path filename;
+    public:
+        /// @brief Open file for reading and writing
+        /// @param truncate create empty file if exists
+        /// @throw std::runtime_error if file cannot be opened or created
+        RandomAccessFile(const std::filesystem::path& file, bool truncate);
+        ~RandomAccessFile();
+
+        RandomAccessFile(const RandomAccessFile&) = delete;
+        RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+
+        /// @throw std::runtime_error if not enough bytes read
+        void read(size_t offset, void* dst, size_t size);
+
+        /// @throw std::runtime_error on write error
+        void write(size_t offset, const void* src, size_t size);
+
+        size_t length() const;
+
+        void truncate(size_t length);
+
+        /// @brief Flush written data to the storage device
+        void sync();
+
+        void close();
+    };
+
+    /// @brief Flush directory entries changes (created, renamed or removed
+    /// files) to the storage device. Does nothing where not supported
+    /// @throw std::runtime_error if directory cannot be opened or flushed
+    void sync_directory(const std::filesystem::path& directory);
+}
@@ -4,6 +4,7 @@
 #include <filesystem>
 
 #include "debug/Logger.hpp"
+#include "io/MappedFile.hpp"
 
 using namespace io;
 namespace fs = std::filesystem;
@@ -44,6 +45,10 @@ std::unique_ptr<std::istream> StdfsDevice::read(std::string_view path) {
     return input;
 }
 
+std::unique_ptr<MappedFile> StdfsDevice::map(std::string_view path) {
+    return std::make_unique<MappedFile>(resolve(path));
+}
+
 size_t StdfsDevice::size(std::string_view path) {
     return fs::file_size(resolve(path));
 }
@@ -1,11 +1,11 @@
 #include "ZipFileDevice.hpp"
 
 #include <vector>
+#include <zlib.h>
 
 #include "debug/Logger.hpp"
 #include "io/memory_istream.hpp"
 #include "io/memory_ostream.hpp"
-#include "io/deflate_istream.hpp"
 #include "io/deflate_ostream.hpp"
 #include "util/data_io.hpp"
 #include "util/Buffer.hpp"
@@ -57,6 +57,45 @@ namespace {
         return file_time_type::clock::now() + (time_point - system_clock::now());
     }
 
+    /// @brief Stream reading mapped file bytes
+    class mapped_istream : public std::istream {
+    public:
+        explicit mapped_istream(std::unique_ptr<MappedFile> file)
+            : std::istream(&buf),
+              file(std::move(file)),
+              buf(reinterpret_cast<const char*>(this->file->data()),
+                  this->file->size()) {
+        }
+    private:
+        std::unique_ptr<MappedFile> file;
+        span_streambuf buf;
+    };
+
+    /// @brief Inflate raw deflate data at once
+    util::Buffer<ubyte> inflate_bytes(
+        const ubyte* src, size_t srcSize, size_t dstSize
+    ) {
+        util::Buffer<ubyte> dst(dstSize);
+        if (dstSize == 0) {
+            return dst;
+        }
+        z_stream stream {};
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            throw std::runtime_error("zlib init failed");
+        }
+        stream.next_in = const_cast<Bytef*>(src);
+        stream.avail_in = srcSize;
+        stream.next_out = dst.data();
+        stream.avail_out = dstSize;
+        int result = inflate(&stream, Z_FINISH);
+        size_t inflated = stream.total_out;
+        inflateEnd(&stream);
+        if (result != Z_STREAM_END || inflated != dstSize) {
+            throw std::runtime_error("corrupted deflate data");
+        }
+        return dst;
+    }
+
     uint32_t to_ms_dos_timestamp(const file_time_type& fileTime) {
         auto timePoint = time_point_cast<system_clock::duration>(
             fileTime - file_time_type::clock::now() + system_clock::now()
@@ -136,6 +175,19 @@ ZipFileDevice::ZipFileDevice(
     std::unique_ptr<std::istream> filePtr, FileSeparateFunc separateFunc
 )
     : file(std::move(filePtr)), separateFunc(std::move(separateFunc)) {
+    readCentralDirectory();
+}
+
+ZipFileDevice::ZipFileDevice(std::shared_ptr<const MappedFile> mappedFile)
+    : file(std::make_unique<span_istream>(
+          reinterpret_cast<const char*>(mappedFile->data()),
+          mappedFile->size()
+      )),
+      mapped(std::move(mappedFile)) {
+    readCentralDirectory();
+}
+
+void ZipFileDevice::readCentralDirectory() {
     // Searching for EOCD
     file->seekg(0, std::ios::end);
     std::streampos file_size = file->tellg();
@@ -173,22 +225,29 @@ ZipFileDevice::ZipFileDevice(
         entries[entry.fileName] = std::move(entry);
     }
 
-    for (auto& [name, _] : entries) {
+    // Directories may be not listed explicitly
+    std::vector<std::string> names;
+    names.reserve(entries.size());
+    for (const auto& [name, _] : entries) {
+        names.push_back(name);
+    }
+    for (const auto& name : names) {
         io::path path = name;
-
         while (!(path = path.parent()).pathPart().empty()) {
-            if (entries.find(path.pathPart()) != entries.end()) {
-                continue;
-            }
-            Entry entry {};
-            entry.isDirectory = true;
-            entries[path.pathPart()] = entry;
+            entries[path.pathPart()].isDirectory = true;
         }
-        break;
     }
 
-    for (auto& [_, entry] : entries) {
-        findBlob(entry);
+    for (auto& [name, entry] : entries) {
+        if (!entry.isDirectory) {
+            findBlob(entry);
+        }
+        size_t slash = name.rfind('/');
+        if (slash == std::string::npos) {
+            children[""].push_back(name);
+        } else {
+            children[name.substr(0, slash)].push_back(name.substr(slash + 1));
+        }
     }
 }
 
@@ -200,7 +259,9 @@ std::unique_ptr<std::ostream> ZipFileDevice::write(std::string_view path) {
     return nullptr;
 }
 
-std::unique_ptr<std::istream> ZipFileDevice::read(std::string_view path) {
+const ZipFileDevice::Entry& ZipFileDevice::requireFile(
+    std::string_view path
+) const {
     const auto& found = entries.find(std::string(path));
     if (found == entries.end()) {
         throw std::runtime_error("could not to open file zip://" + std::string(path));
@@ -209,25 +270,38 @@ std::unique_ptr<std::istream> ZipFileDevice::read(std::string_view path) {
     if (entry.isDirectory) {
         throw std::runtime_error("zip://" + std::string(path) + " is directory");
     }
-    if (entry.blobOffset == 0) {
-        findBlob(entry);
-    }
-    std::unique_ptr<std::istream> src_stream;
-    if (separateFunc) {
-        // Create new istream for concurrent data reading
-        src_stream = separateFunc();
-        src_stream->seekg(entry.blobOffset);
+    return entry;
+}
+
+util::Buffer<ubyte> ZipFileDevice::readBytes(const Entry& entry) {
+    util::Buffer<ubyte> buffer = nullptr;
+    const ubyte* src;
+    if (mapped) {
+        if (entry.blobOffset + entry.compressedSize > mapped->size()) {
+            throw std::runtime_error("zip entry is out of file bounds");
+        }
+        src = mapped->data() + entry.blobOffset;
     } else {
-        // Read compressed data to memory if istream cannot be separated
-        file->seekg(entry.blobOffset);
-        util::Buffer<char> buffer(entry.compressedSize);
-        file->read(buffer.data(), buffer.size());
-        src_stream = std::make_unique<memory_istream>(std::move(buffer));
+        // Create new istream for concurrent data reading if possible
+        auto separated = separateFunc ? separateFunc() : nullptr;
+        auto& stream = separated ? *separated : *file;
+        stream.seekg(entry.blobOffset);
+        buffer = util::Buffer<ubyte>(entry.compressedSize);
+        stream.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        if (!stream.good()) {
+            throw std::runtime_error("could not read zip entry data");
+        }
+        src = buffer.data();
     }
     if (entry.compressionMethod == COMPRESSION_NONE) {
-        return src_stream;
+        if (mapped) {
+            return util::Buffer<ubyte>(src, entry.compressedSize);
+        }
+        return buffer;
     } else if (entry.compressionMethod == COMPRESSION_DEFLATE) {
-        return std::make_unique<deflate_istream>(std::move(src_stream));
+        return inflate_bytes(
+            src, entry.compressedSize, entry.uncompressedSize
+        );
     } else {
         throw std::runtime_error(
             "unsupported compression method [" +
@@ -236,6 +310,20 @@ std::unique_ptr<std::istream> ZipFileDevice::read(std::string_view path) {
     }
 }
 
+std::unique_ptr<std::istream> ZipFileDevice::read(std::string_view path) {
+    return std::make_unique<mapped_istream>(map(path));
+}
+
+std::unique_ptr<MappedFile> ZipFileDevice::map(std::string_view path) {
+    const auto& entry = requireFile(path);
+    if (mapped && entry.compressionMethod == COMPRESSION_NONE) {
+        return std::make_unique<MappedFile>(
+            mapped, entry.blobOffset, entry.compressedSize
+        );
+    }
+    return std::make_unique<MappedFile>(readBytes(entry));
+}
+
 size_t ZipFileDevice::size(std::string_view path) {
     const auto& found = entries.find(std::string(path));
     if (found == entries.end()) {
@@ -309,30 +397,11 @@ private:
 };
 
 std::unique_ptr<PathsGenerator> ZipFileDevice::list(std::string_view path) {
-    std::vector<std::string> names;
-    if (path.empty()) {
-        for (const auto& [name, entry] : entries) {
-            if (name.find('/') == std::string::npos) {
-                names.push_back(name);
-            }
-        }
-    } else {
-        auto folder = std::string(path) + "/";
-        size_t folder_len = folder.length();
-        for (const auto& [name, entry] : entries) {
-            if (name.find(folder) != 0) {
-                continue;
-            }
-            size_t pos = name.find('/', folder_len);
-            if (pos == std::string::npos) {
-                names.push_back(name.substr(folder_len, pos - folder_len));
-            }
-            if (pos == name.length() - 1) {
-                names.push_back(name.substr(folder_len, pos - folder_len));
-            }
-        }
+    const auto& found = children.find(std::string(path));
+    if (found == children.end()) {
+        return std::make_unique<ListPathsGenerator>(std::vector<std::string>());
     }
-    return std::make_unique<ListPathsGenerator>(std::move(names));
+    return std::make_unique<ListPathsGenerator>(found->second);
 }
 
 #include "io/io.hpp"
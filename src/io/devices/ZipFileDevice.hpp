@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include "Device.hpp"
 
@@ -36,9 +37,15 @@ namespace io {
             FileSeparateFunc separateFunc = nullptr
         );
 
+        /// @brief Read ZIP file from memory. Stored entries are mapped
+        /// without copying, deflated entries are inflated at once
+        /// @param file memory-mapped ZIP file
+        ZipFileDevice(std::shared_ptr<const MappedFile> file);
+
         std::filesystem::path resolve(std::string_view path) override;
         std::unique_ptr<std::ostream> write(std::string_view path) override;
         std::unique_ptr<std::istream> read(std::string_view path) override;
+        std::unique_ptr<MappedFile> map(std::string_view path) override;
         size_t size(std::string_view path) override;
         io::file_time_type lastWriteTime(std::string_view path) override;
         bool exists(std::string_view path) override;
@@ -52,10 +59,18 @@ namespace io {
     private:
         std::unique_ptr<std::istream> file;
         FileSeparateFunc separateFunc;
+        std::shared_ptr<const MappedFile> mapped;
         std::unordered_map<std::string, Entry> entries;
+        /// @brief Directories entries names, built once with the central
+        /// directory. Key is the directory path, empty for the root
+        std::unordered_map<std::string, std::vector<std::string>> children;
 
+        void readCentralDirectory();
         Entry readEntry();
         void findBlob(Entry& entry);
+        const Entry& requireFile(std::string_view path) const;
+        /// @brief Read and decompress entry data
+        util::Buffer<ubyte> readBytes(const Entry& entry);
     };
 
     void write_zip(const path& folder, const path& file);
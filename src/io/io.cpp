@@ -15,6 +15,7 @@
 #include "util/stringutil.hpp"
 
 #include "devices/Device.hpp"
+#include "MappedFile.hpp"
 
 namespace fs = std::filesystem;
 
@@ -123,6 +124,14 @@ std::unique_ptr<std::istream> io::read(const io::path& filename) {
     return device->read(filename.pathPart());
 }
 
+std::unique_ptr<io::MappedFile> io::map(const io::path& filename) {
+    auto device = io::get_device(filename.entryPoint());
+    if (device == nullptr) {
+        throw std::runtime_error("io-device not found: " + filename.entryPoint());
+    }
+    return device->map(filename.pathPart());
+}
+
 util::Buffer<ubyte> io::read_bytes_buffer(const path& file) {
     size_t size;
     auto bytes = io::read_bytes(file, size);
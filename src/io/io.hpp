@@ -14,6 +14,7 @@
 
 namespace io {
     class Device;
+    class MappedFile;
 
     /// @brief Set device for the entry-point
     void set_device(const std::string& name, std::shared_ptr<Device> device);
@@ -150,6 +151,11 @@ namespace io {
     /// @throw std::runtime_error if file cannot be opened
     std::unique_ptr<std::istream> read(const io::path& file);
 
+    /// @brief Map file to memory for reading
+    /// @return nullptr if memory mapping is not supported by the device
+    /// @throw std::runtime_error if file cannot be opened
+    std::unique_ptr<MappedFile> map(const io::path& file);
+
     /// @brief Read bytes array from the file
     bool read(const io::path& file, char* data, size_t size);
     util::Buffer<ubyte> read_bytes_buffer(const path& file);
@@ -62,3 +62,50 @@ public:
 private:
     memory_view_streambuf buf;
 };
+
+/// @brief Seekable streambuf reading memory owned by someone else
+class span_streambuf : public std::streambuf {
+public:
+    span_streambuf(const char* data, size_t size) {
+        char* base = const_cast<char*>(data);
+        setg(base, base, base + size);
+    }
+
+    span_streambuf(const span_streambuf&) = delete;
+    span_streambuf& operator=(const span_streambuf&) = delete;
+
+protected:
+    int_type underflow() override {
+        return traits_type::eof();
+    }
+
+    pos_type seekoff(
+        off_type off, std::ios_base::seekdir dir, std::ios_base::openmode
+    ) override {
+        off_type base = 0;
+        if (dir == std::ios_base::cur) {
+            base = gptr() - eback();
+        } else if (dir == std::ios_base::end) {
+            base = egptr() - eback();
+        }
+        return seekpos(base + off, std::ios_base::in);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode) override {
+        off_type offset = pos;
+        if (offset < 0 || offset > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + offset, egptr());
+        return pos;
+    }
+};
+
+class span_istream : public std::istream {
+public:
+    span_istream(const char* data, size_t size)
+        : std::istream(&buf), buf(data, size) {}
+
+private:
+    span_streambuf buf;
+};
@@ -65,6 +65,9 @@ SettingsHandler::SettingsHandler(EngineSettings& settings) {
     builder.add("load-distance", &settings.chunks.loadDistance);
     builder.add("load-speed", &settings.chunks.loadSpeed);
     builder.add("padding", &settings.chunks.padding);
+    builder.add("generator-workers", &settings.chunks.generatorWorkers);
+    builder.add("lighting-workers", &settings.chunks.lightingWorkers);
+    builder.add("pack-voxels", &settings.chunks.packVoxels);
 
     builder.addSection("graphics");
     builder.add("fog-curve", &settings.graphics.fogCurve);
@@ -72,6 +75,7 @@ SettingsHandler::SettingsHandler(EngineSettings& settings) {
     builder.add("dense-render", &settings.graphics.denseRender);
     builder.add("gamma", &settings.graphics.gamma);
     builder.add("frustum-culling", &settings.graphics.frustumCulling);
+    builder.add("cave-culling", &settings.graphics.caveCulling);
     builder.add("skybox-resolution", &settings.graphics.skyboxResolution);
     builder.add("chunk-max-vertices", &settings.graphics.chunkMaxVertices);
     builder.add("chunk-max-vertices-dense", &settings.graphics.chunkMaxVerticesDense);
@@ -81,6 +85,8 @@ SettingsHandler::SettingsHandler(EngineSettings& settings) {
     builder.add("shadows-quality", &settings.graphics.shadowsQuality);
     builder.add("dense-render-distance", &settings.graphics.denseRenderDistance);
     builder.add("soft-lighting", &settings.graphics.softLighting);
+    builder.add("greedy-meshing", &settings.graphics.greedyMeshing);
+    builder.add("compact-vertices", &settings.graphics.compactVertices);
 
     builder.addSection("ui");
     builder.add("language", &settings.ui.language);
@@ -89,9 +95,16 @@ SettingsHandler::SettingsHandler(EngineSettings& settings) {
     builder.addSection("pathfinding");
     builder.add("steps-per-async-agent", &settings.pathfinding.stepsPerAsyncAgent);
 
+    builder.addSection("physics");
+    builder.add("workers", &settings.physics.workers);
+
+    builder.addSection("entities");
+    builder.add("tick-lod-distance", &settings.entities.tickLodDistance);
+
     builder.addSection("debug");
     builder.add("generator-test-mode", &settings.debug.generatorTestMode);
     builder.add("do-write-lights", &settings.debug.doWriteLights);
+    builder.add("fast-data-compression", &settings.debug.fastDataCompression);
     builder.add("do-trace-shaders", &settings.debug.doTraceShaders);
     builder.add("enable-experimental", &settings.debug.enableExperimental);
 }
@@ -8,11 +8,19 @@
 #include "data/dv.hpp"
 #include "typedefs.hpp"
 
+/// @brief Interned ids of item script events (see lua::intern_event)
+struct ItemEventIds {
+    int use;
+    int useon;
+    int blockbreakby;
+};
+
 struct ItemFuncsSet {
     bool init : 1;
     bool on_use : 1;
     bool on_use_on_block : 1;
     bool on_block_break_by : 1;
+    ItemEventIds events;
 };
 
 enum class ItemIconType {
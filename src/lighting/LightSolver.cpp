@@ -1,25 +1,91 @@
-#include <iostream>
 #include <assert.h>
+#include <algorithm>
 
 #include "LightSolver.hpp"
 #include "Lightmap.hpp"
 #include "content/Content.hpp"
+#include "maths/voxmaths.hpp"
 #include "voxels/Chunks.hpp"
 #include "voxels/Chunk.hpp"
 #include "voxels/voxel.hpp"
 #include "voxels/Block.hpp"
 
-LightSolver::LightSolver(const ContentIndices& contentIds, Chunks& chunks, int channel) 
+// neighbours order affects the removal result, must be the same in all paths
+static const int coords[] = {
+        0, 0, 1,
+        0, 0,-1,
+        0, 1, 0,
+        0,-1, 0,
+        1, 0, 0,
+       -1, 0, 0
+};
+
+static const int offsets[] = {
+    CHUNK_W,
+    -CHUNK_W,
+    CHUNK_W * CHUNK_D,
+    -CHUNK_W * CHUNK_D,
+    1,
+    -1
+};
+
+/// @brief All neighbours of the voxel are in the same chunk
+static inline bool is_interior(int lx, int y, int lz) {
+    return lx > 0 && lx < CHUNK_W - 1 && lz > 0 && lz < CHUNK_D - 1 &&
+           y > 0 && y < CHUNK_H - 1;
+}
+
+LightSolver::LightSolver(
+    const ContentIndices& contentIds, const Chunks& chunks, int channel
+)
     : blockDefs(contentIds.blocks.getDefs()),
-      chunks(chunks), 
+      chunks(chunks),
       channel(channel) {
+    const auto& blocks = contentIds.blocks;
+    lightPassing.resize(blocks.count());
+    for (size_t id = 0; id < blocks.count(); id++) {
+        lightPassing[id] = blockDefs[id]->lightPassing;
+    }
+}
+
+Chunk* LightSolver::getChunk(int cx, int cz) {
+    if (!cacheValid) {
+        cacheX = cx;
+        cacheZ = cz;
+        cacheValid = true;
+    }
+    int lx = cx - cacheX + 1;
+    int lz = cz - cacheZ + 1;
+    if (lx < 0 || lz < 0 || lx > 2 || lz > 2) {
+        return chunks.getChunk(cx, cz);
+    }
+    int index = lz * 3 + lx;
+    if (!cached[index]) {
+        cache[index] = chunks.getChunk(cx, cz);
+        cached[index] = true;
+    }
+    return cache[index];
+}
+
+Chunk* LightSolver::getChunkByVoxel(int x, int y, int z) {
+    if (y < 0 || y >= CHUNK_H) {
+        return nullptr;
+    }
+    return getChunk(floordiv<CHUNK_W>(x), floordiv<CHUNK_D>(z));
+}
+
+void LightSolver::resetCache() {
+    if (cacheValid) {
+        cacheValid = false;
+        std::fill(std::begin(cached), std::end(cached), false);
+    }
 }
 
 void LightSolver::add(int x, int y, int z, int emission) {
     if (emission <= 1) {
         return;
     }
-    Chunk* chunk = chunks.getChunkByVoxel(x, y, z);
+    Chunk* chunk = getChunkByVoxel(x, y, z);
     if (chunk == nullptr) {
         return;
     }
@@ -31,16 +97,29 @@ void LightSolver::add(int x, int y, int z, int emission) {
 
     addqueue.push(lightentry {x, y, z, ubyte(emission)});
 
-    chunk->flags.modified = true;
+    chunk->setModified(y);
     lightmap.set(x-chunk->x*CHUNK_W, y, z-chunk->z*CHUNK_D, channel, emission);
 }
 
 void LightSolver::add(int x, int y, int z) {
-    add(x,y,z, chunks.getLight(x,y,z, channel));
+    Chunk* chunk = getChunkByVoxel(x, y, z);
+    if (chunk == nullptr) {
+        return;
+    }
+    assert(chunk->lightmap != nullptr);
+    ubyte light = chunk->lightmap->get(
+        x - chunk->x * CHUNK_W, y, z - chunk->z * CHUNK_D, channel
+    );
+    if (light <= 1) {
+        return;
+    }
+    // the value is already set
+    addqueue.push(lightentry {x, y, z, light});
+    chunk->setModified(y);
 }
 
 void LightSolver::remove(int x, int y, int z) {
-    Chunk* chunk = chunks.getChunkByVoxel(x, y, z);
+    Chunk* chunk = getChunkByVoxel(x, y, z);
     if (chunk == nullptr) {
         return;
     }
@@ -55,40 +134,74 @@ void LightSolver::remove(int x, int y, int z) {
     lightmap.set(x-chunk->x*CHUNK_W, y, z-chunk->z*CHUNK_D, channel, 0);
 }
 
-void LightSolver::solve(){
-    const int coords[] = {
-            0, 0, 1,
-            0, 0,-1,
-            0, 1, 0,
-            0,-1, 0,
-            1, 0, 0,
-           -1, 0, 0
-    };
+void LightSolver::solveRemove() {
+    const int shift = channel << 2;
+    const light_t mask = ~(0xF << shift);
 
     while (!remqueue.empty()){
-        const lightentry entry = remqueue.front();
-        remqueue.pop();
+        const lightentry entry = remqueue.pop();
+
+        int cx = floordiv<CHUNK_W>(entry.x);
+        int cz = floordiv<CHUNK_D>(entry.z);
+        int elx = entry.x - cx * CHUNK_W;
+        int elz = entry.z - cz * CHUNK_D;
+        if (is_interior(elx, entry.y, elz)) {
+            Chunk* chunk = getChunk(cx, cz);
+            assert(chunk != nullptr && chunk->lightmap != nullptr);
+            chunk->setModified(entry.y);
+            light_t* map = chunk->lightmap->getLightsWriteable();
+            const voxel* voxels = chunk->getVoxels();
+            int index = vox_index(elx, entry.y, elz);
+
+            for (int i = 0; i < 6; i++) {
+                int nindex = index + offsets[i];
+                ubyte light = (map[nindex] >> shift) & 0xF;
+                if (light != 0 && light == entry.light-1) {
+                    blockid_t id = voxels[nindex].id;
+                    uint8_t emission = id ? blockDefs[id]->emission[channel] : 0;
+                    map[nindex] = (map[nindex] & mask) | (emission << shift);
+
+                    int imul3 = i*3;
+                    int x = entry.x+coords[imul3];
+                    int y = entry.y+coords[imul3+1];
+                    int z = entry.z+coords[imul3+2];
+                    if (emission) {
+                        addqueue.push(lightentry {x, y, z, emission});
+                    }
+                    remqueue.push(lightentry {x, y, z, light});
+                } else if (light >= entry.light) {
+                    int imul3 = i*3;
+                    addqueue.push(lightentry {
+                        entry.x+coords[imul3],
+                        entry.y+coords[imul3+1],
+                        entry.z+coords[imul3+2],
+                        light});
+                }
+            }
+            continue;
+        }
 
         for (int i = 0; i < 6; i++) {
             int imul3 = i*3;
             int x = entry.x+coords[imul3];
             int y = entry.y+coords[imul3+1];
             int z = entry.z+coords[imul3+2];
-            
-            Chunk* chunk = chunks.getChunkByVoxel(x,y,z);
+
+            Chunk* chunk = getChunkByVoxel(x,y,z);
             if (chunk) {
                 int lx = x - chunk->x * CHUNK_W;
                 int lz = z - chunk->z * CHUNK_D;
-                chunk->flags.modified = true;
+                chunk->setModified(y);
 
                 assert(chunk->lightmap != nullptr);
                 auto& lightmap = *chunk->lightmap;
 
                 ubyte light = lightmap.get(lx,y,lz, channel);
                 if (light != 0 && light == entry.light-1){
-                    voxel* vox = chunks.get(x, y, z);
-                    if (vox && vox->id != 0) {
-                        const Block* block = blockDefs[vox->id];
+                    const voxel& vox =
+                        chunk->getVoxels()[vox_index(lx, y, lz)];
+                    if (vox.id != 0) {
+                        const Block* block = blockDefs[vox.id];
                         if (uint8_t emission = block->emission[channel]) {
                             addqueue.push(lightentry {x, y, z, emission});
                             lightmap.set(lx, y, lz, channel, emission);
@@ -104,10 +217,45 @@ void LightSolver::solve(){
             }
         }
     }
+}
+
+void LightSolver::solveAdd() {
+    const int shift = channel << 2;
+    const light_t mask = ~(0xF << shift);
 
     while (!addqueue.empty()){
-        const lightentry entry = addqueue.front();
-        addqueue.pop();
+        const lightentry entry = addqueue.pop();
+
+        int cx = floordiv<CHUNK_W>(entry.x);
+        int cz = floordiv<CHUNK_D>(entry.z);
+        int elx = entry.x - cx * CHUNK_W;
+        int elz = entry.z - cz * CHUNK_D;
+        if (is_interior(elx, entry.y, elz)) {
+            Chunk* chunk = getChunk(cx, cz);
+            assert(chunk != nullptr && chunk->lightmap != nullptr);
+            chunk->setModified(entry.y);
+            light_t* map = chunk->lightmap->getLightsWriteable();
+            const voxel* voxels = chunk->getVoxels();
+            int index = vox_index(elx, entry.y, elz);
+            const uint8_t* passing = lightPassing.data();
+            const ubyte newLight = entry.light - 1;
+            const light_t newBits = newLight << shift;
+
+            for (int i = 0; i < 6; i++) {
+                int nindex = index + offsets[i];
+                ubyte light = (map[nindex] >> shift) & 0xF;
+                if (light+2 <= entry.light && passing[voxels[nindex].id]) {
+                    map[nindex] = (map[nindex] & mask) | newBits;
+                    int imul3 = i*3;
+                    addqueue.push(lightentry {
+                        entry.x+coords[imul3],
+                        entry.y+coords[imul3+1],
+                        entry.z+coords[imul3+2],
+                        newLight});
+                }
+            }
+            continue;
+        }
 
         for (int i = 0; i < 6; i++) {
             int imul3 = i*3;
@@ -115,7 +263,7 @@ void LightSolver::solve(){
             int y = entry.y+coords[imul3+1];
             int z = entry.z+coords[imul3+2];
 
-            Chunk* chunk = chunks.getChunkByVoxel(x,y,z);
+            Chunk* chunk = getChunkByVoxel(x,y,z);
             if (chunk == nullptr) {
                 continue;
             }
@@ -123,18 +271,21 @@ void LightSolver::solve(){
             auto& lightmap = *chunk->lightmap;
             int lx = x - chunk->x * CHUNK_W;
             int lz = z - chunk->z * CHUNK_D;
-            chunk->flags.modified = true;
+            chunk->setModified(y);
 
             ubyte light = lightmap.get(lx, y, lz, channel);
-            voxel& v = chunk->voxels[vox_index(lx, y, lz)];
+            const voxel& v = chunk->getVoxels()[vox_index(lx, y, lz)];
             const Block* block = blockDefs[v.id];
             if (block->lightPassing && light+2 <= entry.light){
-                lightmap.set(
-                    x-chunk->x*CHUNK_W, y, z-chunk->z*CHUNK_D, 
-                    channel, 
-                    entry.light-1);
+                lightmap.set(lx, y, lz, channel, entry.light-1);
                 addqueue.push(lightentry {x, y, z, ubyte(entry.light-1)});
             }
         }
     }
 }
+
+void LightSolver::solve() {
+    solveRemove();
+    solveAdd();
+    resetCache();
+}
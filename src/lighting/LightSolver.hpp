@@ -1,7 +1,10 @@
 #pragma once
 
-#include <queue>
+#include <vector>
 
+#include "typedefs.hpp"
+
+class Chunk;
 class Chunks;
 class ContentIndices;
 class Block;
@@ -13,14 +16,58 @@ struct lightentry {
     unsigned char light;
 };
 
+/// @brief FIFO queue keeping its memory between solver runs
+class LightQueue {
+    std::vector<lightentry> entries;
+    size_t head = 0;
+public:
+    inline void push(const lightentry& entry) {
+        entries.push_back(entry);
+    }
+
+    inline lightentry pop() {
+        lightentry entry = entries[head++];
+        if (head == entries.size()) {
+            head = 0;
+            entries.clear();
+        }
+        return entry;
+    }
+
+    inline bool empty() const {
+        return head == entries.size();
+    }
+};
+
+/// @brief Single channel light propagation solver.
+/// Chunks of a 3x3 area around the first accessed chunk are cached until
+/// solve() is finished, so the chunks matrix must not be modified between
+/// add/remove calls and solve().
 class LightSolver {
-    std::queue<lightentry> addqueue;
-    std::queue<lightentry> remqueue;
+    LightQueue addqueue;
+    LightQueue remqueue;
     const Block* const* blockDefs;
-    Chunks& chunks;
+    /// @brief Block::lightPassing by block id
+    std::vector<uint8_t> lightPassing;
+    const Chunks& chunks;
     int channel;
+
+    int cacheX = 0;
+    int cacheZ = 0;
+    bool cacheValid = false;
+    bool cached[9] {};
+    Chunk* cache[9] {};
+
+    Chunk* getChunk(int cx, int cz);
+    Chunk* getChunkByVoxel(int x, int y, int z);
+    void resetCache();
+
+    void solveRemove();
+    void solveAdd();
 public:
-    LightSolver(const ContentIndices& contentIds, Chunks& chunks, int channel);
+    LightSolver(
+        const ContentIndices& contentIds, const Chunks& chunks, int channel
+    );
 
     void add(int x, int y, int z);
     void add(int x, int y, int z, int emission);
@@ -9,22 +9,43 @@
 #include "constants.hpp"
 #include "util/timeutil.hpp"
 #include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
+#include "util/ParallelExecutor.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 
 static debug::Logger logger("lighting");
 
-Lighting::Lighting(const Content& content, Chunks& chunks) 
-  : content(content), chunks(chunks) {
-    auto& indices = *content.getIndices();
-    solverR = std::make_unique<LightSolver>(indices, chunks, 0);
-    solverG = std::make_unique<LightSolver>(indices, chunks, 1);
-    solverB = std::make_unique<LightSolver>(indices, chunks, 2);
-    solverS = std::make_unique<LightSolver>(indices, chunks, 3);
+Lighting::Solvers::Solvers(const ContentIndices& indices, const Chunks& chunks)
+    : r(std::make_unique<LightSolver>(indices, chunks, 0)),
+      g(std::make_unique<LightSolver>(indices, chunks, 1)),
+      b(std::make_unique<LightSolver>(indices, chunks, 2)),
+      s(std::make_unique<LightSolver>(indices, chunks, 3)) {
+}
+
+Lighting::Solvers::~Solvers() = default;
+
+Lighting::Lighting(const ContentIndices& indices, Chunks& chunks, int workers)
+  : indices(indices), chunks(chunks) {
+    if (workers > 0) {
+        executor = std::make_unique<util::ParallelExecutor>(
+            "lighting", workers + 1
+        );
+    }
+    uint workersCount = executor ? executor->getWorkersCount() : 1;
+    for (uint i = 0; i < workersCount; i++) {
+        solvers.push_back(std::make_unique<Solvers>(indices, chunks));
+    }
 }
 
 Lighting::~Lighting() = default;
 
+uint Lighting::getWorkersCount() const {
+    return solvers.size();
+}
+
 void Lighting::clear(){
     const auto& chunks = this->chunks.getChunks();
     for (size_t index = 0; index < chunks.size(); index++){
@@ -46,12 +67,13 @@ void Lighting::prebuildSkyLight(Chunk& chunk, const ContentIndices& indices) {
     
     const auto* blockDefs = indices.blocks.getDefs();
 
+    const voxel* voxels = chunk.getVoxels();
     int highestPoint = 0;
     for (int z = 0; z < CHUNK_D; z++){
         for (int x = 0; x < CHUNK_W; x++){
             for (int y = CHUNK_H-1; y >= 0; y--){
                 int index = (y * CHUNK_D + z) * CHUNK_W + x;
-                voxel& vox = chunk.voxels[index];
+                const voxel& vox = voxels[index];
                 const Block* block = blockDefs[vox.id];
                 if (!block->skyLightPassing) {
                     if (highestPoint < y) {
@@ -69,60 +91,63 @@ void Lighting::prebuildSkyLight(Chunk& chunk, const ContentIndices& indices) {
     lightmap.highestPoint = highestPoint;
 }
 
-void Lighting::buildSkyLight(int cx, int cz){
-    const auto blockDefs = content.getIndices()->blocks.getDefs();
+void Lighting::buildSkyLight(Solvers& solvers, Chunk& chunk) {
+    const auto blockDefs = indices.blocks.getDefs();
+    auto& solverS = *solvers.s;
 
-    Chunk* chunk = chunks.getChunk(cx, cz);
-    if (chunk == nullptr) {
-        logger.error() << "attempted to build sky lights to chunk missing in local matrix";
-        return;
-    }
-    assert(chunk->lightmap != nullptr);
-    auto& lightmap = *chunk->lightmap;
+    assert(chunk.lightmap != nullptr);
+    auto& lightmap = *chunk.lightmap;
+    const voxel* voxels = chunk.getVoxels();
 
     for (int z = 0; z < CHUNK_D; z++){
         for (int x = 0; x < CHUNK_W; x++){
-            int gx = x + cx * CHUNK_W;
-            int gz = z + cz * CHUNK_D;
+            int gx = x + chunk.x * CHUNK_W;
+            int gz = z + chunk.z * CHUNK_D;
             for (int y = lightmap.highestPoint; y >= 0; y--){
-                while (y > 0 && !blockDefs[chunk->voxels[vox_index(x, y, z)].id]->lightPassing) {
+                while (y > 0 && !blockDefs[voxels[vox_index(x, y, z)].id]->lightPassing) {
                     y--;
                 }
                 if (lightmap.getS(x, y, z) != 15) {
-                    solverS->add(gx,y+1,gz);
+                    solverS.add(gx,y+1,gz);
                     for (; y >= 0; y--){
-                        solverS->add(gx+1,y,gz);
-                        solverS->add(gx-1,y,gz);
-                        solverS->add(gx,y,gz+1);
-                        solverS->add(gx,y,gz-1);
+                        solverS.add(gx+1,y,gz);
+                        solverS.add(gx-1,y,gz);
+                        solverS.add(gx,y,gz+1);
+                        solverS.add(gx,y,gz-1);
                     }
                 }
             }
         }
     }
-    solverS->solve();
+    solverS.solve();
 }
 
-
-void Lighting::onChunkLoaded(int cx, int cz, bool expand) {
-    auto& solverR = *this->solverR;
-    auto& solverG = *this->solverG;
-    auto& solverB = *this->solverB;
-    auto& solverS = *this->solverS;
-
-    auto blockDefs = content.getIndices()->blocks.getDefs();
-    auto chunk = chunks.getChunk(cx, cz);
+void Lighting::buildSkyLight(int cx, int cz){
+    Chunk* chunk = chunks.getChunk(cx, cz);
     if (chunk == nullptr) {
-        logger.error() << "attempted to build lights to chunk missing in local matrix";
+        logger.error() << "attempted to build sky lights to chunk missing in local matrix";
         return;
     }
-    assert(chunk->lightmap != nullptr);
-    auto& lightmap = *chunk->lightmap;
+    buildSkyLight(*solvers[0], *chunk);
+}
+
+void Lighting::buildChunkLights(Solvers& solvers, Chunk& chunk, bool expand) {
+    auto& solverR = *solvers.r;
+    auto& solverG = *solvers.g;
+    auto& solverB = *solvers.b;
+    auto& solverS = *solvers.s;
+
+    auto blockDefs = indices.blocks.getDefs();
+    int cx = chunk.x;
+    int cz = chunk.z;
+    assert(chunk.lightmap != nullptr);
+    auto& lightmap = *chunk.lightmap;
+    const voxel* voxels = chunk.getVoxels();
 
     for (uint y = 0; y < CHUNK_H; y++){
         for (uint z = 0; z < CHUNK_D; z++){
             for (uint x = 0; x < CHUNK_W; x++){
-                const voxel& vox = chunk->voxels[(y * CHUNK_D + z) * CHUNK_W + x];
+                const voxel& vox = voxels[(y * CHUNK_D + z) * CHUNK_W + x];
                 const Block* block = blockDefs[vox.id];
                 int gx = x + cx * CHUNK_W;
                 int gz = z + cz * CHUNK_D;
@@ -173,8 +198,78 @@ void Lighting::onChunkLoaded(int cx, int cz, bool expand) {
     solverS.solve();
 }
 
+void Lighting::onChunkLoaded(int cx, int cz, bool expand) {
+    auto chunk = chunks.getChunk(cx, cz);
+    if (chunk == nullptr) {
+        logger.error() << "attempted to build lights to chunk missing in local matrix";
+        return;
+    }
+    buildChunkLights(*solvers[0], *chunk, expand);
+}
+
+void Lighting::buildChunksLights(const std::vector<glm::ivec2>& positions) {
+    std::vector<Chunk*> targets;
+    targets.reserve(positions.size());
+    for (const auto& pos : positions) {
+        auto chunk = chunks.getChunk(pos.x, pos.y);
+        if (chunk == nullptr) {
+            logger.error() << "attempted to build lights to chunk missing in local matrix";
+            continue;
+        }
+        targets.push_back(chunk);
+    }
+    auto process = [this](Solvers& solvers, Chunk& chunk) {
+        debug::ProfileScope profile(debug::ProfileStage::LIGHTING);
+        bool expand = !chunk.flags.loadedLights;
+        if (expand) {
+            buildSkyLight(solvers, chunk);
+        }
+        buildChunkLights(solvers, chunk, expand);
+    };
+    if (executor == nullptr || targets.size() < 2) {
+        for (auto chunk : targets) {
+            process(*solvers[0], *chunk);
+        }
+        return;
+    }
+    // Lights of a chunk spread to the 3x3 area around it only, so chunks
+    // at distance 3+ do not touch the same memory. Each chunk goes to the
+    // wave after the last one containing a chunk it conflicts with, so
+    // conflicting chunks keep their order.
+    std::vector<uint> chunkWaves(targets.size());
+    std::vector<std::vector<Chunk*>> waves;
+    for (size_t i = 0; i < targets.size(); i++) {
+        uint wave = 0;
+        for (size_t j = 0; j < i; j++) {
+            if (std::abs(targets[i]->x - targets[j]->x) < 3 &&
+                std::abs(targets[i]->z - targets[j]->z) < 3) {
+                wave = std::max(wave, chunkWaves[j] + 1);
+            }
+        }
+        chunkWaves[i] = wave;
+        if (wave >= waves.size()) {
+            waves.resize(wave + 1);
+        }
+        waves[wave].push_back(targets[i]);
+    }
+    for (const auto& wave : waves) {
+        executor->run(
+            wave.size(),
+            [this, &wave, &process](size_t index, uint worker) {
+                process(*solvers[worker], *wave[index]);
+            }
+        );
+    }
+}
+
 void Lighting::onBlockSet(int x, int y, int z, blockid_t id){
-    const auto& block = content.getIndices()->blocks.require(id);
+    const auto& block = indices.blocks.require(id);
+    const auto& mainSolvers = *solvers[0];
+    auto& solverR = mainSolvers.r;
+    auto& solverG = mainSolvers.g;
+    auto& solverB = mainSolvers.b;
+    auto& solverS = mainSolvers.s;
+
     solverR->remove(x,y,z);
     solverG->remove(x,y,z);
     solverB->remove(x,y,z);
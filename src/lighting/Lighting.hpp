@@ -1,28 +1,64 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
 #include "typedefs.hpp"
 
-class Content;
 class ContentIndices;
 class Chunk;
 class Chunks;
 class LightSolver;
 
+namespace util {
+    class ParallelExecutor;
+}
+
 class Lighting {
-    const Content& content;
+    /// @brief Set of solvers (one per channel) owned by a single worker
+    struct Solvers {
+        std::unique_ptr<LightSolver> r;
+        std::unique_ptr<LightSolver> g;
+        std::unique_ptr<LightSolver> b;
+        std::unique_ptr<LightSolver> s;
+
+        Solvers(const ContentIndices& indices, const Chunks& chunks);
+        ~Solvers();
+    };
+
+    const ContentIndices& indices;
     Chunks& chunks;
-    std::unique_ptr<LightSolver> solverR;
-    std::unique_ptr<LightSolver> solverG;
-    std::unique_ptr<LightSolver> solverB;
-    std::unique_ptr<LightSolver> solverS;
+    /// @brief Per-worker solvers. First one is used on the main thread
+    std::vector<std::unique_ptr<Solvers>> solvers;
+    /// @brief nullptr if lights are built on the main thread only
+    std::unique_ptr<util::ParallelExecutor> executor;
+
+    void buildSkyLight(Solvers& solvers, Chunk& chunk);
+    void buildChunkLights(Solvers& solvers, Chunk& chunk, bool expand);
 public:
-    Lighting(const Content& content, Chunks& chunks);
+    /// @param workers number of additional threads used to build
+    /// chunks lights (0 - main thread only)
+    Lighting(const ContentIndices& indices, Chunks& chunks, int workers = 0);
     ~Lighting();
 
     void clear();
+
+    /// @return number of threads building chunks lights
+    uint getWorkersCount() const;
+
     void buildSkyLight(int cx, int cz);
     void onChunkLoaded(int cx, int cz, bool expand);
     void onBlockSet(int x, int y, int z, blockid_t id);
 
+    /// @brief Build lights of loaded chunks. Chunks with 3x3 areas not
+    /// overlapping are processed in parallel. Result is the same as
+    /// calling buildSkyLight (if chunk has no lights loaded) and
+    /// onChunkLoaded for each chunk in the given order.
+    /// @param positions chunks positions. All chunks in 3x3 area around
+    /// each one must be present
+    void buildChunksLights(const std::vector<glm::ivec2>& positions);
+
     static void prebuildSkyLight(Chunk& chunk, const ContentIndices& indices);
 };
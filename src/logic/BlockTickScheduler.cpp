@@ -0,0 +1,324 @@
+#include "BlockTickScheduler.hpp"
+
+#include <algorithm>
+
+#include "constants.hpp"
+#include "content/Content.hpp"
+#include "maths/voxmaths.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/blocks_agent.hpp"
+
+using blocks_agent::BlockRegisterEvent;
+
+static inline uint local_index(const glm::ivec3& pos, glm::ivec2 chunk) {
+    return vox_index(
+        pos.x - chunk.x * CHUNK_W, pos.y, pos.z - chunk.y * CHUNK_D
+    );
+}
+
+void BlockPositions::add(const glm::ivec3& pos) {
+    glm::ivec2 chunk(floordiv<CHUNK_W>(pos.x), floordiv<CHUNK_D>(pos.z));
+    uint key = local_index(pos, chunk);
+    const auto& found = bucketsIndices.find(chunk);
+    if (found == bucketsIndices.end()) {
+        bucketsIndices[chunk] = buckets.size();
+        buckets.push_back(Bucket {chunk, {pos}, {{key, 0}}});
+    } else {
+        auto& bucket = buckets[found->second];
+        uint slot = bucket.positions.size();
+        if (!bucket.slots.emplace(key, slot).second) {
+            return;
+        }
+        bucket.positions.push_back(pos);
+    }
+    count++;
+}
+
+bool BlockPositions::remove(const glm::ivec3& pos) {
+    glm::ivec2 chunk(floordiv<CHUNK_W>(pos.x), floordiv<CHUNK_D>(pos.z));
+    const auto& found = bucketsIndices.find(chunk);
+    if (found == bucketsIndices.end()) {
+        return false;
+    }
+    size_t bucketIndex = found->second;
+    auto& bucket = buckets[bucketIndex];
+    auto& positions = bucket.positions;
+    const auto& foundSlot = bucket.slots.find(local_index(pos, chunk));
+    if (foundSlot == bucket.slots.end()) {
+        return false;
+    }
+    size_t index = foundSlot->second;
+    bucket.slots.erase(foundSlot);
+    auto move = [&bucket, &positions, chunk](size_t from, size_t to) {
+        positions[to] = positions[from];
+        bucket.slots[local_index(positions[to], chunk)] = to;
+    };
+    // visited position is replaced with the last visited one, so the
+    // cursor still separates visited positions from the rest
+    if (bucketIndex == bucketCursor && index < positionCursor) {
+        size_t visited = --positionCursor;
+        if (index != visited) {
+            move(visited, index);
+        }
+        index = visited;
+    }
+    // swap-remove keeping the moved position slot actual
+    if (index != positions.size() - 1) {
+        move(positions.size() - 1, index);
+    }
+    positions.pop_back();
+    count--;
+    if (positions.empty()) {
+        removeBucket(bucketIndex);
+    }
+    return true;
+}
+
+void BlockPositions::moveBucket(size_t from, size_t to) {
+    buckets[to] = std::move(buckets[from]);
+    bucketsIndices[buckets[to].chunk] = to;
+}
+
+void BlockPositions::removeBucket(size_t index) {
+    bucketsIndices.erase(buckets[index].chunk);
+    if (index == bucketCursor) {
+        positionCursor = 0;
+    } else if (index < bucketCursor) {
+        // the gap is moved to the cursor keeping visited buckets before
+        // the current one
+        size_t visited = bucketCursor - 1;
+        if (index != visited) {
+            moveBucket(visited, index);
+        }
+        index = visited;
+        if (bucketCursor < buckets.size()) {
+            moveBucket(bucketCursor, visited);
+            index = bucketCursor;
+        }
+        bucketCursor--;
+    }
+    if (index != buckets.size() - 1) {
+        moveBucket(buckets.size() - 1, index);
+    }
+    buckets.pop_back();
+    if (bucketCursor >= buckets.size()) {
+        bucketCursor = 0;
+        positionCursor = 0;
+    }
+}
+
+size_t BlockPositions::removeChunk(int cx, int cz) {
+    const auto& found = bucketsIndices.find(glm::ivec2(cx, cz));
+    if (found == bucketsIndices.end()) {
+        return 0;
+    }
+    size_t index = found->second;
+    size_t removed = buckets[index].positions.size();
+    count -= removed;
+    removeBucket(index);
+    return removed;
+}
+
+void BlockPositions::next(size_t n, std::vector<glm::ivec3>& dst) {
+    n = std::min(n, count);
+    while (n > 0) {
+        if (bucketCursor >= buckets.size()) {
+            bucketCursor = 0;
+        }
+        const auto& positions = buckets[bucketCursor].positions;
+        if (positionCursor >= positions.size()) {
+            bucketCursor++;
+            positionCursor = 0;
+            continue;
+        }
+        size_t taken = std::min(n, positions.size() - positionCursor);
+        auto begin = positions.begin() + positionCursor;
+        dst.insert(dst.end(), begin, begin + taken);
+        positionCursor += taken;
+        n -= taken;
+    }
+}
+
+void BlockPositions::pop(size_t n, std::vector<glm::ivec3>& dst) {
+    while (n > 0 && !buckets.empty()) {
+        size_t index = buckets.size() - 1;
+        auto& bucket = buckets[index];
+        auto& positions = bucket.positions;
+        size_t taken = std::min(n, positions.size());
+        for (size_t i = 0; i < taken; i++) {
+            const auto& pos = positions[positions.size() - 1 - i];
+            bucket.slots.erase(local_index(pos, bucket.chunk));
+            dst.push_back(pos);
+        }
+        positions.resize(positions.size() - taken);
+        count -= taken;
+        n -= taken;
+        if (positions.empty()) {
+            removeBucket(index);
+        }
+    }
+}
+
+BlockTickScheduler::BlockTickScheduler(const ContentIndices& indices)
+    : indices(indices), entries(indices.blocks.count()) {
+}
+
+BlockTickScheduler::~BlockTickScheduler() = default;
+
+BlockTickScheduler::Entry& BlockTickScheduler::require(blockid_t id) {
+    auto& entry = entries.at(id);
+    if (entry == nullptr) {
+        const auto& def = indices.blocks.require(id);
+        entry = std::make_unique<Entry>();
+        entry->tps = 20.0f / def.tickInterval;
+        activeIds.push_back(id);
+    }
+    return *entry;
+}
+
+BlockEventsBatch& BlockTickScheduler::nextBatch(
+    blockid_t id, BlockEventType type, float tps
+) {
+    if (batchesCount == batches.size()) {
+        batches.emplace_back();
+    }
+    auto& batch = batches[batchesCount++];
+    batch.id = id;
+    batch.type = type;
+    batch.tps = tps;
+    batch.positions.clear();
+    return batch;
+}
+
+void BlockTickScheduler::removeChunk(int cx, int cz) {
+    for (blockid_t id : activeIds) {
+        auto& entry = *entries[id];
+        entry.updating.removeChunk(cx, cz);
+        entry.present.removeChunk(cx, cz);
+    }
+}
+
+util::span<BlockEventsBatch> BlockTickScheduler::process(
+    const std::vector<BlockRegisterEvent>& events
+) {
+    batchesCount = 0;
+    BlockEventsBatch* removedBatch = nullptr;
+    for (const auto& event : events) {
+        if (event.bits & BlockRegisterEvent::CHUNK_REMOVED_BIT) {
+            removeChunk(event.coord.x, event.coord.z);
+            continue;
+        }
+        bool isRegister = event.bits & BlockRegisterEvent::REGISTER_BIT;
+        bool isUpdating = event.bits & BlockRegisterEvent::UPDATING_BIT;
+        bool isPresent = event.bits & BlockRegisterEvent::PRESENT_EVENT_BIT;
+        bool isRemoved = event.bits & BlockRegisterEvent::REMOVED_EVENT_BIT;
+
+        if (!isRegister && isRemoved) {
+            if (removedBatch == nullptr || removedBatch->id != event.id) {
+                auto end = batches.begin() + batchesCount;
+                auto found = std::find_if(
+                    batches.begin(), end, [&event](const auto& batch) {
+                        return batch.id == event.id;
+                    }
+                );
+                if (found == end) {
+                    removedBatch =
+                        &nextBatch(event.id, BlockEventType::removed, 0.0f);
+                } else {
+                    removedBatch = &*found;
+                }
+            }
+            removedBatch->positions.push_back(event.coord);
+        }
+        if (isRegister && isPresent) {
+            auto& entry = require(event.id);
+            entry.present.add(event.coord);
+            entry.presentUpdating |= isUpdating;
+            continue;
+        }
+        if (!isRegister) {
+            if (auto& entry = entries.at(event.id)) {
+                entry->present.remove(event.coord);
+                entry->updating.remove(event.coord);
+            }
+        } else if (isUpdating) {
+            require(event.id).updating.add(event.coord);
+        }
+    }
+    return util::span<BlockEventsBatch>(batches.data(), batchesCount);
+}
+
+/// @brief Subtract time of performed steps keeping the fraction of step,
+/// so ticks rate does not depend on the frame time
+static float advance_timer(float timer, size_t steps, float stepsPerSecond) {
+    timer -= steps / stepsPerSecond;
+    // backlog is dropped
+    return std::max(0.0f, std::min(timer, 1.0f / stepsPerSecond));
+}
+
+util::span<BlockEventsBatch> BlockTickScheduler::update(float delta) {
+    batchesCount = 0;
+    for (blockid_t id : activeIds) {
+        auto& entry = *entries[id];
+        size_t count = entry.updating.size();
+        if (count == 0) {
+            entry.tickTimer = 0.0f;
+            continue;
+        }
+        // ticks of all blocks are spread over the tick interval
+        entry.tickTimer += delta;
+        size_t steps = std::min(
+            count, static_cast<size_t>(entry.tickTimer * entry.tps * count)
+        );
+        if (steps == 0) {
+            continue;
+        }
+        entry.tickTimer = advance_timer(
+            entry.tickTimer, steps, entry.tps * count
+        );
+        auto& batch = nextBatch(id, BlockEventType::tick, entry.tps);
+        entry.updating.next(steps, batch.positions);
+    }
+    for (blockid_t id : activeIds) {
+        auto& entry = *entries[id];
+        size_t count = entry.present.size();
+        if (count == 0) {
+            entry.presentTimer = 0.0f;
+            continue;
+        }
+        entry.presentTimer += delta;
+        size_t steps = std::min(
+            count, static_cast<size_t>(entry.presentTimer * entry.tps * count)
+        );
+        if (steps == 0) {
+            continue;
+        }
+        entry.presentTimer = advance_timer(
+            entry.presentTimer, steps, entry.tps * count
+        );
+        auto& batch = nextBatch(id, BlockEventType::present, entry.tps);
+        entry.present.pop(steps, batch.positions);
+        if (entry.presentUpdating) {
+            for (const auto& pos : batch.positions) {
+                entry.updating.add(pos);
+            }
+        }
+    }
+    return util::span<BlockEventsBatch>(batches.data(), batchesCount);
+}
+
+void BlockTickScheduler::clear() {
+    for (auto& entry : entries) {
+        entry = nullptr;
+    }
+    activeIds.clear();
+    batchesCount = 0;
+}
+
+size_t BlockTickScheduler::countUpdating() const {
+    size_t count = 0;
+    for (blockid_t id : activeIds) {
+        count += entries[id]->updating.size();
+    }
+    return count;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include "typedefs.hpp"
+#include "util/span.hpp"
+#include "voxels/voxel.hpp"
+
+class ContentIndices;
+
+namespace blocks_agent {
+    struct BlockRegisterEvent;
+}
+
+enum class BlockEventType { tick, present, removed };
+
+/// @brief Positions of blocks of a single id and event type
+struct BlockEventsBatch {
+    blockid_t id;
+    BlockEventType type;
+    /// @brief Block ticks per second
+    float tps;
+    std::vector<glm::ivec3> positions;
+};
+
+/// @brief Block positions grouped by chunks. A chunk group is removed at
+/// once, a single position is removed in constant time and iteration
+/// cycles over all positions
+class BlockPositions {
+    struct Bucket {
+        glm::ivec2 chunk;
+        std::vector<glm::ivec3> positions;
+        /// @brief Positions indices by voxel index in the chunk
+        std::unordered_map<uint, uint> slots;
+    };
+    std::vector<Bucket> buckets;
+    std::unordered_map<glm::ivec2, size_t> bucketsIndices;
+    size_t count = 0;
+    /// @brief Cycling iteration position
+    size_t bucketCursor = 0;
+    size_t positionCursor = 0;
+
+    void moveBucket(size_t from, size_t to);
+    void removeBucket(size_t index);
+public:
+    /// @brief Add position if not added yet
+    void add(const glm::ivec3& pos);
+
+    /// @return true if the position was found and removed
+    bool remove(const glm::ivec3& pos);
+
+    /// @brief Remove all positions of the chunk
+    /// @return number of removed positions
+    size_t removeChunk(int cx, int cz);
+
+    /// @brief Append next positions to the list cycling over positions
+    void next(size_t n, std::vector<glm::ivec3>& dst);
+
+    /// @brief Move the last positions to the list
+    void pop(size_t n, std::vector<glm::ivec3>& dst);
+
+    size_t size() const {
+        return count;
+    }
+};
+
+/// @brief Schedules on_block_tick and on_block_present events of blocks
+/// registered by blocks_agent. Each block gets a tick every tick interval
+/// with ticks of a block id spread evenly over frames
+class BlockTickScheduler {
+    struct Entry {
+        /// @brief Block ticks per second
+        float tps;
+        /// @brief Blocks having on_block_tick event
+        BlockPositions updating;
+        /// @brief Blocks waiting for on_block_present event
+        BlockPositions present;
+        float tickTimer = 0.0f;
+        float presentTimer = 0.0f;
+        /// @brief Move blocks from present queue to the updating list
+        bool presentUpdating = false;
+    };
+    const ContentIndices& indices;
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::vector<blockid_t> activeIds;
+    std::vector<BlockEventsBatch> batches;
+    size_t batchesCount = 0;
+
+    Entry& require(blockid_t id);
+    BlockEventsBatch& nextBatch(blockid_t id, BlockEventType type, float tps);
+    void removeChunk(int cx, int cz);
+public:
+    BlockTickScheduler(const ContentIndices& indices);
+    ~BlockTickScheduler();
+
+    /// @brief Apply blocks registration events
+    /// @return on_block_removed events batches (valid until next call)
+    util::span<BlockEventsBatch> process(
+        const std::vector<blocks_agent::BlockRegisterEvent>& events
+    );
+
+    /// @brief Advance timers
+    /// @param delta time elapsed since the previous update in seconds
+    /// @return on_block_tick and on_block_present events batches
+    /// (valid until next call)
+    util::span<BlockEventsBatch> update(float delta);
+
+    /// @brief Remove all blocks
+    void clear();
+
+    /// @return number of blocks having on_block_tick event
+    size_t countUpdating() const;
+};
@@ -1,7 +1,5 @@
 #include "BlocksController.hpp"
 
-#include <set>
-
 #include "content/Content.hpp"
 #include "items/Inventories.hpp"
 #include "items/Inventory.hpp"
@@ -25,7 +23,8 @@ BlocksController::BlocksController(const Level& level, Lighting* lighting)
       lighting(lighting),
       randTickClock(20, 3),
       blocksTickClock(20, 3),
-      worldTickClock(20, 1) {
+      worldTickClock(20, 1),
+      tickScheduler(*level.content.getIndices()) {
 }
 
 void BlocksController::updateSides(int x, int y, int z) {
@@ -144,46 +143,53 @@ void BlocksController::onBlocksTick(int tickid, int parts) {
     }
 }
 
+/// @brief Random ticks per section. Same voxel rate as 4 ticks per
+/// quarter of the chunk height
+static inline constexpr int SECTION_RANDOM_TICKS =
+    16 * VOXELS_SECTION_H / CHUNK_H;
+
 void BlocksController::randomTick(
-    const Chunk& chunk, int segments, const ContentIndices* indices
+    Chunk& chunk, const ContentIndices& indices
 ) {
-    const int segheight = CHUNK_H / segments;
-
-    for (int s = 0; s < segments; s++) {
-        for (int i = 0; i < 4; i++) {
-            int segmentY = s * segheight;
-            if (segmentY  > chunk.top) {
-                break;
-            }
+    if (!chunk.flags.randomTicksCounted) {
+        blocks_agent::count_random_tick_blocks(indices, chunk);
+    }
+    for (int s = 0; s < VOXELS_SECTIONS; s++) {
+        // sections without random updating blocks are skipped
+        if (chunk.randomTickBlocks[s] == 0) {
+            continue;
+        }
+        for (int i = 0; i < SECTION_RANDOM_TICKS; i++) {
             int bx = random.rand() % CHUNK_W;
-            int by = random.rand() % segheight + segmentY;
+            int by = random.rand() % VOXELS_SECTION_H + s * VOXELS_SECTION_H;
             int bz = random.rand() % CHUNK_D;
-            const voxel& vox = chunk.voxels[vox_index(bx, by, bz)];
-            auto& block = indices->blocks.require(vox.id);
-            if (block.rt.funcsset.randupdate) {
-                scripting::random_update_block(
-                    block,
-                    glm::ivec3(
-                        chunk.x * CHUNK_W + bx, by, chunk.z * CHUNK_D + bz
-                    )
-                );
+            blockid_t id = chunk.getVoxel(vox_index(bx, by, bz)).id;
+            if (!indices.blocks.require(id).rt.funcsset.randupdate) {
+                continue;
             }
+            auto& positions = randomTickPositions[id];
+            if (positions.empty()) {
+                randomTickIds.push_back(id);
+            }
+            positions.emplace_back(
+                chunk.x * CHUNK_W + bx, by, chunk.z * CHUNK_D + bz
+            );
         }
     }
 }
 
 void BlocksController::randomTick(int tickid, int parts, uint padding) {
-    auto indices = level.content.getIndices();
-
-    std::set<uint64_t> chunksIterated;
+    const auto& indices = *level.content.getIndices();
+    randomTickPositions.resize(indices.blocks.count());
 
+    // chunks shared by players are stamped to be ticked once
+    if (++randomTickGeneration == 0) {
+        randomTickGeneration = 1;
+    }
     for (const auto& [pid, player] : *level.players) {
         const auto& chunks = *player->chunks;
-        int offsetX = chunks.getOffsetX();
-        int offsetY = chunks.getOffsetY();
         int width = chunks.getWidth();
         int height = chunks.getHeight();
-        int segments = 4;
 
         for (uint z = padding; z < height - padding; z++) {
             for (uint x = padding; x < width - padding; x++) {
@@ -192,23 +198,21 @@ void BlocksController::randomTick(int tickid, int parts, uint padding) {
                     continue;
                 }
                 auto& chunk = chunks.getChunks()[index];
-                if (chunk == nullptr || !chunk->flags.lighted) {
+                if (chunk == nullptr || !chunk->flags.lighted ||
+                    chunk->randomTickStamp == randomTickGeneration) {
                     continue;
                 }
-                union {
-                    int32_t pos[2];
-                    uint64_t key;
-                } posU;
-                posU.pos[0] = x + offsetX;
-                posU.pos[1] = z + offsetY;
-                if (chunksIterated.find(posU.key) != chunksIterated.end()) {
-                    continue;
-                }
-                chunksIterated.insert(posU.key);
-                randomTick(*chunk, segments, indices);
+                chunk->randomTickStamp = randomTickGeneration;
+                randomTick(*chunk, indices);
             }
         }
     }
+    for (blockid_t id : randomTickIds) {
+        auto& positions = randomTickPositions[id];
+        scripting::random_update_blocks(indices.blocks.require(id), positions);
+        positions.clear();
+    }
+    randomTickIds.clear();
 }
 
 int64_t BlocksController::createBlockInventory(int x, int y, int z) {
@@ -223,7 +227,7 @@ int64_t BlocksController::createBlockInventory(int x, int y, int z) {
     auto inv = chunk->getBlockInventory(lx, y, lz);
     if (inv == nullptr) {
         const auto& indices = level.content.getIndices()->blocks;
-        auto& def = indices.require(chunk->voxels[vox_index(lx, y, lz)].id);
+        auto& def = indices.require(chunk->getVoxel(vox_index(lx, y, lz)).id);
         int invsize = def.inventorySize;
         if (invsize == 0) {
             return 0;
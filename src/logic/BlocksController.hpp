@@ -3,6 +3,7 @@
 #include <functional>
 #include <glm/glm.hpp>
 
+#include "BlockTickScheduler.hpp"
 #include "maths/fastmaths.hpp"
 #include "typedefs.hpp"
 #include "util/Clock.hpp"
@@ -32,7 +33,15 @@ class BlocksController {
     util::Clock blocksTickClock;
     util::Clock worldTickClock;
     FastRandom random {};
+    BlockTickScheduler tickScheduler;
     std::vector<on_block_interaction> blockInteractionCallbacks;
+    /// @brief Random tick positions indexed by block id
+    std::vector<std::vector<glm::ivec3>> randomTickPositions;
+    /// @brief Ids of blocks having random tick positions
+    std::vector<blockid_t> randomTickIds;
+    /// @brief Random tick generation. Chunks stamped with the current
+    /// generation are ticked already
+    uint32_t randomTickGeneration = 0;
 public:
     BlocksController(const Level& level, Lighting* lighting);
 
@@ -46,9 +55,10 @@ public:
     );
 
     void update(float delta, uint padding);
-    void randomTick(
-        const Chunk& chunk, int segments, const ContentIndices* indices
-    );
+    /// @brief Select random positions in chunk sections having blocks
+    /// with on_random_update event. Events are emitted by randomTick(...)
+    /// in one call per block id
+    void randomTick(Chunk& chunk, const ContentIndices& indices);
     void randomTick(int tickid, int parts, uint padding);
     void onBlocksTick(int tickid, int parts);
     int64_t createBlockInventory(int x, int y, int z);
@@ -61,4 +71,8 @@ public:
 
     /// @brief Add block interaction callback
     void listenBlockInteraction(const on_block_interaction& callback);
+
+    BlockTickScheduler& getTickScheduler() {
+        return tickScheduler;
+    }
 };
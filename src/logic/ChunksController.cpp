@@ -10,6 +10,7 @@
 #include "maths/voxmaths.hpp"
 #include "util/timeutil.hpp"
 #include "objects/Player.hpp"
+#include "objects/Players.hpp"
 #include "voxels/Block.hpp"
 #include "voxels/Chunk.hpp"
 #include "voxels/Chunks.hpp"
@@ -21,20 +22,59 @@
 
 const uint MAX_WORK_PER_FRAME = 128;
 const uint MIN_SURROUNDING = 9;
+/// @brief Max number of chunks being generated per worker
+const uint MAX_GENERATING_PER_WORKER = 4;
+/// @brief Max number of chunks lighted at once per lighting worker
+const uint LIGHTS_BATCH_PER_WORKER = 2;
+/// @brief Max number of generated chunks kept while no player needs them
+const uint MAX_UNCLAIMED_CHUNKS = 64;
 
-ChunksController::ChunksController(Level& level)
+class ChunkGenWorker : public util::Worker<ChunkGenJob, ChunkGenResult> {
+    const WorldGenerator& generator;
+public:
+    ChunkGenWorker(const WorldGenerator& generator) : generator(generator) {
+    }
+
+    ChunkGenResult operator()(const ChunkGenJob& job) override {
+        auto& chunk = *job.chunk;
+        generator.generate(job.prepared, chunk.getVoxels());
+        chunk.updateHeights();
+        return ChunkGenResult {job.index, job.chunk};
+    }
+};
+
+ChunksController::ChunksController(Level& level, int generatorWorkers)
     : level(level),
       generator(std::make_unique<WorldGenerator>(
           level.content.generators.require(level.getWorld()->getGenerator()),
           level.content,
           level.getWorld()->getSeed()
-      )) {}
+      )) {
+    if (generatorWorkers > 0) {
+        genPool = std::make_unique<
+            util::ThreadPool<ChunkGenJob, ChunkGenResult>>(
+            "chunks-gen-pool",
+            [this]() {
+                return std::make_shared<ChunkGenWorker>(*generator);
+            },
+            [this](ChunkGenResult& result) {
+                generated.emplace(result.index, std::move(result));
+            },
+            generatorWorkers
+        );
+    }
+}
 
 ChunksController::~ChunksController() = default;
 
 void ChunksController::update(
     int64_t maxDuration, int loadDistance, uint padding, Player& player
-) const {
+) {
+    if (genPool) {
+        genPool->update();
+        commitGenerated();
+    }
+
     const auto& position = player.getPosition();
     int centerX = floordiv<CHUNK_W>(glm::floor(position.x));
     int centerY = floordiv<CHUNK_D>(glm::floor(position.z));
@@ -77,15 +117,9 @@ bool ChunksController::isInLoadingZone(
     return distance < minDistance;
 }
 
-bool ChunksController::loadVisible(const Player& player, uint padding) const {
-    auto& chunks = *player.chunks;
+void ChunksController::unloadFar(Chunks& chunks) const {
     int sizeX = chunks.getWidth();
     int sizeY = chunks.getHeight();
-
-    int nearX = 0;
-    int nearZ = 0;
-    bool assigned = false;
-    int minDistance = ((sizeX - padding * 2) / 2) * ((sizeY - padding * 2) / 2);
     int maxDistance = ((sizeX) / 2) * ((sizeY) / 2);
     for (uint z = 0; z < sizeY; z++) {
         for (uint x = 0; x < sizeX; x++) {
@@ -94,90 +128,163 @@ bool ChunksController::loadVisible(const Player& player, uint padding) const {
             int lz = z - sizeY / 2;
             int distance = (lx * lx + lz * lz);
             auto& chunk = chunks.getChunks()[index];
-            if (chunk != nullptr) {
-                if (distance >= maxDistance) {
-                    chunks.remove(
-                        x + chunks.getOffsetX(), z + chunks.getOffsetY()
-                    );
-                }
-                continue;
+            if (chunk != nullptr && distance >= maxDistance) {
+                chunks.remove(x + chunks.getOffsetX(), z + chunks.getOffsetY());
             }
         }
     }
-    for (uint z = padding; z < sizeY - padding; z++) {
-        for (uint x = padding; x < sizeX - padding; x++) {
-            int index = z * sizeX + x;
-            int lx = x - sizeX / 2;
-            int lz = z - sizeY / 2;
-            int distance = (lx * lx + lz * lz);
-            auto& chunk = chunks.getChunks()[index];
-            if (chunk != nullptr) {
-                if (chunk->flags.loaded && !chunk->flags.lighted) {
-                    if (buildLights(player, chunk)) {
-                        return true;
+}
+
+bool ChunksController::loadVisible(const Player& player, uint padding) {
+    auto& chunks = *player.chunks;
+    int sizeX = chunks.getWidth();
+    int sizeY = chunks.getHeight();
+    int offsetX = chunks.getOffsetX();
+    int offsetY = chunks.getOffsetY();
+
+    auto& queue = loadQueues[player.getId()];
+    if (chunks.getRemovalsGeneration() != queue.chunksGeneration) {
+        // chunks were removed since the last update
+        queue.entries.reset();
+    }
+    if (queue.entries.update(sizeX, sizeY, padding, offsetX, offsetY)) {
+        unloadFar(chunks);
+    }
+    queue.chunksGeneration = chunks.getRemovalsGeneration();
+
+    int minDistance = queue.entries.getLoadingDistance();
+    const auto& buffer = chunks.getChunks();
+    size_t maxLightsBatch =
+        (lighting ? lighting->getWorkersCount() : 1) * LIGHTS_BATCH_PER_WORKER;
+    std::vector<std::shared_ptr<Chunk>> lightsBatch;
+    bool finished = true;
+    for (size_t i = queue.entries.getCursor(); i < queue.entries.size(); i++) {
+        const auto& entry = queue.entries[i];
+        const auto& chunk = buffer[entry.z * sizeX + entry.x];
+        if (chunk != nullptr) {
+            // chunks at the loading circle edge are never surrounded
+            if (chunk->flags.loaded && !chunk->flags.lighted &&
+                entry.surroundable) {
+                if (isSurrounded(chunks, *chunk)) {
+                    lightsBatch.push_back(chunk);
+                    if (lightsBatch.size() >= maxLightsBatch) {
+                        break;
                     }
                 }
-                continue;
+                finished = false;
+            } else if (finished) {
+                queue.entries.setCursor(i + 1);
             }
-
-            if (distance < minDistance) {
-                minDistance = distance;
-                nearX = x;
-                nearZ = z;
-                assigned = true;
+            continue;
+        }
+        if (!lightsBatch.empty()) {
+            // nearer chunks lights go first
+            break;
+        }
+        if (entry.distance >= minDistance) {
+            // entries are sorted by distance, the rest are out of the
+            // loading circle
+            if (finished) {
+                queue.entries.setCursor(queue.entries.size());
             }
+            break;
+        }
+        if (!generating.empty() &&
+            generating.find({entry.x + offsetX, entry.z + offsetY}) !=
+                generating.end()) {
+            finished = false;
+            continue;
+        }
+        if (!player.isLoadingChunks()) {
+            return false;
         }
+        return createChunk(player, entry.x + offsetX, entry.z + offsetY);
     }
+    if (!lightsBatch.empty()) {
+        buildLights(lightsBatch);
+        return true;
+    }
+    return false;
+}
 
-    const auto& chunk = chunks.getChunks()[nearZ * sizeX + nearX];
-    if (chunk != nullptr || !assigned || !player.isLoadingChunks()) {
-        return false;
+void ChunksController::removePlayer(u64id_t playerId) {
+    loadQueues.erase(playerId);
+}
+
+void ChunksController::resetLoadQueues() {
+    for (auto& [_, queue] : loadQueues) {
+        queue.entries.reset();
     }
-    int offsetX = chunks.getOffsetX();
-    int offsetY = chunks.getOffsetY();
-    createChunk(player, nearX + offsetX, nearZ + offsetY);
-    return true;
 }
 
-bool ChunksController::buildLights(
-    const Player& player, const std::shared_ptr<Chunk>& chunk
-) const {
+bool ChunksController::isSurrounded(const Chunks& chunks, const Chunk& chunk) {
     int surrounding = 0;
     for (int oz = -1; oz <= 1; oz++) {
         for (int ox = -1; ox <= 1; ox++) {
-            if (player.chunks->getChunk(chunk->x + ox, chunk->z + oz))
+            if (chunks.getChunk(chunk.x + ox, chunk.z + oz))
                 surrounding++;
         }
     }
-    if (surrounding == MIN_SURROUNDING) {
-        if (lighting && chunk->lightmap) {
-            bool lightsCache = chunk->flags.loadedLights;
-            if (!lightsCache) {
-                lighting->buildSkyLight(chunk->x, chunk->z);
+    return surrounding == MIN_SURROUNDING;
+}
+
+void ChunksController::buildLights(
+    const std::vector<std::shared_ptr<Chunk>>& chunks
+) const {
+    if (lighting) {
+        std::vector<glm::ivec2> positions;
+        for (const auto& chunk : chunks) {
+            if (chunk->lightmap) {
+                positions.emplace_back(chunk->x, chunk->z);
             }
-            lighting->onChunkLoaded(chunk->x, chunk->z, !lightsCache);
         }
+        lighting->buildChunksLights(positions);
+    }
+    for (const auto& chunk : chunks) {
         chunk->flags.lighted = true;
-        return true;
     }
-    return false;
 }
 
-void ChunksController::createChunk(const Player& player, int x, int z) const {
+bool ChunksController::createChunk(const Player& player, int x, int z) {
     if (!player.isLoadingChunks()) {
         if (auto chunk = level.chunks->fetch(x, z)) {
             player.chunks->putChunk(chunk);
         }
-        return;
+        return true;
+    }
+    if (genPool && generating.size() >=
+        genPool->getWorkersCount() * MAX_GENERATING_PER_WORKER) {
+        return false;
+    }
+    if (auto chunk = level.chunks->commitPending(x, z)) {
+        // generated while no player needed it
+        player.chunks->putChunk(chunk);
+        finishChunk(chunk);
+        return true;
     }
     auto chunk = level.chunks->create(x, z, lighting != nullptr);
-    player.chunks->putChunk(chunk);
     auto& chunkFlags = chunk->flags;
+    if (!chunkFlags.loaded && genPool) {
+        // hide the chunk until generated
+        level.chunks->setPending(chunk);
+        generating[{x, z}] = chunk;
+        genPool->enqueueJob(
+            ChunkGenJob {nextJobIndex++, chunk, generator->prepare(x, z)}
+        );
+        return true;
+    }
+    player.chunks->putChunk(chunk);
     if (!chunkFlags.loaded) {
-        generator->generate(chunk->voxels, x, z);
+        generator->generate(chunk->getVoxels(), x, z);
         chunkFlags.unsaved = true;
     }
     chunk->updateHeights();
+    finishChunk(chunk);
+    return true;
+}
+
+void ChunksController::finishChunk(const std::shared_ptr<Chunk>& chunk) const {
+    auto& chunkFlags = chunk->flags;
     level.events->trigger(LevelEventType::CHUNK_PRESENT, chunk.get());
     if (!chunkFlags.loadedLights && chunk->lightmap) {
         Lighting::prebuildSkyLight(*chunk, *level.content.getIndices());
@@ -185,3 +292,46 @@ void ChunksController::createChunk(const Player& player, int x, int z) const {
     chunkFlags.loaded = true;
     chunkFlags.ready = true;
 }
+
+void ChunksController::commitGenerated() {
+    while (!generated.empty() && generated.begin()->first == nextCommitIndex) {
+        auto result = std::move(generated.begin()->second);
+        generated.erase(generated.begin());
+        nextCommitIndex++;
+
+        auto chunk = std::move(result.chunk);
+        generating.erase({chunk->x, chunk->z});
+        chunk->flags.unsaved = true;
+
+        bool claimed = false;
+        for (auto player : level.players->getAll()) {
+            if (player->chunks == nullptr ||
+                !player->chunks->isInside(chunk->x, chunk->z)) {
+                continue;
+            }
+            if (!claimed) {
+                level.chunks->commitPending(chunk->x, chunk->z);
+                claimed = true;
+            }
+            player->chunks->putChunk(chunk);
+        }
+        if (claimed) {
+            finishChunk(chunk);
+        } else {
+            keepUnclaimed(chunk->x, chunk->z);
+        }
+    }
+}
+
+void ChunksController::keepUnclaimed(int x, int z) {
+    unclaimed.emplace_back(x, z);
+    if (unclaimed.size() <= MAX_UNCLAIMED_CHUNKS) {
+        return;
+    }
+    auto pos = unclaimed.front();
+    unclaimed.pop_front();
+    // the position may be claimed and being generated again since then
+    if (generating.find(pos) == generating.end()) {
+        level.chunks->erasePending(pos.x, pos.y);
+    }
+}
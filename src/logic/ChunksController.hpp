@@ -1,39 +1,105 @@
 #pragma once
 
+#include <deque>
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
 
 #include "typedefs.hpp"
+#include "ChunksLoadQueue.hpp"
+#include "util/ThreadPool.hpp"
+#include "world/generator/WorldGenerator.hpp"
 
 class Level;
 class Chunk;
 class Chunks;
 class Player;
 class Lighting;
-class WorldGenerator;
+
+struct ChunkGenJob {
+    /// @brief Job sequence number used to commit results in enqueue order
+    uint64_t index;
+    /// @brief Target chunk. Pending in GlobalChunks until committed
+    std::shared_ptr<Chunk> chunk;
+    PreparedChunk prepared;
+};
+
+struct ChunkGenResult {
+    uint64_t index;
+    std::shared_ptr<Chunk> chunk;
+};
 
 /// @brief ChunksController manages chunks dynamic loading/unloading
 class ChunksController {
 private:
     Level& level;
     std::unique_ptr<WorldGenerator> generator;
+    /// @brief Chunks being generated by workers
+    std::unordered_map<glm::ivec2, std::shared_ptr<Chunk>> generating;
+    /// @brief Generated chunks waiting to be committed in enqueue order
+    std::map<uint64_t, ChunkGenResult> generated;
+    uint64_t nextJobIndex = 0;
+    uint64_t nextCommitIndex = 0;
+    /// @brief Chunk generation workers. nullptr if chunks are generated
+    /// on the main thread
+    std::unique_ptr<util::ThreadPool<ChunkGenJob, ChunkGenResult>> genPool;
+    /// @brief Generated chunks not needed by any player when committed.
+    /// They are kept pending in GlobalChunks until requested or evicted
+    std::deque<glm::ivec2> unclaimed;
 
-    /// @brief Process one chunk: load it or calculate lights for it
-    bool loadVisible(const Player& player, uint padding) const;
-    bool buildLights(const Player& player, const std::shared_ptr<Chunk>& chunk) const;
-    void createChunk(const Player& player, int x, int y) const;
+    struct PlayerLoadQueue {
+        ChunksLoadQueue entries;
+        /// @brief Player chunks removals generation after the last
+        /// queue update
+        uint64_t chunksGeneration = 0;
+    };
+    std::unordered_map<u64id_t, PlayerLoadQueue> loadQueues;
+
+    /// @brief Remove chunks out of the matrix loading circle
+    void unloadFar(Chunks& chunks) const;
+
+    /// @brief Load one chunk or calculate lights for a batch of chunks
+    bool loadVisible(const Player& player, uint padding);
+    /// @brief Check if all chunks in 3x3 area around the chunk are present
+    static bool isSurrounded(const Chunks& chunks, const Chunk& chunk);
+    void buildLights(const std::vector<std::shared_ptr<Chunk>>& chunks) const;
+    /// @brief Create, load or generate the chunk.
+    /// The position must not be being generated
+    /// @return false if the chunk can't be created now
+    bool createChunk(const Player& player, int x, int y);
+    /// @brief Chunk is ready to be shown: notify and prepare it
+    void finishChunk(const std::shared_ptr<Chunk>& chunk) const;
+    /// @brief Commit generated chunks to the level in enqueue order
+    void commitGenerated();
+    /// @brief Keep generated chunk pending, evicting the oldest ones
+    void keepUnclaimed(int x, int z);
 public:
     std::unique_ptr<Lighting> lighting;
 
-    ChunksController(Level& level);
+    /// @param generatorWorkers number of chunk generation workers
+    /// (0 - generate chunks on the main thread)
+    ChunksController(Level& level, int generatorWorkers = 0);
     ~ChunksController();
 
     /// @param maxDuration milliseconds reserved for chunks loading
     void update(
         int64_t maxDuration, int loadDistance, uint padding, Player& player
-    ) const;
+    );
 
     bool isInLoadingZone(const Player& player, uint padding, int x, int z) const;
 
+    /// @brief Release the player chunks loading state
+    void removePlayer(u64id_t playerId);
+
+    /// @brief Restart chunks loading from the nearest positions.
+    /// Call when loaded chunks need to be processed again (e.g. lights reset)
+    void resetLoadQueues();
+
     const WorldGenerator* getGenerator() const {
         return generator.get();
     }
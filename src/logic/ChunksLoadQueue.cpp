@@ -0,0 +1,57 @@
+#include "ChunksLoadQueue.hpp"
+
+#include <algorithm>
+
+bool ChunksLoadQueue::update(
+    int width, int height, uint padding, int offsetX, int offsetZ
+) {
+    if (this->width != width || this->height != height ||
+        this->padding != padding) {
+        this->width = width;
+        this->height = height;
+        this->padding = padding;
+
+        int innerWidth = width - static_cast<int>(padding) * 2;
+        int innerHeight = height - static_cast<int>(padding) * 2;
+        loadingDistance = (innerWidth / 2) * (innerHeight / 2);
+        auto inCircle = [this](int x, int z) {
+            int lx = x - this->width / 2;
+            int lz = z - this->height / 2;
+            return lx * lx + lz * lz < loadingDistance;
+        };
+        entries.clear();
+        for (int z = padding; z < height - static_cast<int>(padding); z++) {
+            for (int x = padding; x < width - static_cast<int>(padding); x++) {
+                int lx = x - width / 2;
+                int lz = z - height / 2;
+                bool surroundable = true;
+                for (int oz = -1; oz <= 1; oz++) {
+                    for (int ox = -1; ox <= 1; ox++) {
+                        surroundable &= inCircle(x + ox, z + oz);
+                    }
+                }
+                entries.push_back(
+                    Entry {x, z, lx * lx + lz * lz, surroundable}
+                );
+            }
+        }
+        // stable sort keeps row-major order for equal distances
+        std::stable_sort(
+            entries.begin(),
+            entries.end(),
+            [](const auto& a, const auto& b) {
+                return a.distance < b.distance;
+            }
+        );
+    } else if (this->offsetX == offsetX && this->offsetZ == offsetZ) {
+        return false;
+    }
+    this->offsetX = offsetX;
+    this->offsetZ = offsetZ;
+    cursor = 0;
+    return true;
+}
+
+void ChunksLoadQueue::reset() {
+    cursor = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include "typedefs.hpp"
+
+/// @brief Chunks matrix positions sorted by distance to the matrix centre.
+/// Loading is resumed from the first unfinished position, so the matrix is
+/// rescanned only when its size, padding or position changes.
+class ChunksLoadQueue {
+public:
+    struct Entry {
+        /// @brief Position in chunks matrix
+        int x, z;
+        /// @brief Squared distance to the matrix centre
+        int distance;
+        /// @brief All 3x3 chunks around are in the loading circle,
+        /// so the chunk may be lighted
+        bool surroundable;
+    };
+private:
+    std::vector<Entry> entries;
+    int width = 0;
+    int height = 0;
+    uint padding = 0;
+    int offsetX = 0;
+    int offsetZ = 0;
+    int loadingDistance = 0;
+    /// @brief Index of the first unfinished entry
+    size_t cursor = 0;
+public:
+    /// @brief Sync queue with the chunks matrix
+    /// @param width chunks matrix width
+    /// @param height chunks matrix height
+    /// @param padding matrix border not used for loading
+    /// @param offsetX chunks matrix offset X
+    /// @param offsetZ chunks matrix offset Z
+    /// @return true if the queue was reset (the matrix moved or resized)
+    bool update(int width, int height, uint padding, int offsetX, int offsetZ);
+
+    /// @brief Restart iteration from the nearest position
+    void reset();
+
+    /// @brief Mark all entries before the index as finished
+    void setCursor(size_t index) {
+        cursor = index;
+    }
+
+    /// @brief Squared radius of the loading circle. Positions at this
+    /// distance and further are not loaded
+    int getLoadingDistance() const {
+        return loadingDistance;
+    }
+
+    size_t getCursor() const {
+        return cursor;
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    const Entry& operator[](size_t index) const {
+        return entries[index];
+    }
+};
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 
+#include "content/Content.hpp"
 #include "debug/Logger.hpp"
 #include "engine/Engine.hpp"
 #include "world/files/WorldFiles.hpp"
@@ -11,6 +12,7 @@
 #include "objects/Player.hpp"
 #include "physics/Hitbox.hpp"
 #include "voxels/Chunks.hpp"
+#include "voxels/GlobalChunks.hpp"
 #include "voxels/Pathfinding.hpp"
 #include "scripting/scripting.hpp"
 #include "lighting/Lighting.hpp"
@@ -26,8 +28,15 @@ LevelController::LevelController(
 )
     : settings(engine->getSettings()),
       level(std::move(levelPtr)),
-      chunks(std::make_unique<ChunksController>(*level)),
-      playerTickClock(20, 3) {
+      chunks(std::make_unique<ChunksController>(
+          *level, settings.chunks.generatorWorkers.get()
+      )),
+      playerTickClock(20, 3),
+      voxelsPackClock(1, 40) {
+    level->entities->setPhysicsWorkers(settings.physics.workers.get());
+    level->entities->setTickLodDistance(
+        settings.entities.tickLodDistance.get()
+    );
     
     level->events->listen(LevelEventType::CHUNK_PRESENT, [](auto, Chunk* chunk) {
         scripting::on_chunk_present(*chunk, chunk->flags.loaded);
@@ -38,7 +47,9 @@ LevelController::LevelController(
 
     if (clientPlayer) {
         chunks->lighting = std::make_unique<Lighting>(
-            level->content, *clientPlayer->chunks
+            *level->content.getIndices(),
+            *clientPlayer->chunks,
+            settings.chunks.lightingWorkers.get()
         );
     }
     blocks = std::make_unique<BlocksController>(
@@ -119,6 +130,12 @@ void LevelController::update(float delta, bool pause) {
         }
     }
     level->entities->clean();
+
+    if (settings.chunks.packVoxels.get() && voxelsPackClock.update(delta)) {
+        level->chunks->packIdleVoxels(
+            voxelsPackClock.getPart(), voxelsPackClock.getParts()
+        );
+    }
 }
 
 void LevelController::processBeforeQuit() {
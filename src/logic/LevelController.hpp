@@ -21,6 +21,7 @@ class LevelController {
     std::unique_ptr<ChunksController> chunks;
 
     util::Clock playerTickClock;
+    util::Clock voxelsPackClock;
 public:
     CallbacksSet<> preQuitCallbacks;
 
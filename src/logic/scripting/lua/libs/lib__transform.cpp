@@ -9,9 +9,7 @@ static int l_get_pos(lua::State* L) {
 
 static int l_set_pos(lua::State* L) {
     if (auto entity = get_entity(L, 1)) {
-        auto vec = lua::tovec3(L, 2);
-        entity->getTransform().setPos(vec);
-        entity->getRigidbody().hitbox.position = vec;
+        entity->setPos(lua::tovec3(L, 2));
     }
     return 0;
 }
@@ -214,8 +214,8 @@ static int l_set_states(lua::State* L) {
     }
     int lx = x - cx * CHUNK_W;
     int lz = z - cz * CHUNK_D;
-    chunk->voxels[vox_index(lx, y, lz)].state = int2blockstate(states);
-    chunk->setModifiedAndUnsaved();
+    chunk->getVoxels()[vox_index(lx, y, lz)].state = int2blockstate(states);
+    chunk->setModifiedAndUnsaved(y);
     return 0;
 }
 
@@ -282,7 +282,7 @@ static int l_set_user_bits(lua::State* L) {
     }
     int lx = x - cx * CHUNK_W;
     int lz = z - cz * CHUNK_D;
-    auto vox = &chunk->voxels[vox_index(lx, y, lz)];
+    auto vox = &chunk->getVoxels()[vox_index(lx, y, lz)];
     const auto& def = content->getIndices()->blocks.require(vox->id);
     if (def.rt.extended) {
         auto origin = blocks_agent::seek_origin(chunks, {x, y, z}, def, vox->state);
@@ -310,7 +310,7 @@ static int l_set_variant(lua::State* L) {
     }
     int lx = x - cx * CHUNK_W;
     int lz = z - cz * CHUNK_D;
-    auto vox = &chunk->voxels[vox_index(lx, y, lz)];
+    auto vox = &chunk->getVoxels()[vox_index(lx, y, lz)];
     const auto& def = content->getIndices()->blocks.require(vox->id);
 
     if (def.variants == nullptr) {
@@ -614,7 +614,7 @@ static int l_get_field(lua::State* L) {
     auto lz = z - cz * CHUNK_W;
     size_t voxelIndex = vox_index(lx, y, lz);
 
-    const auto& vox = chunk->voxels[voxelIndex];
+    voxel vox = chunk->getVoxel(voxelIndex);
     const auto& def = content->getIndices()->blocks.require(vox.id);
     if (def.dataStruct == nullptr) {
         return 0;
@@ -683,7 +683,7 @@ static int l_set_field(lua::State* L) {
         return 0;
     }
     size_t voxelIndex = vox_index(lx, y, lz);
-    const auto& vox = chunk->voxels[voxelIndex];
+    voxel vox = chunk->getVoxel(voxelIndex);
 
     const auto& def = content->getIndices()->blocks.require(vox.id);
     if (def.dataStruct == nullptr) {
@@ -742,25 +742,71 @@ static int l_get_tags(lua::State* L) {
     return 0;
 }
 
-static int l_pull_register_events(lua::State* L) {
-    auto events = blocks_agent::pull_register_events();
-    if (events.empty())
-        return 0;
+static int get_event_id(const Block& def, BlockEventType type) {
+    const auto& events = def.rt.funcsset.events;
+    switch (type) {
+        case BlockEventType::tick: return events.blocktick;
+        case BlockEventType::present: return events.blockpresent;
+        case BlockEventType::removed: return events.blockremoved;
+    }
+    return 0;
+}
 
-    lua::createtable(L, events.size() * 4, 0);
-    for (int i = 0; i < events.size(); i++) {
-        const auto& event = events[i];
-        lua::pushinteger(L, static_cast<int>(event.bits) | event.id << 16);
-        lua::rawseti(L, i * 4 + 1);
+/// @brief Push batches as {event, coords, tps, ...} table where event is
+/// interned event id, coords is {x1, y1, z1, x2, ...} and tps is false
+/// for non-tick events
+static int push_events_batches(
+    lua::State* L, util::span<BlockEventsBatch> batches
+) {
+    if (batches.size() == 0) {
+        return 0;
+    }
+    lua::createtable(L, batches.size() * 3, 0);
+    for (size_t i = 0; i < batches.size(); i++) {
+        const auto& batch = batches[i];
+        const auto& def = indices->blocks.require(batch.id);
+        lua::pushinteger(L, get_event_id(def, batch.type));
+        lua::rawseti(L, i * 3 + 1);
+
+        const auto& positions = batch.positions;
+        lua::createtable(L, positions.size() * 3, 0);
+        for (size_t j = 0; j < positions.size(); j++) {
+            for (int k = 0; k < 3; k++) {
+                lua::pushinteger(L, positions[j][k]);
+                lua::rawseti(L, j * 3 + k + 1);
+            }
+        }
+        lua::rawseti(L, i * 3 + 2);
 
-        for (int j = 0; j < 3; j++) {
-            lua::pushinteger(L, event.coord[j]);
-            lua::rawseti(L, i * 4 + j + 2);
+        if (batch.type == BlockEventType::tick) {
+            lua::pushnumber(L, batch.tps);
+        } else {
+            lua::pushboolean(L, false);
         }
+        lua::rawseti(L, i * 3 + 3);
     }
     return 1;
 }
 
+static int l_process_register_events(lua::State* L) {
+    auto events = blocks_agent::pull_register_events();
+    if (blocks == nullptr || events.empty()) {
+        return 0;
+    }
+    return push_events_batches(
+        L, blocks->getTickScheduler().process(events)
+    );
+}
+
+static int l_perform_ticks(lua::State* L) {
+    if (blocks == nullptr) {
+        return 0;
+    }
+    return push_events_batches(
+        L, blocks->getTickScheduler().update(lua::tonumber(L, 1))
+    );
+}
+
 const luaL_Reg blocklib[] = {
     {"index", lua::wrap<l_index>},
     {"name", lua::wrap<l_get_def>},
@@ -802,6 +848,7 @@ const luaL_Reg blocklib[] = {
     {"reload_script", lua::wrap<l_reload_script>},
     {"has_tag", lua::wrap<l_has_tag>},
     {"__get_tags", lua::wrap<l_get_tags>},
-    {"__pull_register_events", lua::wrap<l_pull_register_events>},
+    {"__process_register_events", lua::wrap<l_process_register_events>},
+    {"__perform_ticks", lua::wrap<l_perform_ticks>},
     {nullptr, nullptr}
 };
@@ -2,6 +2,7 @@
 #include <glm/glm.hpp>
 
 #include "items/Inventory.hpp"
+#include "logic/LevelController.hpp"
 #include "libentity.hpp"
 #include "objects/Entities.hpp"
 #include "objects/Entity.hpp"
@@ -313,6 +314,9 @@ static int l_delete(lua::State* L) {
     auto id = lua::tointeger(L, 1);
     level->players->suspend(id);
     level->players->remove(id);
+    if (controller) {
+        controller->getChunksController()->removePlayer(id);
+    }
     return 0;
 }
 
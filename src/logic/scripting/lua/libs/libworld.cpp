@@ -164,7 +164,7 @@ static void integrate_chunk_client(Chunk& chunk) {
                 continue;
             }
             if (auto other = level->chunks->getChunk(x + lx, z + lz)) {
-                other->flags.modified = true;
+                other->setModified();
             }
         }
     }
@@ -193,6 +193,7 @@ static int l_set_chunk_data(lua::State* L) {
         return lua::pushboolean(L, true);
     }
     integrate_chunk_client(*chunk);
+    controller->getChunksController()->resetLoadQueues();
     return lua::pushboolean(L, true);
 }
 
@@ -165,6 +165,16 @@ bool lua::emit_event(
     return false;
 }
 
+int lua::intern_event(State* L, const std::string& name) {
+    getglobal(L, "events");
+    getfield(L, "intern");
+    pushstring(L, name);
+    call(L, 1, 1);
+    int id = tointeger(L, -1);
+    pop(L, 2);
+    return id;
+}
+
 State* lua::get_main_state() {
     return main_thread;
 }
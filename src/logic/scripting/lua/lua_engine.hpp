@@ -25,6 +25,27 @@ namespace lua {
         const std::string& name,
         std::function<int(State*)> args = [](auto*) { return 0; }
     );
+
+    /// @brief Get id of the event for emission without name lookup.
+    /// Same name always gets the same id
+    int intern_event(State*, const std::string& name);
+
+    /// @brief Emit interned event
+    /// @param id event id (see intern_event)
+    /// @param args pushes arguments, returns their number
+    template <typename ArgsFunc>
+    bool emit_event(State* L, int id, const ArgsFunc& args) {
+        getglobal(L, "events");
+        getfield(L, "emit_id");
+        pushinteger(L, id);
+        if (call_nothrow(L, args(L) + 1)) {
+            bool result = toboolean(L, -1);
+            pop(L, 2);
+            return result;
+        }
+        pop(L, 1);
+        return false;
+    }
     State* get_main_state();
     State* create_state(const EnginePaths& paths, StateType stateType);
     [[nodiscard]] scriptenv create_environment(State* L);
@@ -1,8 +1,8 @@
 #include "lua_type_heightmap.hpp"
 
 #include "util/functional_util.hpp"
-#define FNL_IMPL
 #include "maths/FastNoiseLite.h"
+#include "maths/noise.hpp"
 #include "coders/imageio.hpp"
 #include "io/util.hpp"
 #include "graphics/core/ImageData.hpp"
@@ -16,6 +16,7 @@
 #include <sstream>
 #include <iomanip>
 #include <filesystem>
+#include <vector>
 
 using namespace lua;
 
@@ -111,12 +112,15 @@ static int l_noise(lua::State* L) {
             shiftMapY = touserdata<LuaHeightmap>(L, 7);
         }
         noise->noise_type = noise_type;
+        // rows are evaluated at once to use the vectorized noise
+        std::vector<float> us(w);
+        std::vector<float> vs(w);
+        std::vector<float> values(w);
         for (uint y = 0; y < h; y++) {
-            for (uint x = 0; x < w; x++) {
-                uint i = y * w + x;
-                for (uint c = 0; c < octaves; c++) {
-                    float m = s * (1 << c);
-                    float value = heights[i];
+            for (uint c = 0; c < octaves; c++) {
+                float m = s * (1 << c);
+                for (uint x = 0; x < w; x++) {
+                    uint i = y * w + x;
                     float u = (x + offset.x) * m;
                     float v = (y + offset.y) * m;
                     if (shiftMapX) {
@@ -125,10 +129,16 @@ static int l_noise(lua::State* L) {
                     if (shiftMapY) {
                         v += shiftMapY->getValues()[i];
                     }
-
-                    value += fnlGetNoise2D(noise, u, v) /
-                            static_cast<float>(1 << c) * multiplier;
-                    heights[i] = value;
+                    us[x] = u;
+                    vs[x] = v;
+                }
+                noise::get_noise_2d(
+                    *noise, us.data(), vs.data(), values.data(), w
+                );
+                for (uint x = 0; x < w; x++) {
+                    uint i = y * w + x;
+                    heights[i] += values[x] / static_cast<float>(1 << c) *
+                                  multiplier;
                 }
             }
         }
@@ -8,6 +8,7 @@
 #include "content/ContentPack.hpp"
 #include "content/ContentControl.hpp"
 #include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
 #include "engine/Engine.hpp"
 #include "engine/EnginePaths.hpp"
 #include "io/io.hpp"
@@ -247,6 +248,7 @@ std::unique_ptr<Process> scripting::start_app_script(const io::path& script) {
 }
 
 void scripting::process_post_runnables() {
+    debug::ProfileScope profile(debug::ProfileStage::SCRIPTING);
     auto L = lua::get_main_state();
     if (lua::getglobal(L, "__process_post_runnables")) {
         lua::call_nothrow(L, 0, 0);
@@ -321,6 +323,7 @@ void scripting::on_world_load(LevelController* controller) {
 }
 
 void scripting::on_world_tick(int tps) {
+    debug::ProfileScope profile(debug::ProfileStage::SCRIPTING);
     auto L = lua::get_main_state();
     if (lua::getglobal(L, "__vc_on_world_tick")) {
         lua::pushinteger(L, tps);
@@ -384,30 +387,44 @@ void scripting::cleanup(const std::vector<std::string>& nonReset) {
 }
 
 void scripting::on_blocks_tick(const Block& block, int tps) {
-    std::string name = block.name + ".blockstick";
-    lua::emit_event(lua::get_main_state(), name, [tps](auto L) {
+    debug::ProfileScope profile(debug::ProfileStage::SCRIPTING);
+    int event = block.rt.funcsset.events.blockstick;
+    lua::emit_event(lua::get_main_state(), event, [tps](auto L) {
         return lua::pushinteger(L, tps);
     });
 }
 
 void scripting::update_block(const Block& block, const glm::ivec3& pos) {
-    std::string name = block.name + ".update";
-    lua::emit_event(lua::get_main_state(), name, [pos](auto L) {
+    int event = block.rt.funcsset.events.update;
+    lua::emit_event(lua::get_main_state(), event, [pos](auto L) {
         return lua::pushivec_stack(L, pos);
     });
 }
 
-void scripting::random_update_block(const Block& block, const glm::ivec3& pos) {
-    std::string name = block.name + ".randupdate";
-    lua::emit_event(lua::get_main_state(), name, [pos](auto L) {
-        return lua::pushivec_stack(L, pos);
-    });
+void scripting::random_update_blocks(
+    const Block& block, const std::vector<glm::ivec3>& positions
+) {
+    auto L = lua::get_main_state();
+    lua::getglobal(L, "events");
+    lua::getfield(L, "__emit_batch");
+    lua::pushinteger(L, block.rt.funcsset.events.randupdate);
+    lua::createtable(L, positions.size() * 3, 0);
+    for (size_t i = 0; i < positions.size(); i++) {
+        for (int k = 0; k < 3; k++) {
+            lua::pushinteger(L, positions[i][k]);
+            lua::rawseti(L, i * 3 + k + 1);
+        }
+    }
+    // tps
+    lua::pushnil(L);
+    lua::pushinteger(L, block.rt.id);
+    // events table and results if any
+    lua::pop(L, 1 + lua::call_nothrow(L, 4, 0));
 }
 
-/// TODO: replace template with index
-template<bool WorldFuncsSet::*worldfunc>
+template <bool WorldFuncsSet::*worldfunc, int WorldEventIds::*worldevent>
 static bool on_block_common(
-    const std::string& suffix,
+    int event,
     bool blockfunc,
     Player* player,
     const Block& block,
@@ -415,9 +432,8 @@ static bool on_block_common(
 ) {
     bool result = false;
     if (blockfunc) {
-        std::string name = block.name + "." + suffix;
         result =
-            lua::emit_event(lua::get_main_state(), name, [pos, player](auto L) {
+            lua::emit_event(lua::get_main_state(), event, [pos, player](auto L) {
                 lua::pushivec_stack(L, pos);
                 lua::pushinteger(L, player ? player->getId() : -1);
                 return 4;
@@ -430,9 +446,10 @@ static bool on_block_common(
         return 5;
     };
     for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.*worldfunc) {
+        const auto& funcsset = pack->worldfuncsset;
+        if (funcsset.*worldfunc) {
             lua::emit_event(
-                lua::get_main_state(), packid + ":.block" + suffix, args
+                lua::get_main_state(), funcsset.events.*worldevent, args
             );
         }
     }
@@ -442,40 +459,51 @@ static bool on_block_common(
 void scripting::on_block_placed(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
-    on_block_common<&WorldFuncsSet::onblockplaced>(
-        "placed", block.rt.funcsset.onplaced, player, block, pos
+    const auto& funcsset = block.rt.funcsset;
+    on_block_common<&WorldFuncsSet::onblockplaced, &WorldEventIds::blockplaced>(
+        funcsset.events.placed, funcsset.onplaced, player, block, pos
     );
 }
 
 void scripting::on_block_replaced(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
-    on_block_common<&WorldFuncsSet::onblockreplaced>(
-        "replaced", block.rt.funcsset.onreplaced, player, block, pos
+    const auto& funcsset = block.rt.funcsset;
+    on_block_common<
+        &WorldFuncsSet::onblockreplaced,
+        &WorldEventIds::blockreplaced>(
+        funcsset.events.replaced, funcsset.onreplaced, player, block, pos
     );
 }
 
 void scripting::on_block_breaking(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
-    on_block_common<&WorldFuncsSet::onblockbreaking>(
-        "breaking", block.rt.funcsset.onbreaking, player, block, pos
+    const auto& funcsset = block.rt.funcsset;
+    on_block_common<
+        &WorldFuncsSet::onblockbreaking,
+        &WorldEventIds::blockbreaking>(
+        funcsset.events.breaking, funcsset.onbreaking, player, block, pos
     );
 }
 
 void scripting::on_block_broken(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
-    on_block_common<&WorldFuncsSet::onblockbroken>(
-        "broken", block.rt.funcsset.onbroken, player, block, pos
+    const auto& funcsset = block.rt.funcsset;
+    on_block_common<&WorldFuncsSet::onblockbroken, &WorldEventIds::blockbroken>(
+        funcsset.events.broken, funcsset.onbroken, player, block, pos
     );
 }
 
 bool scripting::on_block_interact(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
-    return on_block_common<&WorldFuncsSet::onblockinteract>(
-        "interact", block.rt.funcsset.oninteract, player, block, pos
+    const auto& funcsset = block.rt.funcsset;
+    return on_block_common<
+        &WorldFuncsSet::onblockinteract,
+        &WorldEventIds::blockinteract>(
+        funcsset.events.interact, funcsset.oninteract, player, block, pos
     );
 }
 
@@ -486,9 +514,10 @@ void scripting::on_chunk_present(const Chunk& chunk, bool loaded) {
         return 3;
     };
     for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.onchunkpresent) {
+        const auto& funcsset = pack->worldfuncsset;
+        if (funcsset.onchunkpresent) {
             lua::emit_event(
-                lua::get_main_state(), packid + ":.chunkpresent", args
+                lua::get_main_state(), funcsset.events.chunkpresent, args
             );
         }
     }
@@ -501,9 +530,10 @@ void scripting::on_chunk_remove(const Chunk& chunk) {
         return 2;
     };
     for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.onchunkremove) {
+        const auto& funcsset = pack->worldfuncsset;
+        if (funcsset.onchunkremove) {
             lua::emit_event(
-                lua::get_main_state(), packid + ":.chunkremove", args
+                lua::get_main_state(), funcsset.events.chunkremove, args
             );
         }
     }
@@ -517,9 +547,10 @@ void scripting::on_inventory_open(const Player* player, const Inventory& invento
         return 2;
     };
     for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.oninventoryopen) {
+        const auto& funcsset = pack->worldfuncsset;
+        if (funcsset.oninventoryopen) {
             lua::emit_event(
-                lua::get_main_state(), packid + ":.inventoryopen", args
+                lua::get_main_state(), funcsset.events.inventoryopen, args
             );
         }
     }
@@ -532,34 +563,36 @@ void scripting::on_inventory_closed(const Player* player, const Inventory& inven
         return 2;
     };
     for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.oninventoryclosed) {
+        const auto& funcsset = pack->worldfuncsset;
+        if (funcsset.oninventoryclosed) {
             lua::emit_event(
-                lua::get_main_state(), packid + ":.inventoryclosed", args
+                lua::get_main_state(), funcsset.events.inventoryclosed, args
             );
         }
     }
 }
 
 void scripting::on_player_tick(Player* player, int tps) {
+    debug::ProfileScope profile(debug::ProfileStage::SCRIPTING);
     auto args = [=](lua::State* L) {
         lua::pushinteger(L, player ? player->getId() : -1);
         lua::pushinteger(L, tps);
         return 2;
     };
     for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.onplayertick) {
+        const auto& funcsset = pack->worldfuncsset;
+        if (funcsset.onplayertick) {
             lua::emit_event(
-                lua::get_main_state(), packid + ":.playertick", args
+                lua::get_main_state(), funcsset.events.playertick, args
             );
         }
     }
 }
 
 bool scripting::on_item_use(Player* player, const ItemDef& item) {
-    std::string name = item.name + ".use";
     return lua::emit_event(
         lua::get_main_state(),
-        name,
+        item.rt.funcsset.events.use,
         [player](lua::State* L) { return lua::pushinteger(L, player->getId()); }
     );
 }
@@ -567,10 +600,9 @@ bool scripting::on_item_use(Player* player, const ItemDef& item) {
 bool scripting::on_item_use_on_block(
     Player* player, const ItemDef& item, glm::ivec3 ipos, glm::ivec3 normal
 ) {
-    std::string name = item.name + ".useon";
     return lua::emit_event(
         lua::get_main_state(),
-        name,
+        item.rt.funcsset.events.useon,
         [ipos, normal, player](auto L) {
             lua::pushivec_stack(L, ipos);
             lua::pushinteger(L, player->getId());
@@ -583,10 +615,9 @@ bool scripting::on_item_use_on_block(
 bool scripting::on_item_break_block(
     Player* player, const ItemDef& item, int x, int y, int z
 ) {
-    std::string name = item.name + ".blockbreakby";
     return lua::emit_event(
         lua::get_main_state(),
-        name,
+        item.rt.funcsset.events.blockbreakby,
         [x, y, z, player](auto L) {
             lua::pushivec_stack(L, glm::ivec3(x, y, z));
             lua::pushinteger(L, player->getId());
@@ -651,6 +682,10 @@ bool scripting::register_event(
     return success;
 }
 
+static int intern_event(const std::string& name) {
+    return lua::intern_event(lua::get_main_state(), name);
+}
+
 int scripting::get_values_on_stack() {
     return lua::gettop(lua::get_main_state());
 }
@@ -686,6 +721,19 @@ void scripting::load_content_script(
         register_event(env, "on_block_present", prefix + ".blockpresent");
     funcsset.onblockremoved =
         register_event(env, "on_block_removed", prefix + ".blockremoved");
+
+    auto& events = funcsset.events;
+    events.update = intern_event(prefix + ".update");
+    events.randupdate = intern_event(prefix + ".randupdate");
+    events.placed = intern_event(prefix + ".placed");
+    events.replaced = intern_event(prefix + ".replaced");
+    events.breaking = intern_event(prefix + ".breaking");
+    events.broken = intern_event(prefix + ".broken");
+    events.interact = intern_event(prefix + ".interact");
+    events.blocktick = intern_event(prefix + ".blocktick");
+    events.blockstick = intern_event(prefix + ".blockstick");
+    events.blockpresent = intern_event(prefix + ".blockpresent");
+    events.blockremoved = intern_event(prefix + ".blockremoved");
 }
 
 void scripting::load_content_script(
@@ -705,6 +753,11 @@ void scripting::load_content_script(
         register_event(env, "on_use_on_block", prefix + ".useon");
     funcsset.on_block_break_by =
         register_event(env, "on_block_break_by", prefix + ".blockbreakby");
+
+    auto& events = funcsset.events;
+    events.use = intern_event(prefix + ".use");
+    events.useon = intern_event(prefix + ".useon");
+    events.blockbreakby = intern_event(prefix + ".blockbreakby");
 }
 
 void scripting::load_entity_component(
@@ -756,6 +809,18 @@ void scripting::load_world_script(
         register_event(env, "on_inventory_open", prefix + ":.inventoryopen");
     funcsset.oninventoryclosed =
         register_event(env, "on_inventory_closed", prefix + ":.inventoryclosed");
+
+    auto& events = funcsset.events;
+    events.blockplaced = intern_event(prefix + ":.blockplaced");
+    events.blockreplaced = intern_event(prefix + ":.blockreplaced");
+    events.blockbreaking = intern_event(prefix + ":.blockbreaking");
+    events.blockbroken = intern_event(prefix + ":.blockbroken");
+    events.blockinteract = intern_event(prefix + ":.blockinteract");
+    events.playertick = intern_event(prefix + ":.playertick");
+    events.chunkpresent = intern_event(prefix + ":.chunkpresent");
+    events.chunkremove = intern_event(prefix + ":.chunkremove");
+    events.inventoryopen = intern_event(prefix + ":.inventoryopen");
+    events.inventoryclosed = intern_event(prefix + ":.inventoryclosed");
 }
 
 void scripting::load_layout_script(
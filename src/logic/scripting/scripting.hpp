@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -30,6 +31,7 @@ struct uidocscript;
 class BlocksController;
 class LevelController;
 class Entity;
+class ComponentsDispatch;
 struct EntityDef;
 class GeneratorScript;
 struct GeneratorDef;
@@ -86,7 +88,11 @@ namespace scripting {
     void cleanup(const std::vector<std::string>& nonReset);
     void on_blocks_tick(const Block& block, int tps);
     void update_block(const Block& block, const glm::ivec3& pos);
-    void random_update_block(const Block& block, const glm::ivec3& pos);
+    /// @brief Emit on_random_update event of the block once for all
+    /// positions. Positions not holding the block anymore are skipped
+    void random_update_blocks(
+        const Block& block, const std::vector<glm::ivec3>& positions
+    );
     void on_block_placed(
         Player* player, const Block& block, const glm::ivec3& pos
     );
@@ -139,8 +145,21 @@ namespace scripting {
     void on_entity_grounded(const Entity& entity, float force);
     void on_entity_fall(const Entity& entity);
     void on_entity_save(const Entity& entity);
-    void on_entities_update(int tps, int parts, int part);
-    void on_entities_physics_update(float delta);
+    /// @brief Call on_update of components
+    /// @param getInterval entity update interval in ticks,
+    /// 0 if the entity is not updated this tick
+    void on_entities_update(
+        const ComponentsDispatch& components,
+        int tps,
+        const std::function<int(entityid_t)>& getInterval
+    );
+    /// @brief Call on_physics_update of components
+    /// @param isActive false if the entity is not updated (despawned)
+    void on_entities_physics_update(
+        const ComponentsDispatch& components,
+        float delta,
+        const std::function<bool(entityid_t)>& isActive
+    );
     void on_entities_render(float delta);
     void on_sensor_enter(const Entity& entity, size_t index, entityid_t oid);
     void on_sensor_exit(const Entity& entity, size_t index, entityid_t oid);
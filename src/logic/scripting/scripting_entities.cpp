@@ -1,6 +1,7 @@
 #include "scripting.hpp"
 
 #include "lua/lua_engine.hpp"
+#include "objects/ComponentsDispatch.hpp"
 #include "objects/Entities.hpp"
 #include "objects/EntityDef.hpp"
 #include "objects/Entity.hpp"
@@ -107,6 +108,8 @@ static void create_component(
     funcsset.on_aim_off = lua::hasfield(L, "on_aim_off");
     funcsset.on_attacked = lua::hasfield(L, "on_attacked");
     funcsset.on_used = lua::hasfield(L, "on_used");
+    funcsset.on_update = lua::hasfield(L, "on_update");
+    funcsset.on_physics_update = lua::hasfield(L, "on_physics_update");
     lua::pop(L, 2);
 
     component.env = compenv;
@@ -269,22 +272,50 @@ void scripting::on_entity_used(const Entity& entity, Player* player) {
     );
 }
 
-void scripting::on_entities_update(int tps, int parts, int part) {
-    auto L = lua::get_main_state();
-    lua::get_from(L, STDCOMP, "update", true);
-    lua::pushinteger(L, tps);
-    lua::pushinteger(L, parts);
-    lua::pushinteger(L, part);
-    lua::call_nothrow(L, 3, 0);
-    lua::pop(L);
+// Callbacks may spawn entities adding components, so the entries are
+// accessed by index and copied before the call
+
+void scripting::on_entities_update(
+    const ComponentsDispatch& components,
+    int tps,
+    const std::function<int(entityid_t)>& getInterval
+) {
+    static const std::string name = "on_update";
+    const auto& groups = components.getGroups();
+    for (size_t group = 0; group < groups.size(); group++) {
+        for (size_t i = 0; i < groups[group].entries.size(); i++) {
+            auto entry = groups[group].entries[i];
+            int interval = getInterval(entry.uid);
+            if (interval == 0) {
+                continue;
+            }
+            // time between the entity updates is 1/rate
+            double rate = static_cast<double>(tps) / interval;
+            process_entity_callback(entry.env, name, [rate](auto L) {
+                return lua::pushnumber(L, rate);
+            });
+        }
+    }
 }
 
-void scripting::on_entities_physics_update(float delta) {
-    auto L = lua::get_main_state();
-    lua::get_from(L, STDCOMP, "physics_update", true);
-    lua::pushnumber(L, delta);
-    lua::call_nothrow(L, 1, 0);
-    lua::pop(L);
+void scripting::on_entities_physics_update(
+    const ComponentsDispatch& components,
+    float delta,
+    const std::function<bool(entityid_t)>& isActive
+) {
+    static const std::string name = "on_physics_update";
+    const auto& groups = components.getGroups();
+    for (size_t group = 0; group < groups.size(); group++) {
+        for (size_t i = 0; i < groups[group].entries.size(); i++) {
+            auto entry = groups[group].entries[i];
+            if (!isActive(entry.uid)) {
+                continue;
+            }
+            process_entity_callback(entry.env, name, [delta](auto L) {
+                return lua::pushnumber(L, delta);
+            });
+        }
+    }
 }
 
 void scripting::on_entities_render(float delta) {
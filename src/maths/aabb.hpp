@@ -91,14 +91,14 @@ struct AABB {
         addPoint(matrix * glm::vec4(pb.x, pa.y, pb.z, 1.0f));
     }
 
-    inline bool intersect(const AABB& aabb) {
+    inline bool intersect(const AABB& aabb) const {
         return (
             a.x <= aabb.b.x && b.x >= aabb.a.x && a.y <= aabb.b.y &&
             b.y >= aabb.a.y && a.z <= aabb.b.z && b.z >= aabb.a.z
         );
     }
 
-    inline bool intersect(const AABB& aabb, float margin) {
+    inline bool intersect(const AABB& aabb, float margin) const {
         return (
             a.x <= aabb.b.x + margin && b.x >= aabb.a.x - margin &&
             a.y <= aabb.b.y + margin && b.y >= aabb.a.y - margin &&
@@ -0,0 +1,310 @@
+#include "noise.hpp"
+
+#define FNL_IMPL
+#include "FastNoiseLite.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NOISE_VECTOR_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#define NOISE_VECTOR_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define NOISE_VECTOR_NEON
+#endif
+
+#if defined(NOISE_VECTOR_AVX2) || defined(NOISE_VECTOR_SSE2) || \
+    defined(NOISE_VECTOR_NEON)
+#define NOISE_VECTORIZED
+#endif
+
+// Vector instruction sets wrappers with the operations used by kernels.
+// Gradient tables lookups are done with scalar loads where there is no
+// gather instruction
+namespace {
+#if defined(NOISE_VECTOR_AVX2)
+    struct Vector {
+        static inline constexpr int N = 8;
+        static inline constexpr const char* NAME = "avx2";
+        using F = __m256;
+        using I = __m256i;
+        using M = __m256;
+
+        static F load(const float* src) { return _mm256_loadu_ps(src); }
+        static void store(float* dst, F v) { _mm256_storeu_ps(dst, v); }
+        static F set(float v) { return _mm256_set1_ps(v); }
+        static I seti(int v) { return _mm256_set1_epi32(v); }
+
+        static F add(F a, F b) { return _mm256_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+        static I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+        static I muli(I a, I b) { return _mm256_mullo_epi32(a, b); }
+        static I xori(I a, I b) { return _mm256_xor_si256(a, b); }
+        static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+        static I shr15(I a) { return _mm256_srai_epi32(a, 15); }
+
+        static M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+        static I selecti(M m, I a, I b) {
+            return _mm256_blendv_epi8(b, a, _mm256_castps_si256(m));
+        }
+
+        static I floor(F v) {
+            I truncated = _mm256_cvttps_epi32(v);
+            M negative = _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_LT_OQ);
+            return _mm256_add_epi32(truncated, _mm256_castps_si256(negative));
+        }
+        static F tofloat(I v) { return _mm256_cvtepi32_ps(v); }
+
+        static F gather(const float* table, I indices) {
+            return _mm256_i32gather_ps(table, indices, 4);
+        }
+    };
+#elif defined(NOISE_VECTOR_SSE2)
+    struct Vector {
+        static inline constexpr int N = 4;
+        static inline constexpr const char* NAME = "sse2";
+        using F = __m128;
+        using I = __m128i;
+        using M = __m128;
+
+        static F load(const float* src) { return _mm_loadu_ps(src); }
+        static void store(float* dst, F v) { _mm_storeu_ps(dst, v); }
+        static F set(float v) { return _mm_set1_ps(v); }
+        static I seti(int v) { return _mm_set1_epi32(v); }
+
+        static F add(F a, F b) { return _mm_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+        static I addi(I a, I b) { return _mm_add_epi32(a, b); }
+        static I muli(I a, I b) {
+#if defined(__SSE4_1__)
+            return _mm_mullo_epi32(a, b);
+#else
+            I even = _mm_mul_epu32(a, b);
+            I odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+            return _mm_unpacklo_epi32(
+                _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))
+            );
+#endif
+        }
+        static I xori(I a, I b) { return _mm_xor_si128(a, b); }
+        static I andi(I a, I b) { return _mm_and_si128(a, b); }
+        static I shr15(I a) { return _mm_srai_epi32(a, 15); }
+
+        static M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+        static F select(M m, F a, F b) {
+            return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+        }
+        static I selecti(M m, I a, I b) {
+            I mi = _mm_castps_si128(m);
+            return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b));
+        }
+
+        static I floor(F v) {
+            I truncated = _mm_cvttps_epi32(v);
+            M negative = _mm_cmplt_ps(v, _mm_setzero_ps());
+            return _mm_add_epi32(truncated, _mm_castps_si128(negative));
+        }
+        static F tofloat(I v) { return _mm_cvtepi32_ps(v); }
+
+        static F gather(const float* table, I indices) {
+            alignas(16) int idx[N];
+            _mm_store_si128(reinterpret_cast<I*>(idx), indices);
+            return _mm_setr_ps(
+                table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]]
+            );
+        }
+    };
+#elif defined(NOISE_VECTOR_NEON)
+    struct Vector {
+        static inline constexpr int N = 4;
+        static inline constexpr const char* NAME = "neon";
+        using F = float32x4_t;
+        using I = int32x4_t;
+        using M = uint32x4_t;
+
+        static F load(const float* src) { return vld1q_f32(src); }
+        static void store(float* dst, F v) { vst1q_f32(dst, v); }
+        static F set(float v) { return vdupq_n_f32(v); }
+        static I seti(int v) { return vdupq_n_s32(v); }
+
+        static F add(F a, F b) { return vaddq_f32(a, b); }
+        static F sub(F a, F b) { return vsubq_f32(a, b); }
+        static F mul(F a, F b) { return vmulq_f32(a, b); }
+        static I addi(I a, I b) { return vaddq_s32(a, b); }
+        static I muli(I a, I b) { return vmulq_s32(a, b); }
+        static I xori(I a, I b) { return veorq_s32(a, b); }
+        static I andi(I a, I b) { return vandq_s32(a, b); }
+        static I shr15(I a) { return vshrq_n_s32(a, 15); }
+
+        static M gt(F a, F b) { return vcgtq_f32(a, b); }
+        static F select(M m, F a, F b) { return vbslq_f32(m, a, b); }
+        static I selecti(M m, I a, I b) { return vbslq_s32(m, a, b); }
+
+        static I floor(F v) {
+            I truncated = vcvtq_s32_f32(v);
+            M negative = vcltq_f32(v, vdupq_n_f32(0.0f));
+            return vaddq_s32(truncated, vreinterpretq_s32_u32(negative));
+        }
+        static F tofloat(I v) { return vcvtq_f32_s32(v); }
+
+        static F gather(const float* table, I indices) {
+            int idx[N];
+            vst1q_s32(idx, indices);
+            float values[N] = {
+                table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]]};
+            return vld1q_f32(values);
+        }
+    };
+#endif
+}
+
+#if defined(NOISE_VECTORIZED)
+
+using F = Vector::F;
+using I = Vector::I;
+using M = Vector::M;
+
+/// @brief _fnlGradCoord2D
+static inline F grad_coord(I seed, I xPrimed, I yPrimed, F xd, F yd) {
+    I hash = Vector::xori(Vector::xori(seed, xPrimed), yPrimed);
+    hash = Vector::muli(hash, Vector::seti(0x27d4eb2d));
+    hash = Vector::xori(hash, Vector::shr15(hash));
+    hash = Vector::andi(hash, Vector::seti(127 << 1));
+    // hash is even, so hash | 1 == hash + 1
+    F gx = Vector::gather(GRADIENTS_2D, hash);
+    F gy = Vector::gather(GRADIENTS_2D + 1, hash);
+    return Vector::add(Vector::mul(xd, gx), Vector::mul(yd, gy));
+}
+
+/// @brief Corner contribution (t^4 * gradient), zero if t <= 0
+static inline F contribution(F t, I seed, I xPrimed, I yPrimed, F xd, F yd) {
+    F t2 = Vector::mul(t, t);
+    F value = Vector::mul(
+        Vector::mul(t2, t2), grad_coord(seed, xPrimed, yPrimed, xd, yd)
+    );
+    F zero = Vector::set(0.0f);
+    return Vector::select(Vector::gt(t, zero), value, zero);
+}
+
+/// @brief Vectorized fnlGetNoise2D for single OpenSimplex2 noise.
+/// Same operations order as the scalar implementation
+/// (_fnlTransformNoiseCoordinate2D and _fnlSingleSimplex2D)
+/// @return number of processed points (multiple of the vector width)
+static size_t simplex_2d(
+    int seed,
+    float frequency,
+    const float* xs,
+    const float* ys,
+    float* dst,
+    size_t count
+) {
+    const float SQRT3 = 1.7320508075688772935274463415059f;
+    const float F2 = 0.5f * (SQRT3 - 1);
+    const float G2 = (3 - SQRT3) / 6;
+    const float C1 = 2 * (1 - 2 * G2) * (1 / G2 - 2);
+    const float C2 = -2 * (1 - 2 * G2) * (1 - 2 * G2);
+
+    const F freq = Vector::set(frequency);
+    const F half = Vector::set(0.5f);
+    const I seeds = Vector::seti(seed);
+    const I primeX = Vector::seti(PRIME_X);
+    const I primeY = Vector::seti(PRIME_Y);
+
+    size_t n = 0;
+    for (; n + Vector::N <= count; n += Vector::N) {
+        F x = Vector::mul(Vector::load(xs + n), freq);
+        F y = Vector::mul(Vector::load(ys + n), freq);
+        F skew = Vector::mul(Vector::add(x, y), Vector::set(F2));
+        x = Vector::add(x, skew);
+        y = Vector::add(y, skew);
+
+        I i = Vector::floor(x);
+        I j = Vector::floor(y);
+        F xi = Vector::sub(x, Vector::tofloat(i));
+        F yi = Vector::sub(y, Vector::tofloat(j));
+
+        F t = Vector::mul(Vector::add(xi, yi), Vector::set(G2));
+        F x0 = Vector::sub(xi, t);
+        F y0 = Vector::sub(yi, t);
+
+        i = Vector::muli(i, primeX);
+        j = Vector::muli(j, primeY);
+
+        F a = Vector::sub(
+            Vector::sub(half, Vector::mul(x0, x0)), Vector::mul(y0, y0)
+        );
+        F n0 = contribution(a, seeds, i, j, x0, y0);
+
+        F c = Vector::add(
+            Vector::mul(Vector::set(C1), t), Vector::add(Vector::set(C2), a)
+        );
+        F x2 = Vector::add(x0, Vector::set(2 * G2 - 1));
+        F y2 = Vector::add(y0, Vector::set(2 * G2 - 1));
+        F n2 = contribution(
+            c, seeds, Vector::addi(i, primeX), Vector::addi(j, primeY), x2, y2
+        );
+
+        M upper = Vector::gt(y0, x0);
+        F x1 = Vector::select(
+            upper,
+            Vector::add(x0, Vector::set(G2)),
+            Vector::add(x0, Vector::set(G2 - 1))
+        );
+        F y1 = Vector::select(
+            upper,
+            Vector::add(y0, Vector::set(G2 - 1)),
+            Vector::add(y0, Vector::set(G2))
+        );
+        I i1 = Vector::selecti(upper, i, Vector::addi(i, primeX));
+        I j1 = Vector::selecti(upper, Vector::addi(j, primeY), j);
+        F b = Vector::sub(
+            Vector::sub(half, Vector::mul(x1, x1)), Vector::mul(y1, y1)
+        );
+        F n1 = contribution(b, seeds, i1, j1, x1, y1);
+
+        F sum = Vector::add(Vector::add(n0, n1), n2);
+        F result = Vector::mul(sum, Vector::set(99.83685446303647f));
+        Vector::store(dst + n, result);
+    }
+    return n;
+}
+
+#define NOISE_VECTOR_NAME Vector::NAME
+#else
+#define NOISE_VECTOR_NAME "scalar"
+#endif
+
+void noise::get_noise_2d(
+    fnl_state& state,
+    const float* xs,
+    const float* ys,
+    float* dst,
+    size_t count
+) {
+    size_t n = 0;
+#if defined(NOISE_VECTORIZED)
+    bool fractal = state.fractal_type == FNL_FRACTAL_FBM ||
+                   state.fractal_type == FNL_FRACTAL_RIDGED ||
+                   state.fractal_type == FNL_FRACTAL_PINGPONG;
+    if (state.noise_type == FNL_NOISE_OPENSIMPLEX2 && !fractal) {
+        n = simplex_2d(state.seed, state.frequency, xs, ys, dst, count);
+    }
+#endif
+    // remaining points and not vectorized settings
+    for (; n < count; n++) {
+        dst[n] = fnlGetNoise2D(&state, xs[n], ys[n]);
+    }
+}
+
+const char* noise::get_simd_name() {
+    return NOISE_VECTOR_NAME;
+}
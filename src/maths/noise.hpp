@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+
+struct fnl_state;
+
+namespace noise {
+    /// @brief Evaluate fnlGetNoise2D for a row of points.
+    /// Single OpenSimplex2 noise is vectorized (AVX2, SSE2 or NEON
+    /// depending on the target), other settings are evaluated by the
+    /// scalar FastNoiseLite functions
+    /// @param xs points x coordinates
+    /// @param ys points y coordinates
+    /// @param dst output noise values
+    void get_noise_2d(
+        fnl_state& state,
+        const float* xs,
+        const float* ys,
+        float* dst,
+        size_t count
+    );
+
+    /// @return name of the vector instruction set used by get_noise_2d
+    const char* get_simd_name();
+}
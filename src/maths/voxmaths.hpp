@@ -7,6 +7,12 @@ inline constexpr int floordiv(int a, int b) {
     return a / b;
 }
 
+/// @brief Floor without a libm call. The value must fit int range
+inline constexpr int floor_int(float x) {
+    int i = static_cast<int>(x);
+    return i - (x < static_cast<float>(i));
+}
+
 inline constexpr bool is_pot(int a) {
     return (a > 0) && ((a & (a - 1)) == 0);
 }
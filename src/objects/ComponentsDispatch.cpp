@@ -0,0 +1,50 @@
+#include "ComponentsDispatch.hpp"
+
+void ComponentsDispatch::add(
+    entityid_t uid, const std::string& component, scriptenv env
+) {
+    uint32_t groupIndex;
+    auto found = groupsIndices.find(component);
+    if (found == groupsIndices.end()) {
+        groupIndex = groups.size();
+        groups.push_back(Group {component, {}});
+        groupsIndices[component] = groupIndex;
+    } else {
+        groupIndex = found->second;
+    }
+    auto& entries = groups[groupIndex].entries;
+    positions[uid].push_back(
+        Position {groupIndex, static_cast<uint32_t>(entries.size())}
+    );
+    entries.push_back(Entry {uid, std::move(env)});
+    count++;
+}
+
+void ComponentsDispatch::remove(entityid_t uid) {
+    auto found = positions.find(uid);
+    if (found == positions.end()) {
+        return;
+    }
+    auto& own = found->second;
+    while (!own.empty()) {
+        Position position = own.back();
+        own.pop_back();
+
+        // the last entry of the group takes place of the removed one
+        auto& entries = groups[position.group].entries;
+        uint32_t last = entries.size() - 1;
+        if (position.index != last) {
+            auto& entry = entries[position.index];
+            entry = std::move(entries[last]);
+            for (auto& moved : positions.at(entry.uid)) {
+                if (moved.group == position.group && moved.index == last) {
+                    moved.index = position.index;
+                    break;
+                }
+            }
+        }
+        entries.pop_back();
+        count--;
+    }
+    positions.erase(found);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "typedefs.hpp"
+
+/// @brief Script components implementing a callback (e.g. on_update)
+/// grouped by component type, so the callback is dispatched without
+/// visiting components not implementing it
+class ComponentsDispatch {
+public:
+    struct Entry {
+        entityid_t uid;
+        scriptenv env;
+    };
+
+    struct Group {
+        std::string component;
+        std::vector<Entry> entries;
+    };
+private:
+    struct Position {
+        uint32_t group;
+        uint32_t index;
+    };
+    std::vector<Group> groups;
+    std::unordered_map<std::string, uint32_t> groupsIndices;
+    /// @brief Entries of an entity
+    std::unordered_map<entityid_t, std::vector<Position>> positions;
+    size_t count = 0;
+public:
+    void add(entityid_t uid, const std::string& component, scriptenv env);
+
+    /// @brief Remove all entries of the entity
+    void remove(entityid_t uid);
+
+    const std::vector<Group>& getGroups() const {
+        return groups;
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
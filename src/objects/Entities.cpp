@@ -1,6 +1,7 @@
 #define VC_ENABLE_REFLECTION
 #include "Entities.hpp"
 
+#include <algorithm>
 #include <glm/ext/matrix_transform.hpp>
 #include <sstream>
 
@@ -16,18 +17,49 @@
 #include "logic/scripting/scripting.hpp"
 #include "maths/FrustumCulling.hpp"
 #include "maths/rays.hpp"
+#include "maths/voxmaths.hpp"
+#include "util/ParallelExecutor.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/GlobalChunks.hpp"
 #include "EntityDef.hpp"
 #include "Entity.hpp"
 #include "rigging.hpp"
+#include "Player.hpp"
+#include "Players.hpp"
 #include "physics/PhysicsSolver.hpp"
 #include "world/Level.hpp"
 
 static debug::Logger logger("entities");
 
+/// @brief Broadphase grid cell size, most of entities are smaller
+static inline constexpr float GRID_CELL_SIZE = 4.0f;
+/// @brief Distance (in blocks) around a moving hitbox where voxels are
+/// unpacked before stepping. Covers extended blocks origins lookup
+static inline constexpr float PHYSICS_VOXELS_MARGIN = 8.0f;
+/// @brief Max tick LOD level, update interval is 2^level ticks
+static inline constexpr int MAX_TICK_LOD = 3;
+
 Entities::Entities(Level& level)
     : level(level),
       sensorsTickClock(20, 3),
-      updateTickClock(20, 3) {
+      updateTickClock(20, 3),
+      grid(GRID_CELL_SIZE) {
+}
+
+Entities::~Entities() = default;
+
+void Entities::setPhysicsWorkers(int workers) {
+    if (workers > 0) {
+        physicsExecutor = std::make_unique<util::ParallelExecutor>(
+            "physics", workers + 1
+        );
+    } else {
+        physicsExecutor = nullptr;
+    }
+}
+
+void Entities::setTickLodDistance(int distance) {
+    tickLodDistance = std::max(0, distance);
 }
 
 std::optional<Entity> Entities::get(entityid_t id) {
@@ -38,6 +70,21 @@ std::optional<Entity> Entities::get(entityid_t id) {
     return std::nullopt;
 }
 
+AABB Entities::getBounds(const Transform& transform, const Hitbox& hitbox) {
+    // raycasts use unscaled hitbox, sensors use scaled one
+    auto half = glm::max(hitbox.halfsize, hitbox.getHalfSize());
+    AABB aabb(hitbox.position - half, hitbox.position + half);
+    aabb.addPoint(transform.pos);
+    return aabb;
+}
+
+void Entities::updateBounds(const Entity& entity) {
+    grid.update(
+        entity.getUID(),
+        getBounds(entity.getTransform(), entity.getRigidbody().hitbox)
+    );
+}
+
 entityid_t Entities::spawn(
     const EntityDef& def,
     glm::vec3 position,
@@ -100,9 +147,19 @@ entityid_t Entities::spawn(
         loadEntity(saved, get(id).value());
     }
     body.hitbox.position = tsf.pos;
+    grid.update(id, getBounds(tsf, body.hitbox));
     scripting::on_entity_spawn(
         def, id, scripting.components, args, componentsMap
     );
+    for (const auto& component : scripting.components) {
+        const auto& funcsset = component->funcsset;
+        if (funcsset.on_update) {
+            updateComponents.add(id, component->name, component->env);
+        }
+        if (funcsset.on_physics_update) {
+            physicsComponents.add(id, component->name, component->env);
+        }
+    }
     return id;
 }
 
@@ -148,13 +205,21 @@ std::optional<Entities::RaycastResult> Entities::rayCast(
     glm::vec3 start, glm::vec3 dir, float maxDistance, entityid_t ignore
 ) {
     Ray ray(start, dir);
-    auto view = registry.view<EntityId, Transform, Rigidbody>();
+    AABB area(start, start);
+    area.addPoint(start + dir * maxDistance);
+    queried.clear();
+    grid.query(area, queried);
 
     entityid_t foundUID = 0;
     glm::ivec3 foundNormal;
 
-    for (auto [entity, eid, transform, body] : view.each()) {
-        if (eid.uid == ignore || !body.enabled) {
+    for (entityid_t uid : queried) {
+        const auto& found = entities.find(uid);
+        if (uid == ignore || found == entities.end()) {
+            continue;
+        }
+        const auto& body = registry.get<Rigidbody>(found->second);
+        if (!body.enabled) {
             continue;
         }
         auto& hitbox = body.hitbox;
@@ -163,7 +228,7 @@ std::optional<Entities::RaycastResult> Entities::rayCast(
         if (ray.intersectAABB(
                 glm::vec3(), hitbox.getAABB(), maxDistance, normal, distance
             ) > RayRelation::None) {
-            foundUID = eid.uid;
+            foundUID = uid;
             foundNormal = normal;
             maxDistance = static_cast<float>(distance);
         }
@@ -223,6 +288,9 @@ void Entities::clean() {
             for (auto& sensor : rigidbody.sensors) {
                 physics->removeSensor(&sensor);
             }
+            grid.remove(it->first);
+            updateComponents.remove(it->first);
+            physicsComponents.remove(it->first);
             uids.erase(it->second);
             registry.destroy(it->second);
             it = entities.erase(it);
@@ -282,49 +350,178 @@ void Entities::preparePhysics(float delta) {
     }
 }
 
+void Entities::unpackVoxelsAround(const Hitbox& hitbox, float delta) {
+    auto reach = hitbox.getHalfSize() + glm::abs(hitbox.velocity) * delta +
+                 PHYSICS_VOXELS_MARGIN;
+    int x1 = floordiv<CHUNK_W>(std::floor(hitbox.position.x - reach.x));
+    int z1 = floordiv<CHUNK_D>(std::floor(hitbox.position.z - reach.z));
+    int x2 = floordiv<CHUNK_W>(std::floor(hitbox.position.x + reach.x));
+    int z2 = floordiv<CHUNK_D>(std::floor(hitbox.position.z + reach.z));
+    for (int cz = z1; cz <= z2; cz++) {
+        for (int cx = x1; cx <= x2; cx++) {
+            if (auto chunk = level.chunks->getChunk(cx, cz)) {
+                chunk->getVoxels();
+            }
+        }
+    }
+}
+
 void Entities::updatePhysics(float delta) {
     preparePhysics(delta);
 
     auto view = registry.view<EntityId, Transform, Rigidbody>();
-    auto physics = level.physics.get();
+    std::vector<entityid_t> uids;
+    std::vector<Transform*> transforms;
+    std::vector<Hitbox*> hitboxes;
     for (auto [entity, eid, transform, rigidbody] : view.each()) {
         if (!rigidbody.enabled || rigidbody.hitbox.type == BodyType::STATIC) {
+            grid.update(eid.uid, getBounds(transform, rigidbody.hitbox));
             continue;
         }
-        auto& hitbox = rigidbody.hitbox;
-        auto prevVel = hitbox.velocity;
-        bool grounded = hitbox.grounded;
-
-        float vel = glm::length(prevVel);
-        int substeps = static_cast<int>(delta * vel * 20);
-        substeps = std::min(100, std::max(2, substeps));
-        physics->step(*level.chunks, hitbox, delta, substeps, eid.uid);
-        hitbox.friction = glm::abs(hitbox.gravityScale <= 1e-7f)
-                              ? 8.0f
-                              : (!grounded ? 2.0f : 10.0f);
+        unpackVoxelsAround(rigidbody.hitbox, delta);
+        uids.push_back(eid.uid);
+        transforms.push_back(&transform);
+        hitboxes.push_back(&rigidbody.hitbox);
+    }
+
+    // the world is not modified until stepping is finished
+    auto changes = level.physics->stepAll(
+        *level.chunks, hitboxes, delta, physicsExecutor.get()
+    );
+    for (size_t i = 0; i < hitboxes.size(); i++) {
+        auto& transform = *transforms[i];
+        auto& hitbox = *hitboxes[i];
         hitbox.scale = transform.size;
         transform.setPos(hitbox.position);
-        if (hitbox.grounded && !grounded) {
-            scripting::on_entity_grounded(
-                *get(eid.uid), glm::length(prevVel - hitbox.velocity)
-            );
+        grid.update(uids[i], getBounds(transform, hitbox));
+    }
+
+    // callbacks are called in the same order as bodies were stepped
+    for (const auto& change : changes) {
+        auto entity = get(uids[change.index]);
+        if (!entity) {
+            continue;
+        }
+        if (change.grounded) {
+            scripting::on_entity_grounded(*entity, change.impulse);
+        } else {
+            scripting::on_entity_fall(*entity);
+        }
+    }
+    processSensors();
+}
+
+void Entities::processSensors() {
+    std::vector<entityid_t> candidates;
+    for (auto sensorPtr : level.physics->getSensors()) {
+        auto& sensor = *sensorPtr;
+        AABB area;
+        switch (sensor.type) {
+            case SensorType::AABB:
+                area = sensor.calculated.aabb;
+                break;
+            case SensorType::RADIUS: {
+                glm::vec3 center(sensor.calculated.radial);
+                float radius = glm::sqrt(sensor.calculated.radial.w);
+                area = AABB(center - radius, center + radius);
+                break;
+            }
         }
-        if (!hitbox.grounded && grounded) {
-            scripting::on_entity_fall(*get(eid.uid));
+        candidates.clear();
+        grid.query(area, candidates);
+
+        for (entityid_t uid : candidates) {
+            const auto& found = entities.find(uid);
+            if (uid == sensor.entity || found == entities.end()) {
+                continue;
+            }
+            const auto& body = registry.get<Rigidbody>(found->second);
+            const auto& hitbox = body.hitbox;
+            if (!body.enabled || hitbox.type == BodyType::STATIC) {
+                continue;
+            }
+            bool triggered = false;
+            switch (sensor.type) {
+                case SensorType::AABB:
+                    triggered = AABB(
+                        hitbox.position - hitbox.getHalfSize(),
+                        hitbox.position + hitbox.getHalfSize()
+                    ).intersect(sensor.calculated.aabb);
+                    break;
+                case SensorType::RADIUS:
+                    triggered = glm::distance2(
+                        hitbox.position, glm::vec3(sensor.calculated.radial)
+                    ) < sensor.calculated.radial.w;
+                    break;
+            }
+            if (triggered) {
+                if (sensor.prevEntered.find(uid) == sensor.prevEntered.end()) {
+                    sensor.enterCallback(sensor.entity, sensor.index, uid);
+                }
+                sensor.nextEntered.insert(uid);
+            }
         }
     }
 }
 
+bool Entities::isActive(entityid_t uid) const {
+    const auto& found = entities.find(uid);
+    return found != entities.end() &&
+           !registry.get<EntityId>(found->second).destroyFlag;
+}
+
+int Entities::getUpdateInterval(entityid_t uid) const {
+    const auto& found = entities.find(uid);
+    if (found == entities.end() ||
+        registry.get<EntityId>(found->second).destroyFlag) {
+        return 0;
+    }
+    if (tickLodDistance == 0) {
+        return 1;
+    }
+    const auto& pos = registry.get<Transform>(found->second).pos;
+    int level = MAX_TICK_LOD;
+    for (const auto& center : lodCenters) {
+        float steps = glm::distance(pos, center) / tickLodDistance;
+        if (steps < level) {
+            level = static_cast<int>(steps);
+        }
+    }
+    int interval = 1 << level;
+    // entities of the same level are spread over ticks
+    return (ticks + uid) % interval == 0 ? interval : 0;
+}
+
 void Entities::update(float delta) {
     if (updateTickClock.update(delta)) {
+        int parts = updateTickClock.getParts();
+        int part = updateTickClock.getPart();
+        if (part == 0) {
+            ticks++;
+            lodCenters.clear();
+            for (const auto& [_, player] : *level.players) {
+                if (!player->isSuspended()) {
+                    lodCenters.push_back(player->getPosition());
+                }
+            }
+        }
         scripting::on_entities_update(
+            updateComponents,
             updateTickClock.getTickRate(),
-            updateTickClock.getParts(),
-            updateTickClock.getPart()
+            [this, parts, part](entityid_t uid) {
+                if (uid % parts != static_cast<entityid_t>(part)) {
+                    return 0;
+                }
+                return getUpdateInterval(uid);
+            }
         );
     }
     updatePhysics(delta);
-    scripting::on_entities_physics_update(delta);
+    scripting::on_entities_physics_update(
+        physicsComponents,
+        delta,
+        [this](entityid_t uid) { return isActive(uid); }
+    );
 }
 
 static void debug_render_skeleton(
@@ -425,8 +622,15 @@ void Entities::render(
 }
 
 bool Entities::hasBlockingInside(AABB aabb) {
-    auto view = registry.view<EntityId, Rigidbody>();
-    for (auto [entity, eid, body] : view.each()) {
+    queried.clear();
+    grid.query(aabb, queried);
+    for (entityid_t uid : queried) {
+        const auto& found = entities.find(uid);
+        if (found == entities.end()) {
+            continue;
+        }
+        const auto& eid = registry.get<EntityId>(found->second);
+        const auto& body = registry.get<Rigidbody>(found->second);
         if (eid.def.blocking && aabb.intersect(body.hitbox.getAABB(), -0.05f)) {
             return true;
         }
@@ -436,16 +640,18 @@ bool Entities::hasBlockingInside(AABB aabb) {
 
 std::vector<Entity> Entities::getAllInside(AABB aabb) {
     std::vector<Entity> collected;
-    auto view = registry.view<EntityId, Transform>();
-    for (auto [entity, eid, transform] : view.each()) {
+    aabb.fix();
+    queried.clear();
+    grid.query(aabb, queried);
+    for (entityid_t uid : queried) {
+        const auto& found = entities.find(uid);
+        if (found == entities.end()) {
+            continue;
+        }
+        const auto& eid = registry.get<EntityId>(found->second);
+        const auto& transform = registry.get<Transform>(found->second);
         if (!eid.destroyFlag && aabb.contains(transform.pos)) {
-            const auto& found = uids.find(entity);
-            if (found == uids.end()) {
-                continue;
-            }
-            if (auto wrapper = get(found->second)) {
-                collected.push_back(*wrapper);
-            }
+            collected.emplace_back(*this, uid, registry, found->second);
         }
     }
     return collected;
@@ -453,16 +659,16 @@ std::vector<Entity> Entities::getAllInside(AABB aabb) {
 
 std::vector<Entity> Entities::getAllInRadius(glm::vec3 center, float radius) {
     std::vector<Entity> collected;
-    auto view = registry.view<Transform>();
-    for (auto [entity, transform] : view.each()) {
+    queried.clear();
+    grid.query(AABB(center - radius, center + radius), queried);
+    for (entityid_t uid : queried) {
+        const auto& found = entities.find(uid);
+        if (found == entities.end()) {
+            continue;
+        }
+        const auto& transform = registry.get<Transform>(found->second);
         if (glm::distance2(transform.pos, center) <= radius * radius) {
-            const auto& found = uids.find(entity);
-            if (found == uids.end()) {
-                continue;
-            }
-            if (auto wrapper = get(found->second)) {
-                collected.push_back(*wrapper);
-            }
+            collected.emplace_back(*this, uid, registry, found->second);
         }
     }
     return collected;
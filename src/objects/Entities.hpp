@@ -6,9 +6,11 @@
 #include <vector>
 
 #include "physics/Hitbox.hpp"
+#include "physics/SpatialGrid.hpp"
 #include "Transform.hpp"
 #include "Rigidbody.hpp"
 #include "ScriptComponents.hpp"
+#include "ComponentsDispatch.hpp"
 #include "typedefs.hpp"
 #include "util/Clock.hpp"
 
@@ -31,6 +33,10 @@ namespace rigging {
     class SkeletonConfig;
 }
 
+namespace util {
+    class ParallelExecutor;
+}
+
 class Entities {
     entt::registry registry;
     Level& level;
@@ -39,11 +45,44 @@ class Entities {
     entityid_t nextID = 1;
     util::Clock sensorsTickClock;
     util::Clock updateTickClock;
+    /// @brief Broadphase of entities bounds (see getBounds)
+    SpatialGrid grid;
+    /// @brief Broadphase query results buffer
+    std::vector<entityid_t> queried;
+    /// @brief Rigidbodies stepping workers. nullptr if physics is stepped
+    /// on the calling thread only
+    std::unique_ptr<util::ParallelExecutor> physicsExecutor;
+    /// @brief Components implementing on_update
+    ComponentsDispatch updateComponents;
+    /// @brief Components implementing on_physics_update
+    ComponentsDispatch physicsComponents;
+    /// @brief Distance from players where entities update rate starts
+    /// decreasing (tick LOD), 0 if disabled
+    int tickLodDistance = 0;
+    /// @brief Completed entities ticks (all parts)
+    uint64_t ticks = 0;
+    /// @brief Positions of players the tick LOD distance is measured from
+    std::vector<glm::vec3> lodCenters;
 
     void updateSensors(
         Rigidbody& body, const Transform& tsf, std::vector<Sensor*>& sensors
     );
     void preparePhysics(float delta);
+    void processSensors();
+
+    /// @return false if the entity is despawned
+    bool isActive(entityid_t uid) const;
+
+    /// @brief Update interval of the entity in ticks (tick LOD)
+    /// @return 0 if the entity is not updated this tick
+    int getUpdateInterval(entityid_t uid) const;
+
+    /// @brief Unpack voxels of chunks the hitbox may reach while stepping,
+    /// so physics workers never unpack chunks concurrently
+    void unpackVoxelsAround(const Hitbox& hitbox, float delta);
+
+    /// @brief Area covering entity hitbox and transform position
+    static AABB getBounds(const Transform& transform, const Hitbox& hitbox);
 public:
     struct RaycastResult {
         entityid_t entity;
@@ -52,6 +91,16 @@ public:
     };
 
     Entities(Level& level);
+    ~Entities();
+
+    /// @brief Set number of additional threads stepping rigidbodies
+    /// (0 - calling thread only)
+    void setPhysicsWorkers(int workers);
+
+    /// @brief Set distance from players (in blocks) where entities update
+    /// rate is halved. Further away it is halved again for each distance
+    /// step, down to 1/8. 0 - disabled
+    void setTickLodDistance(int distance);
 
     void clean();
     void updatePhysics(float delta);
@@ -79,6 +128,10 @@ public:
 
     std::optional<Entity> get(entityid_t id);
 
+    /// @brief Update entity in the broadphase after its position was set
+    /// outside of physics update
+    void updateBounds(const Entity& entity);
+
     /// @brief Entities raycast. No blocks check included, use combined with
     /// Chunks.rayCast
     /// @param start Ray start
@@ -105,6 +105,12 @@ Rigidbody& Entity::getRigidbody() const {
     return registry.get<Rigidbody>(entity);
 }
 
+void Entity::setPos(const glm::vec3& position) {
+    getTransform().setPos(position);
+    getRigidbody().hitbox.position = position;
+    entities.updateBounds(*this);
+}
+
 entityid_t Entity::getUID() const {
     return registry.get<EntityId>(entity).uid;
 }
@@ -62,6 +62,9 @@ public:
 
     void setRig(const rigging::SkeletonConfig* rigConfig);
 
+    /// @brief Move entity transform and hitbox keeping the broadphase in sync
+    void setPos(const glm::vec3& position);
+
     entityid_t getUID() const;
 
     int64_t getPlayer() const;
@@ -17,6 +17,8 @@ struct EntityFuncsSet {
     bool on_aim_off;
     bool on_attacked;
     bool on_used;
+    bool on_update;
+    bool on_physics_update;
 };
 
 struct UserComponent {
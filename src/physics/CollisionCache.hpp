@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "constants.hpp"
+#include "maths/aabb.hpp"
+#include "maths/voxmaths.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/blocks_agent.hpp"
+
+/// @brief Obstacles of a voxels window around a moving body gathered once
+/// per physics step, so collision probes are array lookups.
+/// Probes outside of the window fall back to the storage lookup.
+/// Results are the same as blocks_agent::is_obstacle_at gives
+/// @tparam Storage chunks storage class
+template <class Storage>
+class CollisionCache {
+    struct Obstacle {
+        /// @brief Block hitboxes, nullptr if the voxel is not an obstacle
+        const AABB* hitboxes = nullptr;
+        size_t count = 0;
+        /// @brief Extended block segment offset to the origin
+        glm::ivec3 offset {};
+    };
+    /// @brief Missing voxels below the world top are full obstacles
+    static inline const AABB FULL_OBSTACLE {};
+
+    const Storage* chunks = nullptr;
+    glm::ivec3 origin {};
+    glm::ivec3 size {};
+    std::vector<Obstacle> obstacles;
+
+    Obstacle gatherVoxel(const Chunk* chunk, int x, int y, int z) const {
+        if (y >= CHUNK_H) {
+            return {};
+        }
+        if (y < 0 || chunk == nullptr) {
+            return {&FULL_OBSTACLE, 1};
+        }
+        int lx = x - chunk->x * CHUNK_W;
+        int lz = z - chunk->z * CHUNK_D;
+        voxel vox = chunk->getVoxel(vox_index(lx, y, lz));
+        const auto& def =
+            chunks->getContentIndices().blocks.require(vox.id);
+        if (!def.obstacle) {
+            return {};
+        }
+        glm::ivec3 offset {};
+        if (vox.state.segment) {
+            glm::ivec3 point(x, y, z);
+            offset =
+                blocks_agent::seek_origin(*chunks, point, def, vox.state) -
+                point;
+        }
+        const auto& boxes =
+            def.rotatable ? def.rt.hitboxes[vox.state.rotation] : def.hitboxes;
+        return {boxes.data(), boxes.size(), offset};
+    }
+public:
+    /// @brief Max window volume. Fast bodies use storage lookups only
+    static inline constexpr int MAX_VOLUME = 16 * 16 * 16;
+    static inline constexpr float MAX_REACH = 8.0f;
+
+    /// @brief Gather obstacles of voxels in range [begin, end]
+    void gather(
+        const Storage& chunks, const glm::ivec3& begin, const glm::ivec3& end
+    ) {
+        this->chunks = &chunks;
+        origin = begin;
+        size = glm::max(end - begin + 1, glm::ivec3(0));
+        if (static_cast<int64_t>(size.x) * size.y * size.z > MAX_VOLUME) {
+            size = {};
+        }
+        obstacles.resize(size.x * size.y * size.z);
+        for (int z = 0; z < size.z; z++) {
+            int gz = origin.z + z;
+            for (int x = 0; x < size.x; x++) {
+                int gx = origin.x + x;
+                const Chunk* chunk = blocks_agent::get_chunk(
+                    chunks, floordiv<CHUNK_W>(gx), floordiv<CHUNK_D>(gz)
+                );
+                for (int y = 0; y < size.y; y++) {
+                    obstacles[(y * size.z + z) * size.x + x] =
+                        gatherVoxel(chunk, gx, origin.y + y, gz);
+                }
+            }
+        }
+    }
+
+    /// @brief Gather obstacles around the hitbox reachable within the step
+    void gather(
+        const Storage& chunks,
+        const glm::vec3& position,
+        const glm::vec3& half,
+        float reach
+    ) {
+        if (!(reach < MAX_REACH)) {
+            gather(chunks, glm::ivec3(0), glm::ivec3(-1));
+            return;
+        }
+        gather(
+            chunks,
+            glm::ivec3(glm::floor(position - half - reach)),
+            glm::ivec3(glm::floor(position + half + reach))
+        );
+    }
+
+    /// @return obstacle hitbox containing the point or nullptr
+    const AABB* isObstacleAt(float x, float y, float z) const {
+        int ix = floor_int(x);
+        int iy = floor_int(y);
+        int iz = floor_int(z);
+        // negative local coordinates become large unsigned values
+        uint lx = ix - origin.x;
+        uint ly = iy - origin.y;
+        uint lz = iz - origin.z;
+        if (lx >= static_cast<uint>(size.x) ||
+            ly >= static_cast<uint>(size.y) ||
+            lz >= static_cast<uint>(size.z)) {
+            return blocks_agent::is_obstacle_at(*chunks, x, y, z);
+        }
+        const auto& obstacle = obstacles[(ly * size.z + lz) * size.x + lx];
+        if (obstacle.hitboxes == &FULL_OBSTACLE) {
+            return obstacle.hitboxes;
+        }
+        const auto& offset = obstacle.offset;
+        glm::vec3 point(
+            x - ix - offset.x, y - iy - offset.y, z - iz - offset.z
+        );
+        for (size_t i = 0; i < obstacle.count; i++) {
+            if (obstacle.hitboxes[i].contains(point)) {
+                return &obstacle.hitboxes[i];
+            }
+        }
+        return nullptr;
+    }
+};
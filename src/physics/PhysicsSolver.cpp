@@ -1,7 +1,9 @@
 #include "PhysicsSolver.hpp"
+#include "CollisionCache.hpp"
 #include "Hitbox.hpp"
 
 #include "maths/aabb.hpp"
+#include "util/ParallelExecutor.hpp"
 #include "voxels/Block.hpp"
 #include "voxels/GlobalChunks.hpp"
 #include "voxels/voxel.hpp"
@@ -13,16 +15,72 @@
 
 inline const float E = 0.03f;
 inline const float MAX_FIX = 0.1f;
+/// @brief Number of hitboxes stepped by a single stepAll job
+inline constexpr size_t STEP_BATCH_SIZE = 32;
+
+using Collisions = CollisionCache<GlobalChunks>;
 
 PhysicsSolver::PhysicsSolver(glm::vec3 gravity) : gravity(gravity) {}
 
+std::vector<GroundedChange> PhysicsSolver::stepAll(
+    const GlobalChunks& chunks,
+    const std::vector<Hitbox*>& hitboxes,
+    float delta,
+    util::ParallelExecutor* executor
+) const {
+    uint workers = executor ? executor->getWorkersCount() : 1;
+    std::vector<std::vector<GroundedChange>> workersChanges(workers);
+    size_t batches =
+        (hitboxes.size() + STEP_BATCH_SIZE - 1) / STEP_BATCH_SIZE;
+    auto stepBatch = [&](size_t batch, uint worker) {
+        size_t end =
+            std::min(hitboxes.size(), (batch + 1) * STEP_BATCH_SIZE);
+        for (size_t i = batch * STEP_BATCH_SIZE; i < end; i++) {
+            auto& hitbox = *hitboxes[i];
+            auto prevVel = hitbox.velocity;
+            bool grounded = hitbox.grounded;
+
+            float vel = glm::length(prevVel);
+            int substeps = static_cast<int>(delta * vel * 20);
+            substeps = std::min(100, std::max(2, substeps));
+            step(chunks, hitbox, delta, substeps);
+            hitbox.friction = glm::abs(hitbox.gravityScale <= 1e-7f)
+                                  ? 8.0f
+                                  : (!grounded ? 2.0f : 10.0f);
+            if (hitbox.grounded != grounded) {
+                workersChanges[worker].push_back(GroundedChange {
+                    i, hitbox.grounded, glm::length(prevVel - hitbox.velocity)
+                });
+            }
+        }
+    };
+    if (executor) {
+        executor->run(batches, stepBatch);
+    } else {
+        for (size_t i = 0; i < batches; i++) {
+            stepBatch(i, 0);
+        }
+    }
+    std::vector<GroundedChange> changes;
+    for (const auto& workerChanges : workersChanges) {
+        changes.insert(
+            changes.end(), workerChanges.begin(), workerChanges.end()
+        );
+    }
+    std::sort(
+        changes.begin(),
+        changes.end(),
+        [](const auto& a, const auto& b) { return a.index < b.index; }
+    );
+    return changes;
+}
+
 void PhysicsSolver::step(
     const GlobalChunks& chunks, 
     Hitbox& hitbox, 
     float delta, 
-    uint substeps, 
-    entityid_t entity
-) {
+    uint substeps
+) const {
     float dt = delta / static_cast<float>(substeps);
     float linearDamping = hitbox.linearDamping * hitbox.friction;
     float s = 2.0f/BLOCK_AABB_GRID;
@@ -34,6 +92,14 @@ void PhysicsSolver::step(
     
     bool prevGrounded = hitbox.grounded;
     hitbox.grounded = false;
+
+    static thread_local Collisions collisions;
+    if (hitbox.type == BodyType::DYNAMIC || hitbox.crouching) {
+        // distance the hitbox may pass during the step plus probes offsets
+        float reach = (glm::length(vel) + glm::length(gravity) *
+                       std::abs(gravityScale) * delta) * delta + 1.0f;
+        collisions.gather(chunks, pos, half, reach);
+    }
     for (uint i = 0; i < substeps; i++) {
         float px = pos.x;
         float py = pos.y;
@@ -41,7 +107,7 @@ void PhysicsSolver::step(
         
         vel += gravity * dt * gravityScale;
         if (hitbox.type == BodyType::DYNAMIC) {
-            colisionCalc(chunks, hitbox, vel, pos, half, 
+            colisionCalc(collisions, hitbox, vel, pos, half, 
                          (prevGrounded && gravityScale > 0.0f) ? 0.5f : 0.0f);
         }
 
@@ -57,7 +123,7 @@ void PhysicsSolver::step(
                 float x = (px-half.x+E) + ix * s;
                 for (int iz = 0; iz <= (half.z-E)*2/s; iz++){
                     float z = (pos.z-half.z+E) + iz * s;
-                    if (chunks.isObstacleAt(x,y,z)){
+                    if (collisions.isObstacleAt(x,y,z)){
                         hitbox.grounded = true;
                         break;
                     }
@@ -71,7 +137,7 @@ void PhysicsSolver::step(
                 float x = (pos.x-half.x+E) + ix * s;
                 for (int iz = 0; iz <= (half.z-E)*2/s; iz++){
                     float z = (pz-half.z+E) + iz * s;
-                    if (chunks.isObstacleAt(x,y,z)){
+                    if (collisions.isObstacleAt(x,y,z)){
                         hitbox.grounded = true;
                         break;
                     }
@@ -88,38 +154,10 @@ void PhysicsSolver::step(
     if (hitbox.verticalDamping > 0.0f) {
         vel.y /= 1.0f + delta * linearDamping * hitbox.verticalDamping;
     }
-
-    AABB aabb;
-    aabb.a = hitbox.position - hitbox.getHalfSize();
-    aabb.b = hitbox.position + hitbox.getHalfSize();
-    for (size_t i = 0; i < sensors.size(); i++) {
-        auto& sensor = *sensors[i];
-        if (sensor.entity == entity) {
-            continue;
-        }
-
-        bool triggered = false;
-        switch (sensor.type) {
-            case SensorType::AABB:
-                triggered = aabb.intersect(sensor.calculated.aabb);
-                break;
-            case SensorType::RADIUS:
-                triggered = glm::distance2(
-                    hitbox.position, glm::vec3(sensor.calculated.radial))
-                     < sensor.calculated.radial.w;
-                break;
-        }
-        if (triggered) {
-            if (sensor.prevEntered.find(entity) == sensor.prevEntered.end()) {
-                sensor.enterCallback(sensor.entity, sensor.index, entity);
-            }
-            sensor.nextEntered.insert(entity);
-        }
-    }
 }
 
 static float calc_step_height(
-    const GlobalChunks& chunks, 
+    const Collisions& collisions, 
     const glm::vec3& pos, 
     const glm::vec3& half,
     float stepHeight,
@@ -130,7 +168,7 @@ static float calc_step_height(
             float x = (pos.x-half.x+E) + ix * s;
             for (int iz = 0; iz <= (half.z-E)*2/s; iz++) {
                 float z = (pos.z-half.z+E) + iz * s;
-                if (chunks.isObstacleAt(x, pos.y+half.y+stepHeight, z)) {
+                if (collisions.isObstacleAt(x, pos.y+half.y+stepHeight, z)) {
                     return 0.0f;
                 }
             }
@@ -141,7 +179,7 @@ static float calc_step_height(
 
 template <int nx, int ny, int nz>
 static bool calc_collision_neg(
-    const GlobalChunks& chunks,
+    const Collisions& collisions,
     glm::vec3& pos,
     glm::vec3& vel,
     const glm::vec3& half,
@@ -159,7 +197,7 @@ static bool calc_collision_neg(
             coord[nz] = (pos[nz]-half[nz]+E) + iz * s;
             coord[nx] = (pos[nx]-half[nx]-E);
 
-            if (const auto aabb = chunks.isObstacleAt(coord.x, coord.y, coord.z)) {
+            if (const auto aabb = collisions.isObstacleAt(coord.x, coord.y, coord.z)) {
                 vel[nx] = 0.0f;
                 float newx = std::floor(coord[nx]) + aabb->max()[nx] + half[nx] + E;
                 if (std::abs(newx-pos[nx]) <= MAX_FIX) {
@@ -174,7 +212,7 @@ static bool calc_collision_neg(
 
 template <int nx, int ny, int nz>
 static void calc_collision_pos(
-    const GlobalChunks& chunks,
+    const Collisions& collisions,
     glm::vec3& pos,
     glm::vec3& vel,
     const glm::vec3& half,
@@ -191,7 +229,7 @@ static void calc_collision_pos(
         for (int iz = 0; iz <= (half[nz]-E)*2/s; iz++) {
             coord[nz] = (pos[nz]-half[nz]+E) + iz * s;
             coord[nx] = (pos[nx]+half[nx]+E);
-            if (const auto aabb = chunks.isObstacleAt(coord.x, coord.y, coord.z)) {
+            if (const auto aabb = collisions.isObstacleAt(coord.x, coord.y, coord.z)) {
                 vel[nx] = 0.0f;
                 float newx = std::floor(coord[nx]) - half[nx] + aabb->min()[nx] - E;
                 if (std::abs(newx-pos[nx]) <= MAX_FIX) {
@@ -204,27 +242,27 @@ static void calc_collision_pos(
 }
 
 void PhysicsSolver::colisionCalc(
-    const GlobalChunks& chunks, 
+    const Collisions& collisions, 
     Hitbox& hitbox, 
     glm::vec3& vel, 
     glm::vec3& pos, 
     const glm::vec3 half,
     float stepHeight
-) {
+) const {
     // step size (smaller - more accurate, but slower)
     float s = 2.0f/BLOCK_AABB_GRID;
 
-    stepHeight = calc_step_height(chunks, pos, half, stepHeight, s);
+    stepHeight = calc_step_height(collisions, pos, half, stepHeight, s);
 
     const AABB* aabb;
     
-    calc_collision_neg<0, 1, 2>(chunks, pos, vel, half, stepHeight, s);
-    calc_collision_pos<0, 1, 2>(chunks, pos, vel, half, stepHeight, s);
+    calc_collision_neg<0, 1, 2>(collisions, pos, vel, half, stepHeight, s);
+    calc_collision_pos<0, 1, 2>(collisions, pos, vel, half, stepHeight, s);
 
-    calc_collision_neg<2, 1, 0>(chunks, pos, vel, half, stepHeight, s);
-    calc_collision_pos<2, 1, 0>(chunks, pos, vel, half, stepHeight, s);
+    calc_collision_neg<2, 1, 0>(collisions, pos, vel, half, stepHeight, s);
+    calc_collision_pos<2, 1, 0>(collisions, pos, vel, half, stepHeight, s);
 
-    if (calc_collision_neg<1, 0, 2>(chunks, pos, vel, half, stepHeight, s)) {
+    if (calc_collision_neg<1, 0, 2>(collisions, pos, vel, half, stepHeight, s)) {
         hitbox.grounded = true;
     }
 
@@ -234,7 +272,7 @@ void PhysicsSolver::colisionCalc(
             for (int iz = 0; iz <= (half.z-E)*2/s; iz++) {
                 float z = (pos.z-half.z+E) + iz * s;
                 float y = (pos.y-half.y+E);
-                if ((aabb = chunks.isObstacleAt(x,y,z))){
+                if ((aabb = collisions.isObstacleAt(x,y,z))){
                     vel.y = 0.0f;
                     float newy = std::floor(y) + aabb->max().y + half.y;
                     if (std::abs(newy-pos.y) <= MAX_FIX+stepHeight) {
@@ -251,7 +289,7 @@ void PhysicsSolver::colisionCalc(
             for (int iz = 0; iz <= (half.z-E)*2/s; iz++) {
                 float z = (pos.z-half.z+E) + iz * s;
                 float y = (pos.y+half.y+E);
-                if ((aabb = chunks.isObstacleAt(x,y,z))){
+                if ((aabb = collisions.isObstacleAt(x,y,z))){
                     vel.y = 0.0f;
                     float newy = std::floor(y) - half.y + aabb->min().y - E;
                     if (std::abs(newy-pos.y) <= MAX_FIX) {
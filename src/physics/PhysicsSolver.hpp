@@ -12,6 +12,22 @@ class Block;
 class GlobalChunks;
 struct Sensor;
 
+template <class Storage>
+class CollisionCache;
+
+namespace util {
+    class ParallelExecutor;
+}
+
+/// @brief Hitbox grounded state change made by PhysicsSolver::stepAll
+struct GroundedChange {
+    /// @brief Hitbox index
+    size_t index;
+    bool grounded;
+    /// @brief Velocity change length
+    float impulse;
+};
+
 class PhysicsSolver {
     glm::vec3 gravity;
     std::vector<Sensor*> sensors;
@@ -21,17 +37,27 @@ public:
         const GlobalChunks& chunks,
         Hitbox& hitbox,
         float delta,
-        uint substeps,
-        entityid_t entity
-    );
-    void colisionCalc(
+        uint substeps
+    ) const;
+    /// @brief Step hitboxes in batches. Chunks must not be modified
+    /// meanwhile. The result does not depend on the number of workers
+    /// @param executor stepping workers or nullptr to step on the calling
+    /// thread only
+    /// @return grounded state changes sorted by hitbox index
+    std::vector<GroundedChange> stepAll(
         const GlobalChunks& chunks,
+        const std::vector<Hitbox*>& hitboxes,
+        float delta,
+        util::ParallelExecutor* executor
+    ) const;
+    void colisionCalc(
+        const CollisionCache<GlobalChunks>& collisions,
         Hitbox& hitbox,
         glm::vec3& vel,
         glm::vec3& pos,
         const glm::vec3 half,
         float stepHeight
-    );
+    ) const;
     bool isBlockInside(int x, int y, int z, Hitbox* hitbox);
     bool isBlockInside(int x, int y, int z, Block* def, blockstate state, Hitbox* hitbox);
 
@@ -39,5 +65,9 @@ public:
         this->sensors = std::move(sensors);
     }
 
+    const std::vector<Sensor*>& getSensors() const {
+        return sensors;
+    }
+
     void removeSensor(Sensor* sensor);
 };
@@ -0,0 +1,109 @@
+#include "SpatialGrid.hpp"
+
+SpatialGrid::SpatialGrid(float cellSize) : cellSize(cellSize) {
+}
+
+glm::ivec3 SpatialGrid::getCell(const glm::vec3& pos) const {
+    return glm::ivec3(glm::floor(pos / cellSize));
+}
+
+bool SpatialGrid::isLarge(const AABB& aabb) const {
+    auto size = aabb.size();
+    return size.x > cellSize || size.y > cellSize || size.z > cellSize;
+}
+
+void SpatialGrid::insert(entityid_t id, const AABB& aabb) {
+    Location location {{}, 0, isLarge(aabb)};
+    std::vector<Entry>* entries = &largeEntries;
+    if (!location.large) {
+        location.cell = getCell(aabb.center());
+        entries = &cells[location.cell];
+    }
+    location.index = entries->size();
+    entries->push_back(Entry {id, aabb});
+    locations[id] = location;
+}
+
+void SpatialGrid::erase(const Location& location) {
+    auto& entries = location.large ? largeEntries : cells.at(location.cell);
+    if (location.index + 1 != entries.size()) {
+        entries[location.index] = entries.back();
+        locations.at(entries[location.index].id).index = location.index;
+    }
+    entries.pop_back();
+    if (!location.large && entries.empty()) {
+        cells.erase(location.cell);
+    }
+}
+
+void SpatialGrid::update(entityid_t id, const AABB& aabb) {
+    const auto& found = locations.find(id);
+    if (found == locations.end()) {
+        insert(id, aabb);
+        return;
+    }
+    const auto& location = found->second;
+    bool large = isLarge(aabb);
+    if (large && location.large) {
+        largeEntries[location.index].aabb = aabb;
+        return;
+    }
+    if (!large && !location.large &&
+        location.cell == getCell(aabb.center())) {
+        cells.at(location.cell)[location.index].aabb = aabb;
+        return;
+    }
+    erase(location);
+    locations.erase(found);
+    insert(id, aabb);
+}
+
+bool SpatialGrid::remove(entityid_t id) {
+    const auto& found = locations.find(id);
+    if (found == locations.end()) {
+        return false;
+    }
+    erase(found->second);
+    locations.erase(found);
+    return true;
+}
+
+void SpatialGrid::clear() {
+    cells.clear();
+    largeEntries.clear();
+    locations.clear();
+}
+
+void SpatialGrid::query(const AABB& area, std::vector<entityid_t>& dst) const {
+    auto collect = [&area, &dst](const std::vector<Entry>& entries) {
+        for (const auto& entry : entries) {
+            if (entry.aabb.intersect(area)) {
+                dst.push_back(entry.id);
+            }
+        }
+    };
+    collect(largeEntries);
+
+    // centers of intersecting objects are at most half of cell away
+    glm::vec3 begin = glm::floor(area.min() / cellSize - 0.5f);
+    glm::vec3 end = glm::floor(area.max() / cellSize + 0.5f);
+    glm::vec3 extent = end - begin + 1.0f;
+    double volume = static_cast<double>(extent.x) * extent.y * extent.z;
+    // also handles non-finite areas
+    if (!(volume < cells.size())) {
+        for (const auto& [_, entries] : cells) {
+            collect(entries);
+        }
+        return;
+    }
+    for (int y = begin.y; y <= end.y; y++) {
+        for (int z = begin.z; z <= end.z; z++) {
+            for (int x = begin.x; x <= end.x; x++) {
+                const auto& found = cells.find(glm::ivec3(x, y, z));
+                if (found != cells.end()) {
+                    collect(found->second);
+                }
+            }
+        }
+    }
+}
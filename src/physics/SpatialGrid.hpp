@@ -0,0 +1,55 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include "maths/aabb.hpp"
+#include "typedefs.hpp"
+
+/// @brief Loose uniform grid broadphase. Every object is stored in the cell
+/// containing its bounding box center, so moving inside a cell costs a
+/// single lookup. Objects larger than a cell are kept in a separate list
+/// checked by every query
+class SpatialGrid {
+    struct Entry {
+        entityid_t id;
+        AABB aabb;
+    };
+    struct Location {
+        glm::ivec3 cell;
+        size_t index;
+        bool large;
+    };
+    float cellSize;
+    std::unordered_map<glm::ivec3, std::vector<Entry>> cells;
+    std::vector<Entry> largeEntries;
+    std::unordered_map<entityid_t, Location> locations;
+
+    glm::ivec3 getCell(const glm::vec3& pos) const;
+    bool isLarge(const AABB& aabb) const;
+    void insert(entityid_t id, const AABB& aabb);
+    void erase(const Location& location);
+public:
+    /// @param cellSize grid cell size, objects with a side greater than
+    /// the cell size are not partitioned
+    SpatialGrid(float cellSize);
+
+    /// @brief Insert the object or update its bounding box
+    void update(entityid_t id, const AABB& aabb);
+
+    /// @return true if the object was found and removed
+    bool remove(entityid_t id);
+
+    void clear();
+
+    /// @brief Append ids of objects which bounding boxes intersect the area
+    void query(const AABB& area, std::vector<entityid_t>& dst) const;
+
+    size_t size() const {
+        return locations.size();
+    }
+};
@@ -44,6 +44,14 @@ struct ChunksSettings {
     IntegerSetting loadDistance {22, 3, 80};
     /// @brief Buffer zone where chunks are not unloading (chunk is unit)
     IntegerSetting padding {2, 1, 8};
+    /// @brief Number of chunk generation worker threads
+    /// (0 - generate chunks on the main thread)
+    IntegerSetting generatorWorkers {2, 0, 32};
+    /// @brief Number of additional threads building chunks lights
+    /// (0 - main thread only)
+    IntegerSetting lightingWorkers {2, 0, 32};
+    /// @brief Pack voxels of idle chunks to save memory
+    FlagSetting packVoxels {true};
 };
 
 struct CameraSettings {
@@ -71,6 +79,8 @@ struct GraphicsSettings {
     FlagSetting denseRender {true};
     /// @brief Enable chunks frustum culling
     FlagSetting frustumCulling {true};
+    /// @brief Skip chunk sections hidden underground
+    FlagSetting caveCulling {true};
     /// @brief Skybox texture face resolution
     IntegerSetting skyboxResolution {64 + 32, 64, 128};
     /// @brief Chunk renderer vertices buffer capacity
@@ -89,6 +99,22 @@ struct GraphicsSettings {
     IntegerSetting denseRenderDistance {56, 0, 10'000};
     /// @brief Soft lighting for blocks
     FlagSetting softLighting {true};
+    /// @brief Merge coplanar faces of full cubes into larger quads
+    FlagSetting greedyMeshing {false};
+    /// @brief Store chunk meshes in the 16 bytes vertex format
+    FlagSetting compactVertices {false};
+};
+
+struct PhysicsSettings {
+    /// @brief Number of additional threads stepping entities physics
+    /// (0 - main thread only)
+    IntegerSetting workers {2, 0, 32};
+};
+
+struct EntitiesSettings {
+    /// @brief Distance from players (in blocks) where entities update rate
+    /// is halved, halved again for each next distance step (0 - disabled)
+    IntegerSetting tickLodDistance {0, 0, 1024};
 };
 
 struct PathfindingSettings {
@@ -101,6 +127,9 @@ struct DebugSettings {
     FlagSetting generatorTestMode {false};
     /// @brief Write lights cache
     FlagSetting doWriteLights {true};
+    /// @brief Compress inventories, entities and blocks data with LZ4.
+    /// Worlds saved this way can't be opened by older engine versions
+    FlagSetting fastDataCompression {false};
     /// @brief Write preprocessed shaders code to user:export
     FlagSetting doTraceShaders {false};
     /// @brief Enable experimental optimizations and features
@@ -125,4 +154,6 @@ struct EngineSettings {
     UiSettings ui;
     NetworkSettings network;
     PathfindingSettings pathfinding;
+    PhysicsSettings physics;
+    EntitiesSettings entities;
 };
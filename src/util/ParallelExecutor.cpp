@@ -0,0 +1,119 @@
+#include "ParallelExecutor.hpp"
+
+#include <algorithm>
+
+#include "debug/Logger.hpp"
+
+using namespace util;
+
+ParallelExecutor::ParallelExecutor(std::string name, int maxWorkers)
+    : name(std::move(name)) {
+    uint numThreads = std::max(1U, std::thread::hardware_concurrency());
+    switch (maxWorkers) {
+        case 0:
+            break;
+        case -2:
+            numThreads = std::max(1U, numThreads / 2);
+            break;
+        case -4:
+            numThreads = std::max(1U, numThreads / 4);
+            break;
+        default:
+            numThreads = std::max(
+                1U, std::min(numThreads, static_cast<uint>(maxWorkers))
+            );
+            break;
+    }
+    // the calling thread is a worker too
+    for (uint i = 1; i < numThreads; i++) {
+        threads.emplace_back(&ParallelExecutor::threadLoop, this, i);
+    }
+    debug::Logger(this->name).info()
+        << "created " << getWorkersCount() << " workers";
+}
+
+ParallelExecutor::~ParallelExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        working = false;
+    }
+    startCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ParallelExecutor::process(uint worker) {
+    while (true) {
+        size_t index = nextIndex++;
+        if (index >= jobsCount) {
+            break;
+        }
+        try {
+            (*job)(index, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error == nullptr) {
+                error = std::current_exception();
+            }
+            // skip remaining jobs
+            nextIndex = jobsCount;
+        }
+    }
+}
+
+void ParallelExecutor::threadLoop(uint worker) {
+    uint64_t lastGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [this, lastGeneration] {
+                return !working || generation != lastGeneration;
+            });
+            if (!working) {
+                break;
+            }
+            lastGeneration = generation;
+        }
+        process(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeWorkers--;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void ParallelExecutor::run(size_t count, const Job& job) {
+    if (count == 0) {
+        return;
+    }
+    if (threads.empty() || count == 1) {
+        for (size_t i = 0; i < count; i++) {
+            job(i, 0);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        jobsCount = count;
+        nextIndex = 0;
+        activeWorkers = threads.size();
+        error = nullptr;
+        generation++;
+    }
+    startCondition.notify_all();
+    process(0);
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+        this->job = nullptr;
+        error = this->error;
+        this->error = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
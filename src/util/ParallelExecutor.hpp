@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "typedefs.hpp"
+
+namespace util {
+    /// @brief Persistent worker threads running indexed jobs in fork-join
+    /// manner. Unlike ThreadPool, run() blocks until all jobs are done.
+    class ParallelExecutor {
+    public:
+        /// @param index job index
+        /// @param worker index of the worker (0 is the calling thread)
+        using Job = std::function<void(size_t index, uint worker)>;
+    private:
+        std::string name;
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable startCondition;
+        std::condition_variable doneCondition;
+        const Job* job = nullptr;
+        size_t jobsCount = 0;
+        std::atomic<size_t> nextIndex = 0;
+        /// @brief Number of workers still processing the current batch
+        uint activeWorkers = 0;
+        /// @brief Incremented on each run() to wake workers up
+        uint64_t generation = 0;
+        bool working = true;
+        std::exception_ptr error;
+
+        void threadLoop(uint worker);
+        void process(uint worker);
+    public:
+        /// @param name executor name (used in logger)
+        /// @param maxWorkers max number of threads including the calling
+        /// one. Special values: 0 is hardware concurrency, -2 is half of it,
+        /// -4 is quarter.
+        ParallelExecutor(std::string name, int maxWorkers);
+        ~ParallelExecutor();
+
+        ParallelExecutor(const ParallelExecutor&) = delete;
+
+        /// @brief Run job for each index in range [0, count) and wait for
+        /// completion. The first exception thrown by a job is rethrown.
+        /// Not reentrant.
+        void run(size_t count, const Job& job);
+
+        /// @return number of workers including the calling thread
+        uint getWorkersCount() const {
+            return threads.size() + 1;
+        }
+    };
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace util {
+    /// @brief First-fit allocator of ranges in a linear space of elements
+    /// (e.g. GPU buffer) with coalescing of freed ranges and compaction
+    class RangeAllocator {
+        size_t capacity;
+        size_t freeSpace;
+        /// @brief Free ranges sizes by offset
+        std::map<size_t, size_t> freeRanges;
+        /// @brief Allocated ranges sizes by offset
+        std::map<size_t, size_t> allocated;
+    public:
+        static inline constexpr size_t INVALID = SIZE_MAX;
+
+        struct Move {
+            size_t from;
+            size_t to;
+            size_t size;
+        };
+
+        explicit RangeAllocator(size_t capacity)
+            : capacity(capacity), freeSpace(capacity) {
+            if (capacity) {
+                freeRanges[0] = capacity;
+            }
+        }
+
+        /// @return offset of the allocated range or INVALID if there is
+        /// no free range large enough
+        size_t allocate(size_t size) {
+            if (size == 0) {
+                throw std::invalid_argument("zero size allocation");
+            }
+            for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+                auto [offset, rangeSize] = *it;
+                if (rangeSize < size) {
+                    continue;
+                }
+                freeRanges.erase(it);
+                if (rangeSize > size) {
+                    freeRanges[offset + size] = rangeSize - size;
+                }
+                allocated[offset] = size;
+                freeSpace -= size;
+                return offset;
+            }
+            return INVALID;
+        }
+
+        void free(size_t offset) {
+            auto found = allocated.find(offset);
+            if (found == allocated.end()) {
+                throw std::runtime_error("range is not allocated");
+            }
+            size_t size = found->second;
+            allocated.erase(found);
+            freeSpace += size;
+
+            auto next = freeRanges.lower_bound(offset);
+            if (next != freeRanges.end() && next->first == offset + size) {
+                size += next->second;
+                next = freeRanges.erase(next);
+            }
+            if (next != freeRanges.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset) {
+                    prev->second += size;
+                    return;
+                }
+            }
+            freeRanges[offset] = size;
+        }
+
+        /// @brief Extend the space keeping allocations in place
+        void grow(size_t newCapacity) {
+            if (newCapacity <= capacity) {
+                return;
+            }
+            size_t extra = newCapacity - capacity;
+            if (!freeRanges.empty()) {
+                auto last = std::prev(freeRanges.end());
+                if (last->first + last->second == capacity) {
+                    last->second += extra;
+                    capacity = newCapacity;
+                    freeSpace += extra;
+                    return;
+                }
+            }
+            freeRanges[capacity] = extra;
+            capacity = newCapacity;
+            freeSpace += extra;
+        }
+
+        /// @brief Pack allocations to the beginning of the space keeping
+        /// their order
+        /// @return new places of all allocations ordered by offset.
+        /// Destination never exceeds source, so the moves may be applied
+        /// in order within the same storage
+        std::vector<Move> defragment() {
+            std::vector<Move> moves;
+            moves.reserve(allocated.size());
+            std::map<size_t, size_t> packed;
+            size_t offset = 0;
+            for (const auto& [from, size] : allocated) {
+                moves.push_back(Move {from, offset, size});
+                packed.emplace_hint(packed.end(), offset, size);
+                offset += size;
+            }
+            allocated = std::move(packed);
+            freeRanges.clear();
+            if (offset < capacity) {
+                freeRanges[offset] = capacity - offset;
+            }
+            return moves;
+        }
+
+        size_t getCapacity() const {
+            return capacity;
+        }
+
+        size_t getFreeSpace() const {
+            return freeSpace;
+        }
+
+        size_t getLargestFreeRange() const {
+            size_t largest = 0;
+            for (const auto& [_, size] : freeRanges) {
+                largest = std::max(largest, size);
+            }
+            return largest;
+        }
+
+        size_t getAllocationsCount() const {
+            return allocated.size();
+        }
+    };
+}
@@ -36,6 +36,8 @@ namespace util {
     class ThreadPool : public Task {
         debug::Logger logger;
         std::queue<T> jobs;
+        /// @brief High priority lane taken by workers before the jobs
+        std::queue<T> priorityJobs;
         std::queue<ThreadPoolResult<T, R>> results;
         std::mutex resultsMutex;
         std::vector<std::thread> threads;
@@ -61,13 +63,15 @@ namespace util {
                 {
                     std::unique_lock<std::mutex> lock(jobsMutex);
                     jobsMutexCondition.wait(lock, [this] {
-                        return !jobs.empty() || !working;
+                        return !jobs.empty() || !priorityJobs.empty() ||
+                               !working;
                     });
                     if (!working || failed) {
                         break;
                     }
-                    job = std::move(jobs.front());
-                    jobs.pop();
+                    auto& queue = priorityJobs.empty() ? jobs : priorityJobs;
+                    job = std::move(queue.front());
+                    queue.pop();
 
                     busyWorkers++;
                 }
@@ -125,7 +129,7 @@ namespace util {
                 case UNLIMITED:
                     break;
                 case HALF:
-                    numThreads = std::max(1U, numThreads);
+                    numThreads = std::max(1U, numThreads / 2);
                     break;
                 case QUARTER:
                     numThreads = std::max(1U, numThreads / 4);
@@ -215,7 +219,7 @@ namespace util {
 
                 if (onComplete && busyWorkers == 0) {
                     std::lock_guard<std::mutex> jobsLock(jobsMutex);
-                    if (jobs.empty()) {
+                    if (jobs.empty() && priorityJobs.empty()) {
                         onComplete();
                         complete = true;
                     }
@@ -229,10 +233,12 @@ namespace util {
             }
         }
 
-        void enqueueJob(T job) {
+        /// @param priority put the job to the high priority lane, taken
+        /// by workers before all regular jobs
+        void enqueueJob(T job, bool priority = false) {
             {
                 std::lock_guard<std::mutex> lock(jobsMutex);
-                jobs.push(std::move(job));
+                (priority ? priorityJobs : jobs).push(std::move(job));
             }
             jobsMutexCondition.notify_one();
         }
@@ -240,6 +246,7 @@ namespace util {
         void clearQueue() {
             std::lock_guard<std::mutex> lock(jobsMutex);
             jobs = {};
+            priorityJobs = {};
         }
 
         /// @brief If false: worker will be blocked until it's result performed
@@ -264,7 +271,7 @@ namespace util {
         }
 
         uint getWorkTotal() const override {
-            return jobs.size() + jobsDone + busyWorkers;
+            return jobs.size() + priorityJobs.size() + jobsDone + busyWorkers;
         }
 
         uint getWorkDone() const override {
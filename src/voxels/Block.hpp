@@ -39,6 +39,21 @@ inline constexpr int BLOCK_MAX_VARIANTS = 16;
 
 inline std::string DEFAULT_MATERIAL = "base:stone";
 
+/// @brief Interned ids of block script events (see lua::intern_event)
+struct BlockEventIds {
+    int update;
+    int randupdate;
+    int placed;
+    int replaced;
+    int breaking;
+    int broken;
+    int interact;
+    int blocktick;
+    int blockstick;
+    int blockpresent;
+    int blockremoved;
+};
+
 struct BlockFuncsSet {
     bool init : 1;
     bool update : 1;
@@ -52,6 +67,7 @@ struct BlockFuncsSet {
     bool onblockstick : 1;
     bool onblockpresent : 1;
     bool onblockremoved : 1;
+    BlockEventIds events;
 };
 
 struct CoordSystem {
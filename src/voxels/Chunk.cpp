@@ -9,27 +9,70 @@
 #include "voxel.hpp"
 
 Chunk::Chunk(int xpos, int zpos, std::shared_ptr<Lightmap> lightmap)
-    : x(xpos), z(zpos), lightmap(std::move(lightmap)) {
+    : voxels(std::make_unique<voxel[]>(CHUNK_VOL)),
+      x(xpos),
+      z(zpos),
+      lightmap(std::move(lightmap)) {
     bottom = 0;
     top = CHUNK_H;
 }
 
 void Chunk::updateHeights() {
     flags.dirtyHeights = false;
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        if (voxels[i].id != 0) {
-            bottom = i / (CHUNK_D * CHUNK_W);
-            break;
+    // packed voxels are read by sections to avoid per-voxel unpacking
+    voxel sectionBuffer[VOXELS_SECTION_VOL];
+    int lowest = -1;
+    for (uint s = 0; s < VOXELS_SECTIONS && lowest == -1; s++) {
+        const voxel* section = getSection(s, sectionBuffer);
+        for (uint i = 0; i < VOXELS_SECTION_VOL; i++) {
+            if (section[i].id != 0) {
+                lowest = s * VOXELS_SECTION_VOL + i;
+                break;
+            }
         }
     }
-    for (int i = CHUNK_VOL - 1; i >= 0; i--) {
-        if (voxels[i].id != 0) {
-            top = i / (CHUNK_D * CHUNK_W) + 1;
-            break;
+    if (lowest == -1) {
+        return;
+    }
+    bottom = lowest / (CHUNK_D * CHUNK_W);
+    for (int s = VOXELS_SECTIONS - 1; s >= 0; s--) {
+        const voxel* section = getSection(s, sectionBuffer);
+        for (int i = VOXELS_SECTION_VOL - 1; i >= 0; i--) {
+            if (section[i].id != 0) {
+                top = (s * VOXELS_SECTION_VOL + i) / (CHUNK_D * CHUNK_W) + 1;
+                return;
+            }
         }
     }
 }
 
+void Chunk::unpackVoxels() {
+    voxels.reset(new voxel[CHUNK_VOL]);
+    packedVoxels->unpack(voxels.get());
+    packedVoxels = nullptr;
+}
+
+bool Chunk::packIdleVoxels() {
+    if (voxels == nullptr) {
+        return true;
+    }
+    if (voxelsAccessed) {
+        voxelsAccessed = false;
+        return false;
+    }
+    packedVoxels = std::make_unique<PalettedVoxels>();
+    packedVoxels->pack(voxels.get());
+    voxels = nullptr;
+    return true;
+}
+
+size_t Chunk::getVoxelsMemoryUsage() const {
+    if (voxels) {
+        return CHUNK_VOL * sizeof(voxel);
+    }
+    return packedVoxels->getMemoryUsage();
+}
+
 void Chunk::addBlockInventory(
     std::shared_ptr<Inventory> inventory, uint x, uint y, uint z
 ) {
@@ -71,21 +114,29 @@ std::shared_ptr<Inventory> Chunk::getBlockInventory(uint x, uint y, uint z)
 std::unique_ptr<ubyte[]> Chunk::encode() const {
     auto buffer = std::make_unique<ubyte[]>(CHUNK_DATA_LEN);
     auto dst = reinterpret_cast<uint16_t*>(buffer.get());
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        dst[i] = dataio::h2le(voxels[i].id);
-        dst[CHUNK_VOL + i] = dataio::h2le(blockstate2int(voxels[i].state));
+    voxel sectionBuffer[VOXELS_SECTION_VOL];
+    for (uint section = 0; section < VOXELS_SECTIONS; section++) {
+        const voxel* src = getSection(section, sectionBuffer);
+        uint offset = section * VOXELS_SECTION_VOL;
+        for (uint i = 0; i < VOXELS_SECTION_VOL; i++) {
+            dst[offset + i] = dataio::h2le(src[i].id);
+            dst[CHUNK_VOL + offset + i] =
+                dataio::h2le(blockstate2int(src[i].state));
+        }
     }
     return buffer;
 }
 
 bool Chunk::decode(const ubyte* data) {
     auto src = reinterpret_cast<const uint16_t*>(data);
+    voxel* voxels = getVoxels();
     for (uint i = 0; i < CHUNK_VOL; i++) {
         voxel& vox = voxels[i];
 
         vox.id = dataio::le2h(src[i]);
         vox.state = int2blockstate(dataio::le2h(src[CHUNK_VOL + i]));
     }
+    flags.randomTicksCounted = false;
     return true;
 }
 
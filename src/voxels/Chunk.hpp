@@ -2,6 +2,8 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <unordered_map>
 
@@ -9,6 +11,7 @@
 #include "lighting/Lightmap.hpp"
 #include "util/SmallHeap.hpp"
 #include "maths/aabb.hpp"
+#include "PalettedVoxels.hpp"
 #include "voxel.hpp"
 
 /// @brief Total bytes number of chunk voxel data
@@ -23,10 +26,17 @@ using ChunkInventoriesMap =
 using BlocksMetadata = util::SmallHeap<uint16_t, uint8_t>;
 
 class Chunk {
+    /// @brief Unpacked voxels. nullptr while voxels are packed
+    std::unique_ptr<voxel[]> voxels;
+    /// @brief Packed voxels. nullptr while voxels are unpacked
+    std::unique_ptr<PalettedVoxels> packedVoxels;
+    /// @brief Set on unpacked voxels access, reset by packIdleVoxels
+    bool voxelsAccessed = false;
+
+    void unpackVoxels();
 public:
     int x, z;
     int bottom, top;
-    voxel voxels[CHUNK_VOL] {};
     std::shared_ptr<Lightmap> lightmap;
     struct {
         bool modified : 1;
@@ -38,7 +48,18 @@ public:
         bool entities : 1;
         bool blocksData : 1;
         bool dirtyHeights : 1;
+        /// @brief randomTickBlocks is valid
+        bool randomTicksCounted : 1;
     } flags {};
+    /// @brief Bit mask of vertical sections to remesh, updated along with
+    /// flags.modified
+    uint32_t modifiedSections = 0;
+    /// @brief Number of blocks having on_random_update event per section.
+    /// Counted by blocks_agent::count_random_tick_blocks, updated on block
+    /// set while flags.randomTicksCounted is set
+    std::array<uint16_t, VOXELS_SECTIONS> randomTickBlocks {};
+    /// @brief Generation of the last random tick (see BlocksController)
+    uint32_t randomTickStamp = 0;
 
     /// @brief Block inventories map where key is index of block in voxels array
     ChunkInventoriesMap inventories;
@@ -50,6 +71,52 @@ public:
     /// @brief Refresh `bottom` and `top` values
     void updateHeights();
 
+    /// @brief Get voxels array unpacking voxels if packed. The pointer is
+    /// valid until voxels are packed by packIdleVoxels
+    voxel* getVoxels() {
+        if (voxels == nullptr) {
+            unpackVoxels();
+        }
+        // no writes if accessed already as voxels are read concurrently
+        if (!voxelsAccessed) {
+            voxelsAccessed = true;
+        }
+        return voxels.get();
+    }
+
+    /// @brief Get voxel without unpacking voxels
+    /// @param index voxel index in the voxels array
+    voxel getVoxel(uint index) const {
+        if (voxels) {
+            return voxels[index];
+        }
+        return packedVoxels->get(index);
+    }
+
+    /// @brief Get section voxels without unpacking voxels
+    /// @param index section index
+    /// @param buffer VOXELS_SECTION_VOL voxels array used if voxels are packed
+    /// @return section voxels (valid until voxels are packed or unpacked)
+    const voxel* getSection(uint index, voxel* buffer) const {
+        if (voxels) {
+            return voxels.get() + index * VOXELS_SECTION_VOL;
+        }
+        packedVoxels->unpackSection(index, buffer);
+        return buffer;
+    }
+
+    /// @brief Pack voxels if not accessed via getVoxels since
+    /// the previous call
+    /// @return true if voxels are packed
+    bool packIdleVoxels();
+
+    bool isPacked() const {
+        return voxels == nullptr;
+    }
+
+    /// @return memory used by voxels in bytes
+    size_t getVoxelsMemoryUsage() const;
+
     /// @brief Creates new block inventory given size
     /// @return inventory id or 0 if block does not exists
     void addBlockInventory(
@@ -61,8 +128,33 @@ public:
     /// @return inventory bound to the given block or nullptr
     std::shared_ptr<Inventory> getBlockInventory(uint x, uint y, uint z) const;
 
-    inline void setModifiedAndUnsaved() {
+    static inline constexpr uint32_t ALL_SECTIONS =
+        (1ULL << CHUNK_SECTIONS) - 1;
+
+    /// @brief Mark all sections modified
+    inline void setModified() {
         flags.modified = true;
+        modifiedSections = ALL_SECTIONS;
+    }
+
+    /// @brief Mark sections modified by a change of voxel or light at the
+    /// given level. Neighbour levels faces and ambient occlusion depend on it
+    inline void setModified(int y) {
+        flags.modified = true;
+        int lower = std::max(y - 1, 0) / CHUNK_SECTION_H;
+        int upper = std::min(y + 1, CHUNK_H - 1) / CHUNK_SECTION_H;
+        for (int i = lower; i <= upper; i++) {
+            modifiedSections |= 1U << i;
+        }
+    }
+
+    inline void setModifiedAndUnsaved() {
+        setModified();
+        flags.unsaved = true;
+    }
+
+    inline void setModifiedAndUnsaved(int y) {
+        setModified(y);
         flags.unsaved = true;
     }
 
@@ -33,6 +33,7 @@ Chunks::Chunks(
       areaMap(w, d) {
     areaMap.setCenter(ox - w / 2, oz - d / 2);
     areaMap.setOutCallback([this](int, int, const auto& chunk) {
+        removalsGeneration++;
         this->events->trigger(LevelEventType::CHUNK_HIDDEN, chunk.get());
     });
 }
@@ -380,10 +381,17 @@ void Chunks::getVoxels(VoxelsVolume& volume, bool backlight, int top) const {
                     }
                 }
             } else {
-                const voxel* cvoxels = chunk->voxels;
                 const light_t* clights =
                     chunk->lightmap ? chunk->lightmap->getLights() : nullptr;
+                // packed chunk voxels are unpacked by sections
+                voxel sectionBuffer[VOXELS_SECTION_VOL];
+                const voxel* section = nullptr;
                 for (int ly = y; ly < y + h; ly++) {
+                    if (section == nullptr || ly % VOXELS_SECTION_H == 0) {
+                        section = chunk->getSection(
+                            ly / VOXELS_SECTION_H, sectionBuffer
+                        );
+                    }
                     for (int lz = std::max(z, cz * CHUNK_D);
                              lz < std::min(z + d, (cz + 1) * CHUNK_D);
                              lz++) {
@@ -398,7 +406,7 @@ void Chunks::getVoxels(VoxelsVolume& volume, bool backlight, int top) const {
                                 CHUNK_W,
                                 CHUNK_D
                             );
-                            voxels[vidx] = cvoxels[cidx];
+                            voxels[vidx] = section[cidx % VOXELS_SECTION_VOL];
                             light_t light = clights ? clights[cidx]
                                                     : Lightmap::SUN_LIGHT_ONLY;
                             if (backlight) {
@@ -40,6 +40,8 @@ class Chunks {
     );
 
     util::AreaMap2D<std::shared_ptr<Chunk>, int32_t> areaMap;
+    /// @brief Incremented on every chunk removal
+    uint64_t removalsGeneration = 0;
 public:
     Chunks(
         int32_t w,
@@ -158,10 +160,20 @@ public:
         return areaMap.getOffsetY();
     }
 
+    bool isInside(int32_t x, int32_t z) const {
+        return areaMap.isInside(x, z);
+    }
+
     size_t getChunksCount() const {
         return areaMap.count();
     }
 
+    /// @brief Changes when any chunk is removed from the matrix,
+    /// including chunks left out of the area after move or resize
+    uint64_t getRemovalsGeneration() const {
+        return removalsGeneration;
+    }
+
     size_t getVolume() const {
         return areaMap.area();
     }
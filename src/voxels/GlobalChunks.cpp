@@ -7,6 +7,7 @@
 #include "coders/json.hpp"
 #include "content/Content.hpp"
 #include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
 #include "items/Inventories.hpp"
 #include "lighting/Lightmap.hpp"
 #include "maths/voxmaths.hpp"
@@ -42,8 +43,9 @@ std::shared_ptr<Chunk> GlobalChunks::fetch(int x, int z) {
 static void check_voxels(const ContentIndices& indices, Chunk& chunk) {
     bool corrupted = false;
     blockid_t defsCount = indices.blocks.count();
+    voxel* voxels = chunk.getVoxels();
     for (size_t i = 0; i < CHUNK_VOL; i++) {
-        blockid_t id = chunk.voxels[i].id;
+        blockid_t id = voxels[i].id;
         if (id >= defsCount) {
             if (!corrupted) {
 #ifdef NDEBUG
@@ -58,7 +60,7 @@ static void check_voxels(const ContentIndices& indices, Chunk& chunk) {
                 abort();
 #endif
             }
-            chunk.voxels[i] = {};
+            voxels[i] = {};
         }
     }
 }
@@ -76,7 +78,7 @@ static inline auto load_inventories(
     auto iterator = invs.begin();
     while (iterator != invs.end()) {
         uint index = iterator->first;
-        const auto& def = defs.require(chunk.voxels[index].id);
+        const auto& def = defs.require(chunk.getVoxel(index).id);
         if (def.inventorySize == 0) {
             iterator = invs.erase(iterator);
             continue;
@@ -98,6 +100,9 @@ std::shared_ptr<Chunk> GlobalChunks::create(int x, int z, bool lighting) {
     if (found != chunksMap.end()) {
         return found->second;
     }
+    if (isPending(x, z)) {
+        return nullptr;
+    }
     static std::unique_ptr<ubyte[]> voxelDataBuffer = nullptr;
     if (voxelDataBuffer == nullptr) {
         voxelDataBuffer = std::make_unique<ubyte[]>(CHUNK_DATA_LEN);
@@ -110,6 +115,7 @@ std::shared_ptr<Chunk> GlobalChunks::create(int x, int z, bool lighting) {
     World& world = *level.getWorld();
     auto& regions = world.wfile.get()->getRegions();
 
+    debug::ProfileScope profile(debug::ProfileStage::REGION_LOAD);
     if (regions.getVoxels(chunk->x, chunk->z, voxelDataBuffer.get())) {
         const auto& indices = *level.content.getIndices();
 
@@ -130,6 +136,8 @@ std::shared_ptr<Chunk> GlobalChunks::create(int x, int z, bool lighting) {
         for (auto& entry : chunk->inventories) {
             level.inventories->store(entry.second);
         }
+    } else {
+        profile.cancel();
     }
     if (chunk->lightmap) {
         if (regions.getLights(chunk->x, chunk->z, voxelDataBuffer.get())) {
@@ -141,6 +149,31 @@ std::shared_ptr<Chunk> GlobalChunks::create(int x, int z, bool lighting) {
     return chunk;
 }
 
+void GlobalChunks::setPending(std::shared_ptr<Chunk> chunk) {
+    auto key = keyfrom(chunk->x, chunk->z);
+    chunksMap.erase(key);
+    pendingChunks[key] = std::move(chunk);
+}
+
+std::shared_ptr<Chunk> GlobalChunks::commitPending(int x, int z) {
+    const auto& found = pendingChunks.find(keyfrom(x, z));
+    if (found == pendingChunks.end()) {
+        return nullptr;
+    }
+    auto chunk = std::move(found->second);
+    pendingChunks.erase(found);
+    chunksMap[keyfrom(x, z)] = chunk;
+    return chunk;
+}
+
+void GlobalChunks::erasePending(int x, int z) {
+    pendingChunks.erase(keyfrom(x, z));
+}
+
+bool GlobalChunks::isPending(int x, int z) const {
+    return pendingChunks.find(keyfrom(x, z)) != pendingChunks.end();
+}
+
 void GlobalChunks::pinChunk(std::shared_ptr<Chunk> chunk) {
     pinnedChunks[{chunk->x, chunk->z}] = std::move(chunk);
 }
@@ -214,6 +247,21 @@ void GlobalChunks::putChunk(std::shared_ptr<Chunk> chunk) {
     chunksMap[keyfrom(chunk->x, chunk->z)] = std::move(chunk);
 }
 
+size_t GlobalChunks::packIdleVoxels(int part, int parts) {
+    size_t packed = 0;
+    for (const auto& [_, chunk] : chunksMap) {
+        if (!chunk->flags.loaded) {
+            continue;
+        }
+        uint hash = (chunk->x * 73856093U) ^ (chunk->z * 19349663U);
+        if (hash % parts != static_cast<uint>(part)) {
+            continue;
+        }
+        packed += chunk->packIdleVoxels();
+    }
+    return packed;
+}
+
 const AABB* GlobalChunks::isObstacleAt(float x, float y, float z) const {
     return blocks_agent::is_obstacle_at(*this, x, y, z);
 }
@@ -29,6 +29,8 @@ class GlobalChunks {
     Level& level;
     const ContentIndices& indices;
     std::unordered_map<uint64_t, std::shared_ptr<Chunk>> chunksMap;
+    /// @brief Chunks being generated or generated but not requested yet
+    std::unordered_map<uint64_t, std::shared_ptr<Chunk>> pendingChunks;
     std::unordered_map<glm::ivec2, std::shared_ptr<Chunk>> pinnedChunks;
     std::unordered_map<ptrdiff_t, int> refCounters;
 
@@ -40,8 +42,19 @@ public:
     void setOnUnload(consumer<Chunk&> onUnload);
 
     std::shared_ptr<Chunk> fetch(int x, int z);
+    /// @return nullptr if the chunk is pending (see setPending)
     std::shared_ptr<Chunk> create(int x, int z, bool lighting);
 
+    /// @brief Move the chunk out of the storage until commitPending.
+    /// Meanwhile the chunk is not accessible and create() returns nullptr
+    /// at its position instead of creating it again
+    void setPending(std::shared_ptr<Chunk> chunk);
+    /// @brief Put the pending chunk to the storage
+    /// @return the chunk or nullptr if there is no pending chunk
+    std::shared_ptr<Chunk> commitPending(int x, int z);
+    void erasePending(int x, int z);
+    bool isPending(int x, int z) const;
+
     void pinChunk(std::shared_ptr<Chunk> chunk);
     void unpinChunk(int x, int z);
 
@@ -57,6 +70,13 @@ public:
 
     void putChunk(std::shared_ptr<Chunk> chunk);
 
+    /// @brief Pack voxels of chunks not accessed since the previous call.
+    /// Chunks are split to parts by coordinates to spread work over frames
+    /// @param part index of the chunks part to process
+    /// @param parts number of parts
+    /// @return number of packed chunks
+    size_t packIdleVoxels(int part = 0, int parts = 1);
+
     const AABB* isObstacleAt(float x, float y, float z) const;
 
     inline Chunk* getChunk(int cx, int cz) const {
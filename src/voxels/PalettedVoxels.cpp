@@ -0,0 +1,170 @@
+#include "PalettedVoxels.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static inline uint32_t voxel_key(voxel vox) {
+    uint32_t key;
+    std::memcpy(&key, &vox, sizeof(key));
+    return key;
+}
+
+namespace {
+    /// @brief Voxel to palette index map. Cleared in O(1) by switching
+    /// to the next generation
+    class PaletteBuilder {
+        struct Entry {
+            uint32_t key;
+            uint16_t index;
+            uint16_t generation;
+        };
+        /// @brief Twice as large as the max palette size
+        static constexpr uint32_t CAPACITY_LOG = 13;
+        static constexpr uint32_t CAPACITY = 1 << CAPACITY_LOG;
+        static_assert(CAPACITY >= VOXELS_SECTION_VOL * 2);
+
+        std::unique_ptr<Entry[]> entries;
+        uint16_t generation = 0;
+    public:
+        std::vector<voxel> palette;
+
+        PaletteBuilder() : entries(std::make_unique<Entry[]>(CAPACITY)) {
+        }
+
+        void reset() {
+            palette.clear();
+            if (++generation == 0) {
+                std::fill(entries.get(), entries.get() + CAPACITY, Entry {});
+                generation = 1;
+            }
+        }
+
+        uint16_t indexOf(voxel vox, uint32_t key) {
+            uint32_t slot = (key * 2654435761U) >> (32 - CAPACITY_LOG);
+            while (true) {
+                auto& entry = entries[slot];
+                if (entry.generation != generation) {
+                    entry.key = key;
+                    entry.index = static_cast<uint16_t>(palette.size());
+                    entry.generation = generation;
+                    palette.push_back(vox);
+                    return entry.index;
+                }
+                if (entry.key == key) {
+                    return entry.index;
+                }
+                slot = (slot + 1) & (CAPACITY - 1);
+            }
+        }
+    };
+}
+
+static inline uint8_t bits_for(size_t paletteSize) {
+    uint8_t bits = 1;
+    while ((1ULL << bits) < paletteSize) {
+        bits *= 2;
+    }
+    return bits;
+}
+
+PalettedVoxels::PalettedVoxels() {
+    for (auto& section : sections) {
+        section.palette.push_back(voxel {});
+    }
+}
+
+void PalettedVoxels::packSection(Section& section, const voxel* voxels) {
+    uint32_t firstKey = voxel_key(voxels[0]);
+    uint uniformEnd = 1;
+    while (uniformEnd < VOXELS_SECTION_VOL &&
+           voxel_key(voxels[uniformEnd]) == firstKey) {
+        uniformEnd++;
+    }
+    if (uniformEnd == VOXELS_SECTION_VOL) {
+        section.palette.assign(1, voxels[0]);
+        section.indices = nullptr;
+        section.bits = 0;
+        return;
+    }
+    // the table is reused to avoid allocation per section
+    static thread_local PaletteBuilder builder;
+    builder.reset();
+
+    uint16_t indices[VOXELS_SECTION_VOL];
+    uint32_t lastKey = firstKey;
+    uint16_t lastIndex = builder.indexOf(voxels[0], firstKey);
+    for (uint i = 0; i < VOXELS_SECTION_VOL; i++) {
+        uint32_t key = voxel_key(voxels[i]);
+        if (key != lastKey) {
+            lastKey = key;
+            lastIndex = builder.indexOf(voxels[i], key);
+        }
+        indices[i] = lastIndex;
+    }
+    uint8_t bits = bits_for(builder.palette.size());
+    uint perWord = 64 / bits;
+    auto words = std::make_unique<uint64_t[]>(VOXELS_SECTION_VOL / perWord);
+    for (uint i = 0; i < VOXELS_SECTION_VOL; i++) {
+        words[i / perWord] |=
+            static_cast<uint64_t>(indices[i]) << ((i % perWord) * bits);
+    }
+    section.palette =
+        std::vector<voxel>(builder.palette.begin(), builder.palette.end());
+    section.indices = std::move(words);
+    section.bits = bits;
+}
+
+void PalettedVoxels::pack(const voxel* voxels) {
+    for (uint i = 0; i < VOXELS_SECTIONS; i++) {
+        packSection(sections[i], voxels + i * VOXELS_SECTION_VOL);
+    }
+}
+
+template <int BITS>
+static void unpack_indices(
+    const uint64_t* words, const voxel* palette, voxel* dst
+) {
+    constexpr int PER_WORD = 64 / BITS;
+    constexpr uint64_t MASK = (1ULL << BITS) - 1;
+    for (int i = 0; i < VOXELS_SECTION_VOL / PER_WORD; i++) {
+        uint64_t word = words[i];
+        for (int j = 0; j < PER_WORD; j++) {
+            *dst++ = palette[word & MASK];
+            word >>= BITS;
+        }
+    }
+}
+
+void PalettedVoxels::unpackSection(uint index, voxel* dst) const {
+    const auto& section = sections[index];
+    const uint64_t* words = section.indices.get();
+    const voxel* palette = section.palette.data();
+    switch (section.bits) {
+        case 0:
+            std::fill(dst, dst + VOXELS_SECTION_VOL, palette[0]);
+            break;
+        case 1: unpack_indices<1>(words, palette, dst); break;
+        case 2: unpack_indices<2>(words, palette, dst); break;
+        case 4: unpack_indices<4>(words, palette, dst); break;
+        case 8: unpack_indices<8>(words, palette, dst); break;
+        case 16: unpack_indices<16>(words, palette, dst); break;
+    }
+}
+
+void PalettedVoxels::unpack(voxel* dst) const {
+    for (uint i = 0; i < VOXELS_SECTIONS; i++) {
+        unpackSection(i, dst + i * VOXELS_SECTION_VOL);
+    }
+}
+
+size_t PalettedVoxels::getMemoryUsage() const {
+    size_t usage = sizeof(PalettedVoxels);
+    for (const auto& section : sections) {
+        usage += section.palette.capacity() * sizeof(voxel);
+        if (section.bits) {
+            uint words = VOXELS_SECTION_VOL / (64 / section.bits);
+            usage += words * sizeof(uint64_t);
+        }
+    }
+    return usage;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "constants.hpp"
+#include "voxel.hpp"
+
+/// @brief Height of chunk voxels section
+inline constexpr int VOXELS_SECTION_H = 16;
+/// @brief Number of voxels in a section. Section voxels are a contiguous
+/// part of the chunk voxels array
+inline constexpr int VOXELS_SECTION_VOL = CHUNK_W * CHUNK_D * VOXELS_SECTION_H;
+inline constexpr int VOXELS_SECTIONS = CHUNK_H / VOXELS_SECTION_H;
+
+/// @brief Compact chunk voxels storage. Each section keeps palette of its
+/// distinct voxels and palette indices packed with minimal bits per voxel
+/// (1, 2, 4, 8 or 16). Uniform sections keep the single voxel only
+class PalettedVoxels {
+    struct Section {
+        /// @brief Distinct section voxels
+        std::vector<voxel> palette;
+        /// @brief Palette indices packed to 64-bit words.
+        /// nullptr if the section is uniform
+        std::unique_ptr<uint64_t[]> indices;
+        /// @brief Bits per palette index (0 if the section is uniform)
+        uint8_t bits = 0;
+    };
+    Section sections[VOXELS_SECTIONS];
+
+    static void packSection(Section& section, const voxel* voxels);
+public:
+    /// @brief Create storage filled with air
+    PalettedVoxels();
+
+    /// @brief Pack voxels array
+    /// @param voxels CHUNK_VOL voxels
+    void pack(const voxel* voxels);
+
+    /// @brief Unpack all voxels
+    /// @param dst CHUNK_VOL voxels array
+    void unpack(voxel* dst) const;
+
+    /// @brief Unpack section voxels
+    /// @param dst VOXELS_SECTION_VOL voxels array
+    void unpackSection(uint index, voxel* dst) const;
+
+    /// @param index voxel index in the chunk voxels array
+    voxel get(uint index) const {
+        const auto& section = sections[index / VOXELS_SECTION_VOL];
+        if (section.bits == 0) {
+            return section.palette[0];
+        }
+        index %= VOXELS_SECTION_VOL;
+        uint perWord = 64 / section.bits;
+        uint64_t word = section.indices[index / perWord];
+        uint shift = (index % perWord) * section.bits;
+        uint64_t mask = (1ULL << section.bits) - 1;
+        return section.palette[(word >> shift) & mask];
+    }
+
+    bool isUniform(uint section) const {
+        return sections[section].bits == 0;
+    }
+
+    /// @return heap and object memory used in bytes
+    size_t getMemoryUsage() const;
+};
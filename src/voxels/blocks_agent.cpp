@@ -9,7 +9,7 @@ using namespace blocks_agent;
 static std::vector<BlockRegisterEvent> block_register_events {};
 
 std::vector<BlockRegisterEvent> blocks_agent::pull_register_events() {
-    auto events = block_register_events;
+    auto events = std::move(block_register_events);
     block_register_events.clear();
     return events;
 }
@@ -28,22 +28,35 @@ static void on_chunk_register_event(
     const Chunk& chunk,
     bool present
 ) {
-    const auto& voxels = chunk.voxels;
-
     int totalBegin = chunk.bottom * (CHUNK_W * CHUNK_D);
     int totalEnd = chunk.top * (CHUNK_W * CHUNK_D);
 
+    // removed chunk blocks are unregistered at once, so only blocks
+    // having on_block_removed event are listed
+    uint8_t mask = 0x7F;
+    if (!present) {
+        mask = BlockRegisterEvent::REMOVED_EVENT_BIT;
+        block_register_events.push_back(BlockRegisterEvent {
+            BlockRegisterEvent::CHUNK_REMOVED_BIT, 0, {chunk.x, 0, chunk.z}
+        });
+    }
     uint8_t flagsCache[1024] {};
 
+    // removed chunk voxels may be packed
+    voxel sectionBuffer[VOXELS_SECTION_VOL];
+    const voxel* section = nullptr;
     for (int i = totalBegin; i < totalEnd; i++) {
-        blockid_t id = voxels[i].id;
+        if (section == nullptr || i % VOXELS_SECTION_VOL == 0) {
+            section = chunk.getSection(i / VOXELS_SECTION_VOL, sectionBuffer);
+        }
+        blockid_t id = section[i % VOXELS_SECTION_VOL].id;
         uint8_t bits = id < sizeof(flagsCache) ? flagsCache[id] : 0;
         if ((bits & 0x80) == 0) {
             const auto& def = indices.blocks.require(id);
             bits = get_events_bits(def);
             flagsCache[id] = bits | 0x80;
         }
-        bits &= 0x7F;
+        bits &= mask;
         if (bits == 0) {
             continue;
         }
@@ -68,22 +81,49 @@ void blocks_agent::on_chunk_remove(
     on_chunk_register_event(indices, chunk, false);
 }
 
+void blocks_agent::count_random_tick_blocks(
+    const ContentIndices& indices, Chunk& chunk
+) {
+    chunk.randomTickBlocks.fill(0);
+    chunk.flags.randomTicksCounted = true;
+
+    const auto& blocks = indices.blocks;
+    voxel sectionBuffer[VOXELS_SECTION_VOL];
+    int topSection = (chunk.top + VOXELS_SECTION_H - 1) / VOXELS_SECTION_H;
+    for (int s = chunk.bottom / VOXELS_SECTION_H; s < topSection; s++) {
+        const voxel* section = chunk.getSection(s, sectionBuffer);
+        blockid_t prevId = BLOCK_VOID;
+        bool randupdate = false;
+        uint16_t count = 0;
+        for (int i = 0; i < VOXELS_SECTION_VOL; i++) {
+            blockid_t id = section[i].id;
+            // voxels of the same id mostly go in rows
+            if (id != prevId) {
+                prevId = id;
+                randupdate = blocks.require(id).rt.funcsset.randupdate;
+            }
+            count += randupdate;
+        }
+        chunk.randomTickBlocks[s] = count;
+    }
+}
+
 template <class Storage>
 static void mark_neighboirs_modified(
-    Storage& chunks, int32_t cx, int32_t cz, int32_t lx, int32_t lz
+    Storage& chunks, int32_t cx, int32_t cz, int32_t lx, int32_t y, int32_t lz
 ) {
     Chunk* chunk;
     if (lx == 0 && (chunk = get_chunk(chunks, cx - 1, cz))) {
-        chunk->flags.modified = true;
+        chunk->setModified(y);
     }
     if (lz == 0 && (chunk = get_chunk(chunks, cx, cz - 1))) {
-        chunk->flags.modified = true;
+        chunk->setModified(y);
     }
     if (lx == CHUNK_W - 1 && (chunk = get_chunk(chunks, cx + 1, cz))) {
-        chunk->flags.modified = true;
+        chunk->setModified(y);
     }
     if (lz == CHUNK_D - 1 && (chunk = get_chunk(chunks, cx, cz + 1))) {
-        chunk->flags.modified = true;
+        chunk->setModified(y);
     }
 }
 
@@ -120,6 +160,9 @@ static void finalize_block(
             chunk.flags.blocksData = true;
         }
     }
+    if (def.rt.funcsset.randupdate && chunk.flags.randomTicksCounted) {
+        chunk.randomTickBlocks[y / VOXELS_SECTION_H]--;
+    }
 
     uint8_t bits = get_events_bits(def);
     if (bits == 0) {
@@ -145,13 +188,16 @@ static void initialize_block(
     const auto& def = indices.blocks.require(id);
     vox.id = id;
     vox.state = state;
-    chunk.setModifiedAndUnsaved();
+    chunk.setModifiedAndUnsaved(y);
     if (!state.segment && def.rt.extended) {
         restore_segments(chunks, def, state, x, y, z);
     }
 
     refresh_chunk_heights(chunk, id == BLOCK_AIR, y);
-    mark_neighboirs_modified(chunks, cx, cz, lx, lz);
+    mark_neighboirs_modified(chunks, cx, cz, lx, y, lz);
+    if (def.rt.funcsset.randupdate && chunk.flags.randomTicksCounted) {
+        chunk.randomTickBlocks[y / VOXELS_SECTION_H]++;
+    }
 
     uint8_t bits = get_events_bits(def);
     if (bits == 0) {
@@ -183,7 +229,7 @@ static inline bool set_block(
     int lx = x - cx * CHUNK_W;
     int lz = z - cz * CHUNK_D;
 
-    voxel& vox = chunk->voxels[(y * CHUNK_D + lz) * CHUNK_W + lx];
+    voxel& vox = chunk->getVoxels()[(y * CHUNK_D + lz) * CHUNK_W + lx];
 
     finalize_block(chunks, *chunk, vox, x, y, z, lx, lz);
     initialize_block(chunks, *chunk, vox, id, state, x, y, z, lx, lz, cx, cz);
@@ -430,10 +476,19 @@ inline void get_voxels_impl(
                     }
                 }
             } else {
-                const voxel* cvoxels = chunk->voxels;
                 const light_t* clights =
                     chunk->lightmap ? chunk->lightmap->getLights() : nullptr;
-                for (int ly = y; ly < y + h; ly++) {
+                // packed chunk voxels are unpacked by sections
+                voxel sectionBuffer[VOXELS_SECTION_VOL];
+                const voxel* section = nullptr;
+                // voxels out of the chunk height are left void
+                int endY = std::min(y + h, CHUNK_H);
+                for (int ly = std::max(y, 0); ly < endY; ly++) {
+                    if (section == nullptr || ly % VOXELS_SECTION_H == 0) {
+                        section = chunk->getSection(
+                            ly / VOXELS_SECTION_H, sectionBuffer
+                        );
+                    }
                     for (int lz = std::max(z, cz * CHUNK_D);
                              lz < std::min(z + d, (cz + 1) * CHUNK_D);
                              lz++) {
@@ -448,7 +503,7 @@ inline void get_voxels_impl(
                                 CHUNK_W,
                                 CHUNK_D
                             );
-                            voxels[vidx] = cvoxels[cidx];
+                            voxels[vidx] = section[cidx % VOXELS_SECTION_VOL];
                             light_t light = clights ? clights[cidx]
                                                     : Lightmap::SUN_LIGHT_ONLY;
                             if (backlight) {
@@ -29,6 +29,8 @@ struct BlockRegisterEvent {
     static inline constexpr uint8_t UPDATING_BIT = 0x2;
     static inline constexpr uint8_t PRESENT_EVENT_BIT = 0x4;
     static inline constexpr uint8_t REMOVED_EVENT_BIT = 0x8;
+    /// @brief All blocks of the chunk (coord x, z) are unregistered
+    static inline constexpr uint8_t CHUNK_REMOVED_BIT = 0x10;
     uint8_t bits;
     blockid_t id;
     glm::ivec3 coord;
@@ -39,6 +41,10 @@ std::vector<BlockRegisterEvent> pull_register_events();
 void on_chunk_present(const ContentIndices& indices, const Chunk& chunk);
 void on_chunk_remove(const ContentIndices& indices, const Chunk& chunk);
 
+/// @brief Count blocks having on_random_update event in chunk sections
+/// and set chunk.flags.randomTicksCounted
+void count_random_tick_blocks(const ContentIndices& indices, Chunk& chunk);
+
 /// @brief Get specified chunk.
 /// @tparam Storage 
 /// @param chunks 
@@ -71,7 +77,7 @@ inline voxel* get(const Storage& chunks, int32_t x, int32_t y, int32_t z) {
     }
     int lx = x - cx * CHUNK_W;
     int lz = z - cz * CHUNK_D;
-    return &chunk->voxels[(y * CHUNK_D + lz) * CHUNK_W + lx];
+    return &chunk->getVoxels()[(y * CHUNK_D + lz) * CHUNK_W + lx];
 }
 
 /// @brief Get voxel at specified position.
@@ -350,7 +356,7 @@ inline void set_rotation_extended(
                     int cz = floordiv<CHUNK_D>(pos.z);
                     auto chunk = get_chunk(chunks, cx, cz);
                     assert(chunk != nullptr);
-                    chunk->setModifiedAndUnsaved();
+                    chunk->setModifiedAndUnsaved(pos.y);
                     segmentBlocks.emplace_back(pos);
                 }
             }
@@ -406,7 +412,7 @@ inline void set_rotation(
         int cz = floordiv<CHUNK_D>(z);
         auto chunk = get_chunk(chunks, cx, cz);
         assert(chunk != nullptr);
-        chunk->setModifiedAndUnsaved();
+        chunk->setModifiedAndUnsaved(y);
     }
 }
 
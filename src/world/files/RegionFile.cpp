@@ -0,0 +1,341 @@
+#include "RegionFile.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <zlib.h>
+
+#include "util/data_io.hpp"
+
+/// @brief Sectors taken by the offsets table
+static constexpr uint32_t TABLE_SECTORS = REGION_TABLE_SIZE / REGION_SECTOR_SIZE;
+/// @brief Max sectors count addressable with 32 bit offsets
+static constexpr uint32_t MAX_SECTORS = 0xFFFFFFFFU / REGION_SECTOR_SIZE;
+/// @brief Min free sectors count making region file fragmented
+static constexpr uint32_t FRAGMENTED_MIN_FREE_SECTORS = 64;
+
+static_assert(REGION_TABLE_SIZE % REGION_SECTOR_SIZE == 0);
+
+static uint32_t sectors_for(uint32_t size) {
+    return (size + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+}
+
+static uint32_t calc_checksum(
+    uint32_t generation, uint32_t tableOffset, const ubyte* table
+) {
+    uint32_t values[] {dataio::h2le(generation), dataio::h2le(tableOffset)};
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(values), sizeof(values));
+    crc = crc32(crc, table, REGION_TABLE_SIZE);
+    return static_cast<uint32_t>(crc);
+}
+
+int read_region_commit(
+    size_t length,
+    const RegionFileReader& read,
+    RegionCommit& commit,
+    std::array<uint32_t, REGION_CHUNKS_COUNT>& offsets
+) {
+    if (length < REGION_HEADER_SIZE_V4) {
+        return -1;
+    }
+    RegionCommit slots[2];
+    for (int i = 0; i < 2; i++) {
+        uint32_t values[3];
+        read(
+            REGION_COMMIT_SLOTS_OFFSET + i * REGION_COMMIT_SLOT_SIZE,
+            values,
+            sizeof(values)
+        );
+        slots[i].generation = dataio::le2h(values[0]);
+        slots[i].tableOffset = dataio::le2h(values[1]);
+        slots[i].checksum = dataio::le2h(values[2]);
+    }
+    // the latest commit first
+    int order[] {0, 1};
+    if (slots[1].generation > slots[0].generation) {
+        std::swap(order[0], order[1]);
+    }
+    std::array<ubyte, REGION_TABLE_SIZE> table;
+    for (int slot : order) {
+        const auto& entry = slots[slot];
+        if (entry.tableOffset == 0 ||
+            entry.tableOffset % REGION_SECTOR_SIZE != 0 ||
+            static_cast<size_t>(entry.tableOffset) + REGION_TABLE_SIZE >
+                length) {
+            continue;
+        }
+        read(entry.tableOffset, table.data(), REGION_TABLE_SIZE);
+        if (calc_checksum(entry.generation, entry.tableOffset, table.data()) !=
+            entry.checksum) {
+            continue;
+        }
+        std::memcpy(offsets.data(), table.data(), REGION_TABLE_SIZE);
+        for (auto& offset : offsets) {
+            offset = dataio::le2h(offset);
+        }
+        commit = entry;
+        return slot;
+    }
+    return -1;
+}
+
+RegionFileWriter::RegionFileWriter(const std::filesystem::path& filename)
+    : file(filename, false), filename(filename) {
+    load();
+}
+
+RegionFileWriter::RegionFileWriter(
+    const std::filesystem::path& filename, compression::Method compression
+)
+    : file(filename, true), filename(filename), compression(compression) {
+    ubyte header[REGION_HEADER_SIZE_V4] {};
+    std::memcpy(header, REGION_FORMAT_MAGIC, sizeof(REGION_FORMAT_MAGIC));
+    header[8] = REGION_FORMAT_VERSION;
+    header[9] = static_cast<ubyte>(compression);
+    file.write(0, header, REGION_HEADER_SIZE_V4);
+    // empty region must be committed too
+    modified = true;
+}
+
+void RegionFileWriter::load() {
+    size_t length = file.length();
+    char header[REGION_HEADER_SIZE];
+    if (length < REGION_HEADER_SIZE_V4) {
+        throw illegal_region_format(
+            "incomplete region file header in " + filename.string()
+        );
+    }
+    file.read(0, header, REGION_HEADER_SIZE);
+    if (std::memcmp(header, REGION_FORMAT_MAGIC, sizeof(REGION_FORMAT_MAGIC)) ||
+        header[8] != REGION_FORMAT_VERSION) {
+        throw illegal_region_format(
+            "region format " + std::to_string(REGION_FORMAT_VERSION) +
+            " expected in " + filename.string()
+        );
+    }
+    compression = static_cast<compression::Method>(header[9]);
+    lastSlot = read_region_commit(
+        length,
+        [this](size_t offset, void* dst, size_t size) {
+            file.read(offset, dst, size);
+        },
+        lastCommit,
+        offsets
+    );
+    if (lastSlot == -1) {
+        throw std::runtime_error(
+            "no valid commit found in region file " + filename.string()
+        );
+    }
+    sectorsCount = sectors_for(length);
+
+    std::vector<bool> used(sectorsCount);
+    auto take = [this, &used](uint32_t offset, uint32_t count) {
+        uint32_t first = offset / REGION_SECTOR_SIZE;
+        if (offset % REGION_SECTOR_SIZE != 0 || first + count > sectorsCount) {
+            throw std::runtime_error(
+                "corrupted region file " + filename.string()
+            );
+        }
+        for (uint32_t i = first; i < first + count; i++) {
+            if (used[i]) {
+                throw std::runtime_error(
+                    "overlapping records in region file " + filename.string()
+                );
+            }
+            used[i] = true;
+        }
+    };
+    used[0] = true;
+    take(lastCommit.tableOffset, TABLE_SECTORS);
+    for (uint i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        uint32_t offset = offsets[i];
+        if (offset == 0) {
+            continue;
+        }
+        uint32_t size = 0;
+        if (static_cast<size_t>(offset) + sizeof(size) <= length) {
+            file.read(offset, &size, sizeof(size));
+            size = dataio::le2h(size);
+        }
+        if (static_cast<size_t>(offset) + 8 + size > length) {
+            throw std::runtime_error(
+                "corrupted region file " + filename.string()
+            );
+        }
+        sectors[i] = sectors_for(8 + size);
+        take(offset, sectors[i]);
+    }
+    for (uint32_t i = 1; i < sectorsCount; i++) {
+        if (used[i]) {
+            continue;
+        }
+        if (!freeList.empty() &&
+            freeList.back().first + freeList.back().second == i) {
+            freeList.back().second++;
+        } else {
+            freeList.emplace_back(i, 1);
+        }
+    }
+}
+
+uint32_t RegionFileWriter::allocate(uint32_t count) {
+    for (auto it = freeList.begin(); it != freeList.end(); ++it) {
+        if (it->second < count) {
+            continue;
+        }
+        uint32_t first = it->first;
+        it->first += count;
+        it->second -= count;
+        if (it->second == 0) {
+            freeList.erase(it);
+        }
+        return first;
+    }
+    uint32_t first = sectorsCount;
+    // free range at the end of file is extended
+    if (!freeList.empty() &&
+        freeList.back().first + freeList.back().second == sectorsCount) {
+        first = freeList.back().first;
+        freeList.pop_back();
+    }
+    if (first + count > MAX_SECTORS) {
+        throw std::runtime_error(
+            "region file size limit exceeded in " + filename.string()
+        );
+    }
+    sectorsCount = first + count;
+    return first;
+}
+
+void RegionFileWriter::release(uint32_t offset, uint32_t count) {
+    released.emplace_back(offset / REGION_SECTOR_SIZE, count);
+}
+
+void RegionFileWriter::put(
+    uint index, const ubyte* data, uint32_t size, uint32_t srcSize
+) {
+    uint32_t count = sectors_for(8 + size);
+    size_t offset = static_cast<size_t>(allocate(count)) * REGION_SECTOR_SIZE;
+
+    uint32_t sizes[] {dataio::h2le(size), dataio::h2le(srcSize)};
+    file.write(offset, sizes, sizeof(sizes));
+    file.write(offset + sizeof(sizes), data, size);
+
+    if (offsets.at(index)) {
+        release(offsets[index], sectors[index]);
+    }
+    offsets[index] = offset;
+    sectors[index] = count;
+    modified = true;
+}
+
+void RegionFileWriter::remove(uint index) {
+    if (offsets.at(index) == 0) {
+        return;
+    }
+    release(offsets[index], sectors[index]);
+    offsets[index] = 0;
+    sectors[index] = 0;
+    modified = true;
+}
+
+void RegionFileWriter::commit() {
+    if (!modified) {
+        return;
+    }
+    writeTable();
+    // all referenced data must be stored before the commit
+    sync();
+    writeCommit();
+    sync();
+    reclaim();
+}
+
+void RegionFileWriter::sync() {
+    file.sync();
+}
+
+void RegionFileWriter::writeTable() {
+    assert(nextCommit.tableOffset == 0);
+    uint32_t tableOffset = allocate(TABLE_SECTORS) * REGION_SECTOR_SIZE;
+    std::array<uint32_t, REGION_CHUNKS_COUNT> table;
+    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        table[i] = dataio::h2le(offsets[i]);
+    }
+    file.write(tableOffset, table.data(), REGION_TABLE_SIZE);
+    if (lastCommit.tableOffset) {
+        release(lastCommit.tableOffset, TABLE_SECTORS);
+    }
+    nextCommit.generation = lastCommit.generation + 1;
+    nextCommit.tableOffset = tableOffset;
+    nextCommit.checksum = calc_checksum(
+        nextCommit.generation,
+        nextCommit.tableOffset,
+        reinterpret_cast<const ubyte*>(table.data())
+    );
+}
+
+void RegionFileWriter::writeCommit() {
+    assert(nextCommit.tableOffset != 0);
+    RegionCommit commit = nextCommit;
+    nextCommit = {};
+    // previous commit slot stays untouched until this one is stored
+    int slot = lastSlot ^ 1;
+    uint32_t values[] {
+        dataio::h2le(commit.generation),
+        dataio::h2le(commit.tableOffset),
+        dataio::h2le(commit.checksum),
+        0};
+    file.write(
+        REGION_COMMIT_SLOTS_OFFSET + slot * REGION_COMMIT_SLOT_SIZE,
+        values,
+        sizeof(values)
+    );
+
+    lastCommit = commit;
+    lastSlot = slot;
+    modified = false;
+}
+
+void RegionFileWriter::reclaim() {
+    // released sectors are not referenced by the last commit anymore
+    freeList.insert(freeList.end(), released.begin(), released.end());
+    released.clear();
+    std::sort(freeList.begin(), freeList.end());
+    size_t merged = 0;
+    for (size_t i = 1; i < freeList.size(); i++) {
+        auto& last = freeList[merged];
+        if (last.first + last.second == freeList[i].first) {
+            last.second += freeList[i].second;
+        } else {
+            freeList[++merged] = freeList[i];
+        }
+    }
+    if (!freeList.empty()) {
+        freeList.resize(merged + 1);
+    }
+    if (!freeList.empty() &&
+        freeList.back().first + freeList.back().second == sectorsCount) {
+        sectorsCount = freeList.back().first;
+        freeList.pop_back();
+        file.truncate(static_cast<size_t>(sectorsCount) * REGION_SECTOR_SIZE);
+    }
+}
+
+size_t RegionFileWriter::getFreeSectorsCount() const {
+    size_t count = 0;
+    for (const auto& [_, sectors] : freeList) {
+        count += sectors;
+    }
+    for (const auto& [_, sectors] : released) {
+        count += sectors;
+    }
+    return count;
+}
+
+bool RegionFileWriter::isFragmented() const {
+    size_t free = getFreeSectorsCount();
+    return free >= FRAGMENTED_MIN_FREE_SECTORS && free * 3 >= sectorsCount;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "constants.hpp"
+#include "coders/compression.hpp"
+#include "io/RandomAccessFile.hpp"
+#include "typedefs.hpp"
+
+#define REGION_FORMAT_MAGIC ".VOXREG"
+
+inline constexpr uint REGION_HEADER_SIZE = 10;
+
+inline constexpr uint REGION_SIZE_BIT = 5;
+inline constexpr uint REGION_SIZE = (1 << (REGION_SIZE_BIT));
+inline constexpr uint REGION_CHUNKS_COUNT = ((REGION_SIZE) * (REGION_SIZE));
+
+/// @brief Offsets table size in bytes
+inline constexpr uint REGION_TABLE_SIZE = REGION_CHUNKS_COUNT * 4;
+
+/// @brief Region file (version 4) allocation unit size
+inline constexpr uint REGION_SECTOR_SIZE = 256;
+
+/// @brief Region file (version 4) header size including commit slots
+inline constexpr uint REGION_HEADER_SIZE_V4 = 48;
+
+/// @brief Position of the first commit slot in region file (version 4)
+inline constexpr uint REGION_COMMIT_SLOTS_OFFSET = 16;
+inline constexpr uint REGION_COMMIT_SLOT_SIZE = 16;
+
+class illegal_region_format : public std::runtime_error {
+public:
+    illegal_region_format(const std::string& message)
+        : std::runtime_error(message) {
+    }
+};
+
+/// @brief Region file (version 4) commit referencing the offsets table
+struct RegionCommit {
+    uint32_t generation = 0;
+    uint32_t tableOffset = 0;
+    /// @brief crc32 of generation, table offset and the table bytes
+    uint32_t checksum = 0;
+};
+
+using RegionFileReader = std::function<void(size_t, void*, size_t)>;
+
+/// @brief Find the latest valid commit of region file (version 4)
+/// @param length file length
+/// @param read file bytes reader (offset, destination, size)
+/// @param offsets [out] committed offsets table
+/// @return commit slot index or -1 if no valid commit found
+int read_region_commit(
+    size_t length,
+    const RegionFileReader& read,
+    RegionCommit& commit,
+    std::array<uint32_t, REGION_CHUNKS_COUNT>& offsets
+);
+
+/// @brief Region file (version 4) writer. Chunks are written into free
+/// sectors, so the last committed state is never overwritten. New offsets
+/// table is written the same way and gets committed after all data is
+/// flushed, writing reference to it to one of two header commit slots
+/// alternately.
+///
+/// Sectors released by a commit are reused only after it is synced and
+/// reclaimed, so the file may be read while the data, the table and the
+/// commit are written and synced. Readers opened before reclaim must be
+/// closed before it, as they may reference the released sectors.
+/// @see /doc/specs/region_file_spec.md
+class RegionFileWriter {
+    io::RandomAccessFile file;
+    std::filesystem::path filename;
+    compression::Method compression = compression::Method::NONE;
+    std::array<uint32_t, REGION_CHUNKS_COUNT> offsets {};
+    /// @brief Sectors count taken by each chunk
+    std::array<uint32_t, REGION_CHUNKS_COUNT> sectors {};
+    RegionCommit lastCommit;
+    int lastSlot = 1;
+    /// @brief Commit of the written table waiting for writeCommit
+    RegionCommit nextCommit;
+    /// @brief File length in sectors
+    uint32_t sectorsCount = 1;
+    /// @brief Free sectors ranges (first, count) sorted by position
+    std::vector<std::pair<uint32_t, uint32_t>> freeList;
+    /// @brief Sectors ranges being still used by the last commit
+    std::vector<std::pair<uint32_t, uint32_t>> released;
+    bool modified = false;
+
+    uint32_t allocate(uint32_t count);
+    void release(uint32_t offset, uint32_t count);
+    void load();
+public:
+    /// @brief Open region file (version 4)
+    /// @throw illegal_region_format if file is not a region file (version 4)
+    RegionFileWriter(const std::filesystem::path& filename);
+
+    /// @brief Create empty region file
+    RegionFileWriter(
+        const std::filesystem::path& filename, compression::Method compression
+    );
+
+    /// @brief Write chunk record. Will be available after commit
+    /// @param index chunk index in region
+    void put(uint index, const ubyte* data, uint32_t size, uint32_t srcSize);
+
+    /// @brief Remove chunk record. Will be applied after commit
+    /// @param index chunk index in region
+    void remove(uint index);
+
+    /// @brief Atomically apply all changes made since the last commit:
+    /// writeTable, sync, writeCommit, sync again and reclaim
+    void commit();
+
+    /// @brief Write offsets table of the next commit.
+    /// No changes can be made until writeCommit
+    void writeTable();
+
+    /// @brief Write commit of the table written by writeTable. Data and
+    /// the table must be synced before. The commit is durable after sync
+    void writeCommit();
+
+    /// @brief Make sectors released by the last commit free. The commit
+    /// must be synced before, as the previous one references them.
+    /// Trailing free sectors are truncated, so the file must not be read
+    /// meanwhile
+    void reclaim();
+
+    /// @brief Flush written data to the storage device
+    void sync();
+
+    compression::Method getCompression() const {
+        return compression;
+    }
+
+    /// @return true if free sectors take large part of the file
+    bool isFragmented() const;
+
+    size_t getFreeSectorsCount() const;
+};
@@ -6,35 +6,103 @@
 
 static debug::Logger logger("regions-layer");
 
-#define REGION_FORMAT_MAGIC ".VOXREG"
+/// @brief Max number of region file writers kept open by a layer
+static constexpr size_t MAX_REGION_WRITERS = 8;
 
 static io::path get_region_filename(int x, int z) {
     return std::to_string(x) + "_" + std::to_string(z) + ".bin";
 }
 
-/// @brief Read missing chunks data (null pointers) from region file
-static void fetch_chunks(WorldRegion* region, int x, int z, regfile* file) {
-    auto* chunks = region->getChunks();
-    auto sizes = region->getSizes();
-
-    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
-        int chunk_x = (i % REGION_SIZE) + x * REGION_SIZE;
-        int chunk_z = (i / REGION_SIZE) + z * REGION_SIZE;
-        if (chunks[i] == nullptr) {
-            chunks[i] = RegionsLayer::readChunkData(
-                chunk_x, chunk_z, sizes[i][0], sizes[i][1], file
-            );
+/// @brief Keeps region from being written by other threads
+class RegionWriteGuard {
+    RegionsLayer& layer;
+    glm::ivec2 coord;
+public:
+    RegionWriteGuard(RegionsLayer& layer, glm::ivec2 coord)
+        : layer(layer), coord(coord) {
+        layer.beginWrite(coord);
+    }
+
+    ~RegionWriteGuard() {
+        layer.endWrite(coord);
+    }
+};
+
+/// @brief Keeps region file closed while it's being modified or replaced
+class RegionFileLock {
+    RegionsLayer& layer;
+    glm::ivec2 coord;
+public:
+    RegionFileLock(RegionsLayer& layer, glm::ivec2 coord)
+        : layer(layer), coord(coord) {
+        layer.lockFile(coord);
+    }
+
+    ~RegionFileLock() {
+        layer.unlockFile(coord);
+    }
+};
+
+/// @brief Replace region file with the written one
+static void replace_region_file(
+    RegionsLayer& layer,
+    glm::ivec2 coord,
+    const std::filesystem::path& tmpPath,
+    const std::filesystem::path& path
+) {
+    {
+        RegionFileLock lock(layer, coord);
+        std::filesystem::rename(tmpPath, path);
+    }
+    // make the rename durable, as the old file is gone
+    io::sync_directory(path.parent_path());
+}
+
+using ChunkSupplier = std::function<const ubyte*(
+    uint index,
+    uint32_t& size,
+    uint32_t& srcSize,
+    std::unique_ptr<ubyte[]>& buffer
+)>;
+
+/// @brief Write new region file next to the target one
+/// @return temporary file path to be renamed to the target path
+static std::filesystem::path write_region_file(
+    const io::path& filename,
+    compression::Method compression,
+    const ChunkSupplier& supplier
+) {
+    auto path = io::resolve(filename);
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+
+    RegionFileWriter writer(tmpPath, compression);
+    for (uint i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        uint32_t size;
+        uint32_t srcSize;
+        std::unique_ptr<ubyte[]> buffer;
+        if (auto data = supplier(i, size, srcSize, buffer)) {
+            writer.put(i, data, size, srcSize);
         }
     }
+    writer.commit();
+    return tmpPath;
 }
 
-regfile::regfile(io::path filename) : file(filename), filename(filename) {
-    if (file.length() < REGION_HEADER_SIZE)
+regfile::regfile(io::path filename) : filename(filename) {
+    mapped = io::map(filename);
+    if (mapped) {
+        length = mapped->size();
+    } else {
+        file = std::make_unique<io::rafile>(filename);
+        length = file->length();
+    }
+    if (length < REGION_HEADER_SIZE)
         throw std::runtime_error(
             "incomplete region file header in " + filename.string()
         );
     char header[REGION_HEADER_SIZE];
-    file.read(header, REGION_HEADER_SIZE);
+    readBytes(0, header, REGION_HEADER_SIZE);
 
     // avoid of use strcmp_s
     if (std::string(header, std::strlen(REGION_FORMAT_MAGIC)) !=
@@ -50,110 +118,223 @@ regfile::regfile(io::path filename) : file(filename), filename(filename) {
             " is not supported in " + filename.string()
         );
     }
-
-    size_t file_size = file.length();
-    size_t table_offset = file_size - REGION_CHUNKS_COUNT * 4;
-
-    file.seekg(table_offset);
-    file.read(
-        reinterpret_cast<char*>(offsets.data()),
-        sizeof(uint32_t) * REGION_CHUNKS_COUNT
-    );
+    ubyte method = header[9];
+    if (method > static_cast<ubyte>(compression::Method::ZLIB_DICT)) {
+        throw std::runtime_error(
+            "unknown compression method " + std::to_string(method) + " in " +
+            filename.string()
+        );
+    }
+    compression = static_cast<compression::Method>(method);
+
+    if (version >= 4) {
+        RegionCommit commit;
+        int slot = read_region_commit(
+            length,
+            [this](size_t offset, void* dst, size_t size) {
+                readBytes(offset, dst, size);
+            },
+            commit,
+            offsets
+        );
+        if (slot == -1) {
+            throw std::runtime_error(
+                "no valid commit found in region file " + filename.string()
+            );
+        }
+        dataEnd = length;
+        tableOffset = commit.tableOffset;
+        return;
+    }
+    if (length < REGION_HEADER_SIZE + REGION_TABLE_SIZE) {
+        throw std::runtime_error(
+            "incomplete region file offsets table in " + filename.string()
+        );
+    }
+    tableOffset = length - REGION_TABLE_SIZE;
+    dataEnd = tableOffset;
+    readBytes(tableOffset, offsets.data(), REGION_TABLE_SIZE);
     if (dataio::is_big_endian()) {
         for (size_t i = 0; i < offsets.size(); i++) {
-            offsets[i] = dataio::le2h(i);
+            offsets[i] = dataio::le2h(offsets[i]);
         }
     }
 }
 
-std::unique_ptr<ubyte[]> regfile::read(
-    int index, uint32_t& size, uint32_t& srcSize
-) {
-    size_t file_size = file.length();
-    size_t table_offset = file_size - REGION_CHUNKS_COUNT * 4;
+void regfile::readBytes(size_t offset, void* dst, size_t size) {
+    if (mapped) {
+        std::memcpy(dst, mapped->data() + offset, size);
+        return;
+    }
+    std::lock_guard lock(fileMutex);
+    file->seekg(offset);
+    file->read(reinterpret_cast<char*>(dst), size);
+}
 
+const ubyte* regfile::read(
+    int index,
+    uint32_t& size,
+    uint32_t& srcSize,
+    std::unique_ptr<ubyte[]>& buffer
+) {
     uint32_t offset = offsets.at(index);
     if (offset == 0) {
         return nullptr;
     }
+    if (static_cast<size_t>(offset) + 8 > dataEnd) {
+        logger.error() << "corrupted region " << filename.string()
+                       << " chunk offset detected at "
+                       << (tableOffset + index * 4);
+        return nullptr;
+    }
+    uint32_t buff32[2];
+    readBytes(offset, buff32, sizeof(buff32));
+    size = dataio::le2h(buff32[0]);
+    srcSize = dataio::le2h(buff32[1]);
 
-    uint32_t buff32;
-    file.seekg(offset);
-    file.read(reinterpret_cast<char*>(&buff32), 4);
-    size = dataio::le2h(buff32);
-    file.read(reinterpret_cast<char*>(&buff32), 4);
-    srcSize = dataio::le2h(buff32);
-
-    if (offset + size > file_size) {
+    if (static_cast<size_t>(offset) + 8 + size > dataEnd) {
         logger.error() << "corrupted region " << filename.string()
                        << " chunk offset detected at "
-                       << (table_offset + index * 4);
+                       << (tableOffset + index * 4);
         return nullptr;
     }
-    auto data = std::make_unique<ubyte[]>(size);
-    file.read(reinterpret_cast<char*>(data.get()), size);
-    return data;
+    if (mapped) {
+        return mapped->data() + offset + 8;
+    }
+    buffer = std::make_unique<ubyte[]>(size);
+    readBytes(offset + 8, buffer.get(), size);
+    return buffer.get();
 }
 
-void RegionsLayer::closeRegFile(glm::ivec2 coord) {
-    openRegFiles.erase(coord);
-    regFilesCv.notify_one();
+std::unique_ptr<ubyte[]> regfile::read(
+    int index, uint32_t& size, uint32_t& srcSize
+) {
+    std::unique_ptr<ubyte[]> buffer;
+    const ubyte* data = read(index, size, srcSize, buffer);
+    if (data == nullptr || buffer) {
+        return buffer;
+    }
+    buffer = std::make_unique<ubyte[]>(size);
+    std::memcpy(buffer.get(), data, size);
+    return buffer;
 }
 
-regfile_ptr RegionsLayer::useRegFile(glm::ivec2 coord) {
-    auto* file = openRegFiles[coord].get();
-    file->inUse = true;
-    return regfile_ptr(file, &regFilesCv);
+regfile_ptr RegionsLayer::useRegFile(regfile& file) {
+    file.users++;
+    regFilesLRU.splice(regFilesLRU.begin(), regFilesLRU, file.lruPosition);
+    return regfile_ptr(&file, &regFilesMutex, &regFilesCv);
 }
 
-// Marks regfile as used and unmarks when shared_ptr dies
-regfile_ptr RegionsLayer::getRegFile(glm::ivec2 coord, bool create) {
+bool RegionsLayer::closeUnusedRegFile() {
+    for (auto it = regFilesLRU.rbegin(); it != regFilesLRU.rend(); ++it) {
+        const auto found = openRegFiles.find(*it);
+        if (found->second->users == 0) {
+            regFilesLRU.erase(found->second->lruPosition);
+            openRegFiles.erase(found);
+            return true;
+        }
+    }
+    return false;
+}
+
+void RegionsLayer::beginWrite(glm::ivec2 coord) {
+    std::unique_lock lock(regFilesMutex);
+    regFilesCv.wait(lock, [this, coord] {
+        return writingRegions.find(coord) == writingRegions.end();
+    });
+    writingRegions.insert(coord);
+}
+
+void RegionsLayer::endWrite(glm::ivec2 coord) {
     {
         std::lock_guard lock(regFilesMutex);
+        writingRegions.erase(coord);
+    }
+    regFilesCv.notify_all();
+}
+
+void RegionsLayer::lockFile(glm::ivec2 coord) {
+    std::unique_lock lock(regFilesMutex);
+    lockedRegions.insert(coord);
+    // file may be memory-mapped, so it must be closed before modifying
+    regFilesCv.wait(lock, [this, coord] {
         const auto found = openRegFiles.find(coord);
-        if (found != openRegFiles.end()) {
-            if (found->second->inUse) {
-                throw std::runtime_error("regfile is currently in use");
-            }
-            return useRegFile(found->first);
-        }
+        return found == openRegFiles.end() || found->second->users == 0;
+    });
+    const auto found = openRegFiles.find(coord);
+    if (found != openRegFiles.end()) {
+        regFilesLRU.erase(found->second->lruPosition);
+        openRegFiles.erase(found);
     }
-    if (create) {
-        return createRegFile(coord);
+}
+
+void RegionsLayer::unlockFile(glm::ivec2 coord) {
+    {
+        std::lock_guard lock(regFilesMutex);
+        lockedRegions.erase(coord);
     }
-    return nullptr;
+    regFilesCv.notify_all();
 }
 
-regfile_ptr RegionsLayer::createRegFile(glm::ivec2 coord) {
-    auto file = folder / get_region_filename(coord[0], coord[1]);
-    if (!io::exists(file)) {
+std::unique_ptr<RegionFileWriter> RegionsLayer::takeRegWriter(
+    glm::ivec2 coord
+) {
+    std::lock_guard lock(regFilesMutex);
+    const auto found = regWriters.find(coord);
+    if (found == regWriters.end()) {
         return nullptr;
     }
-    if (openRegFiles.size() == MAX_OPEN_REGION_FILES) {
-        std::unique_lock lock(regFilesMutex);
-        while (true) {
-            bool closed = false;
-            // FIXME: bad choosing algorithm
-            for (auto& entry : openRegFiles) {
-                if (!entry.second->inUse) {
-                    closeRegFile(entry.first);
-                    closed = true;
-                    break;
-                }
-            }
-            if (closed) {
-                break;
-            }
-            // notified when any regfile gets out of use or closed
-            regFilesCv.wait(lock);
+    auto writer = std::move(found->second);
+    regWriters.erase(found);
+    return writer;
+}
+
+void RegionsLayer::keepRegWriter(
+    glm::ivec2 coord, std::unique_ptr<RegionFileWriter> writer
+) {
+    std::lock_guard lock(regFilesMutex);
+    if (regWriters.size() >= MAX_REGION_WRITERS) {
+        regWriters.erase(regWriters.begin());
+    }
+    regWriters[coord] = std::move(writer);
+}
+
+// Marks regfile as used and unmarks when regfile_ptr dies
+regfile_ptr RegionsLayer::getRegFile(glm::ivec2 coord, bool create) {
+    std::unique_lock lock(regFilesMutex);
+    regFilesCv.wait(lock, [this, coord] {
+        return lockedRegions.find(coord) == lockedRegions.end();
+    });
+    auto found = openRegFiles.find(coord);
+    if (found != openRegFiles.end()) {
+        return useRegFile(*found->second);
+    }
+    if (!create) {
+        return nullptr;
+    }
+    auto filename = folder / get_region_filename(coord[0], coord[1]);
+    if (!io::exists(filename)) {
+        return nullptr;
+    }
+    while (openRegFiles.size() >= MAX_OPEN_REGION_FILES) {
+        if (closeUnusedRegFile()) {
+            continue;
+        }
+        // notified when any regfile gets out of use or closed
+        regFilesCv.wait(lock);
+
+        // may be opened by other thread while waiting
+        found = openRegFiles.find(coord);
+        if (found != openRegFiles.end()) {
+            return useRegFile(*found->second);
         }
-        openRegFiles[coord] = std::make_unique<regfile>(file);
-        return useRegFile(coord);
-    } else {
-        std::lock_guard lock(regFilesMutex);
-        openRegFiles[coord] = std::make_unique<regfile>(file);
-        return useRegFile(coord);
     }
+    auto file = std::make_unique<regfile>(filename);
+    auto& ref = *file;
+    regFilesLRU.push_front(coord);
+    ref.lruPosition = regFilesLRU.begin();
+    openRegFiles[coord] = std::move(file);
+    return useRegFile(ref);
 }
 
 WorldRegion* RegionsLayer::getRegion(int x, int z) {
@@ -169,92 +350,257 @@ io::path RegionsLayer::getRegionFilePath(int x, int z) const {
     return folder / get_region_filename(x, z);
 }
 
-WorldRegion* RegionsLayer::getOrCreateRegion(int x, int z) {
-    if (auto region = getRegion(x, z)) {
-        return region;
-    }
+void RegionsLayer::put(
+    int x,
+    int z,
+    std::unique_ptr<ubyte[]> data,
+    uint32_t size,
+    uint32_t srcSize
+) {
+    int regionX, regionZ, localX, localZ;
+    calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
+
     std::lock_guard lock(mapMutex);
-    auto region_ptr = std::make_unique<WorldRegion>();
-    auto region = region_ptr.get();
-    regions[{x, z}] = std::move(region_ptr);
-    return region;
+    auto& region = regions[{regionX, regionZ}];
+    if (region == nullptr) {
+        region = std::make_unique<WorldRegion>();
+    }
+    region->setUnsaved(true);
+    region->put(localX, localZ, std::move(data), size, srcSize);
 }
 
-ubyte* RegionsLayer::getData(int x, int z, uint32_t& size, uint32_t& srcSize) {
+ChunkDataView RegionsLayer::getData(int x, int z) {
     int regionX, regionZ, localX, localZ;
     calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
+    int chunkIndex = localZ * REGION_SIZE + localX;
 
-    WorldRegion* region = getOrCreateRegion(regionX, regionZ);
-    ubyte* data = region->getChunkData(localX, localZ);
-    if (data == nullptr) {
-        auto regfile = getRegFile({regionX, regionZ});
-        if (regfile != nullptr) {
-            auto dataptr = readChunkData(x, z, size, srcSize, regfile.get());
-            if (dataptr) {
-                data = dataptr.get();
-                region->put(localX, localZ, std::move(dataptr), size, srcSize);
-            }
+    ChunkDataView view;
+    if (WorldRegion* region = getRegion(regionX, regionZ)) {
+        // region data may be replaced by other thread
+        std::lock_guard lock(mapMutex);
+        if (ubyte* data = region->getChunkData(localX, localZ)) {
+            auto sizevec = region->getChunkDataSize(localX, localZ);
+            view.size = sizevec[0];
+            view.srcSize = sizevec[1];
+            view.compression = compression;
+            view.buffer = std::make_unique<ubyte[]>(view.size);
+            std::memcpy(view.buffer.get(), data, view.size);
+            view.data = view.buffer.get();
+            return view;
+        }
+        // removed but not written yet
+        if (region->isChunkUnsaved(chunkIndex)) {
+            return view;
         }
     }
-    if (data != nullptr) {
-        auto sizevec = region->getChunkDataSize(localX, localZ);
-        size = sizevec[0];
-        srcSize = sizevec[1];
-        return data;
+    if (auto regfile = getRegFile({regionX, regionZ})) {
+        view.data = regfile.get()->read(
+            chunkIndex, view.size, view.srcSize, view.buffer
+        );
+        view.compression = regfile.get()->compression;
+        // memory-mapped file must stay open while data is in use
+        if (view.data && view.buffer == nullptr) {
+            view.file = std::move(regfile);
+        }
     }
-    return nullptr;
+    return view;
+}
+
+std::unique_ptr<ubyte[]> RegionsLayer::recompress(
+    const ubyte* data,
+    uint32_t& size,
+    uint32_t srcSize,
+    compression::Method method
+) const {
+    std::unique_ptr<ubyte[]> decompressed;
+    if (method != compression::Method::NONE) {
+        decompressed = compression::decompress(
+            data, size, srcSize, method, dictionary.get()
+        );
+        data = decompressed.get();
+    }
+    if (compression == compression::Method::NONE) {
+        if (decompressed == nullptr) {
+            decompressed = std::make_unique<ubyte[]>(srcSize);
+            std::memcpy(decompressed.get(), data, srcSize);
+        }
+        size = srcSize;
+        return decompressed;
+    }
+    size_t length;
+    auto compressed = compression::compress(
+        data, srcSize, length, compression, dictionary.get()
+    );
+    size = length;
+    return compressed;
+}
+
+namespace {
+    struct ChunkCopy {
+        uint index;
+        std::unique_ptr<ubyte[]> data;
+        uint32_t size;
+        uint32_t srcSize;
+        bool unsaved;
+    };
 }
 
 void RegionsLayer::writeRegion(int x, int z, WorldRegion* entry) {
     io::path filename = folder / get_region_filename(x, z);
-
     glm::ivec2 regcoord(x, z);
-    if (auto regfile = getRegFile(regcoord, false)) {
-        fetch_chunks(entry, x, z, regfile.get());
+    RegionWriteGuard guard(*this, regcoord);
 
-        std::lock_guard lock(regFilesMutex);
-        regfile.reset();
-        closeRegFile(regcoord);
+    // writer kept since the last write has the file state loaded
+    auto writer = takeRegWriter(regcoord);
+    if (writer && writer->getCompression() != compression) {
+        writer.reset();
     }
-
-    char header[REGION_HEADER_SIZE] = REGION_FORMAT_MAGIC;
-    header[8] = REGION_FORMAT_VERSION;
-    header[9] = static_cast<ubyte>(compression);  // FIXME
-    std::ofstream file(io::resolve(filename), std::ios::out | std::ios::binary);
-    file.write(header, REGION_HEADER_SIZE);
-
-    size_t offset = REGION_HEADER_SIZE;
-    uint32_t intbuf;
-    uint offsets[REGION_CHUNKS_COUNT] {};
-
-    auto region = entry->getChunks();
-    auto sizes = entry->getSizes();
-
-    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
-        ubyte* chunk = region[i].get();
-        if (chunk == nullptr) {
-            continue;
+    std::unique_ptr<regfile> current;
+    if (writer == nullptr && io::exists(filename)) {
+        try {
+            current = std::make_unique<regfile>(filename);
+        } catch (const illegal_region_format&) {
+            throw;
+        } catch (const std::runtime_error& err) {
+            logger.error() << "region file will be overwritten: "
+                           << err.what();
         }
-        offsets[i] = offset;
-
-        auto sizevec = sizes[i];
-        uint32_t compressedSize = sizevec[0];
-        uint32_t srcSize = sizevec[1];
-
-        intbuf = dataio::h2le(compressedSize);
-        file.write(reinterpret_cast<const char*>(&intbuf), 4);
-        offset += 4;
+    }
+    // new file, older format version or other compression method
+    bool rewrite = writer == nullptr &&
+                   (current == nullptr ||
+                    current->version != REGION_FORMAT_VERSION ||
+                    current->compression != compression);
 
-        intbuf = dataio::h2le(srcSize);
-        file.write(reinterpret_cast<const char*>(&intbuf), 4);
-        offset += 4;
+    std::vector<ChunkCopy> copies;
+    {
+        std::lock_guard lock(mapMutex);
+        auto chunks = entry->getChunks();
+        auto sizes = entry->getSizes();
+        for (uint i = 0; i < REGION_CHUNKS_COUNT; i++) {
+            bool unsaved = entry->isChunkUnsaved(i);
+            if (!unsaved && !(rewrite && chunks[i])) {
+                continue;
+            }
+            ChunkCopy copy {i, nullptr, sizes[i][0], sizes[i][1], unsaved};
+            if (chunks[i]) {
+                copy.data = std::make_unique<ubyte[]>(copy.size);
+                std::memcpy(copy.data.get(), chunks[i].get(), copy.size);
+            }
+            copies.push_back(std::move(copy));
+        }
+        // chunks put while writing will be written next time
+        entry->setUnsaved(false);
+    }
+    try {
+        if (!rewrite) {
+            current.reset();
+            if (writer == nullptr) {
+                writer = std::make_unique<RegionFileWriter>(
+                    io::resolve(filename)
+                );
+            }
+            if (copies.empty()) {
+                keepRegWriter(regcoord, std::move(writer));
+                return;
+            }
+            for (const auto& copy : copies) {
+                if (copy.data) {
+                    writer->put(
+                        copy.index, copy.data.get(), copy.size, copy.srcSize
+                    );
+                } else {
+                    writer->remove(copy.index);
+                }
+            }
+            // committed data is not overwritten, so the file stays
+            // readable until released sectors are reclaimed
+            writer->writeTable();
+            writer->sync();
+            writer->writeCommit();
+            writer->sync();
+            {
+                RegionFileLock lock(*this, regcoord);
+                writer->reclaim();
+            }
+            if (writer->isFragmented()) {
+                fragmentedRegions.push_back(regcoord);
+            } else {
+                keepRegWriter(regcoord, std::move(writer));
+            }
+        } else {
+            size_t next = 0;
+            auto tmpPath = write_region_file(
+                filename,
+                compression,
+                [&](uint i, uint32_t& size, uint32_t& srcSize, auto& buffer)
+                    -> const ubyte* {
+                    if (next < copies.size() && copies[next].index == i) {
+                        const auto& copy = copies[next++];
+                        size = copy.size;
+                        srcSize = copy.srcSize;
+                        return copy.data.get();
+                    }
+                    if (current == nullptr) {
+                        return nullptr;
+                    }
+                    auto data = current->read(i, size, srcSize, buffer);
+                    if (data && current->compression != compression) {
+                        buffer = recompress(
+                            data, size, srcSize, current->compression
+                        );
+                        data = buffer.get();
+                    }
+                    return data;
+                }
+            );
+            current.reset();
+            replace_region_file(
+                *this, regcoord, tmpPath, io::resolve(filename)
+            );
+        }
+    } catch (...) {
+        std::lock_guard lock(mapMutex);
+        entry->setUnsaved(true);
+        for (const auto& copy : copies) {
+            if (copy.unsaved) {
+                entry->setChunkUnsaved(copy.index);
+            }
+        }
+        throw;
+    }
+}
 
-        file.write(reinterpret_cast<const char*>(chunk), compressedSize);
-        offset += compressedSize;
+void RegionsLayer::compactRegion(int x, int z) {
+    io::path filename = folder / get_region_filename(x, z);
+    RegionWriteGuard guard(*this, {x, z});
+    takeRegWriter({x, z});
+    if (!io::exists(filename)) {
+        return;
     }
-    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
-        intbuf = dataio::h2le(offsets[i]);
-        file.write(reinterpret_cast<const char*>(&intbuf), 4);
+    auto current = std::make_unique<regfile>(filename);
+    size_t length = current->length;
+    auto tmpPath = write_region_file(
+        filename,
+        current->compression,
+        [&](uint i, uint32_t& size, uint32_t& srcSize, auto& buffer) {
+            return current->read(i, size, srcSize, buffer);
+        }
+    );
+    current.reset();
+    replace_region_file(*this, {x, z}, tmpPath, io::resolve(filename));
+    logger.info() << "compacted region file " << filename.string() << " ("
+                  << length << " -> " << io::file_size(filename) << " bytes)";
+}
+
+void RegionsLayer::deleteRegion(int x, int z) {
+    io::path filename = folder / get_region_filename(x, z);
+    RegionWriteGuard guard(*this, {x, z});
+    takeRegWriter({x, z});
+    RegionFileLock lock(*this, {x, z});
+    if (io::exists(filename)) {
+        logger.info() << "remove region file " << filename.string();
+        io::remove(filename);
     }
 }
 
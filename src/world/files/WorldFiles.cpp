@@ -47,6 +47,15 @@ WorldFiles::WorldFiles(const io::path& directory, const DebugSettings& settings)
     doWriteLights = settings.doWriteLights.get();
     regions.generatorTestMode = generatorTestMode;
     regions.doWriteLights = doWriteLights;
+    if (settings.fastDataCompression.get()) {
+        for (auto layer : {
+                 REGION_LAYER_INVENTORIES,
+                 REGION_LAYER_ENTITIES,
+                 REGION_LAYER_BLOCKS_DATA,
+             }) {
+            regions.setCompression(layer, compression::Method::LZ4);
+        }
+    }
 }
 
 WorldFiles::~WorldFiles() = default;
@@ -57,7 +57,9 @@ public:
 
     void patchIndicesFile(const dv::value& map);
 
-    /// @brief Write all unsaved data to world files
+    /// @brief Write all unsaved data to world files. Regions are written
+    /// in background
+    /// @see WorldRegions::flush
     /// @param world target world
     /// @param content world content
     void write(const World* world, const Content* content);
@@ -1,10 +1,12 @@
 #include "WorldRegions.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <utility>
 #include <vector>
 
 #include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
 #include "coders/json.hpp"
 #include "coders/byte_utils.hpp"
 #include "coders/rle.hpp"
@@ -13,10 +15,15 @@
 #include "maths/voxmaths.hpp"
 #include "util/data_io.hpp"
 
-#define REGION_FORMAT_MAGIC ".VOXREG"
-
 static debug::Logger logger("world-regions");
 
+/// @brief Name of the layer compression dictionary file
+static const std::string DICTIONARY_FILE = "dictionary.bin";
+
+/// @brief Max memory taken by queued chunk snapshots. Chunks saving blocks
+/// until the save thread catches up
+static constexpr size_t MAX_SNAPSHOTS_MEMORY = 64 * 1024 * 1024;
+
 WorldRegion::WorldRegion()
     : chunksData(
           std::make_unique<std::unique_ptr<ubyte[]>[]>(REGION_CHUNKS_COUNT)
@@ -28,11 +35,22 @@ WorldRegion::~WorldRegion() = default;
 
 void WorldRegion::setUnsaved(bool unsaved) {
     this->unsaved = unsaved;
+    if (!unsaved) {
+        unsavedChunks.reset();
+    }
 }
 bool WorldRegion::isUnsaved() const {
     return unsaved;
 }
 
+void WorldRegion::setChunkUnsaved(uint index) {
+    unsavedChunks.set(index);
+}
+
+bool WorldRegion::isChunkUnsaved(uint index) const {
+    return unsavedChunks.test(index);
+}
+
 std::unique_ptr<ubyte[]>* WorldRegion::getChunks() const {
     return chunksData.get();
 }
@@ -47,6 +65,7 @@ void WorldRegion::put(
     size_t chunk_index = z * REGION_SIZE + x;
     chunksData[chunk_index] = std::move(data);
     sizes[chunk_index] = glm::u32vec2(size, srcSize);
+    unsavedChunks.set(chunk_index);
 }
 
 ubyte* WorldRegion::getChunkData(uint x, uint z) {
@@ -69,52 +88,236 @@ WorldRegions::WorldRegions(const io::path& directory) : directory(directory) {
     lights.folder = directory / "lights";
     lights.compression = compression::Method::EXTRLE8;
 
-    layers[REGION_LAYER_INVENTORIES].folder =
-        directory / "inventories";
-    layers[REGION_LAYER_ENTITIES].folder = directory / "entities";
+    auto& inventories = layers[REGION_LAYER_INVENTORIES];
+    inventories.folder = directory / "inventories";
+    inventories.compression = compression::Method::NONE;
+
+    auto& entities = layers[REGION_LAYER_ENTITIES];
+    entities.folder = directory / "entities";
+    entities.compression = compression::Method::NONE;
 
     auto& blocksData = layers[REGION_LAYER_BLOCKS_DATA];
     blocksData.folder = directory / "blocksdata";
+    blocksData.compression = compression::Method::NONE;
+
+    for (auto& layer : layers) {
+        auto file = layer.folder / DICTIONARY_FILE;
+        if (io::is_regular_file(file)) {
+            layer.dictionary = std::make_shared<compression::Dictionary>(
+                io::read_bytes(file)
+            );
+        }
+    }
+}
+
+void ChunkSnapshot::merge(ChunkSnapshot&& snapshot) {
+    for (size_t i = 0; i < REGION_LAYERS_COUNT; i++) {
+        if (snapshot.data[i]) {
+            data[i] = std::move(snapshot.data[i]);
+            sizes[i] = snapshot.sizes[i];
+        }
+    }
 }
 
-WorldRegions::~WorldRegions() = default;
+size_t ChunkSnapshot::getMemoryUsage() const {
+    size_t usage = 0;
+    for (size_t i = 0; i < REGION_LAYERS_COUNT; i++) {
+        if (data[i]) {
+            usage += sizes[i];
+        }
+    }
+    return usage;
+}
+
+WorldRegions::~WorldRegions() {
+    flush();
+    {
+        std::lock_guard lock(saveMutex);
+        saveStopped = true;
+    }
+    saveCv.notify_all();
+    if (saveThread.joinable()) {
+        saveThread.join();
+    }
+    {
+        std::lock_guard lock(compactionMutex);
+        compactionStopped = true;
+    }
+    compactionCv.notify_all();
+    // not compacted region files are still valid
+    if (compactionThread.joinable()) {
+        compactionThread.join();
+    }
+}
+
+void WorldRegions::compactionLoop() {
+    while (true) {
+        std::pair<RegionLayerIndex, glm::ivec2> entry;
+        {
+            std::unique_lock lock(compactionMutex);
+            compactionCv.wait(lock, [this] {
+                return compactionStopped || !compactionQueue.empty();
+            });
+            if (compactionStopped) {
+                break;
+            }
+            entry = compactionQueue.front();
+            compactionQueue.pop();
+        }
+        const auto& [layerid, coord] = entry;
+        try {
+            layers[layerid].compactRegion(coord.x, coord.y);
+        } catch (const std::exception& err) {
+            logger.error() << "could not compact region " << coord.x << "_"
+                           << coord.y << ": " << err.what();
+        }
+    }
+}
 
 void RegionsLayer::writeAll() {
-    for (auto& it : regions) {
-        WorldRegion* region = it.second.get();
-        if (region->getChunks() == nullptr || !region->isUnsaved()) {
-            continue;
+    std::vector<std::pair<glm::ivec2, WorldRegion*>> unsavedRegions;
+    {
+        std::lock_guard lock(mapMutex);
+        for (auto& [key, region] : regions) {
+            if (region->getChunks() != nullptr && region->isUnsaved()) {
+                unsavedRegions.emplace_back(key, region.get());
+            }
         }
-        const auto& key = it.first;
+    }
+    for (const auto& [key, region] : unsavedRegions) {
         writeRegion(key[0], key[1], region);
     }
 }
 
+void WorldRegions::saveLoop() {
+    std::unique_lock lock(saveMutex);
+    while (true) {
+        saveCv.wait(lock, [this] {
+            return saveStopped || !saveQueue.empty() || writeRequested;
+        });
+        if (!saveQueue.empty()) {
+            glm::ivec2 pos = saveQueue.front();
+            saveQueue.pop_front();
+            // may be already taken by waitForChunk
+            auto snapshot = takeSnapshot(pos);
+            if (snapshot == nullptr) {
+                continue;
+            }
+            lock.unlock();
+            try {
+                debug::ProfileScope profile(debug::ProfileStage::REGION_SAVE);
+                saveSnapshot(pos, *snapshot);
+            } catch (const std::exception& err) {
+                logger.error() << "could not save chunk " << pos.x << ", "
+                               << pos.y << ": " << err.what();
+            }
+            snapshot.reset();
+            lock.lock();
+            savingChunks.erase(pos);
+            saveCv.notify_all();
+        } else if (writeRequested) {
+            writeRequested = false;
+            writing = true;
+            lock.unlock();
+            try {
+                writeRegions();
+            } catch (const std::exception& err) {
+                logger.error() << "could not write regions: " << err.what();
+            }
+            lock.lock();
+            writing = false;
+            saveCv.notify_all();
+        } else if (saveStopped) {
+            break;
+        }
+    }
+}
+
+std::unique_ptr<ChunkSnapshot> WorldRegions::takeSnapshot(glm::ivec2 pos) {
+    auto found = snapshots.find(pos);
+    if (found == snapshots.end()) {
+        return nullptr;
+    }
+    auto snapshot = std::move(found->second);
+    snapshots.erase(found);
+    snapshotsMemory -= snapshot->getMemoryUsage();
+    savingChunks.insert(pos);
+    saveCv.notify_all();
+    return snapshot;
+}
+
+void WorldRegions::saveSnapshot(glm::ivec2 pos, ChunkSnapshot& snapshot) {
+    for (size_t i = 0; i < REGION_LAYERS_COUNT; i++) {
+        if (snapshot.data[i]) {
+            putData(
+                pos.x,
+                pos.y,
+                static_cast<RegionLayerIndex>(i),
+                std::move(snapshot.data[i]),
+                snapshot.sizes[i]
+            );
+        }
+    }
+}
+
+void WorldRegions::waitForChunk(int x, int z) {
+    glm::ivec2 pos(x, z);
+    std::unique_ptr<ChunkSnapshot> snapshot;
+    {
+        std::unique_lock lock(saveMutex);
+        saveCv.wait(lock, [this, pos] {
+            return savingChunks.find(pos) == savingChunks.end();
+        });
+        snapshot = takeSnapshot(pos);
+        if (snapshot == nullptr) {
+            return;
+        }
+    }
+    // put here instead of waiting for the save thread to reach the chunk
+    try {
+        saveSnapshot(pos, *snapshot);
+    } catch (...) {
+        std::lock_guard lock(saveMutex);
+        savingChunks.erase(pos);
+        saveCv.notify_all();
+        throw;
+    }
+    std::lock_guard lock(saveMutex);
+    savingChunks.erase(pos);
+    saveCv.notify_all();
+}
+
 void WorldRegions::put(
     int x,
     int z,
     RegionLayerIndex layerid,
     std::unique_ptr<ubyte[]> data,
     size_t srcSize
+) {
+    // queued snapshot must not overwrite the data later
+    waitForChunk(x, z);
+    putData(x, z, layerid, std::move(data), srcSize);
+}
+
+void WorldRegions::putData(
+    int x,
+    int z,
+    RegionLayerIndex layerid,
+    std::unique_ptr<ubyte[]> data,
+    size_t srcSize
 ) {
     size_t size = srcSize;
     auto& layer = layers[layerid];
-    int regionX, regionZ, localX, localZ;
-    calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
-
-    WorldRegion* region = layer.getOrCreateRegion(regionX, regionZ);
-    region->setUnsaved(true);
-    
     if (data == nullptr) {
-        region->put(localX, localZ, nullptr, 0, 0);
+        layer.put(x, z, nullptr, 0, 0);
         return;
     }
-
     if (layer.compression != compression::Method::NONE) {
         data = compression::compress(
-            data.get(), size, size, layer.compression);
+            data.get(), size, size, layer.compression, layer.dictionary.get()
+        );
     }
-    region->put(localX, localZ, std::move(data), size, srcSize);
+    layer.put(x, z, std::move(data), size, srcSize);
 }
 
 static std::unique_ptr<ubyte[]> write_inventories(
@@ -164,101 +367,145 @@ void WorldRegions::put(Chunk* chunk, std::vector<ubyte> entitiesData) {
     if (!chunk->flags.unsaved && !lightsUnsaved && !chunk->flags.entities) {
         return;
     }
-
-    int regionX, regionZ, localX, localZ;
-    calc_reg_coords(chunk->x, chunk->z, regionX, regionZ, localX, localZ);
-
-    put(chunk->x,
-        chunk->z,
-        REGION_LAYER_VOXELS,
-        chunk->encode(),
-        CHUNK_DATA_LEN);
+    auto snapshot = std::make_unique<ChunkSnapshot>();
+    auto setLayer = [&snapshot](
+        RegionLayerIndex layer, std::unique_ptr<ubyte[]> data, size_t size
+    ) {
+        snapshot->data[layer] = std::move(data);
+        snapshot->sizes[layer] = size;
+    };
+    setLayer(REGION_LAYER_VOXELS, chunk->encode(), CHUNK_DATA_LEN);
 
     // Writing lights cache
     if (doWriteLights && chunk->flags.lighted && chunk->lightmap) {
-        put(chunk->x,
-            chunk->z,
-            REGION_LAYER_LIGHTS,
-            chunk->lightmap->encode(),
-            LIGHTMAP_DATA_LEN);
+        setLayer(
+            REGION_LAYER_LIGHTS, chunk->lightmap->encode(), LIGHTMAP_DATA_LEN
+        );
     }
     // Writing block inventories
     if (!chunk->inventories.empty()) {
         uint datasize;
         auto data = write_inventories(chunk->inventories, datasize);
-        put(chunk->x,
-            chunk->z,
-            REGION_LAYER_INVENTORIES,
-            std::move(data),
-            datasize);
+        setLayer(REGION_LAYER_INVENTORIES, std::move(data), datasize);
     }
     // Writing entities
     if (!entitiesData.empty()) {
         auto data = std::make_unique<ubyte[]>(entitiesData.size());
-        for (size_t i = 0; i < entitiesData.size(); i++) {
-            data[i] = entitiesData[i];
-        }
-        put(chunk->x,
-            chunk->z,
-            REGION_LAYER_ENTITIES,
-            std::move(data),
-            entitiesData.size());
+        std::memcpy(data.get(), entitiesData.data(), entitiesData.size());
+        setLayer(REGION_LAYER_ENTITIES, std::move(data), entitiesData.size());
     }
     // Writing blocks data
     if (chunk->flags.blocksData) {
         auto bytes = chunk->blocksMetadata.serialize();
-        put(chunk->x,
-            chunk->z,
-            REGION_LAYER_BLOCKS_DATA,
-            bytes.release(),
-            bytes.size());
+        size_t size = bytes.size();
+        setLayer(REGION_LAYER_BLOCKS_DATA, bytes.release(), size);
+    }
+
+    glm::ivec2 pos(chunk->x, chunk->z);
+    size_t memoryUsage = snapshot->getMemoryUsage();
+
+    std::unique_lock lock(saveMutex);
+    saveCv.wait(lock, [this, memoryUsage] {
+        return snapshotsMemory + memoryUsage <= MAX_SNAPSHOTS_MEMORY ||
+               snapshots.empty();
+    });
+    auto& queued = snapshots[pos];
+    if (queued) {
+        snapshotsMemory -= queued->getMemoryUsage();
+        queued->merge(std::move(*snapshot));
+        snapshotsMemory += queued->getMemoryUsage();
+        return;
+    }
+    snapshotsMemory += memoryUsage;
+    queued = std::move(snapshot);
+    saveQueue.push_back(pos);
+    if (!saveThread.joinable()) {
+        saveThread = std::thread(&WorldRegions::saveLoop, this);
+    }
+    saveCv.notify_all();
+}
+
+static void decompress_data(
+    const ChunkDataView& view,
+    ubyte* dst,
+    size_t dstlen,
+    const RegionsLayer& layer
+) {
+    if (view.compression == compression::Method::NONE) {
+        std::memcpy(dst, view.data, std::min<size_t>(view.size, dstlen));
+        return;
     }
+    compression::decompress(
+        {view.data, view.size},
+        dst,
+        dstlen,
+        view.compression,
+        layer.dictionary.get()
+    );
+}
+
+/// @brief Replace view data with decompressed data
+static void decompress_view(ChunkDataView& view, const RegionsLayer& layer) {
+    if (view.compression == compression::Method::NONE) {
+        return;
+    }
+    view.buffer = compression::decompress(
+        view.data,
+        view.size,
+        view.srcSize,
+        view.compression,
+        layer.dictionary.get()
+    );
+    view.file = nullptr;
+    view.data = view.buffer.get();
+    view.size = view.srcSize;
+    view.compression = compression::Method::NONE;
 }
 
 bool WorldRegions::getVoxels(int x, int z, ubyte* dst) {
-    uint32_t size;
-    uint32_t srcSize;
+    waitForChunk(x, z);
     auto& layer = layers[REGION_LAYER_VOXELS];
-    auto* data = layer.getData(x, z, size, srcSize);
-    if (data == nullptr) {
+    auto data = layer.getData(x, z);
+    if (!data) {
         return false;
     }
-    assert(srcSize == CHUNK_DATA_LEN);
-    compression::decompress({data, size}, dst, CHUNK_DATA_LEN, layer.compression);
+    assert(data.srcSize == CHUNK_DATA_LEN);
+    decompress_data(data, dst, CHUNK_DATA_LEN, layer);
     return true;
 }
 
 bool WorldRegions::getLights(int x, int z, ubyte* dst) {
-    uint32_t size;
-    uint32_t srcSize;
+    waitForChunk(x, z);
     auto& layer = layers[REGION_LAYER_LIGHTS];
-    auto* bytes = layer.getData(x, z, size, srcSize);
-    if (bytes == nullptr) {
+    auto bytes = layer.getData(x, z);
+    if (!bytes) {
         return false;
     }
-    compression::decompress({bytes, size}, dst, srcSize, layer.compression);
+    decompress_data(bytes, dst, bytes.srcSize, layer);
     return true;
 }
 
 ChunkInventoriesMap WorldRegions::fetchInventories(int x, int z) {
-    uint32_t bytesSize;
-    uint32_t srcSize;
-    auto bytes = layers[REGION_LAYER_INVENTORIES].getData(x, z, bytesSize, srcSize);
-    if (bytes == nullptr) {
+    waitForChunk(x, z);
+    auto& layer = layers[REGION_LAYER_INVENTORIES];
+    auto bytes = layer.getData(x, z);
+    if (!bytes) {
         return {};
     }
-    return load_inventories(bytes, bytesSize);
+    decompress_view(bytes, layer);
+    return load_inventories(bytes.data, bytes.size);
 }
 
 BlocksMetadata WorldRegions::getBlocksData(int x, int z) {
-    uint32_t bytesSize;
-    uint32_t srcSize;
-    auto bytes = layers[REGION_LAYER_BLOCKS_DATA].getData(x, z, bytesSize, srcSize);
-    if (bytes == nullptr) {
+    waitForChunk(x, z);
+    auto& layer = layers[REGION_LAYER_BLOCKS_DATA];
+    auto bytes = layer.getData(x, z);
+    if (!bytes) {
         return {};
     }
+    decompress_view(bytes, layer);
     BlocksMetadata heap;
-    heap.deserialize(bytes, bytesSize);
+    heap.deserialize(bytes.data, bytes.size);
     return heap;
 }
 
@@ -287,6 +534,7 @@ void WorldRegions::processBlocksData(int x, int z, const BlockDataProc& func) {
     if (voxRegfile == nullptr) {
         logger.warning() << "missing voxels region - discard blocks data for "
             << x << "_" << z;
+        datRegfile.reset();
         deleteRegion(REGION_LAYER_BLOCKS_DATA, x, z);
         return;
     }
@@ -314,9 +562,27 @@ void WorldRegions::processBlocksData(int x, int z, const BlockDataProc& func) {
                 put(gx, gz, REGION_LAYER_BLOCKS_DATA, nullptr, 0);
                 continue;
             }
-            voxData = compression::decompress(
-                voxData.get(), voxLength, voxSrcSize, voxLayer.compression
-            );
+            auto voxMethod = voxRegfile.get()->compression;
+            if (voxMethod != compression::Method::NONE) {
+                voxData = compression::decompress(
+                    voxData.get(),
+                    voxLength,
+                    voxSrcSize,
+                    voxMethod,
+                    voxLayer.dictionary.get()
+                );
+            }
+            auto datMethod = datRegfile.get()->compression;
+            if (datMethod != compression::Method::NONE) {
+                datData = compression::decompress(
+                    datData.get(),
+                    datLength,
+                    datSrcSize,
+                    datMethod,
+                    layers[REGION_LAYER_BLOCKS_DATA].dictionary.get()
+                );
+                datLength = datSrcSize;
+            }
 
             BlocksMetadata blocksData;
             blocksData.deserialize(datData.get(), datLength);
@@ -337,13 +603,14 @@ dv::value WorldRegions::fetchEntities(int x, int z) {
     if (generatorTestMode) {
         return nullptr;
     }
-    uint32_t bytesSize;
-    uint32_t srcSize;
-    const ubyte* data = layers[REGION_LAYER_ENTITIES].getData(x, z, bytesSize, srcSize);
-    if (data == nullptr) {
+    waitForChunk(x, z);
+    auto& layer = layers[REGION_LAYER_ENTITIES];
+    auto data = layer.getData(x, z);
+    if (!data) {
         return nullptr;
     }
-    auto map = json::from_binary(data, bytesSize);
+    decompress_view(data, layer);
+    auto map = json::from_binary(data.data, data.size);
     if (map.empty()) {
         return nullptr;
     }
@@ -372,9 +639,10 @@ void WorldRegions::processRegion(
             if (data == nullptr) {
                 continue;
             }
-            if (layer.compression != compression::Method::NONE) {
+            auto method = regfile.get()->compression;
+            if (method != compression::Method::NONE) {
                 data = compression::decompress(
-                    data.get(), length, srcSize, layer.compression
+                    data.get(), length, srcSize, method, layer.dictionary.get()
                 );
             } else {
                 srcSize = length;
@@ -394,23 +662,108 @@ io::path WorldRegions::getRegionFilePath(RegionLayerIndex layerid, int x, int z)
     return layers[layerid].getRegionFilePath(x, z);
 }
 
-void WorldRegions::writeAll() {
+void WorldRegions::setCompression(
+    RegionLayerIndex layerid,
+    compression::Method method,
+    std::shared_ptr<const compression::Dictionary> dictionary
+) {
+    auto& layer = layers[layerid];
+    if (dictionary == nullptr) {
+        dictionary = layer.dictionary;
+    }
+    if (method == compression::Method::ZLIB_DICT && dictionary == nullptr) {
+        throw std::invalid_argument("compression method requires dictionary");
+    }
+    if (dictionary && dictionary != layer.dictionary) {
+        if (layer.dictionary) {
+            if (layer.dictionary->id != dictionary->id) {
+                throw std::runtime_error(
+                    "other compression dictionary is already used by " +
+                    layer.folder.string()
+                );
+            }
+        } else {
+            io::create_directories(layer.folder);
+            io::write_bytes(
+                layer.folder / DICTIONARY_FILE,
+                dictionary->bytes.data(),
+                dictionary->bytes.size()
+            );
+        }
+    }
+    // queued chunks must be compressed with the current method
+    flush();
+
+    std::lock_guard lock(layer.mapMutex);
+    auto prevMethod = layer.compression;
+    layer.dictionary = std::move(dictionary);
+    layer.compression = method;
+    if (prevMethod == method) {
+        return;
+    }
+    // in-memory chunks data is expected to use the layer method
+    for (auto& [_, region] : layer.regions) {
+        auto chunks = region->getChunks();
+        auto sizes = region->getSizes();
+        for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+            if (chunks[i] == nullptr) {
+                continue;
+            }
+            chunks[i] = layer.recompress(
+                chunks[i].get(), sizes[i].x, sizes[i].y, prevMethod
+            );
+        }
+    }
+}
+
+compression::Method WorldRegions::getCompression(
+    RegionLayerIndex layerid
+) const {
+    return layers[layerid].compression;
+}
+
+void WorldRegions::writeRegions() {
     for (auto& layer : layers) {
         io::create_directories(layer.folder);
         layer.writeAll();
     }
+    std::lock_guard lock(compactionMutex);
+    bool scheduled = false;
+    for (auto& layer : layers) {
+        for (const auto& coord : layer.fragmentedRegions) {
+            compactionQueue.emplace(layer.layer, coord);
+            scheduled = true;
+        }
+        layer.fragmentedRegions.clear();
+    }
+    if (!scheduled) {
+        return;
+    }
+    if (!compactionThread.joinable()) {
+        compactionThread = std::thread(&WorldRegions::compactionLoop, this);
+    }
+    compactionCv.notify_one();
 }
 
-void WorldRegions::deleteRegion(RegionLayerIndex layerid, int x, int z) {
-    auto& layer = layers[layerid];
-    if (layer.getRegFile({x, z}, false)) {
-        throw std::runtime_error("region file is currently in use");
-    }
-    auto file = layer.getRegionFilePath(x, z);
-    if (io::exists(file)) {
-        logger.info() << "remove region file " << file.string();
-        io::remove(file);
+void WorldRegions::writeAll() {
+    std::lock_guard lock(saveMutex);
+    writeRequested = true;
+    if (!saveThread.joinable()) {
+        saveThread = std::thread(&WorldRegions::saveLoop, this);
     }
+    saveCv.notify_all();
+}
+
+void WorldRegions::flush() {
+    std::unique_lock lock(saveMutex);
+    saveCv.wait(lock, [this] {
+        return snapshots.empty() && savingChunks.empty() && !writeRequested &&
+               !writing;
+    });
+}
+
+void WorldRegions::deleteRegion(RegionLayerIndex layerid, int x, int z) {
+    layers[layerid].deleteRegion(x, z);
 }
 
 bool WorldRegions::parseRegionFilename(
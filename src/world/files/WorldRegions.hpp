@@ -1,15 +1,23 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <glm/glm.hpp>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <queue>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "coders/compression.hpp"
 #include "io/io.hpp"
+#include "io/MappedFile.hpp"
+#include "RegionFile.hpp"
 #include "maths/voxmaths.hpp"
 #include "typedefs.hpp"
 #include "util/BufferPool.hpp"
@@ -19,49 +27,72 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
-inline constexpr uint REGION_HEADER_SIZE = 10;
-
-inline constexpr uint REGION_SIZE_BIT = 5;
-inline constexpr uint REGION_SIZE = (1 << (REGION_SIZE_BIT));
-inline constexpr uint REGION_CHUNKS_COUNT = ((REGION_SIZE) * (REGION_SIZE));
-
-class illegal_region_format : public std::runtime_error {
-public:
-    illegal_region_format(const std::string& message)
-        : std::runtime_error(message) {
-    }
-};
-
 class WorldRegion {
     std::unique_ptr<std::unique_ptr<ubyte[]>[]> chunksData;
     std::unique_ptr<glm::u32vec2[]> sizes;
     bool unsaved = false;
+    /// @brief Chunks put after the region has been written
+    std::bitset<REGION_CHUNKS_COUNT> unsavedChunks;
 public:
     WorldRegion();
     ~WorldRegion();
 
+    /// @brief Put chunk data marking the chunk unsaved
+    /// @param data nullptr to remove chunk from the region
     void put(uint x, uint z, std::unique_ptr<ubyte[]> data, uint32_t size, uint32_t srcSize);
     ubyte* getChunkData(uint x, uint z);
     glm::u32vec2 getChunkDataSize(uint x, uint z);
 
+    /// @param unsaved false marks all chunks saved
     void setUnsaved(bool unsaved);
     bool isUnsaved() const;
+    void setChunkUnsaved(uint index);
+    bool isChunkUnsaved(uint index) const;
 
     std::unique_ptr<ubyte[]>* getChunks() const;
     glm::u32vec2* getSizes() const;
 };
 
 struct regfile {
-    io::rafile file;
+    /// @brief Memory-mapped file. nullptr if not supported by the device
+    std::unique_ptr<io::MappedFile> mapped;
+    /// @brief File stream used if the file is not memory-mapped
+    std::unique_ptr<io::rafile> file;
+    std::mutex fileMutex;
     io::path filename;
+    size_t length;
+    /// @brief End of chunks data
+    size_t dataEnd;
+    /// @brief Offsets table position
+    size_t tableOffset;
     int version;
-    bool inUse = false;
+    /// @brief Chunks data compression method
+    compression::Method compression;
+    /// @brief Number of regfile_ptr using the file.
+    /// Guarded by RegionsLayer::regFilesMutex
+    int users = 0;
+    /// @brief Position in RegionsLayer::regFilesLRU
+    std::list<glm::ivec2>::iterator lruPosition;
     std::array<uint32_t, REGION_CHUNKS_COUNT> offsets;
 
     regfile(io::path filename);
     regfile(const regfile&) = delete;
 
+    /// @brief Read copy of chunk data
+    /// @return nullptr if chunk is not present in the file
     std::unique_ptr<ubyte[]> read(int index, uint32_t& size, uint32_t& srcSize);
+
+    /// @brief Get chunk data. Memory-mapped file data is not copied
+    /// @param buffer [out] data copy if the file is not memory-mapped
+    /// @return nullptr if chunk is not present in the file
+    const ubyte* read(
+        int index,
+        uint32_t& size,
+        uint32_t& srcSize,
+        std::unique_ptr<ubyte[]>& buffer
+    );
+private:
+    void readBytes(size_t offset, void* dst, size_t size);
 };
 
 using RegionsMap = std::unordered_map<glm::ivec2, std::unique_ptr<WorldRegion>>;
@@ -69,18 +100,35 @@ using RegionProc = std::function<std::unique_ptr<ubyte[]>(std::unique_ptr<ubyte[
 using InventoryProc = std::function<void(Inventory*)>;
 using BlockDataProc = std::function<void(BlocksMetadata*, std::unique_ptr<ubyte[]>)>;
 
-/// @brief Region file pointer keeping inUse flag on until destroyed
+/// @brief Region file pointer keeping the file in use until destroyed
 class regfile_ptr {
     regfile* file;
+    std::mutex* mutex;
     std::condition_variable* cv;
 public:
-    regfile_ptr(regfile* file, std::condition_variable* cv)
-        : file(file), cv(cv) {
+    regfile_ptr(regfile* file, std::mutex* mutex, std::condition_variable* cv)
+        : file(file), mutex(mutex), cv(cv) {
     }
 
     regfile_ptr(const regfile_ptr&) = delete;
 
-    regfile_ptr(std::nullptr_t) : file(nullptr), cv(nullptr) {
+    regfile_ptr(regfile_ptr&& other) noexcept
+        : file(other.file), mutex(other.mutex), cv(other.cv) {
+        other.file = nullptr;
+    }
+
+    regfile_ptr(std::nullptr_t) : file(nullptr), mutex(nullptr), cv(nullptr) {
+    }
+
+    regfile_ptr& operator=(regfile_ptr&& other) noexcept {
+        if (this != &other) {
+            reset();
+            file = other.file;
+            mutex = other.mutex;
+            cv = other.cv;
+            other.file = nullptr;
+        }
+        return *this;
     }
 
     bool operator==(std::nullptr_t) const {
@@ -100,13 +148,34 @@ public:
     }
     void reset() {
         if (file) {
-            file->inUse = false;
-            cv->notify_one();
+            {
+                std::lock_guard lock(*mutex);
+                file->users--;
+            }
+            cv->notify_all();
             file = nullptr;
         }
     }
 };
 
+/// @brief Chunk data of a regions layer. Points to the buffer or
+/// the memory-mapped region file kept in use while the view exists
+struct ChunkDataView {
+    const ubyte* data = nullptr;
+    /// @brief Compressed data length
+    uint32_t size = 0;
+    /// @brief Source data length
+    uint32_t srcSize = 0;
+    compression::Method compression = compression::Method::NONE;
+    regfile_ptr file = nullptr;
+    /// @brief Data copy if the data is not memory-mapped
+    std::unique_ptr<ubyte[]> buffer;
+
+    operator bool() const {
+        return data != nullptr;
+    }
+};
+
 inline void calc_reg_coords(
     int x, int z, int& regionX, int& regionZ, int& localX, int& localZ
 ) {
@@ -123,44 +192,122 @@ struct RegionsLayer {
     /// @brief Regions layer folder
     io::path folder;
 
+    /// @brief Chunks data compression method. Region files compressed
+    /// with other method are recompressed on write
     compression::Method compression = compression::Method::NONE;
 
+    /// @brief Dictionary used by dictionary compression methods
+    std::shared_ptr<const compression::Dictionary> dictionary;
+
     /// @brief In-memory regions data
     RegionsMap regions;
 
-    /// @brief In-memory regions map mutex
+    /// @brief In-memory regions map and regions data mutex
     std::mutex mapMutex;
 
     /// @brief Open region files map
     std::unordered_map<glm::ivec2, std::unique_ptr<regfile>> openRegFiles;
 
+    /// @brief Open region files from the most to the least recently used
+    std::list<glm::ivec2> regFilesLRU;
+
     /// @brief Open region files map mutex
     std::mutex regFilesMutex;
+    /// @brief Notified when a region file gets out of use or closed
     std::condition_variable regFilesCv;
 
+    /// @brief Regions being written. Only one thread writes a region
+    std::unordered_set<glm::ivec2> writingRegions;
+
+    /// @brief Regions which files are being modified in place or replaced.
+    /// Their files can't be open
+    std::unordered_set<glm::ivec2> lockedRegions;
+
+    /// @brief Writers of region files (version 4) kept between writes, so
+    /// the file offsets table and free sectors are not read again.
+    /// Guarded by regFilesMutex, writers being used are taken out of it
+    std::unordered_map<glm::ivec2, std::unique_ptr<RegionFileWriter>>
+        regWriters;
+
+    /// @brief Regions which files got fragmented after writing
+    std::vector<glm::ivec2> fragmentedRegions;
+
+    /// @brief Get open region file or open it
+    /// @param create open the file if it's not open yet
+    /// @return nullptr if region file does not exist or not open
     [[nodiscard]] regfile_ptr getRegFile(glm::ivec2 coord, bool create = true);
-    [[nodiscard]] regfile_ptr useRegFile(glm::ivec2 coord);
-    regfile_ptr createRegFile(glm::ivec2 coord);
-    void closeRegFile(glm::ivec2 coord);
+    /// @brief Mark region file as used. regFilesMutex must be locked
+    [[nodiscard]] regfile_ptr useRegFile(regfile& file);
+    /// @brief Close the least recently used region file that is not in use.
+    /// regFilesMutex must be locked
+    /// @return false if all open files are in use
+    bool closeUnusedRegFile();
+    /// @brief Prevent region from being written by other threads until
+    /// endWrite is called
+    void beginWrite(glm::ivec2 coord);
+    void endWrite(glm::ivec2 coord);
+    /// @brief Close region file and prevent it from opening until
+    /// unlockFile is called. Waits until the file gets out of use
+    void lockFile(glm::ivec2 coord);
+    void unlockFile(glm::ivec2 coord);
+
+    /// @return cached region file writer or nullptr
+    std::unique_ptr<RegionFileWriter> takeRegWriter(glm::ivec2 coord);
+    /// @brief Keep region file writer until the next write
+    void keepRegWriter(
+        glm::ivec2 coord, std::unique_ptr<RegionFileWriter> writer
+    );
 
     WorldRegion* getRegion(int x, int z);
-    WorldRegion* getOrCreateRegion(int x, int z);
 
     io::path getRegionFilePath(int x, int z) const;
 
+    /// @brief Put chunk data to in-memory region marking it unsaved
+    /// @param x chunk x coord
+    /// @param z chunk z coord
+    /// @param data compressed chunk data or nullptr to remove chunk
+    void put(
+        int x,
+        int z,
+        std::unique_ptr<ubyte[]> data,
+        uint32_t size,
+        uint32_t srcSize
+    );
+
     /// @brief Get chunk data. Read from file if not loaded yet.
+    /// In-memory region data is copied to the view buffer
     /// @param x chunk x coord
     /// @param z chunk z coord
-    /// @param size [out] compressed chunk data length
-    /// @param size [out] source chunk data length
-    /// @return nullptr if no saved chunk data found
-    [[nodiscard]] ubyte* getData(int x, int z, uint32_t& size, uint32_t& srcSize);
+    /// @return empty view if no saved chunk data found
+    [[nodiscard]] ChunkDataView getData(int x, int z);
 
-    /// @brief Write or rewrite region file
+    /// @brief Write region unsaved chunks. Region file of older format
+    /// version or compressed with other method is rewritten. Chunks data
+    /// is copied, so the region may be modified while writing
     /// @param x region X
     /// @param z region Z
     void writeRegion(int x, int y, WorldRegion* entry);
 
+    /// @brief Compress chunk data with the layer compression method
+    /// @param size [in, out] compressed data length
+    /// @param method current data compression method
+    std::unique_ptr<ubyte[]> recompress(
+        const ubyte* data,
+        uint32_t& size,
+        uint32_t srcSize,
+        compression::Method method
+    ) const;
+
+    /// @brief Rewrite region file without free sectors
+    /// @param x region X
+    /// @param z region Z
+    void compactRegion(int x, int z);
+
+    /// @brief Delete region file
+    /// @param x region X
+    /// @param z region Z
+    void deleteRegion(int x, int z);
+
     /// @brief Write all unsaved regions to files
     void writeAll();
 
@@ -176,11 +323,76 @@ struct RegionsLayer {
     );
 };
 
+/// @brief Uncompressed chunk data to be put to regions by the save thread
+struct ChunkSnapshot {
+    /// @brief Layers data. nullptr if the layer is not updated
+    std::unique_ptr<ubyte[]> data[REGION_LAYERS_COUNT] {};
+    size_t sizes[REGION_LAYERS_COUNT] {};
+
+    /// @brief Replace layers present in the newer snapshot
+    void merge(ChunkSnapshot&& snapshot);
+
+    size_t getMemoryUsage() const;
+};
+
 class WorldRegions {
     /// @brief World directory
     io::path directory;
 
     RegionsLayer layers[REGION_LAYERS_COUNT] {};
+
+    /// @brief Background chunks compression and region files writing thread
+    std::thread saveThread;
+    std::mutex saveMutex;
+    /// @brief Notified when save thread state changes
+    std::condition_variable saveCv;
+    /// @brief Chunks in order of saving. May contain already taken chunks
+    std::deque<glm::ivec2> saveQueue;
+    /// @brief Queued chunk snapshots. Newer snapshot gets merged into
+    /// the queued one
+    std::unordered_map<glm::ivec2, std::unique_ptr<ChunkSnapshot>> snapshots;
+    /// @brief Chunks being put to regions
+    std::unordered_set<glm::ivec2> savingChunks;
+    /// @brief Memory used by queued snapshots
+    size_t snapshotsMemory = 0;
+    bool writeRequested = false;
+    bool writing = false;
+    bool saveStopped = false;
+
+    /// @brief Background region files compaction thread
+    std::thread compactionThread;
+    std::mutex compactionMutex;
+    std::condition_variable compactionCv;
+    std::queue<std::pair<RegionLayerIndex, glm::ivec2>> compactionQueue;
+    bool compactionStopped = false;
+
+    void compactionLoop();
+
+    void saveLoop();
+
+    /// @brief Take queued chunk snapshot marking the chunk saving.
+    /// saveMutex must be locked
+    /// @return nullptr if no snapshot queued
+    std::unique_ptr<ChunkSnapshot> takeSnapshot(glm::ivec2 pos);
+
+    /// @brief Compress and put snapshot to regions
+    void saveSnapshot(glm::ivec2 pos, ChunkSnapshot& snapshot);
+
+    /// @brief Put queued snapshot of the chunk to regions immediately.
+    /// Waits if the chunk is being saved by the save thread
+    void waitForChunk(int x, int z);
+
+    /// @brief Compress and put data to regions without waiting for
+    /// the chunk snapshot
+    void putData(
+        int x,
+        int z,
+        RegionLayerIndex layer,
+        std::unique_ptr<ubyte[]> data,
+        size_t size
+    );
+
+    void writeRegions();
 public:
     bool generatorTestMode = false;
     bool doWriteLights = true;
@@ -189,7 +401,8 @@ public:
     WorldRegions(const WorldRegions&) = delete;
     ~WorldRegions();
 
-    /// @brief Put all chunk data to regions
+    /// @brief Queue chunk data snapshot to be compressed and put to regions
+    /// by the save thread. Blocks while queued snapshots take too much memory
     void put(Chunk* chunk, std::vector<ubyte> entitiesData);
 
     /// @brief Store data in specified region
@@ -245,9 +458,29 @@ public:
 
     io::path getRegionFilePath(RegionLayerIndex layerid, int x, int z) const;
 
-    /// @brief Write all region layers
+    /// @brief Set regions layer compression method. Waits for queued
+    /// chunks to be saved. Region files are recompressed on write
+    /// @param dictionary dictionary for dictionary compression methods.
+    /// Stored to the layer folder
+    /// @throw std::invalid_argument if required dictionary is not provided
+    /// @throw std::runtime_error if other dictionary is already stored
+    void setCompression(
+        RegionLayerIndex layerid,
+        compression::Method method,
+        std::shared_ptr<const compression::Dictionary> dictionary = nullptr
+    );
+
+    compression::Method getCompression(RegionLayerIndex layerid) const;
+
+    /// @brief Write all region layers in background after all queued
+    /// chunks are put. Fragmented region files are compacted then
+    /// @see flush
     void writeAll();
 
+    /// @brief Wait until all queued chunks are put and requested writing
+    /// is finished
+    void flush();
+
     void deleteRegion(RegionLayerIndex layerid, int x, int z);
 
     /// @brief Extract X and Z from 'X_Z.bin' region file name.
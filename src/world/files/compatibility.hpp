@@ -6,7 +6,7 @@
 
 namespace compatibility {
     /// @brief Convert region file from version 2 to 3
-    /// @see /doc/specs/region_file_spec.md
+    /// @see /doc/specs/outdated/region_file_spec_v3.md
     /// @param src region file source content
     /// @return new region file content
     util::Buffer<ubyte> convert_region_2to3(
@@ -14,6 +14,7 @@
 #include "maths/voxmaths.hpp"
 #include "maths/util.hpp"
 #include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
 
 static debug::Logger logger("world-generator");
 
@@ -144,10 +145,10 @@ static inline const Biome* choose_biome(
     return chosenBiome;
 }
 
-std::unique_ptr<ChunkPrototype> WorldGenerator::generatePrototype(
+std::shared_ptr<ChunkPrototype> WorldGenerator::generatePrototype(
     int chunkX, int chunkZ
 ) {
-    return std::make_unique<ChunkPrototype>();
+    return std::make_shared<ChunkPrototype>();
 }
 
 inline AABB gen_chunk_aabb(int chunkX, int chunkZ) {
@@ -411,7 +412,7 @@ void WorldGenerator::generatePlants(
     int chunkX,
     int chunkZ,
     const Biome** biomes
-) {
+) const {
     const auto& indices = content.getIndices()->blocks;
     util::PseudoRandom plantsRand;
     plantsRand.setSeed(chunkX, chunkZ);
@@ -453,7 +454,7 @@ void WorldGenerator::generateLand(
     int chunkX,
     int chunkZ,
     const Biome** biomes
-) {
+) const {
     uint seaLevel = def.seaLevel;
     for (uint z = 0; z < CHUNK_D; z++) {
         for (uint x = 0; x < CHUNK_W; x++) {
@@ -472,9 +473,35 @@ void WorldGenerator::generateLand(
 }
 
 void WorldGenerator::generate(voxel* voxels, int chunkX, int chunkZ) {
+    generate(prepare(chunkX, chunkZ), voxels);
+}
+
+PreparedChunk WorldGenerator::prepare(int chunkX, int chunkZ) {
     surroundMap.completeAt(chunkX, chunkZ);
 
-    const auto& prototype = requirePrototype(chunkX, chunkZ);
+    const auto& found = prototypes.find({chunkX, chunkZ});
+    if (found == prototypes.end()) {
+        throw std::runtime_error("prototype not found");
+    }
+    // placements are copied as neighbour prototypes may still be modified
+    // while the chunk voxels are being generated
+    auto placements = found->second->placements;
+    std::stable_sort(
+        placements.begin(),
+        placements.end(), 
+        [](const auto& a, const auto& b) {
+            return a.priority < b.priority;
+        }
+    );
+    return PreparedChunk {
+        chunkX, chunkZ, found->second, std::move(placements)};
+}
+
+void WorldGenerator::generate(const PreparedChunk& chunk, voxel* voxels) const {
+    debug::ProfileScope profile(debug::ProfileStage::GENERATION);
+    int chunkX = chunk.x;
+    int chunkZ = chunk.z;
+    const auto& prototype = *chunk.prototype;
     const auto values = prototype.heightmap->getValues();
 
     uint seaLevel = def.seaLevel;
@@ -496,7 +523,7 @@ void WorldGenerator::generate(voxel* voxels, int chunkX, int chunkZ) {
             generate_pole(groundLayers, height, 0, seaLevel, voxels, x, z);
         }
     }
-    generatePlacements(prototype, voxels, chunkX, chunkZ);
+    generatePlacements(prototype, chunk.placements, voxels, chunkX, chunkZ);
     generatePlants(prototype, values, voxels, chunkX, chunkZ, biomes);
 
     [[maybe_unused]] const auto& indices = content.getIndices()->blocks;
@@ -514,16 +541,12 @@ void WorldGenerator::generate(voxel* voxels, int chunkX, int chunkZ) {
 }
 
 void WorldGenerator::generatePlacements(
-    const ChunkPrototype& prototype, voxel* voxels, int chunkX, int chunkZ
-) {
-    auto placements = prototype.placements;
-    std::stable_sort(
-        placements.begin(),
-        placements.end(), 
-        [](const auto& a, const auto& b) {
-            return a.priority < b.priority;
-        }
-    );
+    const ChunkPrototype& prototype,
+    const std::vector<Placement>& placements,
+    voxel* voxels,
+    int chunkX,
+    int chunkZ
+) const {
     for (const auto& placement : placements) {
         if (auto structure = std::get_if<StructurePlacement>(&placement.placement)) {
             generateStructure(prototype, *structure, voxels, chunkX, chunkZ);
@@ -540,7 +563,7 @@ void WorldGenerator::generateStructure(
     const StructurePlacement& placement,
     voxel* voxels, 
     int chunkX, int chunkZ
-) {
+) const {
     if (placement.structure < 0 || placement.structure >= def.structures.size()) {
         logger.error() << "invalid structure index " << placement.structure;
         return;
@@ -581,7 +604,7 @@ void WorldGenerator::generateLine(
     const LinePlacement& line,
     voxel* voxels, 
     int chunkX, int chunkZ
-) {
+) const {
     const auto& indices = content.getIndices()->blocks;
 
     int cgx = chunkX * CHUNK_W;
@@ -642,7 +665,7 @@ void WorldGenerator::generateBlock(
     const BlockPlacement& placement,
     voxel* voxels,
     int chunkX, int chunkZ
-) {
+) const {
     const auto& indices = content.getIndices()->blocks;
     const auto& def = indices.require(placement.block);
 
@@ -37,6 +37,17 @@ struct ChunkPrototype {
     std::vector<std::shared_ptr<Heightmap>> heightmapInputs {};
 };
 
+/// @brief Complete chunk prototype snapshot. Voxels may be generated from it
+/// on any thread (see WorldGenerator::generate(const PreparedChunk&, voxel*))
+struct PreparedChunk {
+    int x;
+    int z;
+    /// @brief Complete prototype kept alive even if the generator unloads it
+    std::shared_ptr<const ChunkPrototype> prototype;
+    /// @brief Prototype placements sorted by priority
+    std::vector<Placement> placements;
+};
+
 struct WorldGenDebugInfo {
     int areaOffsetX;
     int areaOffsetY;
@@ -54,14 +65,14 @@ class WorldGenerator {
     /// @param seed world seed
     uint64_t seed;
     /// @brief Chunk prototypes main storage
-    std::unordered_map<glm::ivec2, std::unique_ptr<ChunkPrototype>> prototypes;
+    std::unordered_map<glm::ivec2, std::shared_ptr<ChunkPrototype>> prototypes;
     /// @brief Chunk prototypes loading surround map
     SurroundMap surroundMap;
 
     /// @brief Generate chunk prototype (see ChunkPrototype)
     /// @param x chunk position X divided by CHUNK_W
     /// @param z chunk position Y divided by CHUNK_D
-    std::unique_ptr<ChunkPrototype> generatePrototype(int x, int z);
+    std::shared_ptr<ChunkPrototype> generatePrototype(int x, int z);
 
     ChunkPrototype& requirePrototype(int x, int z);
 
@@ -82,26 +93,30 @@ class WorldGenerator {
     void placeBlock(const BlockPlacement& block, int priority);
 
     void generatePlacements(
-        const ChunkPrototype& prototype, voxel* voxels, int x, int z
-    );
+        const ChunkPrototype& prototype,
+        const std::vector<Placement>& placements,
+        voxel* voxels,
+        int x,
+        int z
+    ) const;
     void generateLine(
         const ChunkPrototype& prototype, 
         const LinePlacement& placement,
         voxel* voxels, 
         int x, int z
-    );
+    ) const;
     void generateBlock(
         const ChunkPrototype& prototype,
         const BlockPlacement& placement,
         voxel* voxels,
         int x, int z
-    );
+    ) const;
     void generateStructure(
         const ChunkPrototype& prototype, 
         const StructurePlacement& placement,
         voxel* voxels, 
         int x, int z
-    );
+    ) const;
     void generatePlants(
         const ChunkPrototype& prototype,
         float* values,
@@ -109,7 +124,7 @@ class WorldGenerator {
         int x,
         int z,
         const Biome** biomes
-    );
+    ) const;
     void generateLand(
         const ChunkPrototype& prototype,
         float* values,
@@ -117,7 +132,7 @@ class WorldGenerator {
         int x,
         int z,
         const Biome** biomes
-    );
+    ) const;
 
     void placeStructures(
         const std::vector<Placement>& placements,
@@ -140,6 +155,18 @@ public:
     /// @param z chunk position Y divided by CHUNK_D
     void generate(voxel* voxels, int x, int z);
 
+    /// @brief Complete chunk prototype. Must be called on the thread owning
+    /// the generator (generator script is not thread-safe)
+    /// @param x chunk position X divided by CHUNK_W
+    /// @param z chunk position Y divided by CHUNK_D
+    PreparedChunk prepare(int x, int z);
+
+    /// @brief Generate chunk voxels from a prepared prototype.
+    /// Thread-safe: does not modify generator state
+    /// @param chunk prepared chunk prototype
+    /// @param voxels destination chunk voxels buffer
+    void generate(const PreparedChunk& chunk, voxel* voxels) const;
+
     WorldGenDebugInfo createDebugInfo() const;
 
     uint64_t getSeed() const;
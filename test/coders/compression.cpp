@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "coders/compression.hpp"
+
+TEST(Compression, Dictionary) {
+    std::vector<std::vector<ubyte>> samples;
+    std::vector<util::span<ubyte>> spans;
+    for (int i = 0; i < 20; i++) {
+        std::string text =
+            "{\"id\":\"base:player\",\"uid\":" + std::to_string(i * 7919) +
+            ",\"transform\":{\"pos\":[" + std::to_string(i) + ",64,0]}}";
+        samples.emplace_back(text.begin(), text.end());
+    }
+    for (const auto& sample : samples) {
+        spans.emplace_back(sample.data(), sample.size());
+    }
+    auto dictionary = compression::train_dictionary(spans, 1024);
+    EXPECT_GT(dictionary.bytes.size(), 0);
+    EXPECT_LE(dictionary.bytes.size(), 1024);
+
+    const auto& source = samples[3];
+    size_t length;
+    auto compressed = compression::compress(
+        source.data(),
+        source.size(),
+        length,
+        compression::Method::ZLIB_DICT,
+        &dictionary
+    );
+    auto decompressed = compression::decompress(
+        compressed.get(),
+        length,
+        source.size(),
+        compression::Method::ZLIB_DICT,
+        &dictionary
+    );
+    EXPECT_EQ(
+        std::vector<ubyte>(decompressed.get(), decompressed.get() + source.size()),
+        source
+    );
+
+    compression::Dictionary other({1, 2, 3, 4});
+    EXPECT_THROW(
+        compression::decompress(
+            compressed.get(),
+            length,
+            source.size(),
+            compression::Method::ZLIB_DICT,
+            &other
+        ),
+        std::runtime_error
+    );
+    EXPECT_THROW(
+        compression::compress(
+            source.data(),
+            source.size(),
+            length,
+            compression::Method::ZLIB_DICT
+        ),
+        std::invalid_argument
+    );
+}
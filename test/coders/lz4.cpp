@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "coders/lz4.hpp"
+
+static std::vector<ubyte> generate_data(size_t size, int dencity) {
+    std::vector<ubyte> data(size);
+    ubyte next = rand();
+    for (size_t i = 0; i < size; i++) {
+        data[i] = next;
+        if (rand() % dencity == 0) {
+            next = rand();
+        }
+    }
+    return data;
+}
+
+static void test_encode_decode(const std::vector<ubyte>& initial) {
+    std::vector<ubyte> encoded(lz4::max_encoded_size(initial.size()));
+    size_t encodedSize =
+        lz4::encode(initial.data(), initial.size(), encoded.data());
+    EXPECT_LE(encodedSize, encoded.size());
+
+    std::vector<ubyte> decoded(initial.size());
+    size_t decodedSize = lz4::decode(
+        encoded.data(), encodedSize, decoded.data(), decoded.size()
+    );
+    EXPECT_EQ(decodedSize, initial.size());
+    EXPECT_EQ(decoded, initial);
+}
+
+TEST(LZ4, EncodeDecode) {
+    test_encode_decode({});
+    test_encode_decode({1, 2, 3});
+    test_encode_decode(generate_data(50'000, 1));
+    test_encode_decode(generate_data(50'000, 13));
+    test_encode_decode(generate_data(50'000, 90123));
+}
+
+TEST(LZ4, CorruptedData) {
+    auto initial = generate_data(10'000, 13);
+    std::vector<ubyte> encoded(lz4::max_encoded_size(initial.size()));
+    size_t encodedSize =
+        lz4::encode(initial.data(), initial.size(), encoded.data());
+    std::vector<ubyte> decoded(initial.size());
+
+    EXPECT_THROW(
+        lz4::decode(
+            encoded.data(), encodedSize / 2, decoded.data(), decoded.size()
+        ),
+        std::runtime_error
+    );
+    EXPECT_THROW(
+        lz4::decode(
+            encoded.data(), encodedSize, decoded.data(), decoded.size() / 2
+        ),
+        std::runtime_error
+    );
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+
+#include "content/ContentPack.hpp"
+#include "content/loading/ContentDefsCache.hpp"
+#include "io/io.hpp"
+#include "io/devices/StdfsDevice.hpp"
+#include "util/ParallelExecutor.hpp"
+
+namespace fs = std::filesystem;
+
+class ContentDefsCacheTest : public ::testing::Test {
+protected:
+    fs::path root;
+    ContentPack pack;
+
+    void SetUp() override {
+        root = fs::temp_directory_path() / "vc_content_defs_test";
+        fs::remove_all(root);
+        fs::create_directories(root);
+        io::set_device("defstest", std::make_shared<io::StdfsDevice>(root));
+        pack.folder = "defstest:pack";
+        io::create_directories(pack.folder / "blocks/ores");
+        io::create_directories(pack.folder / "blocks/stone.files");
+        io::create_directories(pack.folder / "items");
+        io::write_string(pack.folder / "blocks/stone.json", "{\"a\": 1}");
+        io::write_string(pack.folder / "blocks/ores/coal.json", "{\"b\": 2}");
+        io::write_string(pack.folder / "blocks/stone.files/x.json", "{}");
+        io::write_string(pack.folder / "items/broken.json", "{\"c\": ");
+    }
+
+    void TearDown() override {
+        io::remove_device("defstest");
+        fs::remove_all(root);
+    }
+};
+
+TEST_F(ContentDefsCacheTest, Discover) {
+    auto files = ContentDefsCache::discover({pack});
+    std::vector<std::string> names;
+    for (const auto& file : files) {
+        names.push_back(file.string());
+    }
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(
+        names,
+        std::vector<std::string>({
+            "defstest:pack/blocks/ores/coal.json",
+            "defstest:pack/blocks/stone.json",
+            "defstest:pack/items/broken.json",
+        })
+    );
+}
+
+TEST_F(ContentDefsCacheTest, ParseAndRead) {
+    ContentDefsCache defs;
+    util::ParallelExecutor executor("test", 2);
+    defs.parse(ContentDefsCache::discover({pack}), executor);
+    EXPECT_EQ(defs.size(), 3);
+
+    EXPECT_EQ(defs.read(pack.folder / "blocks/stone.json")["a"].asInteger(), 1);
+    EXPECT_EQ(
+        defs.read(pack.folder / "blocks/ores/coal.json")["b"].asInteger(), 2
+    );
+    // parsing errors are reported on read
+    EXPECT_THROW(
+        defs.read(pack.folder / "items/broken.json"), std::runtime_error
+    );
+    // files out of cache are read in place
+    EXPECT_EQ(defs.read(pack.folder / "blocks/stone.files/x.json").size(), 0);
+}
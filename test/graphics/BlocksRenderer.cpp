@@ -0,0 +1,409 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "assets/Assets.hpp"
+#include "content/Content.hpp"
+#include "frontend/ContentGfxCache.hpp"
+#include "graphics/core/Atlas.hpp"
+#include "graphics/core/ImageData.hpp"
+#include "graphics/core/Mesh.hpp"
+#include "graphics/render/BlocksRenderer.hpp"
+#include "lighting/Lighting.hpp"
+#include "maths/UVRegion.hpp"
+#include "settings.hpp"
+#include "test_world.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunks.hpp"
+#include "voxels/VoxelsVolume.hpp"
+
+static constexpr int AREA_SIZE = 3;
+static constexpr int MESH_PADDING = 2;
+static constexpr size_t CAPACITY = 200'000;
+
+struct MeshingScene {
+    std::unique_ptr<Content> content;
+    Assets assets;
+    EngineSettings settings;
+    std::unique_ptr<ContentGfxCache> cache;
+    std::unique_ptr<Chunks> chunks;
+
+    MeshingScene(bool flat, bool foliage = false) {
+        content = test_world::build_content([](auto& builder) {
+            auto& stone = test_world::create_block(builder, "test:stone");
+            for (auto& texture : stone.defaults.textureFaces) {
+                texture = "stone";
+            }
+            auto& grass = test_world::create_block(builder, "test:grass");
+            grass.defaults.textureFaces = {
+                "grass_side", "grass_side", "dirt",
+                "grass_top", "grass_side", "grass_side"};
+            auto& leaves = test_world::create_block(builder, "test:leaves");
+            leaves.lightPassing = true;
+            leaves.defaults.culling = CullingMode::OPTIONAL;
+            for (auto& texture : leaves.defaults.textureFaces) {
+                texture = "leaves";
+            }
+            auto& flower = test_world::create_block(builder, "test:flower");
+            flower.obstacle = false;
+            flower.lightPassing = true;
+            flower.defaults.model.type = BlockModelType::XSPRITE;
+            for (auto& texture : flower.defaults.textureFaces) {
+                texture = "flower";
+            }
+        });
+
+        assets.store(
+            std::make_unique<Atlas>(
+                std::make_unique<ImageData>(ImageFormat::rgba8888, 4, 4),
+                std::unordered_map<std::string, UVRegion> {
+                    {TEXTURE_NOTFOUND, UVRegion(0.0f, 0.0f, 0.25f, 0.25f)},
+                    {"stone", UVRegion(0.25f, 0.0f, 0.5f, 0.25f)},
+                    {"dirt", UVRegion(0.5f, 0.0f, 0.75f, 0.25f)},
+                    {"grass_top", UVRegion(0.75f, 0.0f, 1.0f, 0.25f)},
+                    {"grass_side", UVRegion(0.0f, 0.25f, 0.25f, 0.5f)},
+                    {"leaves", UVRegion(0.25f, 0.25f, 0.5f, 0.5f)},
+                    {"leaves_opaque", UVRegion(0.5f, 0.25f, 0.75f, 0.5f)},
+                    {"flower", UVRegion(0.75f, 0.25f, 1.0f, 0.5f)}},
+                false
+            ),
+            "blocks"
+        );
+        cache = std::make_unique<ContentGfxCache>(
+            *content, assets, settings.graphics
+        );
+
+        const auto& indices = *content->getIndices();
+        chunks = std::make_unique<Chunks>(
+            AREA_SIZE, AREA_SIZE, 0, 0, nullptr, indices
+        );
+        auto supplier = terrain(flat, foliage);
+        int ox = chunks->getOffsetX();
+        int oz = chunks->getOffsetY();
+        for (int cz = oz; cz < oz + AREA_SIZE; cz++) {
+            for (int cx = ox; cx < ox + AREA_SIZE; cx++) {
+                auto chunk = test_world::create_chunk(cx, cz, supplier, true);
+                Lighting::prebuildSkyLight(*chunk, indices);
+                chunks->putChunk(chunk);
+            }
+        }
+        Lighting lighting(indices, *chunks);
+        lighting.buildChunksLights({{ox + 1, oz + 1}});
+    }
+
+    test_world::BlockSupplier terrain(bool flat, bool foliage) const {
+        blockid_t stone = test_world::block_id(*content, "test:stone");
+        blockid_t grass = test_world::block_id(*content, "test:grass");
+        blockid_t leaves = test_world::block_id(*content, "test:leaves");
+        blockid_t flower = test_world::block_id(*content, "test:flower");
+        return [=](int x, int y, int z) -> blockid_t {
+            int height = flat ? 64 : 64 + static_cast<int>(
+                std::sin(x * 0.2) * 4 + std::cos(z * 0.15) * 4
+            );
+            if (y < height) {
+                return y == height - 1 ? grass : stone;
+            }
+            if (!foliage || y >= height + 4) {
+                return 0;
+            }
+            // leaves touching each other, the ground and the flowers
+            uint hash = test_world::voxel_hash(x, 0, z);
+            if ((hash >> (y - height)) % 3 == 0) {
+                return leaves;
+            } else if (y == height && hash % 5 == 0) {
+                return flower;
+            }
+            return 0;
+        };
+    }
+
+    ChunkMeshData buildMesh(
+        bool greedyMeshing,
+        bool compactVertices = false,
+        uint32_t sections = Chunk::ALL_SECTIONS
+    ) {
+        settings.graphics.greedyMeshing.set(greedyMeshing);
+        settings.graphics.compactVertices.set(compactVertices);
+        BlocksRenderer renderer(CAPACITY, *content, *cache, settings);
+        VoxelsVolume volume(
+            CHUNK_W + MESH_PADDING * 2, CHUNK_H, CHUNK_D + MESH_PADDING * 2
+        );
+        const auto& chunk = *chunks->getChunk(
+            chunks->getOffsetX() + 1, chunks->getOffsetY() + 1
+        );
+        volume.setPosition(
+            chunk.x * CHUNK_W - MESH_PADDING,
+            0,
+            chunk.z * CHUNK_D - MESH_PADDING
+        );
+        chunks->getVoxels(volume, false, chunk.top + 1);
+        renderer.build(&chunk, volume, sections);
+        EXPECT_FALSE(renderer.isCancelled());
+        return renderer.createMesh();
+    }
+};
+
+/// @brief Surface area of triangles by vertex normal and color
+using SurfaceArea = std::map<std::array<uint8_t, 8>, float>;
+
+static SurfaceArea surface_area(const ChunkMeshData& data) {
+    SurfaceArea area;
+    for (const auto& section : data.sections) {
+        const auto& mesh = section.mesh;
+        const auto& indices = mesh.indices.at(0);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            const auto& a = mesh.vertices[indices[i]];
+            const auto& b = mesh.vertices[indices[i + 1]];
+            const auto& c = mesh.vertices[indices[i + 2]];
+            std::array<uint8_t, 8> key {
+                a.normal[0], a.normal[1], a.normal[2], a.normal[3],
+                a.color[0], a.color[1], a.color[2], a.color[3]};
+            area[key] += glm::length(
+                glm::cross(b.position - a.position, c.position - a.position)
+            ) * 0.5f;
+        }
+    }
+    return area;
+}
+
+static size_t count_indices(const ChunkMeshData& data) {
+    size_t count = 0;
+    for (const auto& section : data.sections) {
+        count += section.mesh.indices.at(0).size();
+    }
+    return count;
+}
+
+/// @brief Index stream triangles count and order-independent digest
+struct StreamDigest {
+    size_t triangles;
+    uint64_t digest;
+};
+
+/// @brief Digest triangles of the index stream in all sections. Vertex
+/// attributes are quantized and triangles sorted, so vertices order does
+/// not matter
+static StreamDigest digest_stream(const ChunkMeshData& data, int stream) {
+    using Triangle = std::array<int32_t, 39>;
+    std::vector<Triangle> triangles;
+    for (const auto& section : data.sections) {
+        const auto& mesh = section.mesh;
+        const auto& indices = mesh.indices.at(stream);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            Triangle triangle {};
+            int n = 0;
+            for (size_t j = i; j < i + 3; j++) {
+                const auto& vertex = mesh.vertices[indices[j]];
+                for (int k = 0; k < 3; k++) {
+                    triangle[n++] = std::lround(vertex.position[k] * 256);
+                }
+                for (int k = 0; k < 2; k++) {
+                    triangle[n++] = std::lround(vertex.uv[k] * 4096);
+                }
+                for (int k = 0; k < 4; k++) {
+                    triangle[n++] = vertex.color[k];
+                    triangle[n++] = vertex.normal[k];
+                }
+            }
+            triangles.push_back(triangle);
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    // FNV-1a
+    uint64_t digest = 14695981039346656037ULL;
+    for (const auto& triangle : triangles) {
+        for (int32_t value : triangle) {
+            for (int i = 0; i < 4; i++) {
+                digest ^= static_cast<uint8_t>(value >> (i * 8));
+                digest *= 1099511628211ULL;
+            }
+        }
+    }
+    return StreamDigest {triangles.size(), digest};
+}
+
+static void expect_same_area(const SurfaceArea& expected, SurfaceArea actual) {
+    for (const auto& [key, value] : expected) {
+        EXPECT_NEAR(actual[key], value, 0.01f);
+    }
+    EXPECT_EQ(expected.size(), actual.size());
+}
+
+TEST(BlocksRenderer, GreedyMeshingFlatTerrain) {
+    MeshingScene scene(true);
+    auto plain = scene.buildMesh(false);
+    auto merged = scene.buildMesh(true);
+
+    // all top faces are merged into a single quad
+    EXPECT_EQ(count_indices(plain), CHUNK_W * CHUNK_D * 6);
+    EXPECT_EQ(count_indices(merged), 6);
+    expect_same_area(surface_area(plain), surface_area(merged));
+    // merged quads hold packed atlas region
+    const auto& mesh = merged.sections.at(63 / CHUNK_SECTION_H).mesh;
+    ASSERT_EQ(mesh.indices[0].size(), 6);
+    const auto& vertex = mesh.vertices[mesh.indices[0][0]];
+    EXPECT_LT(vertex.uv.x, 0.0f);
+    EXPECT_LT(vertex.uv.y, 0.0f);
+}
+
+TEST(BlocksRenderer, GreedyMeshingKeepsSurface) {
+    MeshingScene scene(false);
+    auto plain = scene.buildMesh(false);
+    auto merged = scene.buildMesh(true);
+
+    // faces with ambient occlusion gradients are not merged
+    EXPECT_LT(count_indices(merged), count_indices(plain));
+    expect_same_area(surface_area(plain), surface_area(merged));
+}
+
+TEST(BlocksRenderer, CompactVertexPacking) {
+    ChunkVertex vertex {
+        {15.5f, 255.5f, -0.5f}, {0.25f, 0.75f}, {10, 20, 30, 255},
+        {128, 1, 128, 255}};
+    auto unpacked = CompactChunkVertex::pack(vertex).unpack();
+    EXPECT_EQ(unpacked.position, vertex.position);
+    EXPECT_NEAR(unpacked.uv.x, vertex.uv.x, 1.0f / 65535);
+    EXPECT_NEAR(unpacked.uv.y, vertex.uv.y, 1.0f / 65535);
+    EXPECT_EQ(unpacked.color, vertex.color);
+    EXPECT_EQ(unpacked.normal, vertex.normal);
+
+    // custom models normals and positions are quantized
+    vertex.position = {3.1234f, 70.9876f, 8.5555f};
+    vertex.normal = {
+        static_cast<uint8_t>(0.48f * 127 + 128),
+        static_cast<uint8_t>(-0.6f * 127 + 128),
+        static_cast<uint8_t>(-0.64f * 127 + 128),
+        100};
+    unpacked = CompactChunkVertex::pack(vertex).unpack();
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(
+            unpacked.position[i],
+            vertex.position[i],
+            0.5f / CompactChunkVertex::POSITION_SCALE
+        );
+        EXPECT_NEAR(unpacked.normal[i], vertex.normal[i], 6);
+    }
+    EXPECT_NEAR(unpacked.normal[3], vertex.normal[3], 255 / 15);
+}
+
+TEST(BlocksRenderer, CompactVerticesMesh) {
+    MeshingScene scene(false);
+    auto full = scene.buildMesh(false);
+    // greedy meshing is not available for the compact format
+    auto compact = scene.buildMesh(true, true);
+    EXPECT_EQ(sizeof(CompactChunkVertex), 16);
+    EXPECT_EQ(sizeof(ChunkVertex), 28);
+
+    ASSERT_EQ(compact.sections.size(), full.sections.size());
+    size_t fullSize = 0;
+    size_t compactSize = 0;
+    for (size_t s = 0; s < full.sections.size(); s++) {
+        const auto& mesh = full.sections[s].mesh;
+        const auto& compactMesh = compact.sections[s].compactMesh;
+        const auto& vertices = mesh.vertices;
+        const auto& packed = compactMesh.vertices;
+        EXPECT_EQ(compact.sections[s].mesh.vertices.size(), 0);
+        ASSERT_EQ(packed.size(), vertices.size());
+        for (int i = 0; i < 2; i++) {
+            const auto& expected = mesh.indices[i];
+            const auto& indices = compactMesh.indices[i];
+            ASSERT_EQ(indices.size(), expected.size());
+            EXPECT_TRUE(std::equal(
+                indices.data(), indices.data() + indices.size(), expected.data()
+            ));
+        }
+        for (size_t i = 0; i < vertices.size(); i++) {
+            auto vertex = packed[i].unpack();
+            EXPECT_EQ(vertex.position, vertices[i].position);
+            EXPECT_EQ(vertex.normal, vertices[i].normal);
+            EXPECT_EQ(vertex.color, vertices[i].color);
+        }
+        fullSize += vertices.size() * sizeof(ChunkVertex);
+        compactSize += packed.size() * sizeof(CompactChunkVertex);
+    }
+    EXPECT_GT(fullSize, 0);
+    EXPECT_LT(compactSize, fullSize * 0.6);
+}
+
+TEST(BlocksRenderer, PartialRemesh) {
+    MeshingScene scene(false);
+    auto full = scene.buildMesh(false);
+    ASSERT_EQ(full.sections.size(), CHUNK_SECTIONS);
+
+    // the surface crosses the section
+    int index = 64 / CHUNK_SECTION_H;
+    auto partial = scene.buildMesh(false, false, 1U << index);
+    ASSERT_EQ(partial.sections.size(), 1);
+    const auto& expected = full.sections[index].mesh;
+    const auto& actual = partial.sections[0].mesh;
+    EXPECT_EQ(partial.sections[0].index, index);
+    ASSERT_GT(expected.vertices.size(), 0);
+    ASSERT_EQ(actual.vertices.size(), expected.vertices.size());
+    EXPECT_EQ(
+        std::memcmp(
+            actual.vertices.data(),
+            expected.vertices.data(),
+            expected.vertices.size() * sizeof(ChunkVertex)
+        ),
+        0
+    );
+    ASSERT_EQ(actual.indices[0].size(), expected.indices[0].size());
+}
+
+TEST(BlocksRenderer, SectionsVisibilityData) {
+    MeshingScene scene(false);
+    auto mesh = scene.buildMesh(false);
+    ASSERT_EQ(mesh.sections.size(), CHUNK_SECTIONS);
+
+    // the underground is solid stone, the sky is empty
+    const auto& underground = mesh.sections[1];
+    const auto& sky = mesh.sections[CHUNK_SECTIONS - 1];
+    EXPECT_FALSE(underground.connectivity.isConnected(0, 1));
+    EXPECT_EQ(sky.connectivity, SectionConnectivity::open());
+    EXPECT_EQ(sky.mesh.vertices.size(), 0);
+
+    for (const auto& section : mesh.sections) {
+        if (section.mesh.vertices.size() == 0) {
+            continue;
+        }
+        // cube faces are within the section bounds
+        float bottom = section.index * CHUNK_SECTION_H - 0.5f;
+        EXPECT_GE(section.min.y, bottom);
+        EXPECT_LE(section.max.y, bottom + CHUNK_SECTION_H);
+        EXPECT_GE(section.min.x, -0.5f);
+        EXPECT_LE(section.max.x, CHUNK_W - 0.5f);
+    }
+}
+
+TEST(BlocksRenderer, SinglePassMatchesTwoPass) {
+    MeshingScene scene(false, true);
+    // captured from the former two-pass meshing: opaque blocks were meshed
+    // first, then optional culling blocks were meshed once more for each
+    // stream with the shared indices copied into the dense stream
+    struct {
+        bool greedy;
+        StreamDigest normal;
+        StreamDigest dense;
+    } expected[] {
+        {false,
+         {3350, 0x1c1470645390ccb0ULL},
+         {4946, 0x29467b06e0da3a49ULL}},
+        {true,
+         {3306, 0xbfb54014f28f5a1aULL},
+         {4946, 0x29467b06e0da3a49ULL}},
+    };
+    for (const auto& [greedy, normal, dense] : expected) {
+        auto mesh = scene.buildMesh(greedy);
+        auto normalDigest = digest_stream(mesh, 0);
+        auto denseDigest = digest_stream(mesh, 1);
+        EXPECT_EQ(normalDigest.triangles, normal.triangles) << greedy;
+        EXPECT_EQ(normalDigest.digest, normal.digest) << greedy;
+        EXPECT_EQ(denseDigest.triangles, dense.triangles) << greedy;
+        EXPECT_EQ(denseDigest.digest, dense.digest) << greedy;
+    }
+}
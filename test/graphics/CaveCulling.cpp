@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "graphics/render/CaveCulling.hpp"
+
+static constexpr int SECTION_VOLUME = SectionConnectivity::SECTION_VOLUME;
+static constexpr uint32_t ALL_SECTIONS = (1ULL << CHUNK_SECTIONS) - 1;
+
+TEST(CaveCulling, SectionConnectivity) {
+    std::array<bool, SECTION_VOLUME> occluders {};
+    EXPECT_EQ(
+        SectionConnectivity::compute(occluders.data()),
+        SectionConnectivity::open()
+    );
+
+    occluders.fill(true);
+    auto closed = SectionConnectivity::compute(occluders.data());
+    for (int a = 0; a < SectionConnectivity::FACES; a++) {
+        for (int b = 0; b < SectionConnectivity::FACES; b++) {
+            EXPECT_FALSE(closed.isConnected(a, b));
+        }
+    }
+
+    // horizontal floor splits the section
+    occluders.fill(false);
+    for (int i = 0; i < CHUNK_W * CHUNK_D; i++) {
+        occluders[vox_index(0, 8, 0) + i] = true;
+    }
+    auto split = SectionConnectivity::compute(occluders.data());
+    EXPECT_FALSE(split.isConnected(2, 3));
+    EXPECT_FALSE(split.isConnected(3, 2));
+    EXPECT_TRUE(split.isConnected(0, 1));
+    EXPECT_TRUE(split.isConnected(2, 4));
+    EXPECT_TRUE(split.isConnected(3, 5));
+
+    // a hole in the floor
+    occluders[vox_index(5, 8, 5)] = false;
+    EXPECT_EQ(
+        SectionConnectivity::compute(occluders.data()),
+        SectionConnectivity::open()
+    );
+}
+
+TEST(CaveCulling, HiddenSections) {
+    const int width = 3;
+    SectionsConnectivity open;
+    SectionsConnectivity closed;
+    open.fill(SectionConnectivity::open());
+
+    CaveCulling culling;
+    glm::vec3 camera(8.0f, 70.0f, 8.0f);
+    std::vector<const SectionsConnectivity*> graphs {&open, &open, &open};
+    culling.update(camera, width, 1, 0, 0, graphs, nullptr);
+    for (int i = 0; i < width; i++) {
+        EXPECT_EQ(culling.getVisibleSections(i), ALL_SECTIONS);
+    }
+
+    // chunks behind a solid chunk are hidden, the solid chunk sections
+    // are entered from outside so are visible
+    graphs[1] = &closed;
+    culling.update(camera, width, 1, 0, 0, graphs, nullptr);
+    EXPECT_EQ(culling.getVisibleSections(0), ALL_SECTIONS);
+    EXPECT_EQ(culling.getVisibleSections(1), ALL_SECTIONS);
+    EXPECT_EQ(culling.getVisibleSections(2), 0);
+
+    // not meshed chunks do not hide anything
+    graphs[1] = nullptr;
+    culling.update(camera, width, 1, 0, 0, graphs, nullptr);
+    EXPECT_EQ(culling.getVisibleSections(2), ALL_SECTIONS);
+
+    // camera out of the area
+    graphs[1] = &closed;
+    culling.update({-8.0f, 70.0f, 8.0f}, width, 1, 0, 0, graphs, nullptr);
+    EXPECT_EQ(culling.getVisibleSections(2), ALL_SECTIONS);
+}
+
+TEST(CaveCulling, UndergroundCamera) {
+    SectionsConnectivity chunk;
+    chunk.fill(SectionConnectivity::open());
+    // solid ground below the surface section
+    int surface = 4;
+    for (int i = 0; i < surface; i++) {
+        chunk[i] = {};
+    }
+    std::vector<const SectionsConnectivity*> graphs(9, &chunk);
+
+    CaveCulling culling;
+    culling.update({24.0f, 100.0f, 24.0f}, 3, 3, 0, 0, graphs, nullptr);
+    // only the top layer of the underground is seen from the surface
+    uint32_t expected = ALL_SECTIONS & ~((1U << (surface - 1)) - 1);
+    for (int i = 0; i < 9; i++) {
+        EXPECT_EQ(culling.getVisibleSections(i), expected);
+    }
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "graphics/render/ChunksDrawList.hpp"
+
+TEST(ChunksDrawList, Commands) {
+    ChunksDrawList list;
+    glm::vec3 first(0.5f, 0.5f, 16.5f);
+    glm::vec3 second(16.5f, 0.5f, 16.5f);
+    list.add(first, 36, 0, 0);
+    list.add(first, 0, 36, 24);
+    list.add(first, 12, 36, 24);
+    list.add(second, 6, 48, 32);
+
+    const auto& commands = list.getCommands();
+    ASSERT_EQ(commands.size(), 3);
+    for (uint32_t i = 0; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].instanceCount, 1);
+        // offset of the command is taken from the offsets buffer
+        EXPECT_EQ(commands[i].baseInstance, i);
+        EXPECT_EQ(list.getOffsets().at(i), i < 2 ? first : second);
+    }
+    EXPECT_EQ(commands[1].count, 12);
+    EXPECT_EQ(commands[1].firstIndex, 36);
+    EXPECT_EQ(commands[1].baseVertex, 24);
+
+    const auto& batches = list.getBatches();
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0].offset, first);
+    EXPECT_EQ(batches[0].first, 0);
+    EXPECT_EQ(batches[0].count, 2);
+    EXPECT_EQ(batches[1].first, 2);
+    EXPECT_EQ(batches[1].count, 1);
+
+    EXPECT_EQ(sizeof(DrawElementsIndirectCommand), 20);
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_TRUE(list.getBatches().empty());
+}
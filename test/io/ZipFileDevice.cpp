@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "coders/byte_utils.hpp"
+#include "io/devices/ZipFileDevice.hpp"
+#include "io/memory_istream.hpp"
+
+static constexpr int COMPRESSION_NONE = 0;
+static constexpr int COMPRESSION_DEFLATE = 8;
+
+static std::vector<ubyte> deflate_raw(const std::string& text) {
+    z_stream stream {};
+    deflateInit2(
+        &stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+        Z_DEFAULT_STRATEGY
+    );
+    std::vector<ubyte> dst(deflateBound(&stream, text.size()));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = text.size();
+    stream.next_out = dst.data();
+    stream.avail_out = dst.size();
+    deflate(&stream, Z_FINISH);
+    dst.resize(stream.total_out);
+    deflateEnd(&stream);
+    return dst;
+}
+
+/// @brief Build ZIP file with the given entries (name, content, method)
+static std::vector<ubyte> build_zip(
+    const std::vector<std::tuple<std::string, std::string, int>>& files
+) {
+    ByteBuilder data;
+    ByteBuilder centralDir;
+    for (const auto& [name, content, method] : files) {
+        auto bytes = method == COMPRESSION_DEFLATE
+                         ? deflate_raw(content)
+                         : std::vector<ubyte>(content.begin(), content.end());
+        uint32_t crc = crc32(
+            0, reinterpret_cast<const Bytef*>(content.data()), content.size()
+        );
+        size_t offset = data.size();
+        data.putInt32(0x04034b50);
+        data.putInt16(10);
+        data.putInt16(0);
+        data.putInt16(method);
+        data.putInt32(0);
+        data.putInt32(crc);
+        data.putInt32(bytes.size());
+        data.putInt32(content.size());
+        data.putInt16(name.length());
+        data.putInt16(0);
+        data.put(reinterpret_cast<const ubyte*>(name.data()), name.length());
+        data.put(bytes.data(), bytes.size());
+
+        centralDir.putInt32(0x02014b50);
+        centralDir.putInt16(10);
+        centralDir.putInt16(10);
+        centralDir.putInt16(0);
+        centralDir.putInt16(method);
+        centralDir.putInt32(0);
+        centralDir.putInt32(crc);
+        centralDir.putInt32(bytes.size());
+        centralDir.putInt32(content.size());
+        centralDir.putInt16(name.length());
+        centralDir.putInt16(0);
+        centralDir.putInt16(0);
+        centralDir.putInt16(0);
+        centralDir.putInt16(0);
+        centralDir.putInt32(0);
+        centralDir.putInt32(offset);
+        centralDir.put(
+            reinterpret_cast<const ubyte*>(name.data()), name.length()
+        );
+    }
+    size_t centralDirOffset = data.size();
+    data.put(centralDir.data(), centralDir.size());
+    data.putInt32(0x06054b50);
+    data.putInt16(0);
+    data.putInt16(0);
+    data.putInt16(files.size());
+    data.putInt16(files.size());
+    data.putInt32(centralDir.size());
+    data.putInt32(centralDirOffset);
+    data.putInt16(0);
+    return data.build();
+}
+
+static std::vector<std::string> list(io::Device& device, const char* path) {
+    std::vector<std::string> names;
+    auto generator = device.list(path);
+    io::path name;
+    while (generator->next(name)) {
+        names.push_back(name.string());
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static std::string read_text(io::Device& device, const char* path) {
+    auto stream = device.read(path);
+    std::string text(device.size(path), '\0');
+    stream->read(text.data(), text.size());
+    EXPECT_TRUE(stream->good());
+    return text;
+}
+
+TEST(ZipFileDevice, ReadEntries) {
+    std::string stored = "stored entry content";
+    std::string deflated;
+    for (int i = 0; i < 1000; i++) {
+        deflated += "deflated entry line " + std::to_string(i) + "\n";
+    }
+    auto zip = build_zip({
+        {"readme.txt", stored, COMPRESSION_NONE},
+        {"data/lines.txt", deflated, COMPRESSION_DEFLATE},
+        {"data/sub/empty.txt", "", COMPRESSION_DEFLATE},
+    });
+
+    auto mapped = std::make_shared<io::MappedFile>(
+        util::Buffer<ubyte>(zip.data(), zip.size())
+    );
+    io::ZipFileDevice mappedDevice(mapped);
+    io::ZipFileDevice streamDevice(std::make_unique<span_istream>(
+        reinterpret_cast<const char*>(zip.data()), zip.size()
+    ));
+    for (io::Device* device : {
+             static_cast<io::Device*>(&mappedDevice),
+             static_cast<io::Device*>(&streamDevice)
+         }) {
+        EXPECT_EQ(read_text(*device, "readme.txt"), stored);
+        EXPECT_EQ(read_text(*device, "data/lines.txt"), deflated);
+        EXPECT_EQ(device->size("data/sub/empty.txt"), 0);
+
+        auto file = device->map("data/lines.txt");
+        ASSERT_EQ(file->size(), deflated.size());
+        EXPECT_EQ(
+            std::string(reinterpret_cast<const char*>(file->data()), file->size()),
+            deflated
+        );
+
+        EXPECT_TRUE(device->isdir("data"));
+        EXPECT_TRUE(device->isdir("data/sub"));
+        EXPECT_TRUE(device->isfile("data/lines.txt"));
+        EXPECT_EQ(
+            list(*device, ""), (std::vector<std::string> {"data", "readme.txt"})
+        );
+        EXPECT_EQ(
+            list(*device, "data"), (std::vector<std::string> {"lines.txt", "sub"})
+        );
+        EXPECT_TRUE(list(*device, "readme.txt").empty());
+        EXPECT_THROW(device->read("missing.txt"), std::runtime_error);
+        EXPECT_THROW(device->read("data"), std::runtime_error);
+    }
+
+    // stored entries are not copied
+    auto file = mappedDevice.map("readme.txt");
+    ASSERT_EQ(file->size(), stored.size());
+    EXPECT_GE(file->data(), mapped->data());
+    EXPECT_LT(file->data(), mapped->data() + mapped->size());
+}
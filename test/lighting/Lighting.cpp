@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "lighting/Lighting.hpp"
+#include "test_world.hpp"
+#include "voxels/Chunks.hpp"
+
+static constexpr int AREA_SIZE = 8;
+
+struct LightingScene {
+    std::unique_ptr<Content> content;
+    std::unique_ptr<Chunks> chunks;
+    blockid_t stone;
+    blockid_t glass;
+    blockid_t torch;
+
+    LightingScene() : LightingScene(AREA_SIZE) {
+        fill(terrain());
+    }
+
+    /// @brief Create scene having no chunks
+    explicit LightingScene(int size) {
+        content = test_world::build_content([](auto& builder) {
+            test_world::create_block(builder, "test:stone");
+            test_world::create_block(builder, "test:glass").lightPassing =
+                true;
+            auto& torch = test_world::create_block(builder, "test:torch");
+            torch.lightPassing = torch.skyLightPassing = true;
+            torch.emission[0] = 13;
+            torch.emission[1] = 9;
+            torch.emission[2] = 4;
+        });
+        stone = test_world::block_id(*content, "test:stone");
+        glass = test_world::block_id(*content, "test:glass");
+        torch = test_world::block_id(*content, "test:torch");
+        chunks = std::make_unique<Chunks>(
+            size, size, 0, 0, nullptr, *content->getIndices()
+        );
+    }
+
+    void fill(const test_world::BlockSupplier& supplier) {
+        int size = chunks->getWidth();
+        int ox = chunks->getOffsetX();
+        int oz = chunks->getOffsetY();
+        for (int cz = oz; cz < oz + size; cz++) {
+            for (int cx = ox; cx < ox + size; cx++) {
+                auto chunk = test_world::create_chunk(cx, cz, supplier, true);
+                Lighting::prebuildSkyLight(*chunk, *content->getIndices());
+                chunks->putChunk(chunk);
+            }
+        }
+    }
+
+    test_world::BlockSupplier terrain() const {
+        return [=](int x, int y, int z) -> blockid_t {
+            int height = 60 + static_cast<int>(
+                std::sin(x * 0.1) * 10 + std::cos(z * 0.07) * 8
+            );
+            blockid_t id = y < height ? stone : 0;
+            uint hash = test_world::voxel_hash(x, y, z);
+            if (id && y > 30 && std::sin(x * 0.2 + y * 0.3) > 0.7) {
+                id = 0;
+            }
+            if (id && hash % 97 == 0) {
+                return glass;
+            } else if (!id && hash % 1511 == 0) {
+                return torch;
+            }
+            return id;
+        };
+    }
+
+    /// @brief Positions of chunks having all neighbours, nearest first
+    std::vector<glm::ivec2> getInnerChunks() const {
+        std::vector<glm::ivec2> positions;
+        int ox = chunks->getOffsetX();
+        int oz = chunks->getOffsetY();
+        for (int cz = oz + 1; cz < oz + AREA_SIZE - 1; cz++) {
+            for (int cx = ox + 1; cx < ox + AREA_SIZE - 1; cx++) {
+                positions.emplace_back(cx, cz);
+            }
+        }
+        return positions;
+    }
+};
+
+TEST(Lighting, BatchedEqualsSequential) {
+    LightingScene expected;
+    {
+        Lighting lighting(*expected.content->getIndices(), *expected.chunks);
+        for (const auto& pos : expected.getInnerChunks()) {
+            lighting.buildSkyLight(pos.x, pos.y);
+            lighting.onChunkLoaded(pos.x, pos.y, true);
+        }
+    }
+    LightingScene actual;
+    {
+        Lighting lighting(*actual.content->getIndices(), *actual.chunks, 3);
+        lighting.buildChunksLights(actual.getInnerChunks());
+    }
+    const auto& expectedChunks = expected.chunks->getChunks();
+    const auto& actualChunks = actual.chunks->getChunks();
+    ASSERT_EQ(expectedChunks.size(), actualChunks.size());
+    for (size_t i = 0; i < expectedChunks.size(); i++) {
+        const auto& a = *expectedChunks[i];
+        const auto& b = *actualChunks[i];
+        EXPECT_EQ(a.flags.modified, b.flags.modified);
+        EXPECT_EQ(
+            std::memcmp(
+                a.lightmap->getLights(),
+                b.lightmap->getLights(),
+                sizeof(Lightmap::map)
+            ),
+            0
+        );
+    }
+}
+
+TEST(Lighting, SpreadsTorchLight) {
+    constexpr int CAVE_RADIUS = 5;
+    LightingScene scene(3);
+    int ox = scene.chunks->getOffsetX();
+    int oz = scene.chunks->getOffsetY();
+    // closed cave crossing the chunk border
+    glm::ivec3 torch((ox + 1) * CHUNK_W + 1, 50, (oz + 1) * CHUNK_D + 8);
+    scene.fill([&scene, torch](int x, int y, int z) -> blockid_t {
+        glm::ivec3 offset = glm::abs(glm::ivec3(x, y, z) - torch);
+        if (offset == glm::ivec3(0)) {
+            return scene.torch;
+        } else if (std::max({offset.x, offset.y, offset.z}) <= CAVE_RADIUS) {
+            return 0;
+        }
+        return y < 100 ? scene.stone : 0;
+    });
+    Lighting lighting(*scene.content->getIndices(), *scene.chunks);
+    lighting.buildChunksLights({{ox + 1, oz + 1}});
+
+    // light decreases by one per block of the shortest path, walls and
+    // the sky light do not get into the cave
+    const auto& emission = scene.content->blocks.require("test:torch").emission;
+    int radius = CAVE_RADIUS + 1;
+    for (int y = -radius; y <= radius; y++) {
+        for (int z = -radius; z <= radius; z++) {
+            for (int x = -radius; x <= radius; x++) {
+                glm::ivec3 pos = torch + glm::ivec3(x, y, z);
+                bool cave = std::max({std::abs(x), std::abs(y), std::abs(z)}) <=
+                            CAVE_RADIUS;
+                int distance = std::abs(x) + std::abs(y) + std::abs(z);
+                for (int channel = 0; channel < 3; channel++) {
+                    int expected =
+                        cave ? std::max(0, emission[channel] - distance) : 0;
+                    EXPECT_EQ(
+                        scene.chunks->getLight(pos.x, pos.y, pos.z, channel),
+                        expected
+                    ) << x << " " << y << " " << z << " " << channel;
+                }
+                EXPECT_EQ(scene.chunks->getLight(pos.x, pos.y, pos.z, 3), 0);
+            }
+        }
+    }
+}
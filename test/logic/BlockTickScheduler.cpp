@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "logic/BlockTickScheduler.hpp"
+#include "test_world.hpp"
+#include "voxels/blocks_agent.hpp"
+
+using blocks_agent::BlockRegisterEvent;
+
+static constexpr uint8_t TICKING =
+    BlockRegisterEvent::REGISTER_BIT | BlockRegisterEvent::UPDATING_BIT;
+
+struct TickScene {
+    std::unique_ptr<Content> content;
+    blockid_t pipe;
+    blockid_t lamp;
+
+    TickScene() {
+        content = test_world::build_content([](auto& builder) {
+            test_world::create_block(builder, "test:pipe").tickInterval = 2;
+            test_world::create_block(builder, "test:lamp");
+        });
+        pipe = test_world::block_id(*content, "test:pipe");
+        lamp = test_world::block_id(*content, "test:lamp");
+    }
+};
+
+static std::multiset<std::tuple<int, int, int>> collect(
+    BlockTickScheduler& scheduler, float delta, int frames
+) {
+    std::multiset<std::tuple<int, int, int>> ticked;
+    for (int i = 0; i < frames; i++) {
+        for (const auto& batch : scheduler.update(delta)) {
+            EXPECT_EQ(batch.type, BlockEventType::tick);
+            for (const auto& pos : batch.positions) {
+                ticked.emplace(pos.x, pos.y, pos.z);
+            }
+        }
+    }
+    return ticked;
+}
+
+TEST(BlockTickScheduler, TicksEveryBlock) {
+    TickScene scene;
+    BlockTickScheduler scheduler(*scene.content->getIndices());
+    std::vector<BlockRegisterEvent> events;
+    for (int i = 0; i < 100; i++) {
+        events.push_back({TICKING, scene.pipe, {i * 3 - 150, 10, i}});
+    }
+    EXPECT_EQ(scheduler.process(events).size(), 0);
+    EXPECT_EQ(scheduler.countUpdating(), 100);
+
+    // tick interval 2 is 10 ticks per second
+    auto ticked = collect(scheduler, 0.01f, 10);
+    EXPECT_GE(ticked.size(), 99);
+    EXPECT_LE(ticked.size(), 100);
+    ticked.merge(collect(scheduler, 0.01f, 1));
+    EXPECT_EQ(std::set(ticked.begin(), ticked.end()).size(), 100);
+    for (const auto& batch : scheduler.update(0.01f)) {
+        EXPECT_FLOAT_EQ(batch.tps, 10.0f);
+    }
+}
+
+TEST(BlockTickScheduler, RemovesBlocksAndChunks) {
+    TickScene scene;
+    BlockTickScheduler scheduler(*scene.content->getIndices());
+    std::vector<BlockRegisterEvent> events;
+    for (int x = -32; x < 32; x++) {
+        events.push_back({TICKING, scene.lamp, {x, 0, 0}});
+    }
+    scheduler.process(events);
+    EXPECT_EQ(scheduler.countUpdating(), 64);
+
+    events = {
+        {BlockRegisterEvent::UPDATING_BIT, scene.lamp, {5, 0, 0}},
+        {BlockRegisterEvent::CHUNK_REMOVED_BIT, 0, {-2, 0, 0}},
+        {BlockRegisterEvent::REMOVED_EVENT_BIT, scene.lamp, {-20, 0, 0}},
+        {BlockRegisterEvent::REMOVED_EVENT_BIT, scene.lamp, {-21, 0, 0}},
+    };
+    auto removed = scheduler.process(events);
+    ASSERT_EQ(removed.size(), 1);
+    EXPECT_EQ(removed[0].type, BlockEventType::removed);
+    EXPECT_EQ(removed[0].positions.size(), 2);
+    EXPECT_EQ(scheduler.countUpdating(), 64 - 1 - CHUNK_W);
+
+    auto ticked = collect(scheduler, 0.05f, 1);
+    EXPECT_EQ(ticked.size(), 64 - 1 - CHUNK_W);
+    EXPECT_EQ(ticked.count({5, 0, 0}), 0);
+    EXPECT_EQ(ticked.count({-20, 0, 0}), 0);
+}
+
+TEST(BlockTickScheduler, PresentBeforeTicks) {
+    TickScene scene;
+    BlockTickScheduler scheduler(*scene.content->getIndices());
+    uint8_t bits = TICKING | BlockRegisterEvent::PRESENT_EVENT_BIT;
+    scheduler.process(
+        {{bits, scene.lamp, {1, 2, 3}}, {bits, scene.lamp, {4, 5, 6}}}
+    );
+    EXPECT_EQ(scheduler.countUpdating(), 0);
+
+    auto batches = scheduler.update(0.05f);
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0].type, BlockEventType::present);
+    EXPECT_EQ(batches[0].positions.size(), 2);
+    EXPECT_EQ(scheduler.countUpdating(), 2);
+    EXPECT_EQ(collect(scheduler, 0.05f, 1).size(), 2);
+}
+
+TEST(BlockTickScheduler, RemovesIndexedPositions) {
+    TickScene scene;
+    BlockTickScheduler scheduler(*scene.content->getIndices());
+    std::vector<BlockRegisterEvent> events;
+    for (int y = 0; y < 100; y++) {
+        events.push_back({TICKING, scene.lamp, {1, y, 2}});
+    }
+    // registered twice
+    events.push_back({TICKING, scene.lamp, {1, 50, 2}});
+    scheduler.process(events);
+    EXPECT_EQ(scheduler.countUpdating(), 100);
+
+    // removed positions are swapped with the last ones
+    events.clear();
+    for (int y = 0; y < 100; y += 2) {
+        events.push_back(
+            {BlockRegisterEvent::UPDATING_BIT, scene.lamp, {1, y, 2}}
+        );
+    }
+    scheduler.process(events);
+    EXPECT_EQ(scheduler.countUpdating(), 50);
+
+    auto ticked = collect(scheduler, 0.05f, 1);
+    ASSERT_EQ(ticked.size(), 50);
+    for (int y = 1; y < 100; y += 2) {
+        EXPECT_EQ(ticked.count({1, y, 2}), 1);
+    }
+}
+
+TEST(BlockPositions, RemovesDuringIteration) {
+    BlockPositions positions;
+    for (int x = 0; x < 48; x++) {
+        positions.add({x, 0, 0});
+    }
+    // whole first chunk and a part of the second one are visited
+    std::vector<glm::ivec3> visited;
+    positions.next(20, visited);
+    ASSERT_EQ(visited.size(), 20);
+
+    // visited and pending positions of the current chunk
+    EXPECT_TRUE(positions.remove({17, 0, 0}));
+    EXPECT_TRUE(positions.remove({25, 0, 0}));
+    // visited chunk
+    EXPECT_EQ(positions.removeChunk(0, 0), CHUNK_W);
+    ASSERT_EQ(positions.size(), 30);
+
+    // the rest of the cycle is not skipped or repeated
+    std::vector<glm::ivec3> rest;
+    positions.next(27, rest);
+    std::set<std::tuple<int, int, int>> pending;
+    for (const auto& pos : rest) {
+        pending.emplace(pos.x, pos.y, pos.z);
+    }
+    ASSERT_EQ(pending.size(), 27);
+    for (int x = 20; x < 48; x++) {
+        EXPECT_EQ(pending.count({x, 0, 0}), x != 25) << x;
+    }
+
+    // the next cycle starts with the visited positions
+    rest.clear();
+    positions.next(3, rest);
+    std::set<int> next;
+    for (const auto& pos : rest) {
+        next.insert(pos.x);
+    }
+    EXPECT_EQ(next, (std::set<int> {16, 18, 19}));
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "logic/ChunksLoadQueue.hpp"
+
+TEST(ChunksLoadQueue, SortedByDistance) {
+    ChunksLoadQueue queue;
+    EXPECT_TRUE(queue.update(10, 10, 2, 0, 0));
+    EXPECT_EQ(queue.size(), 6 * 6);
+    EXPECT_EQ(queue[0].x, 5);
+    EXPECT_EQ(queue[0].z, 5);
+    EXPECT_EQ(queue[0].distance, 0);
+    for (size_t i = 1; i < queue.size(); i++) {
+        EXPECT_LE(queue[i - 1].distance, queue[i].distance);
+        EXPECT_GE(queue[i].x, 2);
+        EXPECT_LT(queue[i].x, 8);
+        EXPECT_GE(queue[i].z, 2);
+        EXPECT_LT(queue[i].z, 8);
+    }
+}
+
+TEST(ChunksLoadQueue, ResetOnMove) {
+    ChunksLoadQueue queue;
+    queue.update(8, 8, 1, 0, 0);
+    queue.setCursor(10);
+    EXPECT_FALSE(queue.update(8, 8, 1, 0, 0));
+    EXPECT_EQ(queue.getCursor(), 10);
+
+    EXPECT_TRUE(queue.update(8, 8, 1, 1, 0));
+    EXPECT_EQ(queue.getCursor(), 0);
+
+    queue.setCursor(5);
+    EXPECT_TRUE(queue.update(12, 12, 1, 1, 0));
+    EXPECT_EQ(queue.getCursor(), 0);
+    EXPECT_EQ(queue.size(), 10 * 10);
+}
+
+TEST(ChunksLoadQueue, LoadingCircleEdge) {
+    ChunksLoadQueue queue;
+    queue.update(10, 10, 1, 0, 0);
+    EXPECT_EQ(queue.getLoadingDistance(), 16);
+    for (size_t i = 0; i < queue.size(); i++) {
+        const auto& entry = queue[i];
+        bool inner = true;
+        for (int oz = -1; oz <= 1; oz++) {
+            for (int ox = -1; ox <= 1; ox++) {
+                int lx = entry.x + ox - 5;
+                int lz = entry.z + oz - 5;
+                inner &= lx * lx + lz * lz < queue.getLoadingDistance();
+            }
+        }
+        EXPECT_EQ(entry.surroundable, inner);
+    }
+    EXPECT_TRUE(queue[0].surroundable);
+    EXPECT_FALSE(queue[queue.size() - 1].surroundable);
+}
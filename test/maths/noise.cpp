@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "maths/FastNoiseLite.h"
+#include "maths/noise.hpp"
+
+static void test_rows(fnl_state& state, float scale) {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-scale, scale);
+
+    // not a multiple of vector width to cover the remainder
+    const size_t count = 1003;
+    std::vector<float> xs(count);
+    std::vector<float> ys(count);
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = distribution(random);
+        ys[i] = distribution(random);
+    }
+    // grid points to cover floor of negative integers
+    for (size_t i = 0; i < 64; i++) {
+        xs[i] = static_cast<int>(i % 8) - 4;
+        ys[i] = static_cast<int>(i / 8) - 4;
+    }
+    std::vector<float> values(count);
+    noise::get_noise_2d(state, xs.data(), ys.data(), values.data(), count);
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_NEAR(values[i], fnlGetNoise2D(&state, xs[i], ys[i]), 1e-5f)
+            << "at " << xs[i] << ", " << ys[i];
+    }
+}
+
+TEST(noise, OpenSimplex2Rows) {
+    fnl_state state = fnlCreateState();
+    state.noise_type = FNL_NOISE_OPENSIMPLEX2;
+    for (int seed : {1337, -7, 0x7fffffff}) {
+        state.seed = seed;
+        test_rows(state, 10000.0f);
+        test_rows(state, 100.0f);
+    }
+}
+
+TEST(noise, ScalarFallbackRows) {
+    fnl_state state = fnlCreateState();
+    state.noise_type = FNL_NOISE_CELLULAR;
+    test_rows(state, 1000.0f);
+
+    state.noise_type = FNL_NOISE_OPENSIMPLEX2;
+    state.fractal_type = FNL_FRACTAL_FBM;
+    test_rows(state, 1000.0f);
+}
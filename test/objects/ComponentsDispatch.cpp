@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "objects/ComponentsDispatch.hpp"
+
+static std::vector<entityid_t> get_uids(
+    const ComponentsDispatch& dispatch, const std::string& component
+) {
+    std::vector<entityid_t> uids;
+    for (const auto& group : dispatch.getGroups()) {
+        if (group.component != component) {
+            continue;
+        }
+        for (const auto& entry : group.entries) {
+            uids.push_back(entry.uid);
+        }
+    }
+    std::sort(uids.begin(), uids.end());
+    return uids;
+}
+
+TEST(ComponentsDispatch, Grouping) {
+    ComponentsDispatch dispatch;
+    dispatch.add(1, "base:drop", nullptr);
+    dispatch.add(2, "base:mob", nullptr);
+    dispatch.add(3, "base:drop", nullptr);
+    dispatch.add(3, "base:mob", nullptr);
+
+    EXPECT_EQ(dispatch.size(), 4);
+    ASSERT_EQ(dispatch.getGroups().size(), 2);
+    using uids = std::vector<entityid_t>;
+    EXPECT_EQ(get_uids(dispatch, "base:drop"), (uids {1, 3}));
+    EXPECT_EQ(get_uids(dispatch, "base:mob"), (uids {2, 3}));
+}
+
+TEST(ComponentsDispatch, Remove) {
+    ComponentsDispatch dispatch;
+    for (entityid_t uid = 1; uid <= 10; uid++) {
+        dispatch.add(uid, "a", std::make_shared<int>(uid));
+        if (uid % 2 == 0) {
+            dispatch.add(uid, "b", std::make_shared<int>(uid));
+        }
+    }
+    dispatch.remove(2);
+    dispatch.remove(10);
+    dispatch.remove(7);
+    dispatch.remove(42);
+
+    EXPECT_EQ(dispatch.size(), 10);
+    EXPECT_EQ(
+        get_uids(dispatch, "a"),
+        (std::vector<entityid_t> {1, 3, 4, 5, 6, 8, 9})
+    );
+    EXPECT_EQ(get_uids(dispatch, "b"), (std::vector<entityid_t> {4, 6, 8}));
+    // moved entries keep their environments and stay removable
+    for (const auto& group : dispatch.getGroups()) {
+        for (const auto& entry : group.entries) {
+            EXPECT_EQ(*entry.env, entry.uid);
+        }
+    }
+    for (entityid_t uid : {1, 3, 4, 5, 6, 8, 9}) {
+        dispatch.remove(uid);
+    }
+    EXPECT_EQ(dispatch.size(), 0);
+}
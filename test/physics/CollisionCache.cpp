@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+
+#include "physics/CollisionCache.hpp"
+#include "test_world.hpp"
+#include "voxels/Chunks.hpp"
+
+static constexpr int AREA_SIZE = 3;
+
+struct CollisionScene {
+    std::unique_ptr<Content> content;
+    std::unique_ptr<Chunks> chunks;
+
+    CollisionScene() {
+        content = test_world::build_content([](auto& builder) {
+            test_world::create_block(builder, "test:stone");
+            auto& slab = test_world::create_block(builder, "test:slab");
+            slab.hitboxes = {
+                AABB(glm::vec3(0.0f), glm::vec3(1.0f, 0.5f, 1.0f))};
+            test_world::create_block(builder, "test:flower").obstacle = false;
+        });
+        chunks = std::make_unique<Chunks>(
+            AREA_SIZE, AREA_SIZE, 0, 0, nullptr, *content->getIndices()
+        );
+
+        blockid_t stone = test_world::block_id(*content, "test:stone");
+        auto terrain = test_world::rough_terrain(
+            stone,
+            {0,
+             stone,
+             test_world::block_id(*content, "test:slab"),
+             test_world::block_id(*content, "test:flower")},
+            60,
+            4
+        );
+        int ox = chunks->getOffsetX();
+        int oz = chunks->getOffsetY();
+        for (int cz = oz; cz < oz + AREA_SIZE; cz++) {
+            for (int cx = ox; cx < ox + AREA_SIZE; cx++) {
+                // the corner chunk is missing
+                if (cx == ox && cz == oz) {
+                    continue;
+                }
+                chunks->putChunk(test_world::create_chunk(cx, cz, terrain));
+            }
+        }
+    }
+};
+
+static void expect_same(const AABB* expected, const AABB* actual) {
+    ASSERT_EQ(expected == nullptr, actual == nullptr);
+    if (expected) {
+        EXPECT_EQ(expected->min(), actual->min());
+        EXPECT_EQ(expected->max(), actual->max());
+    }
+}
+
+TEST(CollisionCache, MatchesStorageLookup) {
+    CollisionScene scene;
+    const auto& chunks = *scene.chunks;
+    glm::vec3 center(
+        (chunks.getOffsetX() + 1) * CHUNK_W, 62.0f,
+        (chunks.getOffsetY() + 1) * CHUNK_D
+    );
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> offset(-20.0f, 20.0f);
+
+    CollisionCache<Chunks> cache;
+    for (int i = 0; i < 50; i++) {
+        glm::vec3 position =
+            center + glm::vec3(offset(random), 0.0f, offset(random));
+        cache.gather(chunks, position, glm::vec3(0.3f, 0.9f, 0.3f), 1.5f);
+        // probes inside and outside of the window
+        for (int j = 0; j < 500; j++) {
+            glm::vec3 point = position + glm::vec3(
+                offset(random), offset(random) * 0.2f, offset(random)
+            ) * 0.25f;
+            expect_same(
+                blocks_agent::is_obstacle_at(chunks, point.x, point.y, point.z),
+                cache.isObstacleAt(point.x, point.y, point.z)
+            );
+        }
+    }
+}
+
+TEST(CollisionCache, WorldBounds) {
+    CollisionScene scene;
+    const auto& chunks = *scene.chunks;
+    CollisionCache<Chunks> cache;
+    glm::vec3 position(
+        (chunks.getOffsetX() + 1) * CHUNK_W + 0.5f, 0.5f,
+        (chunks.getOffsetY() + 1) * CHUNK_D + 0.5f
+    );
+    cache.gather(chunks, position, glm::vec3(0.5f), 2.0f);
+    EXPECT_NE(cache.isObstacleAt(position.x, -1.5f, position.z), nullptr);
+
+    position.y = CHUNK_H - 0.5f;
+    cache.gather(chunks, position, glm::vec3(0.5f), 2.0f);
+    EXPECT_EQ(
+        cache.isObstacleAt(position.x, CHUNK_H + 0.5f, position.z), nullptr
+    );
+}
+
+TEST(CollisionCache, FastBodyFallsBack) {
+    CollisionScene scene;
+    const auto& chunks = *scene.chunks;
+    CollisionCache<Chunks> cache;
+    glm::vec3 position(
+        (chunks.getOffsetX() + 1) * CHUNK_W + 0.5f, 61.0f,
+        (chunks.getOffsetY() + 1) * CHUNK_D + 0.5f
+    );
+    cache.gather(chunks, position, glm::vec3(0.5f), 1000.0f);
+    expect_same(
+        blocks_agent::is_obstacle_at(chunks, position.x, 59.5f, position.z),
+        cache.isObstacleAt(position.x, 59.5f, position.z)
+    );
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "physics/Hitbox.hpp"
+#include "physics/PhysicsSolver.hpp"
+#include "settings.hpp"
+#include "test_world.hpp"
+#include "util/ParallelExecutor.hpp"
+#include "voxels/GlobalChunks.hpp"
+#include "world/Level.hpp"
+#include "world/World.hpp"
+#include "world/files/WorldFiles.hpp"
+
+static constexpr int AREA_RADIUS = 1;
+static constexpr int BODIES_COUNT = 200;
+static constexpr int FRAMES = 90;
+
+struct PhysicsScene {
+    std::unique_ptr<Content> content;
+    EngineSettings settings;
+    std::unique_ptr<Level> level;
+    std::vector<Hitbox> hitboxes;
+
+    PhysicsScene() {
+        content = test_world::build_content([](auto& builder) {
+            test_world::create_block(builder, "test:stone");
+            auto& slab = test_world::create_block(builder, "test:slab");
+            slab.hitboxes = {
+                AABB(glm::vec3(0.0f), glm::vec3(1.0f, 0.5f, 1.0f))};
+        });
+
+        auto world = std::make_unique<World>(
+            WorldInfo {},
+            std::make_shared<WorldFiles>("physicstest:"),
+            *content,
+            std::vector<ContentPack> {}
+        );
+        level = std::make_unique<Level>(std::move(world), *content, settings);
+
+        blockid_t stone = test_world::block_id(*content, "test:stone");
+        blockid_t slab = test_world::block_id(*content, "test:slab");
+        auto terrain =
+            test_world::rough_terrain(stone, {stone, slab, 0, 0, 0, 0}, 60, 3);
+        for (int cz = -AREA_RADIUS; cz <= AREA_RADIUS; cz++) {
+            for (int cx = -AREA_RADIUS; cx <= AREA_RADIUS; cx++) {
+                level->chunks->putChunk(
+                    test_world::create_chunk(cx, cz, terrain)
+                );
+            }
+        }
+        std::mt19937 random(1309);
+        std::uniform_real_distribution<float> coord(
+            -AREA_RADIUS * CHUNK_W + 2.0f, (AREA_RADIUS + 1) * CHUNK_W - 2.0f
+        );
+        std::uniform_real_distribution<float> speed(-8.0f, 8.0f);
+        for (int i = 0; i < BODIES_COUNT; i++) {
+            Hitbox hitbox(
+                BodyType::DYNAMIC,
+                glm::vec3(coord(random), 64.0f + i % 10, coord(random)),
+                glm::vec3(0.3f, 0.9f, 0.3f)
+            );
+            hitbox.velocity = glm::vec3(speed(random), 0.0f, speed(random));
+            hitboxes.push_back(hitbox);
+        }
+    }
+
+    /// @return grounded state changes of all frames
+    std::vector<GroundedChange> simulate(util::ParallelExecutor* executor) {
+        std::vector<Hitbox*> pointers;
+        for (auto& hitbox : hitboxes) {
+            pointers.push_back(&hitbox);
+        }
+        std::vector<GroundedChange> changes;
+        for (int i = 0; i < FRAMES; i++) {
+            auto frameChanges = level->physics->stepAll(
+                *level->chunks, pointers, 1.0f / 60.0f, executor
+            );
+            changes.insert(
+                changes.end(), frameChanges.begin(), frameChanges.end()
+            );
+        }
+        return changes;
+    }
+};
+
+TEST(PhysicsSolver, ParallelStepMatchesSerial) {
+    PhysicsScene serial;
+    PhysicsScene parallel;
+    util::ParallelExecutor executor("test", 4);
+
+    auto serialChanges = serial.simulate(nullptr);
+    auto parallelChanges = parallel.simulate(&executor);
+
+    for (int i = 0; i < BODIES_COUNT; i++) {
+        const auto& expected = serial.hitboxes[i];
+        const auto& actual = parallel.hitboxes[i];
+        EXPECT_EQ(expected.position, actual.position) << "body " << i;
+        EXPECT_EQ(expected.velocity, actual.velocity) << "body " << i;
+        EXPECT_EQ(expected.grounded, actual.grounded) << "body " << i;
+    }
+    // callbacks order
+    ASSERT_FALSE(serialChanges.empty());
+    ASSERT_EQ(serialChanges.size(), parallelChanges.size());
+    for (size_t i = 0; i < serialChanges.size(); i++) {
+        EXPECT_EQ(serialChanges[i].index, parallelChanges[i].index);
+        EXPECT_EQ(serialChanges[i].grounded, parallelChanges[i].grounded);
+        EXPECT_EQ(serialChanges[i].impulse, parallelChanges[i].impulse);
+    }
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <unordered_map>
+
+#include "physics/SpatialGrid.hpp"
+
+static std::vector<entityid_t> query(
+    const SpatialGrid& grid, const AABB& area
+) {
+    std::vector<entityid_t> found;
+    grid.query(area, found);
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+static std::vector<entityid_t> brute_force(
+    const std::unordered_map<entityid_t, AABB>& objects, const AABB& area
+) {
+    std::vector<entityid_t> found;
+    for (const auto& [id, aabb] : objects) {
+        if (aabb.intersect(area)) {
+            found.push_back(id);
+        }
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+static AABB random_box(std::mt19937& random, float range, float maxSize) {
+    std::uniform_real_distribution<float> position(-range, range);
+    std::uniform_real_distribution<float> size(0.1f, maxSize);
+    glm::vec3 min(position(random), position(random), position(random));
+    return AABB(min, min + glm::vec3(size(random), size(random), size(random)));
+}
+
+TEST(SpatialGrid, InsertAndQuery) {
+    SpatialGrid grid(4.0f);
+    grid.update(1, AABB(glm::vec3(0.0f), glm::vec3(1.0f)));
+    grid.update(2, AABB(glm::vec3(10.0f), glm::vec3(11.0f)));
+    EXPECT_EQ(grid.size(), 2);
+
+    EXPECT_EQ(
+        query(grid, AABB(glm::vec3(0.5f), glm::vec3(2.0f))),
+        std::vector<entityid_t> {1}
+    );
+    EXPECT_EQ(
+        query(grid, AABB(glm::vec3(-5.0f), glm::vec3(20.0f))),
+        (std::vector<entityid_t> {1, 2})
+    );
+    EXPECT_TRUE(query(grid, AABB(glm::vec3(3.0f), glm::vec3(5.0f))).empty());
+}
+
+TEST(SpatialGrid, MoveAcrossCells) {
+    SpatialGrid grid(4.0f);
+    grid.update(1, AABB(glm::vec3(0.0f), glm::vec3(1.0f)));
+    grid.update(1, AABB(glm::vec3(100.0f), glm::vec3(101.0f)));
+    EXPECT_EQ(grid.size(), 1);
+    EXPECT_TRUE(query(grid, AABB(glm::vec3(-1.0f), glm::vec3(2.0f))).empty());
+    EXPECT_EQ(
+        query(grid, AABB(glm::vec3(99.0f), glm::vec3(100.5f))),
+        std::vector<entityid_t> {1}
+    );
+}
+
+TEST(SpatialGrid, LargeObjects) {
+    SpatialGrid grid(4.0f);
+    grid.update(1, AABB(glm::vec3(-50.0f), glm::vec3(50.0f)));
+    grid.update(2, AABB(glm::vec3(0.0f), glm::vec3(1.0f)));
+    EXPECT_EQ(
+        query(grid, AABB(glm::vec3(40.0f), glm::vec3(41.0f))),
+        std::vector<entityid_t> {1}
+    );
+    // shrinks into a regular cell
+    grid.update(1, AABB(glm::vec3(40.0f), glm::vec3(41.0f)));
+    EXPECT_TRUE(query(grid, AABB(glm::vec3(-10.0f), glm::vec3(-5.0f))).empty());
+    EXPECT_TRUE(grid.remove(1));
+    EXPECT_FALSE(grid.remove(1));
+    EXPECT_EQ(
+        query(grid, AABB(glm::vec3(-100.0f), glm::vec3(100.0f))),
+        std::vector<entityid_t> {2}
+    );
+}
+
+TEST(SpatialGrid, NonFiniteArea) {
+    SpatialGrid grid(4.0f);
+    grid.update(1, AABB(glm::vec3(0.0f), glm::vec3(1.0f)));
+    float inf = std::numeric_limits<float>::infinity();
+    AABB area(glm::vec3(0.5f, 0.5f, -inf), glm::vec3(0.5f, 0.5f, inf));
+    EXPECT_EQ(query(grid, area), std::vector<entityid_t> {1});
+}
+
+TEST(SpatialGrid, MatchesBruteForce) {
+    std::mt19937 random(2019);
+    std::uniform_int_distribution<entityid_t> ids(1, 300);
+    SpatialGrid grid(4.0f);
+    std::unordered_map<entityid_t, AABB> objects;
+
+    for (int i = 0; i < 5000; i++) {
+        entityid_t id = ids(random);
+        if (random() % 5 == 0) {
+            EXPECT_EQ(grid.remove(id), objects.erase(id) > 0);
+        } else {
+            auto aabb = random_box(random, 40.0f, random() % 10 ? 2.0f : 12.0f);
+            grid.update(id, aabb);
+            objects[id] = aabb;
+        }
+        if (i % 10 == 0) {
+            auto area = random_box(random, 40.0f, 16.0f);
+            ASSERT_EQ(query(grid, area), brute_force(objects, area));
+        }
+    }
+    EXPECT_EQ(grid.size(), objects.size());
+    grid.clear();
+    EXPECT_EQ(grid.size(), 0);
+}
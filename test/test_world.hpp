@@ -0,0 +1,92 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "content/Content.hpp"
+#include "content/ContentBuilder.hpp"
+#include "core_defs.hpp"
+#include "lighting/Lightmap.hpp"
+#include "objects/rigging.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+
+/// @brief Content and chunks shared by tests
+namespace test_world {
+    /// @brief Build content of the core blocks and the blocks created
+    /// by setup
+    inline std::unique_ptr<Content> build_content(
+        const std::function<void(ContentBuilder&)>& setup
+    ) {
+        ContentBuilder builder;
+        corecontent::setup(nullptr, builder);
+        setup(builder);
+        return builder.build();
+    }
+
+    /// @brief Create block having no item
+    inline Block& create_block(
+        ContentBuilder& builder, const std::string& name
+    ) {
+        auto& block = builder.blocks.create(name);
+        block.pickingItem = CORE_EMPTY;
+        return block;
+    }
+
+    inline blockid_t block_id(
+        const Content& content, const std::string& name
+    ) {
+        return content.blocks.require(name).rt.id;
+    }
+
+    /// @return pseudo-random value of the voxel position
+    inline uint voxel_hash(int x, int y, int z) {
+        return (x * 73856093U) ^ (y * 19349663U) ^ (z * 83492791U);
+    }
+
+    /// @brief Block id by global voxel coordinates
+    using BlockSupplier = std::function<blockid_t(int x, int y, int z)>;
+
+    /// @brief Create chunk filled with the supplied blocks
+    inline std::shared_ptr<Chunk> create_chunk(
+        int cx, int cz, const BlockSupplier& supplier, bool lightmap = false
+    ) {
+        auto chunk = std::make_shared<Chunk>(
+            cx, cz, lightmap ? std::make_shared<Lightmap>() : nullptr
+        );
+        auto voxels = chunk->getVoxels();
+        for (int y = 0; y < CHUNK_H; y++) {
+            for (int z = 0; z < CHUNK_D; z++) {
+                for (int x = 0; x < CHUNK_W; x++) {
+                    voxels[vox_index(x, y, z)].id = supplier(
+                        cx * CHUNK_W + x, y, cz * CHUNK_D + z
+                    );
+                }
+            }
+        }
+        chunk->updateHeights();
+        return chunk;
+    }
+
+    /// @brief Ground of the block below the height and randomly placed
+    /// surface blocks in the layers above
+    /// @param surface surface blocks chosen with equal chances, may include
+    /// air
+    inline BlockSupplier rough_terrain(
+        blockid_t ground,
+        std::vector<blockid_t> surface,
+        int height,
+        int layers
+    ) {
+        return [=](int x, int y, int z) -> blockid_t {
+            if (y < height) {
+                return ground;
+            } else if (y < height + layers) {
+                return surface[voxel_hash(x, y, z) % surface.size()];
+            }
+            return 0;
+        };
+    }
+}
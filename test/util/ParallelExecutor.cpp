@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "util/ParallelExecutor.hpp"
+
+TEST(ParallelExecutor, RunsEachJobOnce) {
+    util::ParallelExecutor executor("test", 4);
+    for (size_t count : {0, 1, 3, 1000}) {
+        std::vector<std::atomic<int>> calls(count);
+        std::atomic<bool> validWorkers = true;
+        executor.run(count, [&](size_t index, uint worker) {
+            calls[index]++;
+            if (worker >= executor.getWorkersCount()) {
+                validWorkers = false;
+            }
+        });
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(calls[i], 1);
+        }
+        EXPECT_TRUE(validWorkers);
+    }
+}
+
+TEST(ParallelExecutor, RethrowsException) {
+    util::ParallelExecutor executor("test", 4);
+    EXPECT_THROW(
+        executor.run(
+            100,
+            [](size_t index, uint) {
+                if (index == 42) {
+                    throw std::runtime_error("test");
+                }
+            }
+        ),
+        std::runtime_error
+    );
+    // still usable
+    std::atomic<int> sum = 0;
+    executor.run(10, [&sum](size_t index, uint) { sum += index; });
+    EXPECT_EQ(sum, 45);
+}
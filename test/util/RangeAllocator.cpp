@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "util/RangeAllocator.hpp"
+
+using namespace util;
+
+TEST(RangeAllocator, Allocation) {
+    RangeAllocator ranges(100);
+    EXPECT_EQ(ranges.allocate(40), 0);
+    EXPECT_EQ(ranges.allocate(40), 40);
+    EXPECT_EQ(ranges.allocate(40), RangeAllocator::INVALID);
+    EXPECT_EQ(ranges.allocate(20), 80);
+    EXPECT_EQ(ranges.getFreeSpace(), 0);
+    EXPECT_THROW(ranges.allocate(0), std::invalid_argument);
+}
+
+TEST(RangeAllocator, FreeCoalescing) {
+    RangeAllocator ranges(100);
+    size_t a = ranges.allocate(10);
+    size_t b = ranges.allocate(10);
+    size_t c = ranges.allocate(10);
+    ranges.allocate(70);
+
+    ranges.free(a);
+    ranges.free(c);
+    EXPECT_EQ(ranges.getLargestFreeRange(), 10);
+    // first fit reuses the freed range
+    EXPECT_EQ(ranges.allocate(5), a);
+    ranges.free(a);
+
+    ranges.free(b);
+    EXPECT_EQ(ranges.getLargestFreeRange(), 30);
+    EXPECT_EQ(ranges.allocate(30), a);
+    EXPECT_THROW(ranges.free(1), std::runtime_error);
+}
+
+TEST(RangeAllocator, Defragment) {
+    RangeAllocator ranges(60);
+    size_t a = ranges.allocate(10);
+    size_t b = ranges.allocate(20);
+    size_t c = ranges.allocate(10);
+    size_t d = ranges.allocate(20);
+    ranges.free(a);
+    ranges.free(c);
+    EXPECT_EQ(ranges.getFreeSpace(), 20);
+    EXPECT_EQ(ranges.allocate(15), RangeAllocator::INVALID);
+
+    size_t e = ranges.allocate(5);
+    auto moves = ranges.defragment();
+    ASSERT_EQ(moves.size(), 3);
+    EXPECT_EQ(moves[0].from, e);
+    EXPECT_EQ(moves[0].to, 0);
+    EXPECT_EQ(moves[1].from, b);
+    EXPECT_EQ(moves[1].to, 5);
+    EXPECT_EQ(moves[2].from, d);
+    EXPECT_EQ(moves[2].to, 25);
+    EXPECT_EQ(moves[2].size, 20);
+    EXPECT_EQ(ranges.getLargestFreeRange(), 15);
+    EXPECT_EQ(ranges.allocate(15), 45);
+    ranges.free(5);
+    EXPECT_EQ(ranges.getFreeSpace(), 20);
+}
+
+TEST(RangeAllocator, Grow) {
+    RangeAllocator ranges(10);
+    ranges.allocate(8);
+    EXPECT_EQ(ranges.allocate(4), RangeAllocator::INVALID);
+    ranges.grow(20);
+    // the tail free range is extended
+    EXPECT_EQ(ranges.allocate(12), 8);
+    ranges.grow(30);
+    EXPECT_EQ(ranges.allocate(10), 20);
+    EXPECT_EQ(ranges.getCapacity(), 30);
+    EXPECT_EQ(ranges.getAllocationsCount(), 3);
+}
@@ -4,11 +4,12 @@
 
 TEST(Chunk, EncodeDecode) {
     Chunk chunk1(0, 0);
+    voxel* voxels = chunk1.getVoxels();
     for (uint i = 0; i < CHUNK_VOL; i++) {
-        chunk1.voxels[i].id = rand();
-        chunk1.voxels[i].state.rotation = rand();
-        chunk1.voxels[i].state.segment = rand();
-        chunk1.voxels[i].state.userbits = rand();
+        voxels[i].id = rand();
+        voxels[i].state.rotation = rand();
+        voxels[i].state.segment = rand();
+        voxels[i].state.userbits = rand();
     }
     auto bytes = chunk1.encode();
 
@@ -16,10 +17,53 @@ TEST(Chunk, EncodeDecode) {
     chunk2.decode(bytes.get());
 
     for (uint i = 0; i < CHUNK_VOL; i++) {
-        EXPECT_EQ(chunk1.voxels[i].id, chunk2.voxels[i].id);
+        EXPECT_EQ(chunk1.getVoxel(i).id, chunk2.getVoxel(i).id);
         EXPECT_EQ(
-            blockstate2int(chunk1.voxels[i].state), 
-            blockstate2int(chunk2.voxels[i].state)
+            blockstate2int(chunk1.getVoxel(i).state), 
+            blockstate2int(chunk2.getVoxel(i).state)
         );
     }
 }
+
+TEST(Chunk, ModifiedSections) {
+    Chunk chunk(0, 0);
+    chunk.flags.modified = false;
+    chunk.modifiedSections = 0;
+    chunk.setModified(CHUNK_SECTION_H);
+    // neighbour voxels faces and ambient occlusion
+    EXPECT_EQ(chunk.modifiedSections, 0b11);
+    EXPECT_TRUE(chunk.flags.modified);
+
+    chunk.modifiedSections = 0;
+    chunk.setModified(CHUNK_SECTION_H + 1);
+    EXPECT_EQ(chunk.modifiedSections, 0b10);
+
+    chunk.modifiedSections = 0;
+    chunk.setModified(0);
+    EXPECT_EQ(chunk.modifiedSections, 0b1);
+    chunk.setModified(CHUNK_H - 1);
+    EXPECT_EQ(chunk.modifiedSections >> (CHUNK_SECTIONS - 1), 1);
+
+    chunk.setModified();
+    EXPECT_EQ(chunk.modifiedSections, Chunk::ALL_SECTIONS);
+}
+
+TEST(Chunk, UpdateHeights) {
+    Chunk chunk(0, 0);
+    voxel* voxels = chunk.getVoxels();
+    voxels[vox_index(3, 20, 5)].id = 1;
+    voxels[vox_index(15, 100, 0)].id = 2;
+    chunk.updateHeights();
+    EXPECT_EQ(chunk.bottom, 20);
+    EXPECT_EQ(chunk.top, 101);
+
+    chunk.packIdleVoxels();
+    ASSERT_TRUE(chunk.packIdleVoxels());
+    chunk.bottom = 0;
+    chunk.top = CHUNK_H;
+    chunk.updateHeights();
+    EXPECT_EQ(chunk.bottom, 20);
+    EXPECT_EQ(chunk.top, 101);
+    // heights are read without unpacking
+    EXPECT_TRUE(chunk.isPacked());
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "voxels/Chunk.hpp"
+#include "voxels/PalettedVoxels.hpp"
+
+static void check_roundtrip(const voxel* voxels) {
+    PalettedVoxels packed;
+    packed.pack(voxels);
+
+    auto unpacked = std::make_unique<voxel[]>(CHUNK_VOL);
+    packed.unpack(unpacked.get());
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        ASSERT_EQ(voxels[i].id, unpacked[i].id);
+        ASSERT_EQ(
+            blockstate2int(voxels[i].state),
+            blockstate2int(unpacked[i].state)
+        );
+        ASSERT_EQ(voxels[i].id, packed.get(i).id);
+    }
+}
+
+TEST(PalettedVoxels, Uniform) {
+    auto voxels = std::make_unique<voxel[]>(CHUNK_VOL);
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        voxels[i].id = i < CHUNK_VOL / 2 ? 1 : 0;
+    }
+    check_roundtrip(voxels.get());
+
+    PalettedVoxels packed;
+    packed.pack(voxels.get());
+    for (uint i = 0; i < VOXELS_SECTIONS; i++) {
+        EXPECT_TRUE(packed.isUniform(i));
+    }
+    EXPECT_LT(packed.getMemoryUsage(), CHUNK_VOL * sizeof(voxel) / 100);
+}
+
+TEST(PalettedVoxels, PaletteSizes) {
+    auto voxels = std::make_unique<voxel[]>(CHUNK_VOL);
+    // each section gets a different number of distinct voxels
+    for (uint s = 0; s < VOXELS_SECTIONS; s++) {
+        uint distinct = 1 + (s * 331) % 1500;
+        for (uint i = 0; i < VOXELS_SECTION_VOL; i++) {
+            auto& vox = voxels[s * VOXELS_SECTION_VOL + i];
+            vox.id = (i * 7) % distinct;
+            vox.state.rotation = i % 3 == 0;
+        }
+    }
+    check_roundtrip(voxels.get());
+}
+
+TEST(PalettedVoxels, Random) {
+    std::mt19937 random(42);
+    auto voxels = std::make_unique<voxel[]>(CHUNK_VOL);
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        voxels[i].id = random();
+        voxels[i].state = int2blockstate(random() & 0xFFFF);
+    }
+    check_roundtrip(voxels.get());
+}
+
+TEST(PalettedVoxels, PackIdleChunk) {
+    Chunk chunk(0, 0);
+    voxel* voxels = chunk.getVoxels();
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        voxels[i].id = i / CHUNK_W % 5;
+    }
+    // accessed since creation
+    EXPECT_FALSE(chunk.packIdleVoxels());
+    EXPECT_TRUE(chunk.packIdleVoxels());
+    EXPECT_TRUE(chunk.isPacked());
+    EXPECT_LT(chunk.getVoxelsMemoryUsage(), CHUNK_VOL * sizeof(voxel) / 4);
+
+    voxel buffer[VOXELS_SECTION_VOL];
+    const voxel* section = chunk.getSection(3, buffer);
+    EXPECT_EQ(section[17].id, (3 * VOXELS_SECTION_VOL + 17) / CHUNK_W % 5);
+    EXPECT_EQ(chunk.getVoxel(1000).id, 1000 / CHUNK_W % 5);
+    EXPECT_TRUE(chunk.isPacked());
+
+    voxels = chunk.getVoxels();
+    EXPECT_FALSE(chunk.isPacked());
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        ASSERT_EQ(voxels[i].id, i / CHUNK_W % 5);
+    }
+    EXPECT_FALSE(chunk.packIdleVoxels());
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "content/Content.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+#include "voxels/blocks_agent.hpp"
+
+TEST(blocks_agent, RandomTickBlocks) {
+    Block air {"core:air"};
+    Block stone {"stone"};
+    Block grass {"grass"};
+    grass.rt.funcsset.randupdate = true;
+    ContentIndices indices(
+        std::vector<Block*> {&air, &stone, &grass},
+        std::vector<ItemDef*> {},
+        std::vector<EntityDef*> {}
+    );
+    Chunks chunks(1, 1, 0, 0, nullptr, indices);
+    auto chunk = std::make_shared<Chunk>(
+        chunks.getOffsetX(), chunks.getOffsetY()
+    );
+    voxel* voxels = chunk->getVoxels();
+    for (int y = 0; y < 40; y++) {
+        for (int z = 0; z < CHUNK_D; z++) {
+            for (int x = 0; x < CHUNK_W; x++) {
+                voxels[vox_index(x, y, z)].id = y == 39 ? 2 : 1;
+            }
+        }
+    }
+    chunk->updateHeights();
+    chunks.putChunk(chunk);
+
+    blocks_agent::count_random_tick_blocks(indices, *chunk);
+    EXPECT_TRUE(chunk->flags.randomTicksCounted);
+    for (int s = 0; s < VOXELS_SECTIONS; s++) {
+        EXPECT_EQ(
+            chunk->randomTickBlocks[s],
+            s == 39 / VOXELS_SECTION_H ? CHUNK_W * CHUNK_D : 0
+        );
+    }
+
+    int x = chunk->x * CHUNK_W;
+    int z = chunk->z * CHUNK_D;
+    blocks_agent::set(chunks, x, 39, z, 1, {});
+    blocks_agent::set(chunks, x, 100, z, 2, {});
+    blocks_agent::set(chunks, x, 101, z, 2, {});
+    blocks_agent::set(chunks, x, 101, z, 2, {});
+    auto counts = chunk->randomTickBlocks;
+    EXPECT_EQ(counts[39 / VOXELS_SECTION_H], CHUNK_W * CHUNK_D - 1);
+    EXPECT_EQ(counts[100 / VOXELS_SECTION_H], 2);
+
+    blocks_agent::count_random_tick_blocks(indices, *chunk);
+    EXPECT_EQ(chunk->randomTickBlocks, counts);
+
+    auto bytes = chunk->encode();
+    chunk->decode(bytes.get());
+    EXPECT_FALSE(chunk->flags.randomTicksCounted);
+    blocks_agent::pull_register_events();
+}
@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "io/io.hpp"
+#include "io/devices/StdfsDevice.hpp"
+#include "util/data_io.hpp"
+#include "world/files/WorldRegions.hpp"
+
+namespace fs = std::filesystem;
+
+static void put_chunk(
+    WorldRegion& region, uint x, uint z, ubyte value, uint32_t size = 0
+) {
+    if (size == 0) {
+        size = x + 1;
+    }
+    auto data = std::make_unique<ubyte[]>(size);
+    std::fill(data.get(), data.get() + size, value);
+    region.put(x, z, std::move(data), size, size);
+}
+
+/// @brief Damage the latest commit slot of region file bytes
+static void tear_last_commit(std::vector<char>& bytes) {
+    uint32_t generations[2];
+    for (int i = 0; i < 2; i++) {
+        std::memcpy(
+            &generations[i],
+            bytes.data() + REGION_COMMIT_SLOTS_OFFSET +
+                i * REGION_COMMIT_SLOT_SIZE,
+            4
+        );
+    }
+    int last = dataio::le2h(generations[1]) > dataio::le2h(generations[0]);
+    bytes[REGION_COMMIT_SLOTS_OFFSET + last * REGION_COMMIT_SLOT_SIZE + 8] ^=
+        0xFF;
+}
+
+class RegionsLayerTest : public ::testing::Test {
+protected:
+    fs::path root;
+
+    void SetUp() override {
+        root = fs::temp_directory_path() / "vc_regions_test";
+        fs::remove_all(root);
+        fs::create_directories(root);
+        io::set_device("regtest", std::make_shared<io::StdfsDevice>(root));
+    }
+
+    void TearDown() override {
+        io::remove_device("regtest");
+        fs::remove_all(root);
+    }
+
+    static void init(RegionsLayer& layer) {
+        layer.folder = "regtest:";
+    }
+
+    std::vector<char> readFile(const std::string& name) {
+        std::ifstream file(root / name, std::ios::binary);
+        return std::vector<char>(
+            std::istreambuf_iterator<char>(file), {}
+        );
+    }
+
+    void writeFile(const std::string& name, const std::vector<char>& bytes) {
+        std::ofstream file(root / name, std::ios::binary);
+        file.write(bytes.data(), bytes.size());
+    }
+};
+
+TEST_F(RegionsLayerTest, ReadWrittenRegions) {
+    const int regionsCount = MAX_OPEN_REGION_FILES + 8;
+    {
+        RegionsLayer layer {};
+        init(layer);
+        for (int i = 0; i < regionsCount; i++) {
+            WorldRegion region;
+            put_chunk(region, 1, 2, i);
+            put_chunk(region, 5, 0, i + 1);
+            layer.writeRegion(i, 0, &region);
+        }
+    }
+    RegionsLayer layer {};
+    init(layer);
+    // keep the first region file in use while others are opened
+    auto first = layer.getData(1, 2);
+    ASSERT_TRUE(first);
+    for (int i = 0; i < regionsCount; i++) {
+        int x = i * REGION_SIZE;
+        auto data = layer.getData(x + 1, 2);
+        ASSERT_TRUE(data);
+        EXPECT_EQ(data.size, 2);
+        EXPECT_EQ(data.data[1], i);
+
+        data = layer.getData(x + 5, 0);
+        ASSERT_TRUE(data);
+        EXPECT_EQ(data.srcSize, 6);
+        EXPECT_EQ(data.data[5], i + 1);
+
+        EXPECT_FALSE(layer.getData(x + 2, 2));
+    }
+    EXPECT_LE(layer.openRegFiles.size(), MAX_OPEN_REGION_FILES);
+    EXPECT_EQ(first.data[0], 0);
+    first = {};
+
+    // chunks not loaded into memory are kept
+    WorldRegion region;
+    put_chunk(region, 3, 3, 42);
+    layer.writeRegion(0, 0, &region);
+    ASSERT_TRUE(layer.getData(1, 2));
+    EXPECT_EQ(layer.getData(3, 3).data[0], 42);
+}
+
+TEST_F(RegionsLayerTest, AppendsUnsavedChunks) {
+    RegionsLayer layer {};
+    init(layer);
+    WorldRegion region;
+    for (uint i = 0; i < REGION_SIZE; i++) {
+        put_chunk(region, i, 0, 1, 1000);
+    }
+    layer.writeRegion(0, 0, &region);
+    size_t length = fs::file_size(root / "0_0.bin");
+
+    for (int i = 0; i < 10; i++) {
+        put_chunk(region, 7, 0, 2 + i, 1000);
+        put_chunk(region, 8, 0, 2 + i, 1000);
+        layer.writeRegion(0, 0, &region);
+    }
+    // replaced records and tables are reused
+    EXPECT_LE(fs::file_size(root / "0_0.bin"), length + 8192);
+    EXPECT_EQ(layer.getData(7, 0).data[999], 11);
+    EXPECT_EQ(layer.getData(9, 0).data[0], 1);
+
+    region.put(9, 0, nullptr, 0, 0);
+    layer.writeRegion(0, 0, &region);
+
+    RegionsLayer reopened {};
+    init(reopened);
+    EXPECT_FALSE(reopened.getData(9, 0));
+    EXPECT_EQ(reopened.getData(8, 0).data[0], 11);
+    EXPECT_EQ(reopened.getData(10, 0).data[0], 1);
+}
+
+TEST_F(RegionsLayerTest, ReadsWhileWriting) {
+    RegionsLayer layer {};
+    init(layer);
+    WorldRegion region;
+    put_chunk(region, 0, 0, 1, 500);
+    layer.writeRegion(0, 0, &region);
+
+    for (int i = 0; i < 5; i++) {
+        auto view = layer.getData(0, 0);
+        ASSERT_TRUE(view);
+        std::thread writer([&layer, &region, i]() {
+            put_chunk(region, 0, 0, 2 + i, 500);
+            layer.writeRegion(0, 0, &region);
+        });
+        // commit waits until the file gets out of use
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EXPECT_EQ(view.data[499], 1 + i);
+        view = {};
+        writer.join();
+        EXPECT_EQ(layer.getData(0, 0).data[0], 2 + i);
+    }
+    // writer is kept between writes
+    EXPECT_EQ(layer.regWriters.size(), 1);
+    layer.deleteRegion(0, 0);
+    EXPECT_TRUE(layer.regWriters.empty());
+    EXPECT_FALSE(layer.getData(0, 0));
+}
+
+TEST_F(RegionsLayerTest, RecoversInterruptedWrite) {
+    WorldRegion region;
+    {
+        RegionsLayer layer {};
+        init(layer);
+        put_chunk(region, 0, 0, 1, 300);
+        layer.writeRegion(0, 0, &region);
+        put_chunk(region, 0, 0, 2, 300);
+        layer.writeRegion(0, 0, &region);
+    }
+    auto bytes = readFile("0_0.bin");
+    // garbage of interrupted write at the end of file
+    auto damaged = bytes;
+    damaged.resize(damaged.size() + 1000, 0x7F);
+    writeFile("0_0.bin", damaged);
+    {
+        RegionsLayer layer {};
+        init(layer);
+        EXPECT_EQ(layer.getData(0, 0).data[0], 2);
+    }
+    // torn commit slot makes the previous commit actual
+    damaged = bytes;
+    tear_last_commit(damaged);
+    writeFile("0_0.bin", damaged);
+
+    RegionsLayer layer {};
+    init(layer);
+    EXPECT_EQ(layer.getData(0, 0).data[0], 1);
+
+    // sectors of the previous commit are not reused by the next write
+    put_chunk(region, 1, 0, 3);
+    layer.writeRegion(0, 0, &region);
+    EXPECT_EQ(layer.getData(0, 0).data[299], 1);
+    EXPECT_EQ(layer.getData(1, 0).data[0], 3);
+}
+
+TEST_F(RegionsLayerTest, ReclaimsAfterCommitIsSynced) {
+    auto path = root / "0_0.bin";
+    RegionFileWriter writer(path, compression::Method::NONE);
+    std::vector<ubyte> data(300, 5);
+    writer.put(0, data.data(), data.size(), data.size());
+    writer.commit();
+    // the record is written at the end of file
+    writer.put(1, data.data(), data.size(), data.size());
+    writer.commit();
+    size_t length = fs::file_size(path);
+
+    writer.remove(1);
+    writer.writeTable();
+    writer.sync();
+    writer.writeCommit();
+    writer.sync();
+    // interrupted before the new commit is stored, the previous one is
+    // still actual and references not truncated sectors
+    auto bytes = readFile("0_0.bin");
+    EXPECT_EQ(bytes.size(), length);
+    tear_last_commit(bytes);
+    writeFile("1_0.bin", bytes);
+    {
+        RegionsLayer layer {};
+        init(layer);
+        auto chunk = layer.getData(REGION_SIZE + 1, 0);
+        ASSERT_TRUE(chunk);
+        EXPECT_EQ(chunk.data[299], 5);
+    }
+
+    writer.reclaim();
+    EXPECT_LT(fs::file_size(path), length);
+    RegionsLayer layer {};
+    init(layer);
+    EXPECT_TRUE(layer.getData(0, 0));
+    EXPECT_FALSE(layer.getData(1, 0));
+}
+
+TEST_F(RegionsLayerTest, UpgradesVersion3) {
+    std::vector<char> bytes(REGION_HEADER_SIZE);
+    std::memcpy(bytes.data(), REGION_FORMAT_MAGIC, 8);
+    bytes[8] = 3;
+    uint32_t offsets[REGION_CHUNKS_COUNT] {};
+    offsets[5] = dataio::h2le(static_cast<uint32_t>(bytes.size()));
+    uint32_t sizes[] {dataio::h2le(3U), dataio::h2le(3U)};
+    bytes.insert(
+        bytes.end(),
+        reinterpret_cast<char*>(sizes),
+        reinterpret_cast<char*>(sizes) + 8
+    );
+    bytes.insert(bytes.end(), {7, 8, 9});
+    bytes.insert(
+        bytes.end(),
+        reinterpret_cast<char*>(offsets),
+        reinterpret_cast<char*>(offsets) + sizeof(offsets)
+    );
+    writeFile("0_0.bin", bytes);
+
+    RegionsLayer layer {};
+    init(layer);
+    auto data = layer.getData(5, 0);
+    ASSERT_TRUE(data);
+    EXPECT_EQ(data.size, 3);
+    EXPECT_EQ(data.data[2], 9);
+    data = {};
+
+    WorldRegion region;
+    put_chunk(region, 6, 0, 10);
+    layer.writeRegion(0, 0, &region);
+    EXPECT_EQ(readFile("0_0.bin")[8], REGION_FORMAT_VERSION);
+    EXPECT_EQ(layer.getData(5, 0).data[2], 9);
+    EXPECT_EQ(layer.getData(6, 0).data[0], 10);
+}
+
+TEST_F(RegionsLayerTest, CompactsFragmentedRegion) {
+    RegionsLayer layer {};
+    init(layer);
+    WorldRegion region;
+    for (uint i = 0; i < REGION_SIZE; i++) {
+        put_chunk(region, i, 0, i, 2000);
+    }
+    layer.writeRegion(0, 0, &region);
+    EXPECT_TRUE(layer.fragmentedRegions.empty());
+
+    for (uint i = 0; i < REGION_SIZE - 1; i++) {
+        if (i % 8) {
+            region.put(i, 0, nullptr, 0, 0);
+        }
+    }
+    layer.writeRegion(0, 0, &region);
+    ASSERT_EQ(layer.fragmentedRegions.size(), 1);
+
+    size_t length = fs::file_size(root / "0_0.bin");
+    layer.compactRegion(0, 0);
+    EXPECT_LT(fs::file_size(root / "0_0.bin"), length / 2);
+    for (uint i = 0; i < REGION_SIZE; i++) {
+        auto data = layer.getData(i, 0);
+        if (i % 8 && i != REGION_SIZE - 1) {
+            EXPECT_FALSE(data);
+        } else {
+            ASSERT_TRUE(data);
+            EXPECT_EQ(data.data[1999], i);
+        }
+    }
+}
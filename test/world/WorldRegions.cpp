@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "io/io.hpp"
+#include "io/devices/StdfsDevice.hpp"
+#include "world/files/WorldRegions.hpp"
+
+namespace fs = std::filesystem;
+
+class WorldRegionsTest : public ::testing::Test {
+protected:
+    fs::path root;
+
+    void SetUp() override {
+        root = fs::temp_directory_path() / "vc_world_regions_test";
+        fs::remove_all(root);
+        fs::create_directories(root);
+        io::set_device("regtest", std::make_shared<io::StdfsDevice>(root));
+    }
+
+    void TearDown() override {
+        io::remove_device("regtest");
+        fs::remove_all(root);
+    }
+
+    static std::unique_ptr<Chunk> create_chunk(int x, int z, blockid_t id) {
+        auto chunk =
+            std::make_unique<Chunk>(x, z, std::make_shared<Lightmap>());
+        chunk->getVoxels()[0].id = id;
+        chunk->getVoxels()[CHUNK_VOL - 1].id = id;
+        chunk->lightmap->map[1] = 0xF000;
+        chunk->flags.lighted = true;
+        chunk->flags.unsaved = true;
+        return chunk;
+    }
+
+    static blockid_t read_voxel(
+        WorldRegions& regions, int x, int z, uint index
+    ) {
+        auto data = std::make_unique<ubyte[]>(CHUNK_DATA_LEN);
+        if (!regions.getVoxels(x, z, data.get())) {
+            return 0;
+        }
+        Chunk chunk(x, z);
+        chunk.decode(data.get());
+        return chunk.getVoxel(index).id;
+    }
+};
+
+TEST_F(WorldRegionsTest, ReadsQueuedChunks) {
+    WorldRegions regions("regtest:");
+    auto chunk = create_chunk(3, -2, 5);
+    regions.put(chunk.get(), {});
+    EXPECT_EQ(read_voxel(regions, 3, -2, 0), 5);
+
+    chunk->getVoxels()[0].id = 6;
+    regions.put(chunk.get(), {});
+    chunk->getVoxels()[0].id = 7;
+    regions.put(chunk.get(), {});
+    EXPECT_EQ(read_voxel(regions, 3, -2, 0), 7);
+    EXPECT_EQ(read_voxel(regions, 3, -2, CHUNK_VOL - 1), 5);
+
+    auto lights = std::make_unique<ubyte[]>(LIGHTMAP_DATA_LEN);
+    ASSERT_TRUE(regions.getLights(3, -2, lights.get()));
+    Lightmap lightmap;
+    lightmap.decode(lights.get());
+    EXPECT_EQ(lightmap.map[1], 0xF000);
+    EXPECT_EQ(lightmap.map[2], 0);
+}
+
+TEST_F(WorldRegionsTest, WritesQueuedChunks) {
+    // more than fits in the snapshots queue
+    const int chunksCount = 300;
+    {
+        WorldRegions regions("regtest:");
+        for (int i = 0; i < chunksCount; i++) {
+            auto chunk = create_chunk(i, i % 7, i % 100 + 1);
+            regions.put(chunk.get(), {});
+        }
+        regions.writeAll();
+        regions.flush();
+        EXPECT_TRUE(fs::exists(root / "regions" / "0_0.bin"));
+
+        auto chunk = create_chunk(0, 0, 42);
+        regions.put(chunk.get(), {});
+        regions.writeAll();
+        // queued chunks are written on destruction
+    }
+    WorldRegions regions("regtest:");
+    EXPECT_EQ(read_voxel(regions, 0, 0, 0), 42);
+    for (int i = 1; i < chunksCount; i++) {
+        EXPECT_EQ(read_voxel(regions, i, i % 7, CHUNK_VOL - 1), i % 100 + 1);
+    }
+}
+
+TEST_F(WorldRegionsTest, ChangesCompression) {
+    {
+        WorldRegions regions("regtest:");
+        // layers format stays readable by older versions by default
+        EXPECT_EQ(
+            regions.getCompression(REGION_LAYER_ENTITIES),
+            compression::Method::NONE
+        );
+        regions.put(create_chunk(1, 1, 5).get(), {});
+        regions.writeAll();
+        regions.flush();
+
+        regions.setCompression(
+            REGION_LAYER_VOXELS, compression::Method::LZ4
+        );
+        EXPECT_EQ(read_voxel(regions, 1, 1, 0), 5);
+        regions.put(create_chunk(2, 1, 6).get(), {});
+        regions.writeAll();
+    }
+    WorldRegions regions("regtest:");
+    regions.setCompression(REGION_LAYER_VOXELS, compression::Method::LZ4);
+    EXPECT_EQ(read_voxel(regions, 1, 1, 0), 5);
+    EXPECT_EQ(read_voxel(regions, 2, 1, 0), 6);
+
+    // the region file is recompressed on write
+    regions.setCompression(
+        REGION_LAYER_VOXELS, compression::Method::EXTRLE16
+    );
+    regions.put(create_chunk(3, 1, 7).get(), {});
+    regions.writeAll();
+    regions.flush();
+    EXPECT_EQ(read_voxel(regions, 1, 1, 0), 5);
+    EXPECT_EQ(read_voxel(regions, 3, 1, 0), 7);
+
+    EXPECT_THROW(
+        regions.setCompression(
+            REGION_LAYER_ENTITIES, compression::Method::ZLIB_DICT
+        ),
+        std::invalid_argument
+    );
+}
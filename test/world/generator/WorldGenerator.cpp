@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "content/Content.hpp"
+#include "content/ContentBuilder.hpp"
+#include "core_defs.hpp"
+#include "objects/rigging.hpp"
+#include "util/ParallelExecutor.hpp"
+#include "voxels/Block.hpp"
+#include "world/generator/GeneratorDef.hpp"
+#include "world/generator/WorldGenerator.hpp"
+
+static constexpr int AREA_RADIUS = 4;
+
+/// @brief Generator script placing lines and blocks crossing chunk borders,
+/// so chunk voxels depend on neighbour prototypes
+class TestGeneratorScript : public GeneratorScript {
+    blockid_t stone;
+    blockid_t dirt;
+public:
+    TestGeneratorScript(blockid_t stone, blockid_t dirt)
+        : stone(stone), dirt(dirt) {
+    }
+
+    void initialize(uint64_t) override {
+    }
+
+    std::shared_ptr<Heightmap> generateHeightmap(
+        const glm::ivec2& offset,
+        const glm::ivec2& size,
+        uint bpd,
+        const std::vector<std::shared_ptr<Heightmap>>&
+    ) override {
+        auto map = std::make_shared<Heightmap>(size.x, size.y);
+        float* values = map->getValues();
+        for (int z = 0; z < size.y; z++) {
+            for (int x = 0; x < size.x; x++) {
+                float wx = (offset.x + x) * static_cast<int>(bpd);
+                float wz = (offset.y + z) * static_cast<int>(bpd);
+                values[z * size.x + x] =
+                    0.25f + 0.1f * std::sin(wx * 0.05f) * std::cos(wz * 0.07f);
+            }
+        }
+        return map;
+    }
+
+    std::vector<std::shared_ptr<Heightmap>> generateParameterMaps(
+        const glm::ivec2& offset, const glm::ivec2& size, uint bpd
+    ) override {
+        auto map = std::make_shared<Heightmap>(size.x, size.y);
+        float* values = map->getValues();
+        for (int z = 0; z < size.y; z++) {
+            for (int x = 0; x < size.x; x++) {
+                values[z * size.x + x] =
+                    0.5f + 0.5f * std::sin((offset.x + x) * 0.3f);
+            }
+        }
+        return {map};
+    }
+
+    std::vector<Placement> placeStructuresWide(
+        const glm::ivec2& offset, const glm::ivec2&, uint
+    ) override {
+        if ((offset.x / CHUNK_W + offset.y / CHUNK_D) % 3) {
+            return {};
+        }
+        glm::ivec3 a(offset.x + 8, 60, offset.y + 8);
+        return {Placement(
+            1, LinePlacement(stone, a, a + glm::ivec3(40, 20, -30), 2)
+        )};
+    }
+
+    std::vector<Placement> placeStructures(
+        const glm::ivec2& offset,
+        const glm::ivec2&,
+        const std::shared_ptr<Heightmap>&,
+        uint
+    ) override {
+        return {
+            Placement(2, BlockPlacement(dirt, {offset.x + 15, 90, offset.y}, 0)),
+            Placement(0, BlockPlacement(stone, {offset.x, 91, offset.y + 16}, 0)),
+        };
+    }
+};
+
+static BlocksLayers make_layers(std::vector<BlocksLayer> layers) {
+    return BlocksLayers {std::move(layers), 0};
+}
+
+static Biome make_biome(
+    const std::string& name, float parameter, const std::string& top
+) {
+    Biome biome;
+    biome.name = name;
+    biome.parameters = {BiomeParameter {parameter, 1.0f}};
+    biome.plants =
+        BiomeElementList({WeightedEntry {"test:grass", 1.0f, {}}}, 0.2f);
+    biome.groundLayers = make_layers({
+        BlocksLayer {top, 2, true, {}},
+        BlocksLayer {"test:stone", -1, true, {}},
+    });
+    biome.seaLayers = make_layers({BlocksLayer {"test:water", -1, true, {}}});
+    return biome;
+}
+
+TEST(WorldGenerator, PreparedChunksMatchSynchronous) {
+    ContentBuilder builder;
+    corecontent::setup(nullptr, builder);
+    for (const auto& name : {"test:stone", "test:dirt", "test:water"}) {
+        builder.blocks.create(name).pickingItem = CORE_EMPTY;
+    }
+    auto& grass = builder.blocks.create("test:grass");
+    grass.pickingItem = CORE_EMPTY;
+    grass.obstacle = false;
+    auto content = builder.build();
+    const auto& blocks = content->blocks;
+
+    GeneratorDef def("test:generator");
+    def.seaLevel = 62;
+    def.biomeParameters = 1;
+    def.wideStructsChunksRadius = 2;
+    def.biomes = {
+        make_biome("plains", 0.0f, "test:dirt"),
+        make_biome("rocks", 1.0f, "test:stone"),
+    };
+    def.script = std::make_unique<TestGeneratorScript>(
+        blocks.require("test:stone").rt.id, blocks.require("test:dirt").rt.id
+    );
+    def.prepare(content.get());
+
+    WorldGenerator syncGenerator(def, *content, 42);
+    WorldGenerator asyncGenerator(def, *content, 42);
+    syncGenerator.update(0, 0, AREA_RADIUS * 2 + 1);
+    asyncGenerator.update(0, 0, AREA_RADIUS * 2 + 1);
+
+    std::vector<glm::ivec2> positions;
+    for (int z = -AREA_RADIUS; z <= AREA_RADIUS; z++) {
+        for (int x = -AREA_RADIUS; x <= AREA_RADIUS; x++) {
+            positions.emplace_back(x, z);
+        }
+    }
+    // prepared on the generator thread, generated on workers in any order
+    std::vector<PreparedChunk> prepared;
+    for (const auto& pos : positions) {
+        prepared.push_back(asyncGenerator.prepare(pos.x, pos.y));
+    }
+    std::vector<std::unique_ptr<voxel[]>> asyncVoxels(positions.size());
+    util::ParallelExecutor executor("test", 4);
+    executor.run(positions.size(), [&](size_t index, uint) {
+        size_t reversed = positions.size() - index - 1;
+        asyncVoxels[reversed] = std::make_unique<voxel[]>(CHUNK_VOL);
+        asyncGenerator.generate(prepared[reversed], asyncVoxels[reversed].get());
+    });
+
+    auto syncVoxels = std::make_unique<voxel[]>(CHUNK_VOL);
+    for (size_t i = 0; i < positions.size(); i++) {
+        const auto& pos = positions[i];
+        syncGenerator.generate(syncVoxels.get(), pos.x, pos.y);
+        EXPECT_EQ(
+            std::memcmp(
+                syncVoxels.get(), asyncVoxels[i].get(), sizeof(voxel) * CHUNK_VOL
+            ),
+            0
+        ) << "chunk " << pos.x << ", " << pos.y;
+    }
+}